@@ -0,0 +1,29 @@
+#version 440
+
+layout(location = 0) in vec2 texCoord;
+layout(location = 0) out vec4 fragColor;
+
+// colorMatrix: normalized samples (y, cb, cr, 1) -> RGB, range expansion and bit depth folded in
+layout(std140, binding = 0) uniform buf {
+    mat4 qt_Matrix;
+    mat4 colorMatrix;
+    float qt_Opacity;
+    int planeLayout;  // 0 = Y + interleaved CbCr (NV12/P010), 1 = Y/Cb/Cr planes, 2 = packed RGB
+};
+
+layout(binding = 1) uniform sampler2D plane0;
+layout(binding = 2) uniform sampler2D plane1;
+layout(binding = 3) uniform sampler2D plane2;
+
+void main() {
+    vec3 rgb;
+    if (planeLayout == 2) {
+        rgb = texture(plane0, texCoord).rgb;
+    } else {
+        float y = texture(plane0, texCoord).r;
+        vec2 cbcr = planeLayout == 0 ? texture(plane1, texCoord).rg
+                                     : vec2(texture(plane1, texCoord).r, texture(plane2, texCoord).r);
+        rgb = (colorMatrix * vec4(y, cbcr, 1.0)).rgb;
+    }
+    fragColor = vec4(clamp(rgb, 0.0, 1.0), 1.0) * qt_Opacity;
+}
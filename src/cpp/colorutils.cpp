@@ -1,4 +1,7 @@
 #include "colorutils.h"
+#ifdef HAS_FFMPEG_LIBS
+#include "ffmpegremuxer.h"
+#endif
 
 // Fix Windows min/max macro conflicts with std::min/std::max
 #ifdef _WIN32
@@ -73,6 +76,21 @@ static constexpr int BAD_APPLE_FRAME_BYTES = (BAD_APPLE_FRAME_WIDTH * BAD_APPLE_
 ColorUtils::ColorUtils(QObject *parent)
     : QObject(parent)
 {
+#ifdef HAS_FFMPEG_LIBS
+    m_videoFixer = new FFmpegRemuxer(this);
+    connect(m_videoFixer, &FFmpegRemuxer::progressChanged, this, [this]() {
+        emit videoFixProgress(m_videoFixer->progress());
+    });
+    connect(m_videoFixer, &FFmpegRemuxer::finished, this, [this](const FFmpegRemuxer::Result &result) {
+        if (result.success) {
+            qDebug() << "[VideoFix] Successfully fixed video. Saved to:" << result.outputPath;
+            emit videoFixFinished(QUrl::fromLocalFile(result.outputPath));
+        } else {
+            qDebug() << "[VideoFix] Fix failed:" << result.error;
+            emit videoFixFinished(QUrl());
+        }
+    });
+#endif
 }
 
 QColor ColorUtils::dominantColor(const QUrl &sourceUrl) const
@@ -915,6 +933,9 @@ qint64 ColorUtils::getAudioDuration(const QUrl &audioUrl) const
 
 bool ColorUtils::isFFmpegAvailable() const
 {
+#ifdef HAS_FFMPEG_LIBS
+    return true;  // Fixing runs in-process on the linked libraries
+#else
     // Try both "ffmpeg" and "ffmpeg.exe" for Windows compatibility
     QStringList commands = QStringList() << "ffmpeg" << "ffmpeg.exe";
     
@@ -931,10 +952,71 @@ bool ColorUtils::isFFmpegAvailable() const
     
     qDebug() << "[VideoFix] FFmpeg not found in PATH";
     return false;
+#endif
+}
+
+QString ColorUtils::videoFixOutputPath(const QString &localPath) const
+{
+    // Same container as the source; the remuxer switches to .mkv if it can't carry a codec
+    const QFileInfo fileInfo(localPath);
+    QString suffix = fileInfo.suffix().toLower();
+    if (suffix.isEmpty()) {
+        suffix = QStringLiteral("mkv");
+    }
+    const QString tempDir = QStandardPaths::writableLocation(QStandardPaths::TempLocation);
+    return tempDir + "/s3rpent_fixed_" + fileInfo.completeBaseName() + "_" + QString::number(QDateTime::currentMSecsSinceEpoch()) + "." + suffix;
+}
+
+bool ColorUtils::startVideoFix(const QUrl &videoUrl)
+{
+#ifdef HAS_FFMPEG_LIBS
+    const QString localPath = videoUrl.isLocalFile()
+            ? videoUrl.toLocalFile()
+            : videoUrl.toString(QUrl::PreferLocalFile);
+
+    if (localPath.isEmpty() || !QFileInfo::exists(localPath))
+        return false;
+
+    const QString tempPath = videoFixOutputPath(localPath);
+    qDebug() << "[VideoFix] Remuxing with timestamp repair:" << localPath << "->" << tempPath;
+    return m_videoFixer->start(localPath, tempPath);
+#else
+    // No linked FFmpeg: the CLI fallback blocks, then reports like the async path
+    const QUrl fixedUrl = fixVideoFile(videoUrl);
+    QMetaObject::invokeMethod(this, [this, fixedUrl]() {
+        emit videoFixFinished(fixedUrl);
+    }, Qt::QueuedConnection);
+    return true;
+#endif
+}
+
+void ColorUtils::cancelVideoFix()
+{
+#ifdef HAS_FFMPEG_LIBS
+    m_videoFixer->cancel();
+#endif
 }
 
 QUrl ColorUtils::fixVideoFile(const QUrl &videoUrl) const
 {
+#ifdef HAS_FFMPEG_LIBS
+    const QString localPath = videoUrl.isLocalFile()
+            ? videoUrl.toLocalFile()
+            : videoUrl.toString(QUrl::PreferLocalFile);
+
+    if (localPath.isEmpty() || !QFileInfo::exists(localPath))
+        return QUrl();
+
+    // Stream copy with regenerated timestamps - no re-encode, no timeout
+    const std::atomic_bool notCancelled(false);
+    const FFmpegRemuxer::Result result = FFmpegRemuxer::remux(localPath, videoFixOutputPath(localPath), notCancelled, nullptr);
+    if (!result.success) {
+        qDebug() << "[VideoFix] Fix failed:" << result.error;
+        return QUrl();
+    }
+    qDebug() << "[VideoFix] Successfully fixed video. Saved to:" << result.outputPath;
+    return QUrl::fromLocalFile(result.outputPath);
+#else
     if (!isFFmpegAvailable()) {
         qDebug() << "[VideoFix] FFmpeg is not available. Please install FFmpeg to fix videos.";
         return QUrl();
@@ -1011,6 +1093,7 @@ QUrl ColorUtils::fixVideoFile(const QUrl &videoUrl) const
 
     qDebug() << "[VideoFix] Fixed video file not found after processing";
     return QUrl();
+#endif
 }
 
 QString ColorUtils::readTextFile(const QUrl &fileUrl) const
@@ -6,6 +6,10 @@
 #include <QUrl>
 #include <QVariantMap>
 
+#ifdef HAS_FFMPEG_LIBS
+class FFmpegRemuxer;
+#endif
+
 class ColorUtils : public QObject
 {
     Q_OBJECT
@@ -19,7 +23,9 @@ public:
     Q_INVOKABLE QUrl saveCoverArtImage(const QVariant &imageVariant) const;
     Q_INVOKABLE QVariantMap getAudioFormatInfo(const QUrl &audioUrl, qint64 durationMs) const;
     Q_INVOKABLE qint64 getAudioDuration(const QUrl &audioUrl) const;
-    Q_INVOKABLE QUrl fixVideoFile(const QUrl &videoUrl) const;
+    Q_INVOKABLE QUrl fixVideoFile(const QUrl &videoUrl) const;  // Blocking - prefer startVideoFix()
+    Q_INVOKABLE bool startVideoFix(const QUrl &videoUrl);       // Async: videoFixProgress / videoFixFinished
+    Q_INVOKABLE void cancelVideoFix();
     Q_INVOKABLE bool isFFmpegAvailable() const;
     Q_INVOKABLE QString readTextFile(const QUrl &fileUrl) const;
     Q_INVOKABLE bool writeTextFile(const QUrl &fileUrl, const QString &content) const;
@@ -43,6 +49,17 @@ public:
     Q_INVOKABLE QUrl createBadAppleTexture() const;  // Creates texture image and returns URL
     Q_INVOKABLE int getBadAppleFrameCount() const;
     Q_INVOKABLE bool isBadAppleFramesLoaded() const;
+
+signals:
+    void videoFixProgress(qreal progress);
+    void videoFixFinished(const QUrl &fixedUrl);  // Empty on failure or cancel
+
+private:
+    QString videoFixOutputPath(const QString &localPath) const;
+
+#ifdef HAS_FFMPEG_LIBS
+    FFmpegRemuxer *m_videoFixer = nullptr;
+#endif
 };
 
 #endif // COLORUTILS_H
@@ -17,6 +17,10 @@
 #include <algorithm>
 #include <QMutexLocker>
 
+#ifdef HAS_FFMPEG_LIBS
+#include "ffmpegvideoplayer.h"
+#endif
+
 EmbeddedSubtitleExtractor::EmbeddedSubtitleExtractor(QObject *parent)
     : QObject(parent)
     , m_activeSubtitleTrack(-1)
@@ -145,6 +149,11 @@ void EmbeddedSubtitleExtractor::extractSubtitleInfo(const QUrl &videoUrl)
 }
 
 void EmbeddedSubtitleExtractor::extractFromFile(const QUrl &videoUrl, int trackIndex)
+{
+    extractTrack(videoUrl, trackIndex, true);
+}
+
+void EmbeddedSubtitleExtractor::extractTrack(const QUrl &videoUrl, int trackIndex, bool allowPlayback)
 {
     // Prevent concurrent extractions
     if (m_extracting) {
@@ -168,6 +177,9 @@ void EmbeddedSubtitleExtractor::extractFromFile(const QUrl &videoUrl, int trackI
         return;
     }
     
+    if (m_currentVideoUrl != videoUrl) {
+        resetPlaybackStreaming();  // Cues and coverage belong to the previous file
+    }
     m_currentVideoUrl = videoUrl;
     
     // First, extract subtitle stream info if not already done
@@ -190,8 +202,8 @@ void EmbeddedSubtitleExtractor::extractFromFile(const QUrl &videoUrl, int trackI
         targetTrack = 0;  // Default to first track
     }
     
-    // Check if subtitles are already extracted and cached in memory
-    if (m_subtitleData.contains(targetTrack) && !m_subtitleData[targetTrack].isEmpty()) {
+    // Check if subtitles are already extracted and cached in memory (cues streamed from playback are partial)
+    if (!m_streamedTracks.contains(targetTrack) && m_subtitleData.contains(targetTrack) && !m_subtitleData[targetTrack].isEmpty()) {
         qDebug() << "[EmbeddedSubtitleExtractor] ✅ Subtitles already cached in memory for track" << targetTrack << "- skipping extraction";
         emit extractionFinished(true);
         return;
@@ -220,6 +232,7 @@ void EmbeddedSubtitleExtractor::extractFromFile(const QUrl &videoUrl, int trackI
                     return a.startTime < b.startTime;
                 });
                 m_subtitleData[targetTrack] = entries;
+                markTrackComplete(targetTrack);
                 
                 qDebug() << "[EmbeddedSubtitleExtractor] ✅ Loaded" << entries.size() << "subtitle entries from cache for track" << targetTrack;
                 emit extractionFinished(true);
@@ -237,6 +250,13 @@ void EmbeddedSubtitleExtractor::extractFromFile(const QUrl &videoUrl, int trackI
     QVariantMap trackInfo = m_subtitleTracks[targetTrack].toMap();
     int ffmpegStreamIndex = trackInfo["ffmpegIndex"].toInt();
     
+    // The playback demuxer reads this file anyway - take the cues from it instead of scanning the whole file
+    if (allowPlayback && streamFromPlayback(localPath, targetTrack, ffmpegStreamIndex)) {
+        emit extractionFinished(true);
+        return;
+    }
+    m_scannedTracks.insert(targetTrack);
+    
     // Try FFmpeg library extraction first (FAST - uses container index!)
     if (m_ffmpegExtractor && m_ffmpegExtractor->isAvailable()) {
         qDebug() << "[EmbeddedSubtitleExtractor] 🚀 Using FFmpeg libraries for FAST extraction (stream" << ffmpegStreamIndex << ")";
@@ -289,7 +309,7 @@ void EmbeddedSubtitleExtractor::extractFromFile(const QUrl &videoUrl, int trackI
                     
                     // Emit update on main thread immediately - subtitles are NOW available for rendering!
                     QMetaObject::invokeMethod(self, [self, entriesCopy, targetTrack, processedCount]() {
-                        self->m_subtitleData[targetTrack] = entriesCopy;
+                        self->applyScannedEntries(targetTrack, entriesCopy);
                         if (processedCount % 50 == 0 || processedCount <= 20) {
                             qDebug() << "[EmbeddedSubtitleExtractor] 📊 Incremental update: now have" << processedCount << "subtitles for track" << targetTrack << "- AVAILABLE FOR RENDERING";
                         }
@@ -317,6 +337,7 @@ void EmbeddedSubtitleExtractor::extractFromFile(const QUrl &videoUrl, int trackI
                 // Final update on main thread (entries were already updated incrementally, but ensure final state)
                 QMetaObject::invokeMethod(self, [self, finalEntries, targetTrack, localPath, success]() {
                     self->m_subtitleData[targetTrack] = finalEntries;
+                    self->markTrackComplete(targetTrack);
                     
                     // Save to cache
                     QString cachePath = self->getCachePath(localPath, targetTrack);
@@ -440,6 +461,7 @@ void EmbeddedSubtitleExtractor::extractFromFileCLI(const QString &localPath, int
                 return a.startTime < b.startTime;
             });
             m_subtitleData[targetTrack] = entries;
+            markTrackComplete(targetTrack);
             
             qDebug() << "[EmbeddedSubtitleExtractor] ✅ Loaded" << entries.size() << "subtitle entries for track" << targetTrack << "(stream" << ffmpegStreamIndex << ")";
             
@@ -750,7 +772,7 @@ void EmbeddedSubtitleExtractor::setActiveSubtitleTrack(int index)
         emit activeSubtitleTrackChanged();
         
         // Extract subtitles for the selected track if not already extracted
-        if (m_enabled && !m_currentVideoUrl.isEmpty() && !m_subtitleData.contains(index)) {
+        if (m_enabled && !m_currentVideoUrl.isEmpty() && !m_subtitleData.contains(index) && !m_streamedTracks.contains(index)) {
             extractFromFile(m_currentVideoUrl, index);
         }
     }
@@ -824,6 +846,14 @@ QString EmbeddedSubtitleExtractor::getSubtitleAtPosition(qint64 positionMs)
 
 void EmbeddedSubtitleExtractor::updateCurrentSubtitle(qint64 positionMs)
 {
+    // Jumped outside what playback has demuxed: cues there (and those still showing) were never read - scan the file
+    const int track = m_activeSubtitleTrack;
+    if (m_streamedTracks.contains(track) && !m_scannedTracks.contains(track) && !m_extracting &&
+        !isCoveredByPlayback(track, positionMs)) {
+        qDebug() << "[EmbeddedSubtitleExtractor] Position" << positionMs << "ms is outside the demuxed range - scanning track" << track << "in background";
+        extractTrack(m_currentVideoUrl, track, false);
+    }
+    
     // Allow updates during extraction - we now have incremental data
     QString newText = getSubtitleAtPosition(positionMs);
     
@@ -852,8 +882,8 @@ QString EmbeddedSubtitleExtractor::readSubtitleAtPosition(const QUrl &videoUrl,
     // If not in cache, trigger background loading (but don't block)
     // This is called from the timer, so we can't wait - just trigger async load
     if (!m_currentProcess || m_currentProcess->state() == QProcess::NotRunning) {
-        // Trigger background extraction of entire track if not already done
-        if (!m_subtitleData.contains(trackIndex) || m_subtitleData[trackIndex].isEmpty()) {
+        // Trigger background extraction of entire track if not already done (or being streamed from playback)
+        if (!m_streamedTracks.contains(trackIndex) && (!m_subtitleData.contains(trackIndex) || m_subtitleData[trackIndex].isEmpty())) {
             extractFromFile(videoUrl, trackIndex);
         }
     }
@@ -877,3 +907,163 @@ QString EmbeddedSubtitleExtractor::getCachePath(const QString &videoPath, int tr
     
     return cacheDir + "/" + filename;
 }
+
+void EmbeddedSubtitleExtractor::setPlaybackSource(QObject *source)
+{
+    if (m_playbackSource == source) {
+        return;
+    }
+    
+    resetPlaybackStreaming();
+#ifdef HAS_FFMPEG_LIBS
+    if (m_playbackSource) {
+        disconnect(m_playbackSource, nullptr, this, nullptr);
+    }
+#endif
+    m_playbackSource = source;
+#ifdef HAS_FFMPEG_LIBS
+    // Signals come from the player's decode thread (queued)
+    if (FFmpegVideoPlayer *player = qobject_cast<FFmpegVideoPlayer*>(source)) {
+        connect(player, &FFmpegVideoPlayer::subtitleCue, this, &EmbeddedSubtitleExtractor::onPlaybackSubtitleCue);
+        connect(player, &FFmpegVideoPlayer::subtitleCoverageChanged, this, &EmbeddedSubtitleExtractor::onPlaybackSubtitleCoverage);
+    }
+#endif
+    emit playbackSourceChanged();
+}
+
+bool EmbeddedSubtitleExtractor::streamFromPlayback(const QString &localPath, int targetTrack, int ffmpegStreamIndex)
+{
+#ifdef HAS_FFMPEG_LIBS
+    FFmpegVideoPlayer *player = qobject_cast<FFmpegVideoPlayer*>(m_playbackSource.data());
+    if (!player || m_scannedTracks.contains(targetTrack)) {
+        return false;
+    }
+    
+    const QUrl playerUrl = player->source();
+    const QString playerPath = playerUrl.isLocalFile() ? playerUrl.toLocalFile() : playerUrl.toString(QUrl::PreferLocalFile);
+    if (playerPath.isEmpty() || QFileInfo(playerPath) != QFileInfo(localPath)) {
+        return false;
+    }
+    
+    if (!m_streamedTracks.contains(targetTrack)) {
+        qDebug() << "[EmbeddedSubtitleExtractor] 🎬 Reading track" << targetTrack << "(stream" << ffmpegStreamIndex << ") from the playback demuxer - no full scan";
+        m_streamedTracks.insert(targetTrack, ffmpegStreamIndex);
+        m_playbackCoverage.remove(targetTrack);
+        updatePlaybackSubtitleStreams();
+    }
+    return true;
+#else
+    Q_UNUSED(localPath)
+    Q_UNUSED(targetTrack)
+    Q_UNUSED(ffmpegStreamIndex)
+    return false;
+#endif
+}
+
+void EmbeddedSubtitleExtractor::updatePlaybackSubtitleStreams()
+{
+#ifdef HAS_FFMPEG_LIBS
+    if (FFmpegVideoPlayer *player = qobject_cast<FFmpegVideoPlayer*>(m_playbackSource.data())) {
+        QList<int> streams = m_streamedTracks.values();
+        std::sort(streams.begin(), streams.end());
+        streams.erase(std::unique(streams.begin(), streams.end()), streams.end());
+        player->setSubtitleStreams(streams);
+    }
+#endif
+}
+
+void EmbeddedSubtitleExtractor::resetPlaybackStreaming()
+{
+    // Streamed cues are partial - drop them so the track is read again for the next file/player
+    for (auto it = m_streamedTracks.cbegin(); it != m_streamedTracks.cend(); ++it) {
+        m_subtitleData.remove(it.key());
+    }
+    m_streamedTracks.clear();
+    m_playbackCoverage.clear();
+    m_scannedTracks.clear();
+    updatePlaybackSubtitleStreams();
+}
+
+bool EmbeddedSubtitleExtractor::isCoveredByPlayback(int track, qint64 positionMs) const
+{
+    const QList<QPair<qint64, qint64>> spans = m_playbackCoverage.value(track);
+    if (spans.isEmpty()) {
+        return true;  // Nothing demuxed yet since the track was selected - wait for playback
+    }
+    for (const QPair<qint64, qint64> &span : spans) {
+        if (positionMs >= span.first && positionMs <= span.second + COVERAGE_MARGIN_MS) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void EmbeddedSubtitleExtractor::applyScannedEntries(int track, const QList<SubtitleEntry> &scanned)
+{
+    // Scan results arrive in file order: everything up to the last one is complete,
+    // streamed cues after it are kept until the scan gets there
+    QList<SubtitleEntry> merged = scanned;
+    if (m_streamedTracks.contains(track) && !scanned.isEmpty()) {
+        const qint64 scannedTo = scanned.last().startTime;
+        for (const SubtitleEntry &entry : m_subtitleData.value(track)) {
+            if (entry.startTime > scannedTo) {
+                merged.append(entry);
+            }
+        }
+    }
+    m_subtitleData[track] = merged;
+}
+
+void EmbeddedSubtitleExtractor::markTrackComplete(int track)
+{
+    m_scannedTracks.insert(track);
+    if (m_streamedTracks.remove(track) > 0) {
+        m_playbackCoverage.remove(track);
+        updatePlaybackSubtitleStreams();  // Playback no longer needs to decode it
+    }
+}
+
+void EmbeddedSubtitleExtractor::onPlaybackSubtitleCue(int streamIndex, qint64 startMs, qint64 endMs, const QString &text)
+{
+    for (auto it = m_streamedTracks.cbegin(); it != m_streamedTracks.cend(); ++it) {
+        if (it.value() != streamIndex) {
+            continue;
+        }
+        
+        // Sorted insert; seeking back re-reads cues that are already there
+        QList<SubtitleEntry> &entries = m_subtitleData[it.key()];
+        auto pos = std::lower_bound(entries.begin(), entries.end(), startMs, [](const SubtitleEntry &entry, qint64 start) {
+            return entry.startTime < start;
+        });
+        bool duplicate = false;
+        for (auto same = pos; same != entries.end() && same->startTime == startMs; ++same) {
+            if (same->text == text) {
+                duplicate = true;
+                break;
+            }
+        }
+        if (!duplicate) {
+            entries.insert(pos, SubtitleEntry{startMs, endMs, text});
+        }
+    }
+}
+
+void EmbeddedSubtitleExtractor::onPlaybackSubtitleCoverage(qint64 fromMs, qint64 toMs)
+{
+    for (auto it = m_streamedTracks.cbegin(); it != m_streamedTracks.cend(); ++it) {
+        // Between seeks the demuxer only moves forward: a report extends the span it started in
+        QList<QPair<qint64, qint64>> &spans = m_playbackCoverage[it.key()];
+        bool extended = false;
+        for (QPair<qint64, qint64> &span : spans) {
+            if (fromMs <= span.second && toMs >= span.first) {
+                span.first = qMin(span.first, fromMs);
+                span.second = qMax(span.second, toMs);
+                extended = true;
+                break;
+            }
+        }
+        if (!extended) {
+            spans.append(qMakePair(fromMs, toMs));
+        }
+    }
+}
@@ -10,6 +10,8 @@
 #include <QMap>
 #include <QPair>
 #include <QMutex>
+#include <QPointer>
+#include <QSet>
 
 // Forward declarations
 class FFmpegSubtitleExtractor;
@@ -23,6 +25,7 @@ class EmbeddedSubtitleExtractor : public QObject
     Q_PROPERTY(QString currentSubtitleText READ currentSubtitleText NOTIFY currentSubtitleTextChanged)
     Q_PROPERTY(bool enabled READ enabled WRITE setEnabled NOTIFY enabledChanged)
     Q_PROPERTY(bool extracting READ extracting NOTIFY extractingChanged)
+    Q_PROPERTY(QObject* playbackSource READ playbackSource WRITE setPlaybackSource NOTIFY playbackSourceChanged)
     
 public:
     explicit EmbeddedSubtitleExtractor(QObject *parent = nullptr);
@@ -49,6 +52,12 @@ public:
     void setEnabled(bool enabled);
     bool extracting() const { return m_extracting; }
     
+    // Player whose demuxer delivers cues during playback (FFmpegVideoPlayer, null = none).
+    // While it plays the same file, a selected track is filled from the packets playback reads anyway;
+    // the whole file is only scanned when the position jumps outside what has been demuxed.
+    QObject* playbackSource() const { return m_playbackSource.data(); }
+    void setPlaybackSource(QObject *source);
+    
     // Get subtitle text for a specific position (in milliseconds)
     Q_INVOKABLE QString getSubtitleAtPosition(qint64 positionMs);
     
@@ -60,6 +69,11 @@ signals:
     void extractingChanged();
     void extractionFinished(bool success);
     void extractionProgress(int percentage);
+    void playbackSourceChanged();
+    
+private slots:
+    void onPlaybackSubtitleCue(int streamIndex, qint64 startMs, qint64 endMs, const QString &text);
+    void onPlaybackSubtitleCoverage(qint64 fromMs, qint64 toMs);
     
 private:
     struct SubtitleEntry {
@@ -89,6 +103,17 @@ private:
     // CLI-based extraction (fallback when libraries not available)
     void extractFromFileCLI(const QString &localPath, int ffmpegStreamIndex, int targetTrack);
     
+    // extractFromFile() body; allowPlayback = take cues from the playback demuxer when it reads this file
+    void extractTrack(const QUrl &videoUrl, int trackIndex, bool allowPlayback);
+    
+    // Playback demuxer cues (see playbackSource)
+    bool streamFromPlayback(const QString &localPath, int targetTrack, int ffmpegStreamIndex);
+    void updatePlaybackSubtitleStreams();
+    void resetPlaybackStreaming();
+    bool isCoveredByPlayback(int track, qint64 positionMs) const;
+    void applyScannedEntries(int track, const QList<SubtitleEntry> &scanned);  // Keeps cues streamed past the scan
+    void markTrackComplete(int track);
+    
     QVariantList m_subtitleTracks;
     int m_activeSubtitleTrack;
     QString m_currentSubtitleText;
@@ -108,6 +133,13 @@ private:
     
     // Mutex to protect FFmpeg extractor from concurrent access
     QMutex m_extractionMutex;
+    
+    // Cues from the playback demuxer
+    QPointer<QObject> m_playbackSource;
+    QMap<int, int> m_streamedTracks;                            // track index -> FFmpeg stream index
+    QMap<int, QList<QPair<qint64, qint64>>> m_playbackCoverage; // track index -> spans demuxed since it was selected (ms)
+    QSet<int> m_scannedTracks;                                  // Whole file scanned (or scan started) - never re-triggered
+    static constexpr qint64 COVERAGE_MARGIN_MS = 3000;          // Position may run this far past the last coverage report
 };
 
 #endif // EMBEDDEDSUBTITLEEXTRACTOR_H
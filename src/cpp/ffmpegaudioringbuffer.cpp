@@ -0,0 +1,149 @@
+#include "ffmpegaudioringbuffer.h"
+#include <QDeadlineTimer>
+#include <cstring>
+
+namespace {
+    quint64 roundUpPowerOfTwo(quint64 value)
+    {
+        quint64 result = 1;
+        while (result < value) {
+            result <<= 1;
+        }
+        return result;
+    }
+}
+
+FFmpegAudioRingBuffer::FFmpegAudioRingBuffer(qint64 capacityBytes, int bytesPerFrame, QObject* parent)
+    : QIODevice(parent)
+    , m_bytesPerFrame(qMax(1, bytesPerFrame))
+{
+    const quint64 size = roundUpPowerOfTwo(quint64(qMax<qint64>(capacityBytes, 4096)));
+    m_buffer.resize(size);
+    m_mask = size - 1;
+}
+
+qint64 FFmpegAudioRingBuffer::queuedBytes() const
+{
+    const quint64 write = m_writePos.load(std::memory_order_acquire);
+    const quint64 read = qMax(m_readPos.load(std::memory_order_acquire), m_discardUpTo.load(std::memory_order_acquire));
+    return write > read ? qint64(write - read) : 0;
+}
+
+qint64 FFmpegAudioRingBuffer::freeBytes() const
+{
+    // Space is reclaimed once the consumer moved past it, or once it was discarded - a paused or
+    // starved sink may not read again for a long time, but it skips discarded bytes without reading them.
+    // (A read already in flight when discardQueued() ran may copy a few overwritten bytes - that audio was
+    // being thrown away anyway.)
+    const quint64 write = m_writePos.load(std::memory_order_relaxed);
+    const quint64 read = qMax(m_readPos.load(std::memory_order_acquire), m_discardUpTo.load(std::memory_order_acquire));
+    return capacity() - qint64(write - read);
+}
+
+bool FFmpegAudioRingBuffer::waitForFreeBytes(qint64 bytes, int timeoutMs)
+{
+    bytes = qMin(bytes, capacity());
+    QMutexLocker locker(&m_spaceMutex);
+    m_spaceWaiters.fetch_add(1, std::memory_order_seq_cst);
+    // Registered before re-checking: a read completing after this check is guaranteed to see the waiter
+    const bool ready = freeBytes() >= bytes || m_spaceAvailable.wait(&m_spaceMutex, QDeadlineTimer(timeoutMs));
+    m_spaceWaiters.fetch_sub(1, std::memory_order_relaxed);
+    return ready && freeBytes() >= bytes;
+}
+
+void FFmpegAudioRingBuffer::wakeProducer()
+{
+    std::atomic_thread_fence(std::memory_order_seq_cst);  // Position store before the waiter check
+    if (m_spaceWaiters.load(std::memory_order_seq_cst) > 0) {
+        QMutexLocker locker(&m_spaceMutex);
+        m_spaceAvailable.wakeAll();
+    }
+}
+
+qint64 FFmpegAudioRingBuffer::push(const char* data, qint64 bytes)
+{
+    const qint64 toWrite = qMin(bytes, freeBytes());
+    if (toWrite <= 0) {
+        return 0;
+    }
+
+    const quint64 write = m_writePos.load(std::memory_order_relaxed);
+    const quint64 offset = write & m_mask;
+    const qint64 first = qMin<qint64>(toWrite, capacity() - qint64(offset));
+    std::memcpy(m_buffer.data() + offset, data, size_t(first));
+    if (toWrite > first) {
+        std::memcpy(m_buffer.data(), data + first, size_t(toWrite - first));
+    }
+
+    const bool wasEmpty = queuedBytes() == 0;
+    m_writePos.store(write + quint64(toWrite), std::memory_order_release);
+
+    // Wake an idle sink (it stops pulling after a long underrun on some backends)
+    if (wasEmpty) {
+        emit readyRead();
+    }
+    return toWrite;
+}
+
+quint64 FFmpegAudioRingBuffer::discardQueued()
+{
+    const quint64 write = m_writePos.load(std::memory_order_relaxed);
+    m_discardUpTo.store(write, std::memory_order_release);
+    wakeProducer();
+    return write;
+}
+
+qint64 FFmpegAudioRingBuffer::bytesAvailable() const
+{
+    return queuedBytes() + QIODevice::bytesAvailable();
+}
+
+qint64 FFmpegAudioRingBuffer::readData(char* data, qint64 maxSize)
+{
+    if (maxSize <= 0) {
+        return 0;
+    }
+
+    quint64 read = m_readPos.load(std::memory_order_relaxed);
+    const quint64 discardUpTo = m_discardUpTo.load(std::memory_order_acquire);
+    if (discardUpTo > read) {
+        read = discardUpTo;
+        m_readPos.store(read, std::memory_order_release);
+    }
+
+    const quint64 write = m_writePos.load(std::memory_order_acquire);
+    qint64 toRead = qMin<qint64>(maxSize, qint64(write - read));
+    toRead -= toRead % m_bytesPerFrame;  // Never hand out half a sample frame
+
+    if (toRead > 0) {
+        const quint64 offset = read & m_mask;
+        const qint64 first = qMin<qint64>(toRead, capacity() - qint64(offset));
+        std::memcpy(data, m_buffer.data() + offset, size_t(first));
+        if (toRead > first) {
+            std::memcpy(data + first, m_buffer.data(), size_t(toRead - first));
+        }
+        m_readPos.store(read + quint64(toRead), std::memory_order_release);
+        wakeProducer();
+    }
+
+    if (toRead < maxSize) {
+        // Underrun: pad with silence so the device keeps streaming, but don't count it as consumed
+        if (toRead == 0) {
+            m_underruns.fetch_add(1, std::memory_order_relaxed);
+        }
+        const qint64 padded = maxSize - (maxSize % m_bytesPerFrame);
+        if (padded > toRead) {
+            std::memset(data + toRead, 0, size_t(padded - toRead));
+            return padded;
+        }
+    }
+    return toRead;
+}
+
+qint64 FFmpegAudioRingBuffer::writeData(const char* data, qint64 maxSize)
+{
+    // Producer side goes through push() - the sink never writes to its source
+    Q_UNUSED(data);
+    Q_UNUSED(maxSize);
+    return -1;
+}
@@ -0,0 +1,76 @@
+#ifndef FFMPEGAUDIORINGBUFFER_H
+#define FFMPEGAUDIORINGBUFFER_H
+
+#include <QIODevice>
+#include <QMutex>
+#include <QWaitCondition>
+#include <atomic>
+#include <vector>
+
+/**
+ * Lock-free single-producer/single-consumer PCM ring, read by QAudioSink in pull mode
+ *
+ * The decode thread push()es resampled PCM; the sink pulls it through readData() on its
+ * own thread. Neither side takes a lock. Read/write positions are monotonic byte counters,
+ * so the number of bytes actually consumed by the sink is always known (readPosition())
+ * and the audio clock can be derived from it instead of from write timing.
+ *
+ * On underrun readData() pads with silence (keeps the device streaming) without advancing
+ * the read position, so the clock stops instead of running ahead of the audio.
+ *
+ * A full ring makes the producer block in waitForFreeBytes() until the sink consumes audio
+ * (readData() wakes it) or discardQueued() frees the ring - no polling.
+ */
+class FFmpegAudioRingBuffer : public QIODevice
+{
+    Q_OBJECT
+
+public:
+    // capacityBytes is rounded up to a power of two; bytesPerFrame keeps reads frame-aligned
+    FFmpegAudioRingBuffer(qint64 capacityBytes, int bytesPerFrame, QObject* parent = nullptr);
+
+    // Producer (decode thread): copy as much as fits, returns bytes accepted
+    qint64 push(const char* data, qint64 bytes);
+
+    // Drop everything queued so far (seek/restart) - the consumer skips it on its next read.
+    // Safe from any thread. Returns the write position the next push() starts at.
+    quint64 discardQueued();
+
+    qint64 capacity() const { return qint64(m_buffer.size()); }
+    qint64 queuedBytes() const;  // Written but not yet consumed
+    qint64 freeBytes() const;    // Includes discarded bytes the consumer hasn't skipped yet
+
+    // Producer: block until at least bytes (capped at capacity) are free, discardQueued() ran,
+    // or timeoutMs passed (lets the caller re-check stop/seek). Returns true if the space is free.
+    bool waitForFreeBytes(qint64 bytes, int timeoutMs);
+
+    quint64 writePosition() const { return m_writePos.load(std::memory_order_acquire); }
+    quint64 readPosition() const { return m_readPos.load(std::memory_order_acquire); }  // Bytes consumed by the sink
+    quint64 underruns() const { return m_underruns.load(std::memory_order_relaxed); }
+
+    bool isSequential() const override { return true; }
+    qint64 bytesAvailable() const override;
+
+protected:
+    qint64 readData(char* data, qint64 maxSize) override;
+    qint64 writeData(const char* data, qint64 maxSize) override;
+
+private:
+    void wakeProducer();
+
+    std::vector<char> m_buffer;
+    quint64 m_mask = 0;
+    int m_bytesPerFrame = 1;
+
+    std::atomic<quint64> m_writePos{0};     // Producer only
+    std::atomic<quint64> m_readPos{0};      // Consumer only
+    std::atomic<quint64> m_discardUpTo{0};  // Producer request: consumer skips to this position
+    std::atomic<quint64> m_underruns{0};
+
+    // Producer blocked on a full ring (the consumer only locks while someone waits)
+    QMutex m_spaceMutex;
+    QWaitCondition m_spaceAvailable;
+    std::atomic<int> m_spaceWaiters{0};
+};
+
+#endif // FFMPEGAUDIORINGBUFFER_H
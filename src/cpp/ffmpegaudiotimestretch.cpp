@@ -0,0 +1,179 @@
+#include "ffmpegaudiotimestretch.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    constexpr double WINDOW_SECONDS = 0.030;   // Long enough for low voices, short enough not to smear transients
+    constexpr double SEARCH_SECONDS = 0.008;
+    constexpr int COARSE_STEP = 4;             // Coarse search: every 4th offset, every 2nd sample
+    constexpr qint64 COMPACT_FRAMES = 8192;    // Drop consumed input in chunks, not per window
+    constexpr double PI = 3.14159265358979323846;
+
+    inline int16_t toSample(float value)
+    {
+        return int16_t(std::lrint(std::clamp(value, -32768.0f, 32767.0f)));
+    }
+}
+
+void FFmpegAudioTimeStretch::configure(int sampleRate, int channels)
+{
+    m_sampleRate = qMax(1, sampleRate);
+    m_channels = qMax(1, channels);
+    m_overlap = qMax(64, int(m_sampleRate * WINDOW_SECONDS / 2.0));
+    m_window = m_overlap * 2;
+    m_search = qMax(16, int(m_sampleRate * SEARCH_SECONDS));
+
+    m_fade.resize(size_t(m_overlap));
+    for (int i = 0; i < m_overlap; ++i) {
+        m_fade[size_t(i)] = float(0.5 - 0.5 * std::cos(PI * (i + 0.5) / m_overlap));
+    }
+    reset();
+}
+
+void FFmpegAudioTimeStretch::setRate(double rate)
+{
+    rate = qBound(MIN_RATE, rate, MAX_RATE);
+    if (rate == m_rate) {
+        return;
+    }
+    m_rate = rate;
+    reset();
+}
+
+void FFmpegAudioTimeStretch::reset()
+{
+    m_input.clear();
+    m_mono.clear();
+    m_tail.clear();
+    m_nominal = 0.0;
+    m_reference = -1;
+}
+
+void FFmpegAudioTimeStretch::process(const int16_t* input, int frames, QByteArray* out)
+{
+    if (frames <= 0 || m_channels <= 0) {
+        return;
+    }
+    if (isBypassed()) {
+        out->append(reinterpret_cast<const char*>(input), frames * m_channels * int(sizeof(int16_t)));
+        return;
+    }
+
+    const float monoScale = 1.0f / float(m_channels);
+    m_input.reserve(m_input.size() + size_t(frames) * size_t(m_channels));
+    m_mono.reserve(m_mono.size() + size_t(frames));
+    for (int i = 0; i < frames; ++i) {
+        float sum = 0.0f;
+        for (int c = 0; c < m_channels; ++c) {
+            const float sample = input[i * m_channels + c];
+            m_input.push_back(sample);
+            sum += sample;
+        }
+        m_mono.push_back(sum * monoScale);
+    }
+
+    for (;;) {
+        const qint64 available = qint64(m_mono.size());
+        const qint64 nominal = std::llround(m_nominal);
+        qint64 start = nominal;
+        if (m_reference < 0) {
+            if (available < nominal + m_window) {
+                break;
+            }
+        } else {
+            if (available < nominal + m_search + m_window) {
+                break;
+            }
+            start = findBestOffset(nominal);
+        }
+
+        emitSegment(start, out);
+        m_reference = start + m_overlap;
+        m_nominal += m_rate * m_overlap;
+    }
+
+    compact();
+}
+
+qint64 FFmpegAudioTimeStretch::findBestOffset(qint64 nominal) const
+{
+    // Compare candidates with the natural continuation of the previous window (what m_tail holds)
+    const float* reference = m_mono.data() + m_reference;
+    const qint64 low = qMax<qint64>(0, nominal - m_search);
+    const qint64 high = nominal + m_search;
+
+    auto score = [&](qint64 start, int sampleStep) {
+        const float* candidate = m_mono.data() + start;
+        double dot = 0.0;
+        double energy = 1e-9;
+        for (int i = 0; i < m_overlap; i += sampleStep) {
+            dot += double(reference[i]) * candidate[i];
+            energy += double(candidate[i]) * candidate[i];
+        }
+        return dot / std::sqrt(energy);
+    };
+
+    qint64 best = nominal;
+    double bestScore = score(nominal, 2);
+    for (qint64 start = low; start <= high; start += COARSE_STEP) {
+        const double value = score(start, 2);
+        if (value > bestScore) {
+            bestScore = value;
+            best = start;
+        }
+    }
+
+    const qint64 coarse = best;
+    bestScore = score(coarse, 1);
+    for (qint64 start = qMax(low, coarse - COARSE_STEP + 1); start <= qMin(high, coarse + COARSE_STEP - 1); ++start) {
+        const double value = score(start, 1);
+        if (value > bestScore) {
+            bestScore = value;
+            best = start;
+        }
+    }
+    return best;
+}
+
+void FFmpegAudioTimeStretch::emitSegment(qint64 start, QByteArray* out)
+{
+    const int samples = m_overlap * m_channels;
+    const qsizetype offset = out->size();
+    out->resize(offset + samples * qsizetype(sizeof(int16_t)));
+    int16_t* dst = reinterpret_cast<int16_t*>(out->data() + offset);
+
+    // First half of this window, crossfaded with the second half of the previous one
+    const float* head = m_input.data() + start * m_channels;
+    if (m_tail.empty()) {
+        for (int i = 0; i < samples; ++i) {
+            dst[i] = toSample(head[i]);
+        }
+    } else {
+        for (int i = 0; i < m_overlap; ++i) {
+            const float fadeIn = m_fade[size_t(i)];
+            for (int c = 0; c < m_channels; ++c) {
+                const int index = i * m_channels + c;
+                dst[index] = toSample(m_tail[size_t(index)] * (1.0f - fadeIn) + head[index] * fadeIn);
+            }
+        }
+    }
+
+    m_tail.assign(head + samples, head + samples * 2);
+}
+
+void FFmpegAudioTimeStretch::compact()
+{
+    // Still needed: the previous window's second half (search reference) and the next search range
+    qint64 keepFrom = qMin<qint64>(qint64(m_nominal) - m_search, m_reference < 0 ? qint64(m_nominal) : m_reference);
+    keepFrom = qBound<qint64>(0, keepFrom, qint64(m_mono.size()));
+    if (keepFrom < COMPACT_FRAMES) {
+        return;
+    }
+
+    m_mono.erase(m_mono.begin(), m_mono.begin() + keepFrom);
+    m_input.erase(m_input.begin(), m_input.begin() + keepFrom * m_channels);
+    m_nominal -= double(keepFrom);
+    if (m_reference >= 0) {
+        m_reference -= keepFrom;
+    }
+}
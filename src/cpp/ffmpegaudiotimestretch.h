@@ -0,0 +1,63 @@
+#ifndef FFMPEGAUDIOTIMESTRETCH_H
+#define FFMPEGAUDIOTIMESTRETCH_H
+
+#include <QByteArray>
+#include <QtGlobal>
+#include <cstdint>
+#include <vector>
+
+/**
+ * Pitch-preserving time stretch for interleaved S16 PCM (WSOLA, like FFmpeg's atempo)
+ *
+ * The input is cut into 30 ms raised-cosine windows advanced by rate * 15 ms; each window is
+ * placed where it best continues the previous one (normalized cross-correlation on a mono
+ * downmix, searched +-8 ms around its nominal position: coarse pass, then refined) and
+ * overlap-added at a fixed 15 ms output hop. Output duration = input duration / rate,
+ * pitch unchanged. Rate 1 passes samples through untouched.
+ *
+ * Not thread-safe - owned by the decode thread.
+ */
+class FFmpegAudioTimeStretch
+{
+public:
+    static constexpr double MIN_RATE = 0.25;
+    static constexpr double MAX_RATE = 4.0;
+
+    FFmpegAudioTimeStretch() = default;
+
+    // Output format (same as input). Drops buffered audio.
+    void configure(int sampleRate, int channels);
+
+    // Drops buffered audio when the rate actually changes
+    void setRate(double rate);
+    double rate() const { return m_rate; }
+    bool isBypassed() const { return m_rate == 1.0; }
+
+    // Forget buffered input (seek, rate change)
+    void reset();
+
+    // Feed `frames` interleaved samples per channel, append the stretched output to `out`
+    void process(const int16_t* input, int frames, QByteArray* out);
+
+private:
+    qint64 findBestOffset(qint64 nominal) const;
+    void emitSegment(qint64 start, QByteArray* out);
+    void compact();
+
+    int m_sampleRate = 0;
+    int m_channels = 0;
+    double m_rate = 1.0;
+
+    int m_window = 0;       // Frames per analysis window (2 * m_overlap)
+    int m_overlap = 0;      // Crossfade length = output hop
+    int m_search = 0;       // +- search range around the nominal position
+
+    std::vector<float> m_input;   // Interleaved input not yet consumed
+    std::vector<float> m_mono;    // Downmix of m_input (correlation search)
+    std::vector<float> m_tail;    // Second half of the previous window (interleaved), crossfaded into the next
+    std::vector<float> m_fade;    // Raised-cosine fade-in of m_overlap frames
+    double m_nominal = 0.0;       // Nominal start of the next window in m_input (advances by rate * m_overlap)
+    qint64 m_reference = -1;      // Second half of the previous window in m_input (-1 = none yet)
+};
+
+#endif // FFMPEGAUDIOTIMESTRETCH_H
@@ -0,0 +1,211 @@
+#include "ffmpegdecodebenchmark.h"
+#include "ffmpegvideoplayer.h"
+#include <QCommandLineParser>
+#include <QDateTime>
+#include <QDebug>
+#include <QEventLoop>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <QSysInfo>
+#include <QThread>
+#include <QTimer>
+#include <QVariantMap>
+#include <cstdio>
+#include <cstring>
+
+#ifdef Q_OS_WIN
+#include <windows.h>
+#include <psapi.h>
+#pragma comment(lib, "psapi.lib")
+#else
+#include <sys/resource.h>
+#endif
+
+extern "C" {
+#include <libavutil/avutil.h>
+#include <libavutil/time.h>
+}
+
+namespace {
+    const char* const BENCHMARK_OPTION = "--benchmark";
+    constexpr int POLL_INTERVAL_MS = 5;
+
+    double milliseconds(qint64 us)
+    {
+        return double(us) / 1000.0;
+    }
+}
+
+bool FFmpegDecodeBenchmark::isRequested(int argc, char* argv[])
+{
+    // "--benchmark <file>" or "--benchmark=<file>" (both accepted by the parser in run()),
+    // but not the other --benchmark-* options on their own
+    const size_t optionLength = std::strlen(BENCHMARK_OPTION);
+    for (int i = 1; i < argc; ++i) {
+        if (std::strncmp(argv[i], BENCHMARK_OPTION, optionLength) == 0 &&
+            (argv[i][optionLength] == '\0' || argv[i][optionLength] == '=')) {
+            return true;
+        }
+    }
+    return false;
+}
+
+int FFmpegDecodeBenchmark::run(const QStringList& arguments)
+{
+    QCommandLineParser parser;
+    const QCommandLineOption fileOption(QStringLiteral("benchmark"), QStringLiteral("Video file to decode."), QStringLiteral("file"));
+    const QCommandLineOption framesOption(QStringLiteral("benchmark-frames"), QStringLiteral("Stop after n frames."), QStringLiteral("n"), QStringLiteral("0"));
+    const QCommandLineOption threadsOption(QStringLiteral("benchmark-threads"), QStringLiteral("Decoder thread cap (0 = auto)."), QStringLiteral("n"), QStringLiteral("-1"));
+    const QCommandLineOption softwareOption(QStringLiteral("benchmark-software"), QStringLiteral("Software decoding only."));
+    const QCommandLineOption jsonOption(QStringLiteral("benchmark-json"), QStringLiteral("Report path (default: stdout)."), QStringLiteral("path"));
+    const QCommandLineOption labelOption(QStringLiteral("benchmark-label"), QStringLiteral("Label copied into the report."), QStringLiteral("text"));
+    parser.addOptions({ fileOption, framesOption, threadsOption, softwareOption, jsonOption, labelOption });
+    if (!parser.parse(arguments)) {
+        qCritical() << "[Benchmark]" << parser.errorText();
+        return 2;
+    }
+
+    const QFileInfo fileInfo(parser.value(fileOption));
+    if (!fileInfo.isFile()) {
+        qCritical() << "[Benchmark] Not a file:" << parser.value(fileOption);
+        return 2;
+    }
+
+    FFmpegVideoPlayer::BenchmarkOptions options;
+    options.softwareDecoding = parser.isSet(softwareOption);
+    options.decoderThreads = parser.value(threadsOption).toInt();
+    options.frameLimit = parser.value(framesOption).toULongLong();
+
+    FFmpegVideoPlayer player;
+    player.setBenchmarkMode(options);
+
+    QString error;
+    QObject::connect(&player, &FFmpegVideoPlayer::errorOccurred, [&error](int, const QString& message) {
+        error = message;
+    });
+
+    player.setSource(QUrl::fromLocalFile(fileInfo.absoluteFilePath()));
+    if (player.implicitWidth() <= 0) {
+        qCritical() << "[Benchmark] Failed to open" << fileInfo.absoluteFilePath() << error;
+        return 1;
+    }
+
+    qInfo() << "[Benchmark] Decoding" << fileInfo.fileName() << player.implicitWidth() << "x" << player.implicitHeight()
+            << (options.softwareDecoding ? "(software)" : "");
+
+    // The decode thread stops playback at the end of the stream or the frame limit
+    const qint64 startUs = av_gettime_relative();
+    player.play();
+
+    QEventLoop loop;
+    QTimer poll;
+    QObject::connect(&poll, &QTimer::timeout, &loop, [&]() {
+        if (player.playbackState() != FFmpegVideoPlayer::PlayingState || !error.isEmpty()) {
+            loop.quit();
+        }
+    });
+    poll.start(POLL_INTERVAL_MS);
+    loop.exec();
+
+    const FFmpegVideoPlayer::BenchmarkCounters counters = player.benchmarkCounters();
+    const FFmpegFramePool::Stats pool = player.framePoolStats();
+    const QVariantMap statistics = player.statistics();
+    player.stop();
+
+    // Wall time up to the last converted frame (not up to the poll that noticed the end)
+    const qint64 endUs = counters.lastFrameUs > 0 ? counters.lastFrameUs : av_gettime_relative();
+    const double wallSeconds = qMax(1e-6, double(endUs - startUs) / 1000000.0);
+    const double frames = double(qMax<quint64>(1, counters.frames));
+
+    QJsonObject video;
+    video.insert(QStringLiteral("width"), player.implicitWidth());
+    video.insert(QStringLiteral("height"), player.implicitHeight());
+    video.insert(QStringLiteral("durationMs"), player.duration());
+    video.insert(QStringLiteral("decoder"), statistics.value(QStringLiteral("decoder")).toString());
+    video.insert(QStringLiteral("hardwareDecoding"), statistics.value(QStringLiteral("hardwareDecoding")).toBool());
+    video.insert(QStringLiteral("decoderThreads"), statistics.value(QStringLiteral("decoderThreads")).toInt());
+    video.insert(QStringLiteral("decoderThreadType"), statistics.value(QStringLiteral("decoderThreadType")).toString());
+    if (statistics.contains(QStringLiteral("toneMapper"))) {
+        video.insert(QStringLiteral("toneMapper"), statistics.value(QStringLiteral("toneMapper")).toString());
+    }
+
+    QJsonObject stages;
+    stages.insert(QStringLiteral("demuxMs"), milliseconds(counters.demuxUs));
+    stages.insert(QStringLiteral("decodeMs"), milliseconds(counters.decodeUs));
+    stages.insert(QStringLiteral("transferMs"), milliseconds(counters.transferUs));
+    stages.insert(QStringLiteral("convertMs"), milliseconds(counters.convertUs));
+
+    QJsonObject perFrame;
+    perFrame.insert(QStringLiteral("demuxMs"), milliseconds(counters.demuxUs) / frames);
+    perFrame.insert(QStringLiteral("decodeMs"), milliseconds(counters.decodeUs) / frames);
+    perFrame.insert(QStringLiteral("transferMs"), milliseconds(counters.transferUs) / frames);
+    perFrame.insert(QStringLiteral("convertMs"), milliseconds(counters.convertUs) / frames);
+
+    QJsonObject framePool;
+    framePool.insert(QStringLiteral("allocations"), qint64(pool.allocations));
+    framePool.insert(QStringLiteral("reuses"), qint64(pool.reuses));
+    framePool.insert(QStringLiteral("resizes"), qint64(pool.resizes));
+    framePool.insert(QStringLiteral("capacity"), pool.capacity);
+    framePool.insert(QStringLiteral("blockBytes"), pool.blockBytes);
+
+    QJsonObject report;
+    report.insert(QStringLiteral("label"), parser.value(labelOption));
+    report.insert(QStringLiteral("file"), fileInfo.fileName());
+    report.insert(QStringLiteral("fileBytes"), fileInfo.size());
+    report.insert(QStringLiteral("timestamp"), QDateTime::currentDateTimeUtc().toString(Qt::ISODate));
+    report.insert(QStringLiteral("os"), QSysInfo::prettyProductName());
+    report.insert(QStringLiteral("cpuCores"), QThread::idealThreadCount());
+    report.insert(QStringLiteral("qt"), QString::fromLatin1(qVersion()));
+    report.insert(QStringLiteral("ffmpeg"), QString::fromLatin1(av_version_info()));
+    report.insert(QStringLiteral("video"), video);
+    report.insert(QStringLiteral("frames"), qint64(counters.frames));
+    report.insert(QStringLiteral("frameLimit"), qint64(options.frameLimit));
+    report.insert(QStringLiteral("wallSeconds"), wallSeconds);
+    report.insert(QStringLiteral("fps"), double(counters.frames) / wallSeconds);
+    report.insert(QStringLiteral("stagesMs"), stages);
+    report.insert(QStringLiteral("stagesMsPerFrame"), perFrame);
+    report.insert(QStringLiteral("framePool"), framePool);
+    const qint64 peakRss = peakRssBytes();
+    report.insert(QStringLiteral("peakRssMB"), peakRss >= 0 ? double(peakRss) / (1024.0 * 1024.0) : -1.0);
+    if (!error.isEmpty()) {
+        report.insert(QStringLiteral("error"), error);
+    }
+
+    const QByteArray json = QJsonDocument(report).toJson(QJsonDocument::Indented);
+    if (parser.isSet(jsonOption)) {
+        QSaveFile file(parser.value(jsonOption));
+        if (!file.open(QIODevice::WriteOnly) || file.write(json) != json.size() || !file.commit()) {
+            qCritical() << "[Benchmark] Failed to write report:" << parser.value(jsonOption);
+            return 1;
+        }
+    } else {
+        std::fwrite(json.constData(), 1, size_t(json.size()), stdout);
+        std::fflush(stdout);
+    }
+
+    qInfo() << "[Benchmark]" << counters.frames << "frames in" << wallSeconds << "s =" << double(counters.frames) / wallSeconds << "fps";
+    return counters.frames > 0 && error.isEmpty() ? 0 : 1;
+}
+
+qint64 FFmpegDecodeBenchmark::peakRssBytes()
+{
+#ifdef Q_OS_WIN
+    PROCESS_MEMORY_COUNTERS counters = {};
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return qint64(counters.PeakWorkingSetSize);
+    }
+    return -1;
+#else
+    struct rusage usage = {};
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return -1;
+    }
+#ifdef Q_OS_MACOS
+    return qint64(usage.ru_maxrss);         // Bytes on macOS
+#else
+    return qint64(usage.ru_maxrss) * 1024;  // Kilobytes on Linux
+#endif
+#endif
+}
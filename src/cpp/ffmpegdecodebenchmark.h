@@ -0,0 +1,33 @@
+#ifndef FFMPEGDECODEBENCHMARK_H
+#define FFMPEGDECODEBENCHMARK_H
+
+#include <QStringList>
+#include <QtGlobal>
+
+/**
+ * Headless decode benchmark: s3rpent_media --benchmark <file> [options]
+ *
+ * Runs FFmpegVideoPlayer's demux → decode → (hardware download) → convert pipeline without a
+ * window, video sink or audio, as fast as it goes, and writes a JSON report: fps, time per
+ * stage, frame pool allocations and peak RSS. For comparing builds and machines (CI).
+ *
+ *   --benchmark-frames <n>     stop after n converted frames (default: whole file)
+ *   --benchmark-threads <n>    decoder thread cap for this run (0 = auto; default: the saved setting)
+ *   --benchmark-software       software decoding only
+ *   --benchmark-json <path>    write the report here instead of stdout
+ *   --benchmark-label <text>   copied into the report (e.g. the commit being measured)
+ */
+class FFmpegDecodeBenchmark
+{
+public:
+    // True if the command line asks for a benchmark run (checked before any QApplication exists)
+    static bool isRequested(int argc, char* argv[]);
+
+    // Needs a QCoreApplication (no GUI). Returns the process exit code.
+    static int run(const QStringList& arguments);
+
+private:
+    static qint64 peakRssBytes();  // -1 if unknown
+};
+
+#endif // FFMPEGDECODEBENCHMARK_H
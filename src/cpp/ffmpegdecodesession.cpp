@@ -0,0 +1,67 @@
+#include "ffmpegdecodesession.h"
+#include <QDebug>
+#include <QFileInfo>
+
+QHash<QString, std::weak_ptr<FFmpegDecodeSession>> FFmpegDecodeSession::s_sessions;
+
+std::shared_ptr<FFmpegDecodeSession> FFmpegDecodeSession::acquire(const QString& key)
+{
+    std::shared_ptr<FFmpegDecodeSession> session = s_sessions.value(key).lock();
+    if (!session) {
+        session.reset(new FFmpegDecodeSession(key));
+        s_sessions.insert(key, session);
+    }
+    return session;
+}
+
+QString FFmpegDecodeSession::keyFor(const QUrl& source)
+{
+    if (!source.isLocalFile()) {
+        return QString();
+    }
+    const QFileInfo info(source.toLocalFile());
+    const QString canonical = info.canonicalFilePath();  // Same file through different paths/links
+    return canonical.isEmpty() ? info.absoluteFilePath() : canonical;
+}
+
+FFmpegDecodeSession::~FFmpegDecodeSession()
+{
+    // Last player left (a newer session for the same key may already exist)
+    auto it = s_sessions.find(m_key);
+    if (it != s_sessions.end() && it.value().expired()) {
+        s_sessions.erase(it);
+    }
+}
+
+bool FFmpegDecodeSession::join(FFmpegVideoPlayer* player)
+{
+    if (!m_decoder) {
+        m_decoder = player;
+        return true;
+    }
+    if (player != m_decoder && !m_followers.contains(player)) {
+        m_followers.append(player);
+        qDebug() << "[FFmpeg] Shared decode of" << m_key << "-" << (m_followers.size() + 1) << "windows on one decoder";
+    }
+    return false;
+}
+
+FFmpegVideoPlayer* FFmpegDecodeSession::leave(FFmpegVideoPlayer* player)
+{
+    if (player != m_decoder) {
+        m_followers.removeAll(player);
+        return nullptr;
+    }
+    m_decoder = m_followers.isEmpty() ? nullptr : m_followers.takeFirst();
+    return m_decoder;
+}
+
+QList<FFmpegVideoPlayer*> FFmpegDecodeSession::members() const
+{
+    QList<FFmpegVideoPlayer*> players;
+    if (m_decoder) {
+        players.append(m_decoder);
+    }
+    players.append(m_followers);
+    return players;
+}
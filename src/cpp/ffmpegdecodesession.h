@@ -0,0 +1,60 @@
+#ifndef FFMPEGDECODESESSION_H
+#define FFMPEGDECODESESSION_H
+
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QUrl>
+#include <memory>
+
+class FFmpegVideoPlayer;
+
+/**
+ * One decode of a source shared by every player (window) that shows it
+ *
+ * The first player to join a source's session decodes it; players that join later are
+ * followers: they open nothing themselves and get the decoder's frames (QVideoFrame is
+ * reference-counted, so N sinks share one buffer) at the same moment the decoder presents
+ * them, so all windows run on the decoder's clock and stay frame-synchronized.
+ * When the decoder leaves, the first follower takes over decoding.
+ *
+ * Video is sized for the largest of their windows and suspended only when all are minimized;
+ * audio plays from the decoding player, so followers forward volume changes to it.
+ *
+ * Players live on the GUI thread; sessions are only touched from there.
+ */
+class FFmpegDecodeSession
+{
+public:
+    // Session for `key` (see keyFor()), created on first use
+    static std::shared_ptr<FFmpegDecodeSession> acquire(const QString& key);
+
+    // Canonical path of a local file (empty = never shared, e.g. network streams)
+    static QString keyFor(const QUrl& source);
+
+    ~FFmpegDecodeSession();
+
+    FFmpegDecodeSession(const FFmpegDecodeSession&) = delete;
+    FFmpegDecodeSession& operator=(const FFmpegDecodeSession&) = delete;
+
+    // True if `player` became the decoder (session was empty)
+    bool join(FFmpegVideoPlayer* player);
+
+    // Remove `player`. If it was the decoder, the first follower becomes the decoder and is returned.
+    FFmpegVideoPlayer* leave(FFmpegVideoPlayer* player);
+
+    FFmpegVideoPlayer* decoder() const { return m_decoder; }
+    const QList<FFmpegVideoPlayer*>& followers() const { return m_followers; }
+    QList<FFmpegVideoPlayer*> members() const;  // Decoder first
+
+private:
+    explicit FFmpegDecodeSession(const QString& key) : m_key(key) {}
+
+    QString m_key;
+    FFmpegVideoPlayer* m_decoder = nullptr;
+    QList<FFmpegVideoPlayer*> m_followers;
+
+    static QHash<QString, std::weak_ptr<FFmpegDecodeSession>> s_sessions;
+};
+
+#endif // FFMPEGDECODESESSION_H
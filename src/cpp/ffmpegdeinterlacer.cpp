@@ -0,0 +1,515 @@
+#include "ffmpegdeinterlacer.h"
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QtConcurrent>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+extern "C" {
+#include <libavutil/frame.h>
+#include <libavutil/pixfmt.h>
+#include <libavutil/version.h>
+}
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define FFMPEG_DEINTERLACE_SSE2 1
+#include <emmintrin.h>
+#endif
+
+#if LIBAVUTIL_VERSION_INT >= AV_VERSION_INT(58, 7, 100)
+#define FFMPEG_DEINTERLACE_FRAME_FLAGS 1
+#endif
+
+namespace {
+    constexpr int kMinRowsPerSlice = 32;
+
+    struct Plane {
+        const uint8_t* prev = nullptr;
+        const uint8_t* cur = nullptr;
+        const uint8_t* next = nullptr;
+        uint8_t* dst = nullptr;
+        int prevStride = 0;
+        int curStride = 0;
+        int nextStride = 0;
+        int dstStride = 0;
+        int width = 0;    // Samples per row (interleaved UV counts both components)
+        int height = 0;
+        int step = 1;     // Distance between horizontal neighbours of one component (2 for interleaved UV)
+    };
+
+    struct FieldJob {
+        Plane planes[3];
+        int planeCount = 0;
+        bool wide = false;  // 16-bit samples
+        int shift = 0;      // P010 keeps its 10 bits in the high bits of each word
+        int parity = 0;     // Rows with this parity are kept, the others interpolated
+        int tff = 0;
+    };
+
+    // Source rows around one missing line (yadif naming: c/e above/below, b/f two lines out)
+    template <typename T>
+    struct Rows {
+        const T* c;       // Current frame, line above
+        const T* e;       // Current frame, line below
+        const T* pc;      // Previous frame, above / below
+        const T* pe;
+        const T* nc;      // Next frame, above / below
+        const T* ne;
+        const T* prev2;   // The missing line in the fields before / after it
+        const T* next2;
+        const T* b0;      // Same fields two lines above / below
+        const T* b1;
+        const T* f0;
+        const T* f1;
+        T* dst;
+    };
+
+    template <typename T>
+    inline const T* rowAt(const uint8_t* base, int stride, int y)
+    {
+        return reinterpret_cast<const T*>(base + ptrdiff_t(stride) * y);
+    }
+
+    inline int maxOf(int a, int b) { return a > b ? a : b; }
+    inline int minOf(int a, int b) { return a < b ? a : b; }
+
+    // One missing sample, horizontal neighbours clamped to the row (same component)
+    template <typename T>
+    void filterPixel(const Rows<T>& r, int x, int width, int step, int shift, bool spatialCheck)
+    {
+        const int lo = x % step;
+        const int hi = width - step + lo;
+        auto at = [&](const T* row, int k) {
+            int i = x + k * step;
+            i = i < lo ? lo : (i > hi ? hi : i);
+            return int(row[i]) >> shift;
+        };
+
+        const int c = at(r.c, 0);
+        const int e = at(r.e, 0);
+        const int p2 = at(r.prev2, 0);
+        const int n2 = at(r.next2, 0);
+        const int d = (p2 + n2) >> 1;
+
+        // Motion: field difference across the frame and line differences against both neighbours
+        const int td0 = std::abs(p2 - n2);
+        const int td1 = (std::abs(at(r.pc, 0) - c) + std::abs(at(r.pe, 0) - e)) >> 1;
+        const int td2 = (std::abs(at(r.nc, 0) - c) + std::abs(at(r.ne, 0) - e)) >> 1;
+        int diff = maxOf(td0 >> 1, maxOf(td1, td2));
+
+        // Edge-directed spatial prediction (±1, ±2 diagonals, the wider one only if the narrower helped)
+        int pred = (c + e) >> 1;
+        int score = std::abs(at(r.c, -1) - at(r.e, -1)) + std::abs(c - e) + std::abs(at(r.c, 1) - at(r.e, 1)) - 1;
+        auto check = [&](int j) {
+            const int s = std::abs(at(r.c, j - 1) - at(r.e, -j - 1)) + std::abs(at(r.c, j) - at(r.e, -j)) +
+                          std::abs(at(r.c, j + 1) - at(r.e, -j + 1));
+            if (s >= score) {
+                return false;
+            }
+            score = s;
+            pred = (at(r.c, j) + at(r.e, -j)) >> 1;
+            return true;
+        };
+        if (check(-1)) {
+            check(-2);
+        }
+        if (check(1)) {
+            check(2);
+        }
+
+        // Spatial interlacing check: widen the allowed range where the temporal neighbours disagree
+        if (spatialCheck) {
+            const int b = (at(r.b0, 0) + at(r.b1, 0)) >> 1;
+            const int f = (at(r.f0, 0) + at(r.f1, 0)) >> 1;
+            const int mx = maxOf(maxOf(d - e, d - c), minOf(b - c, f - e));
+            const int mn = minOf(minOf(d - e, d - c), maxOf(b - c, f - e));
+            diff = maxOf(maxOf(diff, mn), -mx);
+        }
+
+        pred = pred > d + diff ? d + diff : (pred < d - diff ? d - diff : pred);
+        r.dst[x] = T(pred << shift);
+    }
+
+#ifdef FFMPEG_DEINTERLACE_SSE2
+    // Eight samples as int16 lanes (10-bit values at most, sums of three differences still fit)
+    inline __m128i load8(const uint8_t* p, __m128i)
+    {
+        return _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(p)), _mm_setzero_si128());
+    }
+
+    inline __m128i load8(const uint16_t* p, __m128i shift)
+    {
+        return _mm_srl_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)), shift);
+    }
+
+    inline void store8(uint8_t* p, __m128i v, __m128i)
+    {
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(p), _mm_packus_epi16(v, v));
+    }
+
+    inline void store8(uint16_t* p, __m128i v, __m128i shift)
+    {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(p), _mm_sll_epi16(v, shift));
+    }
+
+    inline __m128i absDiff(__m128i a, __m128i b)
+    {
+        return _mm_max_epi16(_mm_sub_epi16(a, b), _mm_sub_epi16(b, a));
+    }
+
+    inline __m128i average(__m128i a, __m128i b)
+    {
+        return _mm_srai_epi16(_mm_add_epi16(a, b), 1);
+    }
+
+    inline __m128i select(__m128i mask, __m128i a, __m128i b)
+    {
+        return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+    }
+
+    // filterPixel for eight samples at x (all neighbours inside the row)
+    template <typename T>
+    void filterVector(const Rows<T>& r, int x, int step, __m128i shift, bool spatialCheck)
+    {
+        auto ld = [&](const T* row, int k) { return load8(row + x + k * step, shift); };
+
+        const __m128i c = ld(r.c, 0);
+        const __m128i e = ld(r.e, 0);
+        const __m128i p2 = ld(r.prev2, 0);
+        const __m128i n2 = ld(r.next2, 0);
+        const __m128i d = average(p2, n2);
+
+        const __m128i td0 = absDiff(p2, n2);
+        const __m128i td1 = _mm_srai_epi16(_mm_add_epi16(absDiff(ld(r.pc, 0), c), absDiff(ld(r.pe, 0), e)), 1);
+        const __m128i td2 = _mm_srai_epi16(_mm_add_epi16(absDiff(ld(r.nc, 0), c), absDiff(ld(r.ne, 0), e)), 1);
+        __m128i diff = _mm_max_epi16(_mm_srai_epi16(td0, 1), _mm_max_epi16(td1, td2));
+
+        __m128i pred = average(c, e);
+        __m128i score = _mm_sub_epi16(_mm_add_epi16(_mm_add_epi16(absDiff(ld(r.c, -1), ld(r.e, -1)), absDiff(c, e)),
+                                                    absDiff(ld(r.c, 1), ld(r.e, 1))),
+                                      _mm_set1_epi16(1));
+        // Lanes where check(j) won; the wider diagonal is only tried in those
+        auto check = [&](int j, __m128i active) {
+            const __m128i s = _mm_add_epi16(_mm_add_epi16(absDiff(ld(r.c, j - 1), ld(r.e, -j - 1)),
+                                                          absDiff(ld(r.c, j), ld(r.e, -j))),
+                                            absDiff(ld(r.c, j + 1), ld(r.e, -j + 1)));
+            const __m128i better = _mm_and_si128(active, _mm_cmplt_epi16(s, score));
+            score = select(better, s, score);
+            pred = select(better, average(ld(r.c, j), ld(r.e, -j)), pred);
+            return better;
+        };
+        const __m128i all = _mm_set1_epi16(-1);
+        check(-2, check(-1, all));
+        check(2, check(1, all));
+
+        if (spatialCheck) {
+            const __m128i b = average(ld(r.b0, 0), ld(r.b1, 0));
+            const __m128i f = average(ld(r.f0, 0), ld(r.f1, 0));
+            const __m128i de = _mm_sub_epi16(d, e);
+            const __m128i dc = _mm_sub_epi16(d, c);
+            const __m128i bc = _mm_sub_epi16(b, c);
+            const __m128i fe = _mm_sub_epi16(f, e);
+            const __m128i mx = _mm_max_epi16(_mm_max_epi16(de, dc), _mm_min_epi16(bc, fe));
+            const __m128i mn = _mm_min_epi16(_mm_min_epi16(de, dc), _mm_max_epi16(bc, fe));
+            diff = _mm_max_epi16(_mm_max_epi16(diff, mn), _mm_sub_epi16(_mm_setzero_si128(), mx));
+        }
+
+        pred = _mm_max_epi16(_mm_min_epi16(pred, _mm_add_epi16(d, diff)), _mm_sub_epi16(d, diff));
+        store8(r.dst + x, pred, shift);
+    }
+#endif
+
+    template <typename T>
+    void filterRows(const Plane& p, int shift, int parity, int tff, int yStart, int yEnd)
+    {
+        // Which neighbouring frames hold the fields on either side of the missing one in time
+        const bool prevIsBefore = (parity ^ tff) != 0;
+        const uint8_t* before = prevIsBefore ? p.prev : p.cur;
+        const uint8_t* after = prevIsBefore ? p.cur : p.next;
+        const int beforeStride = prevIsBefore ? p.prevStride : p.curStride;
+        const int afterStride = prevIsBefore ? p.curStride : p.nextStride;
+        const size_t rowBytes = size_t(p.width) * sizeof(T);
+#ifdef FFMPEG_DEINTERLACE_SSE2
+        const __m128i shiftCount = _mm_cvtsi32_si128(shift);
+        const int edge = 3 * p.step;
+#endif
+
+        for (int y = yStart; y < yEnd; ++y) {
+            T* dst = reinterpret_cast<T*>(p.dst + ptrdiff_t(p.dstStride) * y);
+            if (((y ^ parity) & 1) == 0) {
+                std::memcpy(dst, rowAt<T>(p.cur, p.curStride, y), rowBytes);
+                continue;
+            }
+
+            // Lines outside the frame are mirrored
+            const int above = y > 0 ? y - 1 : y + 1;
+            const int below = y + 1 < p.height ? y + 1 : y - 1;
+            const int above2 = qBound(0, 2 * above - y, p.height - 1);
+            const int below2 = qBound(0, 2 * below - y, p.height - 1);
+            const bool spatialCheck = y != 1 && y + 2 != p.height;
+
+            const Rows<T> r = {
+                rowAt<T>(p.cur, p.curStride, above), rowAt<T>(p.cur, p.curStride, below),
+                rowAt<T>(p.prev, p.prevStride, above), rowAt<T>(p.prev, p.prevStride, below),
+                rowAt<T>(p.next, p.nextStride, above), rowAt<T>(p.next, p.nextStride, below),
+                rowAt<T>(before, beforeStride, y), rowAt<T>(after, afterStride, y),
+                rowAt<T>(before, beforeStride, above2), rowAt<T>(after, afterStride, above2),
+                rowAt<T>(before, beforeStride, below2), rowAt<T>(after, afterStride, below2),
+                dst
+            };
+
+            int x = 0;
+#ifdef FFMPEG_DEINTERLACE_SSE2
+            for (; x < edge && x < p.width; ++x) {
+                filterPixel(r, x, p.width, p.step, shift, spatialCheck);
+            }
+            for (; x + 8 + edge <= p.width; x += 8) {
+                filterVector(r, x, p.step, shiftCount, spatialCheck);
+            }
+#endif
+            for (; x < p.width; ++x) {
+                filterPixel(r, x, p.width, p.step, shift, spatialCheck);
+            }
+        }
+    }
+
+    // One slice = the same fraction of rows of every plane
+    void filterSlice(const FieldJob& job, int slice, int sliceCount)
+    {
+        for (int i = 0; i < job.planeCount; ++i) {
+            const Plane& p = job.planes[i];
+            const int yStart = p.height * slice / sliceCount;
+            const int yEnd = p.height * (slice + 1) / sliceCount;
+            if (job.wide) {
+                filterRows<uint16_t>(p, job.shift, job.parity, job.tff, yStart, yEnd);
+            } else {
+                filterRows<uint8_t>(p, job.shift, job.parity, job.tff, yStart, yEnd);
+            }
+        }
+    }
+
+    int64_t timestampOf(const AVFrame* frame)
+    {
+        return frame->best_effort_timestamp != AV_NOPTS_VALUE ? frame->best_effort_timestamp : frame->pts;
+    }
+
+    bool isTopFieldFirst(const AVFrame* frame)
+    {
+#ifdef FFMPEG_DEINTERLACE_FRAME_FLAGS
+        return (frame->flags & AV_FRAME_FLAG_TOP_FIELD_FIRST) != 0;
+#else
+        return frame->top_field_first != 0;
+#endif
+    }
+
+    void clearInterlacedFlags(AVFrame* frame)
+    {
+#ifdef FFMPEG_DEINTERLACE_FRAME_FLAGS
+        frame->flags &= ~(AV_FRAME_FLAG_INTERLACED | AV_FRAME_FLAG_TOP_FIELD_FIRST);
+#else
+        frame->interlaced_frame = 0;
+        frame->top_field_first = 0;
+#endif
+    }
+}
+
+FFmpegDeinterlacer::FFmpegDeinterlacer(int maxThreads)
+{
+    m_threadPool.setMaxThreadCount(qMax(1, maxThreads > 0 ? maxThreads : QThread::idealThreadCount()));
+    m_outputPool.setCapacity(8);  // Display queue + GUI handoff + frame on screen, two per input at field rate
+}
+
+FFmpegDeinterlacer::~FFmpegDeinterlacer()
+{
+    m_threadPool.waitForDone();
+    reset();
+}
+
+bool FFmpegDeinterlacer::canProcess(int pixelFormat)
+{
+    return pixelFormat == AV_PIX_FMT_NV12 || pixelFormat == AV_PIX_FMT_YUV420P ||
+           pixelFormat == AV_PIX_FMT_P010LE || pixelFormat == AV_PIX_FMT_YUV420P10LE;
+}
+
+bool FFmpegDeinterlacer::isInterlaced(const AVFrame* frame)
+{
+    if (!frame) {
+        return false;
+    }
+#ifdef FFMPEG_DEINTERLACE_FRAME_FLAGS
+    return (frame->flags & AV_FRAME_FLAG_INTERLACED) != 0;
+#else
+    return frame->interlaced_frame != 0;
+#endif
+}
+
+int FFmpegDeinterlacer::threadCount() const
+{
+    return m_threadPool.maxThreadCount();
+}
+
+void FFmpegDeinterlacer::reset()
+{
+    av_frame_free(&m_prev);
+    av_frame_free(&m_cur);
+    av_frame_free(&m_next);
+}
+
+int FFmpegDeinterlacer::process(const AVFrame* in, AVFrame* out[2])
+{
+    if (!in || !canProcess(in->format) || in->width < 2 || in->height < 4 || !in->data[0]) {
+        return 0;
+    }
+
+    // Format/resolution change: the queued frame can't be filtered against this one
+    if (m_cur && (m_cur->format != in->format || m_cur->width != in->width || m_cur->height != in->height)) {
+        qDebug() << "[FFmpeg] Deinterlacer input changed to" << in->width << "x" << in->height << "- restarting";
+        reset();
+    }
+
+    AVFrame* next = av_frame_alloc();
+    if (!next || av_frame_ref(next, in) < 0) {
+        av_frame_free(&next);
+        return 0;
+    }
+    if (!m_cur) {
+        m_cur = next;
+        return 0;
+    }
+
+    m_next = next;
+    const int count = deinterlaceCurrent(out);
+
+    // Slide the window: current becomes the previous frame, the look-ahead the current one
+    av_frame_free(&m_prev);
+    m_prev = m_cur;
+    m_cur = m_next;
+    m_next = nullptr;
+    return count;
+}
+
+int FFmpegDeinterlacer::drain(AVFrame* out[2])
+{
+    if (!m_cur) {
+        return 0;
+    }
+    const int count = deinterlaceCurrent(out);
+    av_frame_free(&m_prev);
+    av_frame_free(&m_cur);
+    return count;
+}
+
+int FFmpegDeinterlacer::deinterlaceCurrent(AVFrame* out[2])
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    // First output keeps the field that is shown first, the second one the other field
+    const bool tff = isTopFieldFirst(m_cur);
+    if (!filterField(out[0], tff ? 0 : 1, tff)) {
+        return 0;
+    }
+    int count = 1;
+
+    if (m_fieldRate) {
+        // Second field sits halfway to the next frame (frame duration / previous frame as fallbacks)
+        int64_t half = 0;
+        const int64_t curTs = timestampOf(m_cur);
+        if (curTs != AV_NOPTS_VALUE) {
+            const int64_t nextTs = m_next ? timestampOf(m_next) : AV_NOPTS_VALUE;
+            const int64_t prevTs = m_prev ? timestampOf(m_prev) : AV_NOPTS_VALUE;
+            if (nextTs != AV_NOPTS_VALUE && nextTs > curTs) {
+                half = (nextTs - curTs) / 2;
+            } else if (m_cur->duration > 0) {
+                half = m_cur->duration / 2;
+            } else if (prevTs != AV_NOPTS_VALUE && prevTs < curTs) {
+                half = (curTs - prevTs) / 2;
+            }
+        }
+
+        // Without timing the second field can't be scheduled - show one output per frame
+        if (half > 0 && filterField(out[1], tff ? 1 : 0, tff)) {
+            out[0]->duration = half;
+            out[1]->duration = half;
+            if (m_cur->pts != AV_NOPTS_VALUE) {
+                out[1]->pts = m_cur->pts + half;
+            }
+            if (m_cur->best_effort_timestamp != AV_NOPTS_VALUE) {
+                out[1]->best_effort_timestamp = m_cur->best_effort_timestamp + half;
+            }
+            count = 2;
+        }
+    }
+
+    m_outputFrames += count;
+    const double ms = timer.nsecsElapsed() / 1000000.0 / count;
+    m_avgMs = m_avgMs > 0.0 ? m_avgMs * 0.9 + ms * 0.1 : ms;
+    return count;
+}
+
+bool FFmpegDeinterlacer::filterField(AVFrame* out, int parity, bool topFieldFirst)
+{
+    const AVFrame* cur = m_cur;
+    const AVFrame* prev = m_prev ? m_prev : cur;
+    const AVFrame* next = m_next ? m_next : cur;
+
+    const int format = cur->format;
+    const bool semiPlanar = format == AV_PIX_FMT_NV12 || format == AV_PIX_FMT_P010LE;
+    const int planeCount = semiPlanar ? 2 : 3;
+    for (int i = 0; i < planeCount; ++i) {
+        if (!prev->data[i] || !cur->data[i] || !next->data[i]) {
+            return false;
+        }
+    }
+
+    av_frame_unref(out);
+    out->format = format;
+    out->width = cur->width;
+    out->height = cur->height;
+    if (m_outputPool.allocFrame(out) < 0 && av_frame_get_buffer(out, 0) < 0) {
+        qWarning() << "[FFmpeg] Deinterlacer: failed to allocate output" << cur->width << "x" << cur->height;
+        return false;
+    }
+    av_frame_copy_props(out, cur);
+    clearInterlacedFlags(out);
+
+    FieldJob job;
+    job.planeCount = planeCount;
+    job.wide = format == AV_PIX_FMT_P010LE || format == AV_PIX_FMT_YUV420P10LE;
+    job.shift = format == AV_PIX_FMT_P010LE ? 6 : 0;
+    job.parity = parity;
+    job.tff = topFieldFirst ? 1 : 0;
+
+    const int chromaWidth = (cur->width + 1) / 2;
+    const int chromaHeight = (cur->height + 1) / 2;
+    for (int i = 0; i < planeCount; ++i) {
+        Plane& p = job.planes[i];
+        p.prev = prev->data[i];
+        p.cur = cur->data[i];
+        p.next = next->data[i];
+        p.dst = out->data[i];
+        p.prevStride = prev->linesize[i];
+        p.curStride = cur->linesize[i];
+        p.nextStride = next->linesize[i];
+        p.dstStride = out->linesize[i];
+        p.width = i == 0 ? cur->width : (semiPlanar ? chromaWidth * 2 : chromaWidth);
+        p.height = i == 0 ? cur->height : chromaHeight;
+        p.step = i > 0 && semiPlanar ? 2 : 1;
+    }
+
+    // Row slices across the private pool (small frames run inline)
+    const int sliceCount = qBound(1, qMin(threadCount(), cur->height / kMinRowsPerSlice), 64);
+    if (sliceCount == 1) {
+        filterSlice(job, 0, 1);
+    } else {
+        std::vector<int> slices(sliceCount);
+        for (int i = 0; i < sliceCount; ++i) {
+            slices[i] = i;
+        }
+        QtConcurrent::blockingMap(&m_threadPool, slices, [&job, sliceCount](int& slice) {
+            filterSlice(job, slice, sliceCount);
+        });
+    }
+    return true;
+}
@@ -0,0 +1,75 @@
+#ifndef FFMPEGDEINTERLACER_H
+#define FFMPEGDEINTERLACER_H
+
+#include <QThreadPool>
+#include <QtGlobal>
+#include "ffmpegframepool.h"
+
+// Forward declarations to avoid including FFmpeg headers in header file
+struct AVFrame;
+
+/**
+ * Native motion-adaptive deinterlacer (yadif algorithm, spatial interlacing check enabled)
+ *
+ * Works in place of the yadif/bwdif filter graph on the decoder's own planes (NV12, YUV420P,
+ * P010, YUV420P10) and writes pooled output frames of the same format.
+ * Lines of the kept field are copied; missing lines are the temporal average of the
+ * neighbouring fields, clamped towards an edge-directed spatial prediction by the local motion.
+ * Needs one frame of look-ahead: process() returns the outputs of the previous input.
+ * Eight samples per SSE2 vector; row slices of all planes run on a private thread pool.
+ *
+ *   Frame rate - one output per input frame (first field's time)
+ *   Field rate - one output per field (50i → 50p, 60i → 60p)
+ */
+class FFmpegDeinterlacer
+{
+public:
+    // maxThreads caps the slice workers (0 = one per core)
+    explicit FFmpegDeinterlacer(int maxThreads = 0);
+    ~FFmpegDeinterlacer();
+
+    FFmpegDeinterlacer(const FFmpegDeinterlacer&) = delete;
+    FFmpegDeinterlacer& operator=(const FFmpegDeinterlacer&) = delete;
+
+    // Formats process() accepts
+    static bool canProcess(int pixelFormat);
+
+    // Frame is flagged interlaced by the decoder (AV_FRAME_FLAG_INTERLACED)
+    static bool isInterlaced(const AVFrame* frame);
+
+    void setFieldRate(bool fieldRate) { m_fieldRate = fieldRate; }
+    bool fieldRate() const { return m_fieldRate; }
+
+    // Queue `in` (referenced, not modified) and deinterlace the frame queued before it into
+    // out[0] (and out[1] at field rate). Output frames must be unref'd; they are allocated
+    // from the internal pool and keep the input's properties (pts, color) minus the
+    // interlaced flags. Returns the number of output frames (0 for the first input or a
+    // frame that can't be processed).
+    int process(const AVFrame* in, AVFrame* out[2]);
+
+    // End of stream / progressive frame follows: deinterlace the queued frame (no look-ahead)
+    int drain(AVFrame* out[2]);
+
+    // Drop queued frames (seek, new file)
+    void reset();
+
+    bool hasPending() const { return m_cur != nullptr; }
+    int threadCount() const;
+    double averageMilliseconds() const { return m_avgMs; }  // Exponential moving average per output frame
+    quint64 outputFrames() const { return m_outputFrames; }
+
+private:
+    int deinterlaceCurrent(AVFrame* out[2]);
+    bool filterField(AVFrame* out, int parity, bool topFieldFirst);
+
+    AVFrame* m_prev = nullptr;     // Previous input (nullptr → current is used)
+    AVFrame* m_cur = nullptr;      // Frame being deinterlaced
+    AVFrame* m_next = nullptr;     // Look-ahead (nullptr → current is used)
+    bool m_fieldRate = true;
+    double m_avgMs = 0.0;
+    quint64 m_outputFrames = 0;
+    QThreadPool m_threadPool;      // Private pool: slices must not queue behind unrelated global pool work
+    FFmpegFramePool m_outputPool;  // Output blocks (separate size class from the decoder's frames)
+};
+
+#endif // FFMPEGDEINTERLACER_H
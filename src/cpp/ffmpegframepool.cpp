@@ -0,0 +1,257 @@
+#include "ffmpegframepool.h"
+#include <QDebug>
+#include <QMutex>
+#include <vector>
+#include <climits>
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavutil/frame.h>
+#include <libavutil/imgutils.h>
+#include <libavutil/mem.h>
+#include <libavutil/pixdesc.h>
+}
+
+namespace {
+    constexpr int kAlign = 64;       // Plane/stride alignment (covers AVX-512 and FFmpeg's STRIDE_ALIGN)
+    constexpr int kPadding = 64;     // Per-plane tail padding (SIMD over-read/over-write safety)
+    constexpr int kDefaultCapacity = 4;
+}
+
+struct FFmpegFramePool::Shared
+{
+    struct Block {
+        std::shared_ptr<Shared> pool;  // Keeps pool state alive while frames are still referenced
+        uint8_t* data = nullptr;
+        int size = 0;
+    };
+
+    QMutex mutex;
+    std::vector<Block*> idle;
+    int blockSize = 0;
+    int capacity = kDefaultCapacity;
+    int outstanding = 0;
+    quint64 allocations = 0;
+    quint64 reuses = 0;
+    quint64 resizes = 0;
+
+    static void freeBlock(Block* block)
+    {
+        av_free(block->data);
+        delete block;
+    }
+
+    // AVBufferRef free callback - return block to the idle list or free it
+    static void releaseBlock(void* opaque, uint8_t* data)
+    {
+        Q_UNUSED(data);
+        Block* block = static_cast<Block*>(opaque);
+        std::shared_ptr<Shared> shared = block->pool;  // Local ref: block may be deleted below
+        
+        QMutexLocker locker(&shared->mutex);
+        shared->outstanding--;
+        if (block->size == shared->blockSize && int(shared->idle.size()) < shared->capacity) {
+            shared->idle.push_back(block);
+            return;
+        }
+        locker.unlock();
+        
+        // Stale size (resolution change) or pool full - give memory back
+        freeBlock(block);
+    }
+};
+
+FFmpegFramePool::FFmpegFramePool()
+    : m_shared(std::make_shared<Shared>())
+{
+}
+
+FFmpegFramePool::~FFmpegFramePool()
+{
+    // Idle blocks hold a reference to m_shared - free them to break the cycle.
+    // Outstanding blocks keep the shared state alive until their last frame is released.
+    reset();
+}
+
+int FFmpegFramePool::getBuffer(AVCodecContext* codecContext, AVFrame* frame)
+{
+    if (!codecContext || !frame || frame->width <= 0 || frame->height <= 0) {
+        return AVERROR(EINVAL);
+    }
+    
+    // Decoders may write past the visible area (macroblock/CTU padding, edge emulation)
+    int width = frame->width;
+    int height = frame->height;
+    int linesizeAlign[AV_NUM_DATA_POINTERS];
+    avcodec_align_dimensions2(codecContext, &width, &height, linesizeAlign);
+    
+    return fillFrame(frame, width, height);
+}
+
+int FFmpegFramePool::allocFrame(AVFrame* frame)
+{
+    if (!frame || frame->width <= 0 || frame->height <= 0 || frame->format < 0) {
+        return AVERROR(EINVAL);
+    }
+    
+    // Same alignment as av_frame_get_buffer()
+    return fillFrame(frame, FFALIGN(frame->width, 32), FFALIGN(frame->height, 32));
+}
+
+int FFmpegFramePool::fillFrame(AVFrame* frame, int alignedWidth, int alignedHeight)
+{
+    const AVPixelFormat format = static_cast<AVPixelFormat>(frame->format);
+    
+    int linesizes[4] = {};
+    int ret = av_image_fill_linesizes(linesizes, format, alignedWidth);
+    if (ret < 0) {
+        return ret;
+    }
+    
+    ptrdiff_t strides[4] = {};
+    for (int i = 0; i < 4; ++i) {
+        linesizes[i] = FFALIGN(linesizes[i], kAlign);
+        strides[i] = linesizes[i];
+    }
+    
+    size_t planeSizes[4] = {};
+    ret = av_image_fill_plane_sizes(planeSizes, format, alignedHeight, strides);
+    if (ret < 0) {
+        return ret;
+    }
+    
+    // PAL8 and friends: plane 1 is the palette (256 x 32-bit entries), not image rows -
+    // its size never follows the aligned stride
+    const AVPixFmtDescriptor* desc = av_pix_fmt_desc_get(format);
+    if (desc && (desc->flags & AV_PIX_FMT_FLAG_PAL)) {
+        linesizes[1] = 4;
+        planeSizes[1] = AVPALETTE_SIZE;
+    }
+    
+    // One contiguous block per frame, each plane starting on an aligned offset
+    size_t offsets[4] = {};
+    size_t total = 0;
+    for (int i = 0; i < 4 && planeSizes[i] > 0; ++i) {
+        offsets[i] = total;
+        total += FFALIGN(planeSizes[i] + kPadding, size_t(kAlign));
+    }
+    if (total == 0 || total > size_t(INT_MAX)) {
+        return AVERROR(EINVAL);
+    }
+    const int blockSize = static_cast<int>(total);
+    
+    // Acquire a block: reuse an idle one, or allocate
+    Shared::Block* block = nullptr;
+    {
+        QMutexLocker locker(&m_shared->mutex);
+        if (m_shared->blockSize != blockSize) {
+            // Format/resolution change - idle blocks have the wrong size
+            if (m_shared->blockSize != 0) {
+                m_shared->resizes++;
+                qDebug() << "[FramePool] Resizing pool:" << m_shared->blockSize << "->" << blockSize << "bytes per frame";
+            }
+            for (Shared::Block* stale : m_shared->idle) {
+                Shared::freeBlock(stale);
+            }
+            m_shared->idle.clear();
+            m_shared->blockSize = blockSize;
+        }
+        
+        if (!m_shared->idle.empty()) {
+            block = m_shared->idle.back();
+            m_shared->idle.pop_back();
+            m_shared->reuses++;
+        } else {
+            m_shared->allocations++;
+        }
+        m_shared->outstanding++;
+    }
+    
+    if (!block) {
+        block = new Shared::Block;
+        block->pool = m_shared;
+        block->size = blockSize;
+        block->data = static_cast<uint8_t*>(av_malloc(blockSize));
+        if (!block->data) {
+            delete block;
+            QMutexLocker locker(&m_shared->mutex);
+            m_shared->outstanding--;
+            return AVERROR(ENOMEM);
+        }
+    }
+    
+    frame->buf[0] = av_buffer_create(block->data, block->size, &Shared::releaseBlock, block, 0);
+    if (!frame->buf[0]) {
+        Shared::releaseBlock(block, block->data);
+        return AVERROR(ENOMEM);
+    }
+    
+    for (int i = 0; i < 4; ++i) {
+        frame->data[i] = planeSizes[i] > 0 ? block->data + offsets[i] : nullptr;
+        frame->linesize[i] = planeSizes[i] > 0 ? linesizes[i] : 0;
+    }
+    frame->extended_data = frame->data;
+    
+    return 0;
+}
+
+void FFmpegFramePool::setCapacity(int blocks)
+{
+    std::vector<Shared::Block*> excess;
+    {
+        QMutexLocker locker(&m_shared->mutex);
+        m_shared->capacity = qMax(1, blocks);
+        while (int(m_shared->idle.size()) > m_shared->capacity) {
+            excess.push_back(m_shared->idle.back());
+            m_shared->idle.pop_back();
+        }
+    }
+    for (Shared::Block* block : excess) {
+        Shared::freeBlock(block);
+    }
+}
+
+int FFmpegFramePool::capacity() const
+{
+    QMutexLocker locker(&m_shared->mutex);
+    return m_shared->capacity;
+}
+
+void FFmpegFramePool::reset()
+{
+    std::vector<Shared::Block*> idle;
+    {
+        QMutexLocker locker(&m_shared->mutex);
+        idle.swap(m_shared->idle);
+        m_shared->blockSize = 0;  // Outstanding blocks are freed on release instead of recycled
+    }
+    for (Shared::Block* block : idle) {
+        Shared::freeBlock(block);
+    }
+}
+
+FFmpegFramePool::Stats FFmpegFramePool::stats() const
+{
+    QMutexLocker locker(&m_shared->mutex);
+    Stats s;
+    s.allocations = m_shared->allocations;
+    s.reuses = m_shared->reuses;
+    s.resizes = m_shared->resizes;
+    s.idle = int(m_shared->idle.size());
+    s.outstanding = m_shared->outstanding;
+    s.capacity = m_shared->capacity;
+    s.blockBytes = m_shared->blockSize;
+    return s;
+}
+
+bool FFmpegFramePool::canPool(AVCodecContext* codecContext, int pixelFormat)
+{
+    if (!codecContext || !codecContext->codec) {
+        return false;
+    }
+    if (!(codecContext->codec->capabilities & AV_CODEC_CAP_DR1)) {
+        return false;
+    }
+    const AVPixFmtDescriptor* desc = av_pix_fmt_desc_get(static_cast<AVPixelFormat>(pixelFormat));
+    return desc && !(desc->flags & AV_PIX_FMT_FLAG_HWACCEL);
+}
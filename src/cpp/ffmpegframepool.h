@@ -0,0 +1,68 @@
+#ifndef FFMPEGFRAMEPOOL_H
+#define FFMPEGFRAMEPOOL_H
+
+#include <QtGlobal>
+#include <memory>
+
+// Forward declarations to avoid including FFmpeg headers in header file
+struct AVCodecContext;
+struct AVFrame;
+
+/**
+ * Recycled, bounded-memory video frame buffer pool
+ *
+ * Hands out one contiguous, 64-byte aligned block per frame (all planes inside it),
+ * sized for the current stream format/resolution. Blocks come back to the pool when
+ * the last AVBufferRef is released (decoder, filter, or a QVideoFrame held by Qt)
+ * and are reused for the next frame. Idle blocks beyond capacity() are freed, so
+ * retained memory stays bounded. A resolution/format change resizes the pool.
+ *
+ * Thread-safe: getBuffer() is called from FFmpeg's frame threads.
+ */
+class FFmpegFramePool
+{
+public:
+    struct Stats {
+        quint64 allocations = 0;  // Blocks allocated from the heap (pool was empty)
+        quint64 reuses = 0;       // Blocks served from the idle list
+        quint64 resizes = 0;      // Format/resolution changes
+        int idle = 0;             // Blocks waiting for reuse
+        int outstanding = 0;      // Blocks currently referenced by frames
+        int capacity = 0;         // Max idle blocks retained
+        qint64 blockBytes = 0;    // Size of one frame block
+    };
+
+    FFmpegFramePool();
+    ~FFmpegFramePool();
+
+    FFmpegFramePool(const FFmpegFramePool&) = delete;
+    FFmpegFramePool& operator=(const FFmpegFramePool&) = delete;
+
+    // AVCodecContext::get_buffer2-compatible allocation (honours codec dimension/stride alignment)
+    // frame->format/width/height must be set. Returns 0 or a negative AVERROR.
+    int getBuffer(AVCodecContext* codecContext, AVFrame* frame);
+
+    // Allocate pooled buffers for a destination frame (hwframe transfer, conversions)
+    // frame->format/width/height must be set. Returns 0 or a negative AVERROR.
+    int allocFrame(AVFrame* frame);
+
+    // Number of idle blocks kept for reuse (extra returned blocks are freed)
+    void setCapacity(int blocks);
+    int capacity() const;
+
+    // Free all idle blocks (outstanding ones are freed when released)
+    void reset();
+
+    Stats stats() const;
+
+    // True if the decoder lets us provide its buffers (DR1) and the format lives in system memory
+    static bool canPool(AVCodecContext* codecContext, int pixelFormat);
+
+private:
+    struct Shared;
+    int fillFrame(AVFrame* frame, int alignedWidth, int alignedHeight);
+
+    std::shared_ptr<Shared> m_shared;
+};
+
+#endif // FFMPEGFRAMEPOOL_H
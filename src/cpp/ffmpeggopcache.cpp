@@ -0,0 +1,109 @@
+#include "ffmpeggopcache.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    // Frames closer than this are the same frame (PTS round-trips through doubles)
+    constexpr double kPtsEpsilon = 0.0005;
+
+    bool ptsLess(const FFmpegGopCache::Entry& entry, double pts)
+    {
+        return entry.pts + kPtsEpsilon < pts;
+    }
+}
+
+FFmpegGopCache::FFmpegGopCache(qint64 budgetBytes)
+    : m_budget(budgetBytes)
+{
+}
+
+void FFmpegGopCache::setBudget(qint64 bytes)
+{
+    m_budget = bytes;
+}
+
+void FFmpegGopCache::clear()
+{
+    m_entries.clear();
+    m_bytes = 0;
+}
+
+bool FFmpegGopCache::contains(double pts) const
+{
+    auto it = std::lower_bound(m_entries.begin(), m_entries.end(), pts, ptsLess);
+    return it != m_entries.end() && std::abs(it->pts - pts) <= kPtsEpsilon;
+}
+
+void FFmpegGopCache::insert(double pts, double duration, const QVideoFrame& frame, double keepNearPts)
+{
+    auto it = std::lower_bound(m_entries.begin(), m_entries.end(), pts, ptsLess);
+    if (it != m_entries.end() && std::abs(it->pts - pts) <= kPtsEpsilon) {
+        return;
+    }
+
+    Entry entry;
+    entry.pts = pts;
+    entry.duration = duration;
+    entry.frame = frame;
+    entry.bytes = frameBytes(frame);
+    m_bytes += entry.bytes;
+    m_entries.insert(it, std::move(entry));
+
+    // Keep the neighbourhood of the viewed frame; always leave at least that frame
+    while (m_bytes > m_budget && m_entries.size() > 1) {
+        const bool dropFront = std::abs(m_entries.front().pts - keepNearPts) >= std::abs(m_entries.back().pts - keepNearPts);
+        m_bytes -= dropFront ? m_entries.front().bytes : m_entries.back().bytes;
+        if (dropFront) {
+            m_entries.pop_front();
+        } else {
+            m_entries.pop_back();
+        }
+    }
+}
+
+const FFmpegGopCache::Entry* FFmpegGopCache::after(double pts, int count, bool clampToRun) const
+{
+    // First entry strictly after pts
+    auto it = std::upper_bound(m_entries.begin(), m_entries.end(), pts,
+                               [](double value, const Entry& entry) { return value + kPtsEpsilon < entry.pts; });
+    const auto available = std::distance(it, m_entries.end());
+    if (count <= 0 || available <= 0) {
+        return nullptr;
+    }
+    if (available < count) {
+        return clampToRun ? &m_entries.back() : nullptr;
+    }
+    return &*(it + (count - 1));
+}
+
+const FFmpegGopCache::Entry* FFmpegGopCache::before(double pts, int count, bool clampToRun) const
+{
+    const int available = countBefore(pts);
+    if (count <= 0 || available <= 0) {
+        return nullptr;
+    }
+    if (available < count) {
+        return clampToRun ? &m_entries.front() : nullptr;
+    }
+    return &m_entries[size_t(available - count)];
+}
+
+int FFmpegGopCache::countBefore(double pts) const
+{
+    auto it = std::lower_bound(m_entries.begin(), m_entries.end(), pts, ptsLess);
+    return int(std::distance(m_entries.begin(), it));
+}
+
+qint64 FFmpegGopCache::frameBytes(const QVideoFrame& frame)
+{
+    const qint64 pixels = qint64(frame.width()) * frame.height();
+    switch (frame.pixelFormat()) {
+        case QVideoFrameFormat::Format_P010:
+        case QVideoFrameFormat::Format_YUV420P10:
+            return pixels * 3;      // 4:2:0, 16-bit samples
+        case QVideoFrameFormat::Format_BGRA8888:
+            return pixels * 4;
+        default:
+            return pixels * 3 / 2;  // 4:2:0, 8-bit samples
+    }
+}
@@ -0,0 +1,62 @@
+#ifndef FFMPEGGOPCACHE_H
+#define FFMPEGGOPCACHE_H
+
+#include <QVideoFrame>
+#include <QtGlobal>
+#include <deque>
+
+/**
+ * Decoded frames around the paused position, for frame stepping
+ *
+ * Holds one contiguous run of converted frames (zero-copy QVideoFrames, so each entry
+ * pins a pooled decoder buffer) sorted by PTS. Stepping inside the run costs nothing;
+ * the player decodes to extend it at either end. Memory is bounded by a byte budget:
+ * inserting past it evicts from whichever end is farther from the position being viewed,
+ * so the run stays contiguous.
+ *
+ * Not thread-safe - owned by the decode thread.
+ */
+class FFmpegGopCache
+{
+public:
+    struct Entry {
+        double pts = 0.0;       // Absolute stream seconds
+        double duration = 0.0;  // Seconds (0 = unknown)
+        QVideoFrame frame;
+        qint64 bytes = 0;
+    };
+
+    explicit FFmpegGopCache(qint64 budgetBytes);
+
+    void setBudget(qint64 bytes);
+    qint64 budget() const { return m_budget; }
+
+    void clear();
+    bool isEmpty() const { return m_entries.empty(); }
+    int size() const { return int(m_entries.size()); }
+    qint64 bytes() const { return m_bytes; }
+    double firstPts() const { return m_entries.empty() ? -1.0 : m_entries.front().pts; }
+    double lastPts() const { return m_entries.empty() ? -1.0 : m_entries.back().pts; }
+
+    bool contains(double pts) const;
+
+    // Sorted insert (a frame already cached at this PTS is kept), then evict past the budget
+    // from the end farther from keepNearPts
+    void insert(double pts, double duration, const QVideoFrame& frame, double keepNearPts);
+
+    // The count-th frame after / before pts (count >= 1), nullptr if the run holds fewer.
+    // With clampToRun the farthest available frame is returned instead of nullptr.
+    const Entry* after(double pts, int count, bool clampToRun = false) const;
+    const Entry* before(double pts, int count, bool clampToRun = false) const;
+    int countBefore(double pts) const;
+
+    // Approximate memory pinned by a frame (plane sizes from format and dimensions)
+    static qint64 frameBytes(const QVideoFrame& frame);
+
+private:
+    std::deque<Entry> m_entries;
+    qint64 m_bytes = 0;
+    qint64 m_budget = 0;
+};
+
+#endif // FFMPEGGOPCACHE_H
@@ -0,0 +1,373 @@
+#include "ffmpeginputstream.h"
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+#include <QSettings>
+#include <QStorageInfo>
+#include <QThread>
+#include <algorithm>
+#include <cstring>
+
+extern "C" {
+#include <libavformat/avformat.h>
+#include <libavutil/mem.h>
+#include <libavutil/time.h>
+}
+
+namespace {
+    constexpr int IO_BUFFER_SIZE = 64 * 1024;          // AVIOContext buffer (one read callback)
+    constexpr qint64 DISK_CHUNK_BYTES = 512 * 1024;    // Read-ahead thread reads this much per syscall
+    constexpr qint64 MIN_READ_AHEAD_BYTES = 1024 * 1024;
+    constexpr qint64 MAX_READ_AHEAD_BYTES = 512 * 1024 * 1024;
+
+    bool isNetworkPath(const QString& filePath)
+    {
+        const QString path = QDir::fromNativeSeparators(filePath);
+        if (path.startsWith(QLatin1String("//"))) {
+            return true;  // UNC share
+        }
+
+        const QStorageInfo storage(filePath);
+        const QByteArray type = storage.fileSystemType().toLower();
+        if (type.startsWith("cifs") || type.startsWith("smb") || type.startsWith("nfs")
+            || type == "fuse.sshfs" || type == "9p" || type == "afpfs" || type == "webdav") {
+            return true;
+        }
+        // Mapped network drives report the share as their device on Windows
+        const QByteArray device = storage.device();
+        return device.startsWith("\\\\") && !device.startsWith("\\\\?\\");
+    }
+}
+
+FFmpegInputStream::~FFmpegInputStream()
+{
+    close();
+}
+
+FFmpegInputStream::Mode FFmpegInputStream::configuredMode(const QString& filePath)
+{
+    QSettings settings;
+    const QString mode = settings.value("video/ffmpegInputMode", "auto").toString();
+    if (mode == QLatin1String("direct")) {
+        return DirectMode;
+    }
+    if (mode == QLatin1String("readahead")) {
+        return ReadAheadMode;
+    }
+    if (mode == QLatin1String("mmap")) {
+        return MemoryMappedMode;
+    }
+    return isNetworkPath(filePath) ? ReadAheadMode : MemoryMappedMode;
+}
+
+qint64 FFmpegInputStream::configuredReadAheadBytes()
+{
+    QSettings settings;
+    const qint64 megabytes = settings.value("video/ffmpegReadAheadMB", int(DEFAULT_READ_AHEAD_BYTES / (1024 * 1024))).toLongLong();
+    return qBound(MIN_READ_AHEAD_BYTES, megabytes * 1024 * 1024, MAX_READ_AHEAD_BYTES);
+}
+
+const char* FFmpegInputStream::modeName(Mode mode)
+{
+    switch (mode) {
+    case ReadAheadMode: return "readahead";
+    case MemoryMappedMode: return "mmap";
+    case DirectMode: break;
+    }
+    return "direct";
+}
+
+bool FFmpegInputStream::open(const QString& filePath, Mode mode, qint64 readAheadBytes)
+{
+    close();
+
+    const QFileInfo info(filePath);
+    if (mode == DirectMode || !info.isFile()) {
+        return false;
+    }
+
+    m_filePath = info.absoluteFilePath();
+    m_size = info.size();
+
+    if (mode == MemoryMappedMode) {
+        m_file.setFileName(m_filePath);
+        if (m_file.open(QIODevice::ReadOnly) && m_size > 0) {
+            m_map = m_file.map(0, m_size);
+        }
+        if (!m_map) {
+            qWarning() << "[FFmpeg] Memory-mapping failed, using read-ahead:" << m_file.errorString();
+            m_file.close();
+            mode = ReadAheadMode;
+        }
+    }
+
+    if (mode == ReadAheadMode) {
+        // Check the file opens here, so a failure falls back to the file protocol instead of a dead stream
+        QFile probe(m_filePath);
+        if (!probe.open(QIODevice::ReadOnly)) {
+            qWarning() << "[FFmpeg] Cannot open for read-ahead:" << probe.errorString();
+            return false;
+        }
+        probe.close();
+
+        const qint64 capacity = qBound(MIN_READ_AHEAD_BYTES, readAheadBytes, MAX_READ_AHEAD_BYTES);
+        m_ring.assign(size_t(capacity), 0);
+        m_keepBehind = capacity / 8;
+        m_bufferStart = m_bufferEnd = m_readPos = 0;
+        m_generation = 0;
+        m_eof = m_ioError = m_stopReadAhead = false;
+        m_readThread = QThread::create([this]() { readAheadThreadFunc(); });
+        m_readThread->start();
+    }
+    m_mode = mode;
+
+    uint8_t* buffer = static_cast<uint8_t*>(av_malloc(IO_BUFFER_SIZE));
+    if (buffer) {
+        m_ioContext = avio_alloc_context(buffer, IO_BUFFER_SIZE, 0, this, &FFmpegInputStream::readPacket, nullptr, &FFmpegInputStream::seek);
+    }
+    if (!m_ioContext) {
+        av_free(buffer);
+        qWarning() << "[FFmpeg] Failed to allocate AVIOContext";
+        close();
+        return false;
+    }
+
+    m_reads.store(0, std::memory_order_relaxed);
+    m_cacheHits.store(0, std::memory_order_relaxed);
+    m_stalls.store(0, std::memory_order_relaxed);
+    m_stallUs.store(0, std::memory_order_relaxed);
+    m_seeks.store(0, std::memory_order_relaxed);
+    m_bytesRead.store(0, std::memory_order_relaxed);
+
+    qDebug() << "[FFmpeg] Custom input:" << modeName(m_mode)
+             << (m_mode == ReadAheadMode ? qint64(m_ring.size()) / (1024 * 1024) : 0) << "MB read-ahead";
+    return true;
+}
+
+void FFmpegInputStream::attach(AVFormatContext* formatContext)
+{
+    if (!formatContext || !m_ioContext) {
+        return;
+    }
+    formatContext->pb = m_ioContext;
+    formatContext->flags |= AVFMT_FLAG_CUSTOM_IO;
+}
+
+void FFmpegInputStream::close()
+{
+    if (m_readThread) {
+        {
+            QMutexLocker locker(&m_mutex);
+            m_stopReadAhead = true;
+            m_spaceAvailable.wakeAll();
+            m_dataReady.wakeAll();
+        }
+        m_readThread->wait();
+        delete m_readThread;
+        m_readThread = nullptr;
+    }
+    m_ring.clear();
+    m_ring.shrink_to_fit();
+
+    if (m_ioContext) {
+        // avio may have replaced the buffer we allocated - free whatever it holds now
+        av_freep(&m_ioContext->buffer);
+        avio_context_free(&m_ioContext);
+        m_ioContext = nullptr;
+    }
+
+    if (m_map) {
+        m_file.unmap(const_cast<uchar*>(m_map));
+        m_map = nullptr;
+    }
+    m_file.close();
+    m_mapPos = 0;
+    m_mode = DirectMode;
+}
+
+FFmpegInputStream::Stats FFmpegInputStream::stats() const
+{
+    Stats stats;
+    stats.reads = m_reads.load(std::memory_order_relaxed);
+    stats.cacheHits = m_cacheHits.load(std::memory_order_relaxed);
+    stats.stalls = m_stalls.load(std::memory_order_relaxed);
+    stats.stallUs = m_stallUs.load(std::memory_order_relaxed);
+    stats.seeks = m_seeks.load(std::memory_order_relaxed);
+    stats.bytesRead = m_bytesRead.load(std::memory_order_relaxed);
+    if (m_mode == ReadAheadMode) {
+        QMutexLocker locker(&m_mutex);
+        stats.bufferedBytes = m_bufferEnd - m_readPos;
+    } else if (m_mode == MemoryMappedMode) {
+        stats.bufferedBytes = m_size - m_mapPos;
+    }
+    return stats;
+}
+
+int FFmpegInputStream::readPacket(void* opaque, uint8_t* buffer, int size)
+{
+    FFmpegInputStream* self = static_cast<FFmpegInputStream*>(opaque);
+    self->m_reads.fetch_add(1, std::memory_order_relaxed);
+    const int ret = self->m_mode == MemoryMappedMode ? self->readMapped(buffer, size) : self->readBuffered(buffer, size);
+    if (ret > 0) {
+        self->m_bytesRead.fetch_add(ret, std::memory_order_relaxed);
+    }
+    return ret;
+}
+
+int64_t FFmpegInputStream::seek(void* opaque, int64_t offset, int whence)
+{
+    FFmpegInputStream* self = static_cast<FFmpegInputStream*>(opaque);
+    if (whence & AVSEEK_SIZE) {
+        return self->m_size;
+    }
+
+    int64_t current = 0;
+    if (self->m_mode == MemoryMappedMode) {
+        current = self->m_mapPos;
+    } else {
+        QMutexLocker locker(&self->m_mutex);
+        current = self->m_readPos;
+    }
+
+    switch (whence & ~AVSEEK_FORCE) {
+    case SEEK_SET: return self->seekTo(offset);
+    case SEEK_CUR: return self->seekTo(current + offset);
+    case SEEK_END: return self->seekTo(self->m_size + offset);
+    default: break;
+    }
+    return AVERROR(EINVAL);
+}
+
+int FFmpegInputStream::readMapped(uint8_t* buffer, int size)
+{
+    const qint64 available = m_size - m_mapPos;
+    if (available <= 0) {
+        return AVERROR_EOF;
+    }
+    const int bytes = int(qMin<qint64>(size, available));
+    std::memcpy(buffer, m_map + m_mapPos, size_t(bytes));
+    m_mapPos += bytes;
+    m_cacheHits.fetch_add(1, std::memory_order_relaxed);
+    return bytes;
+}
+
+int FFmpegInputStream::readBuffered(uint8_t* buffer, int size)
+{
+    QMutexLocker locker(&m_mutex);
+
+    if (m_readPos >= m_bufferEnd && !m_eof && !m_ioError) {
+        // ✅ Ring ran dry - this is the stall the read-ahead exists to avoid, count it
+        const qint64 waitStart = av_gettime_relative();
+        m_stalls.fetch_add(1, std::memory_order_relaxed);
+        while (m_readPos >= m_bufferEnd && !m_eof && !m_ioError && !m_stopReadAhead) {
+            m_spaceAvailable.wakeAll();
+            m_dataReady.wait(&m_mutex);
+        }
+        m_stallUs.fetch_add(av_gettime_relative() - waitStart, std::memory_order_relaxed);
+    } else {
+        m_cacheHits.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    const qint64 available = m_bufferEnd - m_readPos;
+    if (available <= 0) {
+        return m_ioError ? AVERROR(EIO) : AVERROR_EOF;
+    }
+
+    const qint64 capacity = qint64(m_ring.size());
+    int copied = 0;
+    const int bytes = int(qMin<qint64>(size, available));
+    while (copied < bytes) {
+        const qint64 offset = (m_readPos + copied) % capacity;
+        const int chunk = int(qMin<qint64>(bytes - copied, capacity - offset));
+        std::memcpy(buffer + copied, m_ring.data() + offset, size_t(chunk));
+        copied += chunk;
+    }
+    m_readPos += copied;
+    m_spaceAvailable.wakeAll();
+    return copied;
+}
+
+int64_t FFmpegInputStream::seekTo(int64_t position)
+{
+    if (position < 0) {
+        return AVERROR(EINVAL);
+    }
+
+    if (m_mode == MemoryMappedMode) {
+        m_mapPos = qMin<qint64>(position, m_size);
+        return m_mapPos;
+    }
+
+    QMutexLocker locker(&m_mutex);
+    if (position >= m_bufferStart && position <= m_bufferEnd) {
+        m_readPos = position;  // Inside the window (demuxers seek back and forth a lot) - no disk access
+        m_spaceAvailable.wakeAll();
+        return position;
+    }
+
+    // Outside the window: restart the read-ahead there, in-flight disk reads are discarded
+    m_seeks.fetch_add(1, std::memory_order_relaxed);
+    ++m_generation;
+    m_bufferStart = m_bufferEnd = m_readPos = position;
+    m_eof = false;
+    m_ioError = false;
+    m_spaceAvailable.wakeAll();
+    return position;
+}
+
+void FFmpegInputStream::readAheadThreadFunc()
+{
+    QFile file(m_filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        QMutexLocker locker(&m_mutex);
+        m_ioError = true;
+        m_dataReady.wakeAll();
+        return;
+    }
+
+    const qint64 capacity = qint64(m_ring.size());
+    quint64 fileGeneration = ~quint64(0);
+
+    QMutexLocker locker(&m_mutex);
+    while (!m_stopReadAhead) {
+        if (fileGeneration != m_generation) {
+            fileGeneration = m_generation;
+            if (!file.seek(m_bufferEnd)) {
+                m_ioError = true;
+                m_dataReady.wakeAll();
+            }
+        }
+
+        // Free space = ring minus what's still unread and the look-behind kept for backward seeks
+        const qint64 oldest = qMax(m_bufferStart, m_readPos - m_keepBehind);
+        const qint64 space = capacity - (m_bufferEnd - oldest);
+        if (m_eof || m_ioError || space <= 0) {
+            m_spaceAvailable.wait(&m_mutex);
+            continue;
+        }
+        m_bufferStart = oldest;
+
+        // Only this thread writes [m_bufferEnd, m_bufferEnd + chunk); the reader never looks past m_bufferEnd
+        const qint64 offset = m_bufferEnd % capacity;
+        const qint64 chunk = qMin(qMin(space, DISK_CHUNK_BYTES), capacity - offset);
+        uint8_t* target = m_ring.data() + offset;
+        const quint64 generation = m_generation;
+
+        locker.unlock();
+        const qint64 bytes = file.read(reinterpret_cast<char*>(target), chunk);
+        locker.relock();
+
+        if (generation != m_generation) {
+            continue;  // Seek outside the window while reading - that data is stale
+        }
+        if (bytes < 0) {
+            qWarning() << "[FFmpeg] Read-ahead failed:" << file.errorString();
+            m_ioError = true;
+        } else if (bytes == 0) {
+            m_eof = true;
+        } else {
+            m_bufferEnd += bytes;
+        }
+        m_dataReady.wakeAll();
+    }
+}
@@ -0,0 +1,120 @@
+#ifndef FFMPEGINPUTSTREAM_H
+#define FFMPEGINPUTSTREAM_H
+
+#include <QFile>
+#include <QMutex>
+#include <QString>
+#include <QWaitCondition>
+#include <QtGlobal>
+#include <atomic>
+#include <vector>
+
+class QThread;
+
+// Forward declarations to avoid including FFmpeg headers in header file
+struct AVIOContext;
+struct AVFormatContext;
+
+/**
+ * Custom AVIOContext for local files, so demux reads never hit the disk on the caller's thread
+ *
+ *   ReadAheadMode     - a background thread keeps up to `readAheadBytes` of the file ahead of
+ *                       the read position in a ring (plus a small look-behind for the short
+ *                       backward seeks demuxers do). Reads and in-window seeks are served from
+ *                       memory; a read only blocks ("stall") when the ring is empty.
+ *   MemoryMappedMode  - the whole file is mapped (QFile::map); reads are memcpy, the kernel
+ *                       does the read-ahead. Falls back to ReadAheadMode if mapping fails.
+ *   DirectMode        - no custom I/O: open() returns false, avformat uses its file protocol.
+ *
+ * Usage: open(), attach() to a format context allocated with avformat_alloc_context() before
+ * avformat_open_input(), close() after avformat_close_input() (AVFMT_FLAG_CUSTOM_IO means
+ * avformat never frees the I/O context). The AVIO callbacks run on the demuxing thread.
+ */
+class FFmpegInputStream
+{
+public:
+    enum Mode {
+        DirectMode,
+        ReadAheadMode,
+        MemoryMappedMode
+    };
+
+    struct Stats {
+        quint64 reads = 0;          // AVIO read callbacks
+        quint64 cacheHits = 0;      // Reads served without waiting for the disk
+        quint64 stalls = 0;         // Reads that had to wait for the read-ahead thread
+        qint64 stallUs = 0;         // Total time spent waiting
+        quint64 seeks = 0;          // Seeks outside the buffered window (refill from disk)
+        qint64 bytesRead = 0;
+        qint64 bufferedBytes = 0;   // Read-ahead bytes ahead of the read position
+    };
+
+    static constexpr qint64 DEFAULT_READ_AHEAD_BYTES = 16 * 1024 * 1024;
+
+    FFmpegInputStream() = default;
+    ~FFmpegInputStream();
+
+    FFmpegInputStream(const FFmpegInputStream&) = delete;
+    FFmpegInputStream& operator=(const FFmpegInputStream&) = delete;
+
+    // QSettings "video/ffmpegInputMode" ("auto" | "direct" | "readahead" | "mmap") for this file.
+    // Auto: read-ahead for network shares (reads there are slow and bursty), mmap otherwise.
+    static Mode configuredMode(const QString& filePath);
+    // QSettings "video/ffmpegReadAheadMB"
+    static qint64 configuredReadAheadBytes();
+    static const char* modeName(Mode mode);
+
+    // False for DirectMode, non-local paths and open failures - use the default file protocol then
+    bool open(const QString& filePath, Mode mode, qint64 readAheadBytes = DEFAULT_READ_AHEAD_BYTES);
+    // Hand the I/O context to a format context before avformat_open_input()
+    void attach(AVFormatContext* formatContext);
+    // Stop the read-ahead thread and free the I/O context (after avformat_close_input)
+    void close();
+
+    bool isOpen() const { return m_ioContext != nullptr; }
+    Mode mode() const { return m_mode; }
+    Stats stats() const;
+
+private:
+    static int readPacket(void* opaque, uint8_t* buffer, int size);
+    static int64_t seek(void* opaque, int64_t offset, int whence);
+
+    int readMapped(uint8_t* buffer, int size);
+    int readBuffered(uint8_t* buffer, int size);
+    int64_t seekTo(int64_t position);
+    void readAheadThreadFunc();
+
+    Mode m_mode = DirectMode;
+    AVIOContext* m_ioContext = nullptr;
+    QFile m_file;              // Mapped file (MemoryMappedMode)
+    QString m_filePath;
+    qint64 m_size = 0;
+
+    // MemoryMappedMode (demuxing thread only)
+    const uchar* m_map = nullptr;
+    qint64 m_mapPos = 0;
+
+    // ReadAheadMode: ring holds file bytes [m_bufferStart, m_bufferEnd), all guarded by m_mutex
+    QThread* m_readThread = nullptr;
+    mutable QMutex m_mutex;
+    QWaitCondition m_dataReady;        // Wakes the reader: bytes appended, EOF, error
+    QWaitCondition m_spaceAvailable;   // Wakes the read-ahead thread: bytes consumed, seek, stop
+    std::vector<uint8_t> m_ring;
+    qint64 m_keepBehind = 0;           // Consumed bytes kept for short backward seeks
+    qint64 m_bufferStart = 0;
+    qint64 m_bufferEnd = 0;
+    qint64 m_readPos = 0;
+    quint64 m_generation = 0;          // Bumped by seeks outside the window - in-flight disk reads are dropped
+    bool m_eof = false;
+    bool m_ioError = false;
+    bool m_stopReadAhead = false;
+
+    std::atomic<quint64> m_reads{0};
+    std::atomic<quint64> m_cacheHits{0};
+    std::atomic<quint64> m_stalls{0};
+    std::atomic<qint64> m_stallUs{0};
+    std::atomic<quint64> m_seeks{0};
+    std::atomic<qint64> m_bytesRead{0};
+};
+
+#endif // FFMPEGINPUTSTREAM_H
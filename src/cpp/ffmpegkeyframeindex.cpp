@@ -0,0 +1,343 @@
+#include "ffmpegkeyframeindex.h"
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QStandardPaths>
+#include <QtConcurrent>
+#include <algorithm>
+#include <cstring>
+
+extern "C" {
+#include <libavformat/avformat.h>
+#include <libavcodec/avcodec.h>
+}
+
+namespace {
+    constexpr quint32 kCacheMagic = 0x53334b49;  // "S3KI"
+    constexpr quint32 kCacheVersion = 2;  // 2: keyed by PTS (1 held container DTS)
+
+    // Container indexes coarser than this (average keyframe spacing) are refined by a packet scan
+    constexpr double kMaxContainerSpacingSeconds = 5.0;
+
+    // Packets read after a seek before giving up on finding the indexed keyframe
+    constexpr int kMaxPacketsPerIndexEntry = 16;
+
+    // Demuxers whose index entries carry presentation timestamps (Matroska/WebM cue times);
+    // the others (mov/mp4, avi, flv, ...) index decode timestamps
+    bool indexStoresPts(const AVFormatContext* formatContext)
+    {
+        return formatContext && formatContext->iformat && formatContext->iformat->name &&
+               std::strstr(formatContext->iformat->name, "matroska") != nullptr;
+    }
+}
+
+FFmpegKeyframeIndex::~FFmpegKeyframeIndex()
+{
+    reset();
+}
+
+void FFmpegKeyframeIndex::reset()
+{
+    m_cancelScan.store(true, std::memory_order_release);
+    m_scanFuture.waitForFinished();
+    m_scanFuture = QFuture<void>();
+    m_cancelScan.store(false, std::memory_order_release);
+
+    QMutexLocker locker(&m_mutex);
+    m_keyframes.clear();
+    m_keyframes.shrink_to_fit();
+    m_source = NoIndex;
+}
+
+void FFmpegKeyframeIndex::build(const QString& filePath, const AVFormatContext* formatContext, AVStream* stream)
+{
+    reset();
+    if (!stream || filePath.isEmpty()) {
+        return;
+    }
+
+    const int streamIndex = stream->index;
+    const int tbNum = stream->time_base.num;
+    const int tbDen = stream->time_base.den;
+    const QString cacheFile = QFileInfo(filePath).isFile() ? cachePath(filePath, streamIndex) : QString();
+
+    // 1. Previous scan of this exact file
+    if (!cacheFile.isEmpty() && loadCache(cacheFile, tbNum, tbDen)) {
+        qDebug() << "[FFmpeg] Keyframe index loaded from cache:" << count() << "keyframes";
+        return;
+    }
+
+    // 2. Container index (free - already parsed by avformat_open_input / find_stream_info)
+    std::vector<qint64> keyframes;
+    const int entries = avformat_index_get_entries_count(stream);
+    keyframes.reserve(size_t(qMax(0, entries)));
+    for (int i = 0; i < entries; ++i) {
+        const AVIndexEntry* entry = avformat_index_get_entry(stream, i);
+        if (entry && (entry->flags & AVINDEX_KEYFRAME) && entry->timestamp != AV_NOPTS_VALUE) {
+            keyframes.push_back(entry->timestamp);
+        }
+    }
+    std::sort(keyframes.begin(), keyframes.end());
+    keyframes.erase(std::unique(keyframes.begin(), keyframes.end()), keyframes.end());
+
+    bool needsScan = keyframes.size() < 2;
+    if (!needsScan) {
+        const double span = double(keyframes.back() - keyframes.front()) * av_q2d(stream->time_base);
+        needsScan = span / double(keyframes.size() - 1) > kMaxContainerSpacingSeconds;
+    }
+    // Decode timestamps are never published - callers compare keyframes against frame PTS
+    const bool hasPts = indexStoresPts(formatContext);
+    const bool resolveIndex = !needsScan && !hasPts;
+    if (!keyframes.empty()) {
+        qDebug() << "[FFmpeg] Keyframe index from container:" << keyframes.size() << "keyframes"
+                 << (needsScan ? "(sparse - refining with packet scan)"
+                     : resolveIndex ? "(decode timestamps - resolving keyframe PTS)" : "");
+        if (hasPts) {
+            publish(std::move(keyframes), ContainerIndex);
+        }
+    }
+
+    // 3. Background pass (local files only - a second pass over a network stream isn't free)
+    if ((needsScan || resolveIndex) && !cacheFile.isEmpty()) {
+        m_scanFuture = QtConcurrent::run([this, filePath, streamIndex, tbNum, tbDen, cacheFile, resolveIndex]() {
+            scanFile(filePath, streamIndex, tbNum, tbDen, cacheFile, resolveIndex);
+        });
+    }
+}
+
+void FFmpegKeyframeIndex::scanFile(QString filePath, int streamIndex, int timeBaseNum, int timeBaseDen, QString cacheFile,
+                                   bool resolveIndex)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    AVFormatContext* ctx = nullptr;
+    if (avformat_open_input(&ctx, filePath.toUtf8().constData(), nullptr, nullptr) < 0) {
+        qWarning() << "[FFmpeg] Keyframe scan: failed to open" << filePath;
+        return;
+    }
+    // Streams are normally known from the header; probe only if this container creates them lazily
+    if (streamIndex >= int(ctx->nb_streams) && avformat_find_stream_info(ctx, nullptr) < 0) {
+        avformat_close_input(&ctx);
+        return;
+    }
+    if (streamIndex >= int(ctx->nb_streams)) {
+        qWarning() << "[FFmpeg] Keyframe scan: stream" << streamIndex << "not found";
+        avformat_close_input(&ctx);
+        return;
+    }
+
+    // Demux only the video stream's packets (the demuxer skips the rest cheaply)
+    for (unsigned int i = 0; i < ctx->nb_streams; ++i) {
+        ctx->streams[i]->discard = int(i) == streamIndex ? AVDISCARD_DEFAULT : AVDISCARD_ALL;
+    }
+    const AVRational scanTimeBase = ctx->streams[streamIndex]->time_base;
+    const AVRational timeBase{timeBaseNum, timeBaseDen};
+
+    std::vector<qint64> keyframes;
+    AVPacket* packet = av_packet_alloc();
+    bool resolved = false;
+    if (resolveIndex && packet) {
+        // Seek to every indexed keyframe (by its DTS) and take the PTS of the keyframe packet found there.
+        // One packet per GOP instead of demuxing the whole file.
+        AVStream* stream = ctx->streams[streamIndex];
+        const int entries = avformat_index_get_entries_count(stream);
+        std::vector<qint64> indexDts;
+        indexDts.reserve(size_t(qMax(0, entries)));
+        for (int i = 0; i < entries; ++i) {
+            const AVIndexEntry* entry = avformat_index_get_entry(stream, i);
+            if (entry && (entry->flags & AVINDEX_KEYFRAME) && entry->timestamp != AV_NOPTS_VALUE) {
+                indexDts.push_back(entry->timestamp);
+            }
+        }
+
+        resolved = !indexDts.empty();
+        keyframes.reserve(indexDts.size());
+        int missed = 0;
+        for (qint64 dts : indexDts) {
+            if (m_cancelScan.load(std::memory_order_acquire) ||
+                av_seek_frame(ctx, streamIndex, dts, AVSEEK_FLAG_BACKWARD) < 0) {
+                resolved = false;
+                break;
+            }
+            // The seek may land on the previous keyframe - that one is already recorded, so only the
+            // keyframe packet at (or past) this entry's DTS counts; the entry is dropped if it never shows up
+            bool found = false;
+            for (int n = 0; n < kMaxPacketsPerIndexEntry && av_read_frame(ctx, packet) >= 0; ++n) {
+                found = packet->stream_index == streamIndex && (packet->flags & AV_PKT_FLAG_KEY) &&
+                        (packet->dts == AV_NOPTS_VALUE || packet->dts >= dts);
+                if (found) {
+                    const int64_t ts = packet->pts != AV_NOPTS_VALUE ? packet->pts : packet->dts;
+                    if (ts != AV_NOPTS_VALUE) {
+                        keyframes.push_back(av_rescale_q(ts, scanTimeBase, timeBase));
+                    }
+                }
+                av_packet_unref(packet);
+                if (found) {
+                    break;
+                }
+            }
+            if (!found) {
+                ++missed;
+            }
+        }
+        if (missed > 0) {
+            qDebug() << "[FFmpeg] Keyframe index:" << missed << "entries not found after seeking - dropped";
+        }
+        if (!resolved && !m_cancelScan.load(std::memory_order_acquire)) {
+            // Demuxer can't seek precisely enough - fall back to the full scan
+            keyframes.clear();
+            if (av_seek_frame(ctx, streamIndex, stream->start_time != AV_NOPTS_VALUE ? stream->start_time : 0,
+                              AVSEEK_FLAG_BACKWARD) < 0) {
+                av_packet_free(&packet);
+                avformat_close_input(&ctx);
+                return;
+            }
+        }
+    }
+
+    while (!resolved && packet && !m_cancelScan.load(std::memory_order_acquire) && av_read_frame(ctx, packet) >= 0) {
+        if (packet->stream_index == streamIndex && (packet->flags & AV_PKT_FLAG_KEY)) {
+            const int64_t ts = packet->pts != AV_NOPTS_VALUE ? packet->pts : packet->dts;
+            if (ts != AV_NOPTS_VALUE) {
+                keyframes.push_back(av_rescale_q(ts, scanTimeBase, timeBase));
+            }
+        }
+        av_packet_unref(packet);
+    }
+    av_packet_free(&packet);
+    avformat_close_input(&ctx);
+
+    if (m_cancelScan.load(std::memory_order_acquire) || keyframes.empty()) {
+        return;
+    }
+
+    std::sort(keyframes.begin(), keyframes.end());
+    keyframes.erase(std::unique(keyframes.begin(), keyframes.end()), keyframes.end());
+    qDebug() << "[FFmpeg] Keyframe" << (resolved ? "index PTS resolved:" : "scan finished:") << keyframes.size()
+             << "keyframes in" << timer.elapsed() << "ms";
+
+    publish(std::move(keyframes), ScannedIndex);
+    saveCache(cacheFile, timeBaseNum, timeBaseDen);
+}
+
+void FFmpegKeyframeIndex::publish(std::vector<qint64>&& keyframes, Source source)
+{
+    QMutexLocker locker(&m_mutex);
+    m_keyframes = std::move(keyframes);
+    m_source = source;
+}
+
+bool FFmpegKeyframeIndex::keyframeAtOrBefore(qint64 pts, qint64* keyframePts) const
+{
+    QMutexLocker locker(&m_mutex);
+    auto it = std::upper_bound(m_keyframes.begin(), m_keyframes.end(), pts);
+    if (it == m_keyframes.begin()) {
+        return false;  // Before the first known keyframe (or no index)
+    }
+    if (keyframePts) {
+        *keyframePts = *(it - 1);
+    }
+    return true;
+}
+
+bool FFmpegKeyframeIndex::keyframeAtOrAfter(qint64 pts, qint64* keyframePts) const
+{
+    QMutexLocker locker(&m_mutex);
+    auto it = std::lower_bound(m_keyframes.begin(), m_keyframes.end(), pts);
+    if (it == m_keyframes.end()) {
+        return false;  // After the last known keyframe (or no index)
+    }
+    if (keyframePts) {
+        *keyframePts = *it;
+    }
+    return true;
+}
+
+int FFmpegKeyframeIndex::count() const
+{
+    QMutexLocker locker(&m_mutex);
+    return int(m_keyframes.size());
+}
+
+FFmpegKeyframeIndex::Source FFmpegKeyframeIndex::source() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_source;
+}
+
+const char* FFmpegKeyframeIndex::sourceName(Source source)
+{
+    switch (source) {
+        case ContainerIndex: return "container";
+        case ScannedIndex: return "scan";
+        case CachedIndex: return "cache";
+        default: return "none";
+    }
+}
+
+QString FFmpegKeyframeIndex::cachePath(const QString& filePath, int streamIndex)
+{
+    QString cacheDir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+    cacheDir += "/keyframe_index";
+
+    // Size + mtime in the key so a replaced file never reuses a stale index
+    const QFileInfo info(filePath);
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    hash.addData(info.absoluteFilePath().toUtf8());
+    hash.addData(QByteArray::number(info.size()));
+    hash.addData(QByteArray::number(info.lastModified().toMSecsSinceEpoch()));
+    const QString hashStr = hash.result().toHex().left(16);
+
+    return cacheDir + "/" + QString("%1_stream%2.kfi").arg(hashStr).arg(streamIndex);
+}
+
+bool FFmpegKeyframeIndex::loadCache(const QString& path, int timeBaseNum, int timeBaseDen)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QDataStream in(&file);
+    quint32 magic = 0, version = 0, count = 0;
+    qint32 num = 0, den = 0;
+    in >> magic >> version >> num >> den >> count;
+    if (magic != kCacheMagic || version != kCacheVersion || num != timeBaseNum || den != timeBaseDen ||
+        qint64(count) * qint64(sizeof(qint64)) > file.size()) {
+        return false;
+    }
+
+    std::vector<qint64> keyframes(count);
+    for (quint32 i = 0; i < count; ++i) {
+        in >> keyframes[i];
+    }
+    if (in.status() != QDataStream::Ok || keyframes.empty()) {
+        return false;
+    }
+
+    publish(std::move(keyframes), CachedIndex);
+    return true;
+}
+
+void FFmpegKeyframeIndex::saveCache(const QString& path, int timeBaseNum, int timeBaseDen) const
+{
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning() << "[FFmpeg] Failed to write keyframe index cache:" << path;
+        return;
+    }
+
+    QMutexLocker locker(&m_mutex);
+    QDataStream out(&file);
+    out << kCacheMagic << kCacheVersion << qint32(timeBaseNum) << qint32(timeBaseDen) << quint32(m_keyframes.size());
+    for (qint64 pts : m_keyframes) {
+        out << pts;
+    }
+}
@@ -0,0 +1,80 @@
+#ifndef FFMPEGKEYFRAMEINDEX_H
+#define FFMPEGKEYFRAMEINDEX_H
+
+#include <QFuture>
+#include <QMutex>
+#include <QString>
+#include <QtGlobal>
+#include <atomic>
+#include <vector>
+
+// Forward declarations to avoid including FFmpeg headers in header file
+struct AVFormatContext;
+struct AVStream;
+
+/**
+ * Per-file keyframe index for accurate seeking
+ *
+ * Holds the sorted PTS (stream time base) of every keyframe of one video stream.
+ * build() fills it from, in order of preference:
+ *   1. the on-disk cache (CacheLocation/keyframe_index, keyed by path + size + mtime)
+ *   2. the container's own index, when it stores presentation timestamps (Matroska cues) -
+ *      usable immediately
+ *   3. a background pass on a private demuxer (no decoding), written to the cache:
+ *      - DTS-based container indexes (MP4/MOV sample tables, AVI, FLV) are resolved to PTS by
+ *        seeking to each indexed keyframe and reading its packet - with B-frames a keyframe's
+ *        DTS precedes its PTS, so the raw index would land callers one GOP off
+ *      - a missing or too sparse index is replaced by a full packet scan
+ *
+ * Lookups are thread-safe and never block on the scan.
+ */
+class FFmpegKeyframeIndex
+{
+public:
+    enum Source {
+        NoIndex,
+        ContainerIndex,
+        ScannedIndex,
+        CachedIndex
+    };
+
+    FFmpegKeyframeIndex() = default;
+    ~FFmpegKeyframeIndex();
+
+    FFmpegKeyframeIndex(const FFmpegKeyframeIndex&) = delete;
+    FFmpegKeyframeIndex& operator=(const FFmpegKeyframeIndex&) = delete;
+
+    // Start indexing stream (of formatContext, opened from filePath). Cancels any previous build.
+    void build(const QString& filePath, const AVFormatContext* formatContext, AVStream* stream);
+
+    // Cancel a running scan and forget the index
+    void reset();
+
+    // Greatest keyframe PTS <= pts (stream time base). False if the index can't answer.
+    bool keyframeAtOrBefore(qint64 pts, qint64* keyframePts) const;
+    // Smallest keyframe PTS >= pts. False past the last known keyframe (or no index).
+    bool keyframeAtOrAfter(qint64 pts, qint64* keyframePts) const;
+
+    int count() const;
+    Source source() const;
+    static const char* sourceName(Source source);
+
+private:
+    friend class TestFFmpegKeyframeIndex;  // Drives publish() and the cache file directly
+
+    static QString cachePath(const QString& filePath, int streamIndex);
+    bool loadCache(const QString& path, int timeBaseNum, int timeBaseDen);
+    void saveCache(const QString& path, int timeBaseNum, int timeBaseDen) const;
+    // resolveIndex: read the PTS of the container index's keyframes instead of scanning every packet
+    void scanFile(QString filePath, int streamIndex, int timeBaseNum, int timeBaseDen, QString cacheFile, bool resolveIndex);
+    void publish(std::vector<qint64>&& keyframes, Source source);
+
+    mutable QMutex m_mutex;
+    std::vector<qint64> m_keyframes;    // Sorted, unique (guarded by m_mutex)
+    Source m_source = NoIndex;          // Guarded by m_mutex
+
+    QFuture<void> m_scanFuture;
+    std::atomic_bool m_cancelScan{false};
+};
+
+#endif // FFMPEGKEYFRAMEINDEX_H
@@ -0,0 +1,533 @@
+#include "ffmpegremuxer.h"
+#include "ffmpeginputstream.h"
+#include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QtConcurrent>
+#include <vector>
+
+extern "C" {
+#include <libavformat/avformat.h>
+#include <libavcodec/avcodec.h>
+#include <libavutil/avutil.h>
+#include <libavutil/mathematics.h>
+}
+
+namespace {
+    constexpr int64_t DISCONTINUITY_US = 10 * AV_TIME_BASE;   // Same default as ffmpeg's -dts_delta_threshold
+    constexpr qreal PROGRESS_STEP = 0.005;
+    constexpr int64_t KEYFRAME_TOLERANCE_US = 1000;            // Index/packet timestamp rounding
+
+    QString errorString(int error)
+    {
+        char errbuf[AV_ERROR_MAX_STRING_SIZE];
+        av_strerror(error, errbuf, AV_ERROR_MAX_STRING_SIZE);
+        return QString::fromUtf8(errbuf);
+    }
+
+    bool isCopiedStream(const AVStream* stream)
+    {
+        if (stream->disposition & AV_DISPOSITION_ATTACHED_PIC) {
+            return false;  // Cover art - not part of the timeline
+        }
+        const AVMediaType type = stream->codecpar->codec_type;
+        return type == AVMEDIA_TYPE_VIDEO || type == AVMEDIA_TYPE_AUDIO || type == AVMEDIA_TYPE_SUBTITLE;
+    }
+
+    bool canCarry(const AVOutputFormat* format, const AVFormatContext* input)
+    {
+        for (unsigned int i = 0; i < input->nb_streams; ++i) {
+            const AVStream* stream = input->streams[i];
+            if (isCopiedStream(stream) && avformat_query_codec(format, stream->codecpar->codec_id, FF_COMPLIANCE_NORMAL) == 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Fallback packet duration (stream time base) for packets that don't carry one
+    int64_t defaultDuration(const AVStream* stream)
+    {
+        const AVCodecParameters* par = stream->codecpar;
+        if (par->codec_type == AVMEDIA_TYPE_VIDEO) {
+            AVRational rate = stream->avg_frame_rate.num > 0 ? stream->avg_frame_rate : stream->r_frame_rate;
+            if (rate.num <= 0 || rate.den <= 0) {
+                rate = AVRational{ 25, 1 };
+            }
+            return qMax<int64_t>(1, av_rescale_q(1, av_inv_q(rate), stream->time_base));
+        }
+        if (par->codec_type == AVMEDIA_TYPE_AUDIO && par->frame_size > 0 && par->sample_rate > 0) {
+            return qMax<int64_t>(1, av_rescale_q(par->frame_size, AVRational{ 1, par->sample_rate }, stream->time_base));
+        }
+        if (par->codec_type == AVMEDIA_TYPE_AUDIO) {
+            return qMax<int64_t>(1, av_rescale_q(20, AVRational{ 1, 1000 }, stream->time_base));
+        }
+        return 1;
+    }
+
+    // Presentation time of a packet (DTS if it has no PTS)
+    int64_t packetTimeUs(const AVPacket* packet, AVRational timeBase)
+    {
+        const int64_t ts = packet->pts != AV_NOPTS_VALUE ? packet->pts : packet->dts;
+        return ts != AV_NOPTS_VALUE ? av_rescale_q(ts, timeBase, AV_TIME_BASE_Q) : AV_NOPTS_VALUE;
+    }
+
+    struct StreamState {
+        int outputIndex = -1;
+        bool timeline = false;              // Audio/video: detects discontinuities for all streams
+        int64_t duration = 1;
+        int64_t lastDts = AV_NOPTS_VALUE;
+        int64_t nextDts = AV_NOPTS_VALUE;   // lastDts + packet duration
+        bool ended = false;                 // Range jobs: reached the out point
+    };
+}
+
+FFmpegRemuxer::FFmpegRemuxer(QObject* parent)
+    : QObject(parent)
+{
+}
+
+FFmpegRemuxer::~FFmpegRemuxer()
+{
+    cancel();
+    m_future.waitForFinished();
+}
+
+bool FFmpegRemuxer::start(const QString& inputPath, const QString& outputPath, const Range& range)
+{
+    if (m_running) {
+        qWarning() << "[VideoFix] Remux already running";
+        return false;
+    }
+
+    const quint64 generation = ++m_generation;
+    m_cancelled = std::make_shared<std::atomic_bool>(false);
+    m_running = true;
+    m_progress = 0.0;
+    emit runningChanged();
+    emit progressChanged();
+
+    std::shared_ptr<std::atomic_bool> cancelled = m_cancelled;
+    m_future = QtConcurrent::run([this, generation, inputPath, outputPath, range, cancelled]() {
+        auto reportProgress = [this, generation](qreal progress) {
+            QMetaObject::invokeMethod(this, [this, generation, progress]() {
+                if (generation == m_generation && m_running) {
+                    m_progress = progress;
+                    emit progressChanged();
+                }
+            }, Qt::QueuedConnection);
+        };
+
+        const Result result = remux(inputPath, outputPath, *cancelled, reportProgress, range);
+
+        QMetaObject::invokeMethod(this, [this, generation, result]() {
+            finishJob(generation, result);
+        }, Qt::QueuedConnection);
+    });
+    return true;
+}
+
+void FFmpegRemuxer::cancel()
+{
+    if (m_cancelled) {
+        m_cancelled->store(true, std::memory_order_relaxed);
+    }
+}
+
+void FFmpegRemuxer::finishJob(quint64 generation, const Result& result)
+{
+    if (generation != m_generation) {
+        return;
+    }
+    m_running = false;
+    if (result.success) {
+        m_progress = 1.0;
+        emit progressChanged();
+    }
+    emit runningChanged();
+    emit finished(result);
+}
+
+FFmpegRemuxer::Result FFmpegRemuxer::remux(const QString& inputPath, const QString& outputPath,
+                                           const std::atomic_bool& cancelled, const std::function<void(qreal)>& reportProgress,
+                                           const Range& range)
+{
+    Result result;
+    QElapsedTimer timer;
+    timer.start();
+    const bool clip = !range.isFull();
+    const char* const tag = clip ? "[ClipExport]" : "[VideoFix]";
+
+    // Input: read-ahead/mapped I/O keeps the copy at disk speed
+    FFmpegInputStream inputStream;
+    AVFormatContext* input = avformat_alloc_context();
+    if (!input) {
+        result.error = QStringLiteral("Failed to allocate format context");
+        return result;
+    }
+    if (inputStream.open(inputPath, FFmpegInputStream::configuredMode(inputPath), FFmpegInputStream::configuredReadAheadBytes())) {
+        inputStream.attach(input);
+    }
+    input->flags |= AVFMT_FLAG_GENPTS | AVFMT_FLAG_DISCARD_CORRUPT;
+
+    int ret = avformat_open_input(&input, inputPath.toUtf8().constData(), nullptr, nullptr);
+    if (ret < 0) {
+        result.error = errorString(ret);
+        qWarning() << tag << "Failed to open input:" << result.error;
+        return result;  // avformat_open_input freed the context; inputStream closes itself
+    }
+    avformat_find_stream_info(input, nullptr);
+
+    // Output container: the requested one if it can carry every copied codec, Matroska otherwise
+    QString targetPath = outputPath;
+    const AVOutputFormat* format = av_guess_format(nullptr, targetPath.toUtf8().constData(), nullptr);
+    if (!format || !canCarry(format, input)) {
+        const QFileInfo info(outputPath);
+        targetPath = info.dir().filePath(info.completeBaseName() + QStringLiteral(".mkv"));
+        format = av_guess_format("matroska", nullptr, nullptr);
+        qDebug() << tag << "Output container can't carry all streams - writing Matroska instead";
+    }
+    result.outputPath = targetPath;
+
+    AVFormatContext* output = nullptr;
+    AVPacket* packet = av_packet_alloc();
+    std::vector<StreamState> streams(input->nb_streams);
+    std::vector<AVPacket*> held;  // Range jobs: packets since the last keyframe before the in point
+    bool headerWritten = false;
+
+    auto releaseHeld = [&]() {
+        for (AVPacket*& heldPacket : held) {
+            av_packet_free(&heldPacket);
+        }
+        held.clear();
+    };
+    auto cleanup = [&]() {
+        if (output) {
+            if (!(output->oformat->flags & AVFMT_NOFILE)) {
+                avio_closep(&output->pb);
+            }
+            avformat_free_context(output);
+            output = nullptr;
+        }
+        releaseHeld();
+        av_packet_free(&packet);
+        avformat_close_input(&input);
+        inputStream.close();
+    };
+    auto fail = [&](const QString& error) {
+        result.error = error;
+        qWarning() << tag << "Remux failed:" << error;
+        cleanup();
+        QFile::remove(targetPath);
+        return result;
+    };
+
+    ret = avformat_alloc_output_context2(&output, format, nullptr, targetPath.toUtf8().constData());
+    if (ret < 0 || !output || !packet) {
+        return fail(ret < 0 ? errorString(ret) : QStringLiteral("Out of memory"));
+    }
+
+    int timelineStreams = 0;
+    for (unsigned int i = 0; i < input->nb_streams; ++i) {
+        AVStream* in = input->streams[i];
+        if (!isCopiedStream(in) || avformat_query_codec(output->oformat, in->codecpar->codec_id, FF_COMPLIANCE_NORMAL) == 0) {
+            continue;
+        }
+        AVStream* out = avformat_new_stream(output, nullptr);
+        if (!out || avcodec_parameters_copy(out->codecpar, in->codecpar) < 0) {
+            return fail(QStringLiteral("Failed to create output stream"));
+        }
+        out->codecpar->codec_tag = 0;  // Let the muxer pick its own tag
+        out->time_base = in->time_base;
+        out->disposition = in->disposition;
+        out->sample_aspect_ratio = in->sample_aspect_ratio;
+        av_dict_copy(&out->metadata, in->metadata, 0);
+
+        StreamState& state = streams[i];
+        state.outputIndex = out->index;
+        state.timeline = in->codecpar->codec_type != AVMEDIA_TYPE_SUBTITLE;
+        state.duration = defaultDuration(in);
+        if (state.timeline) {
+            ++timelineStreams;
+        }
+    }
+    if (output->nb_streams == 0) {
+        return fail(QStringLiteral("No streams to copy"));
+    }
+    av_dict_copy(&output->metadata, input->metadata, 0);
+    output->avoid_negative_ts = AVFMT_AVOID_NEG_TS_MAKE_ZERO;
+
+    // Range jobs: the copy is cut on the video stream's keyframes
+    int videoIndex = av_find_best_stream(input, AVMEDIA_TYPE_VIDEO, -1, -1, nullptr, 0);
+    if (videoIndex >= 0 && streams[size_t(videoIndex)].outputIndex < 0) {
+        videoIndex = -1;
+    }
+    if (clip && range.startUs > 0) {
+        // Backward seek lands on a keyframe at or before the in point (the packet scan below refines it)
+        const int64_t target = videoIndex >= 0
+            ? av_rescale_q(range.startUs, AV_TIME_BASE_Q, input->streams[videoIndex]->time_base) : range.startUs;
+        ret = av_seek_frame(input, videoIndex, target, AVSEEK_FLAG_BACKWARD);
+        if (ret < 0) {
+            qWarning() << tag << "Seek to the in point failed, scanning from the start:" << errorString(ret);
+        }
+    }
+
+    if (!(output->oformat->flags & AVFMT_NOFILE)) {
+        ret = avio_open(&output->pb, targetPath.toUtf8().constData(), AVIO_FLAG_WRITE);
+        if (ret < 0) {
+            return fail(errorString(ret));
+        }
+    }
+    ret = avformat_write_header(output, nullptr);
+    if (ret < 0) {
+        return fail(errorString(ret));
+    }
+    headerWritten = true;
+
+    const qint64 inputSize = QFileInfo(inputPath).size();
+    int64_t offsetUs = 0;                     // Accumulated discontinuity correction (all streams)
+    int64_t lastTimelineUs = AV_NOPTS_VALUE;  // Latest audio/video DTS written (progress)
+    qreal lastProgress = 0.0;
+
+    // Timestamp repair + write (takes the packet's reference)
+    auto writePacket = [&](AVPacket* pkt) {
+        StreamState& state = streams[size_t(pkt->stream_index)];
+        const AVRational timeBase = input->streams[pkt->stream_index]->time_base;
+        const int64_t duration = pkt->duration > 0 ? pkt->duration : state.duration;
+        const int64_t reorder = (pkt->pts != AV_NOPTS_VALUE && pkt->dts != AV_NOPTS_VALUE && pkt->pts >= pkt->dts)
+                                ? pkt->pts - pkt->dts : 0;
+        bool repaired = false;
+
+        int64_t dts = pkt->dts != AV_NOPTS_VALUE ? pkt->dts : pkt->pts;
+        if (dts == AV_NOPTS_VALUE) {
+            dts = state.nextDts != AV_NOPTS_VALUE ? state.nextDts : 0;
+            repaired = true;
+        } else {
+            dts += av_rescale_q(offsetUs, AV_TIME_BASE_Q, timeBase);
+            const int64_t dtsUs = av_rescale_q(dts, timeBase, AV_TIME_BASE_Q);
+            // Each stream is checked against its own continuation only: a stream whose first packet starts
+            // late (e.g. a delayed audio track) is not a discontinuity and keeps its timestamps
+            const int64_t expectedUs = state.nextDts != AV_NOPTS_VALUE
+                                       ? av_rescale_q(state.nextDts, timeBase, AV_TIME_BASE_Q) : AV_NOPTS_VALUE;
+            if (state.timeline && expectedUs != AV_NOPTS_VALUE && qAbs(dtsUs - expectedUs) > DISCONTINUITY_US) {
+                // ✅ Timeline jump: continue where this stream left off, shift everything after it
+                offsetUs += expectedUs - dtsUs;
+                dts += av_rescale_q(expectedUs - dtsUs, AV_TIME_BASE_Q, timeBase);
+                ++result.discontinuities;
+                repaired = true;
+            }
+        }
+
+        // Muxers need strictly increasing DTS per stream
+        if (state.lastDts != AV_NOPTS_VALUE && dts <= state.lastDts) {
+            dts = state.nextDts > state.lastDts ? state.nextDts : state.lastDts + 1;
+            repaired = true;
+        }
+        if (repaired) {
+            ++result.repairedTimestamps;
+        }
+
+        pkt->dts = dts;
+        pkt->pts = dts + reorder;
+        pkt->duration = duration;
+        state.lastDts = dts;
+        state.nextDts = dts + duration;
+        if (state.timeline) {
+            const int64_t dtsUs = av_rescale_q(dts, timeBase, AV_TIME_BASE_Q);
+            lastTimelineUs = lastTimelineUs == AV_NOPTS_VALUE ? dtsUs : qMax(lastTimelineUs, dtsUs);
+        }
+
+        AVStream* out = output->streams[state.outputIndex];
+        av_packet_rescale_ts(pkt, timeBase, out->time_base);
+        pkt->stream_index = state.outputIndex;
+        pkt->pos = -1;
+        const int writeRet = av_interleaved_write_frame(output, pkt);
+        if (writeRet >= 0) {
+            ++result.packets;
+        }
+        return writeRet;
+    };
+
+    // Range jobs: is a packet after the in point (and before the out point) part of the clip?
+    int endedStreams = 0;
+    int64_t beginUs = clip ? AV_NOPTS_VALUE : 0;  // Video keyframe the clip starts at
+    int64_t videoEndUs = AV_NOPTS_VALUE;          // Video keyframe the clip stops before
+    qint64 droppedLeading = 0;                    // Open-GOP leading frames of the start keyframe
+    auto endStream = [&](StreamState& state) {
+        if (state.timeline && !state.ended) {
+            state.ended = true;
+            ++endedStreams;
+        }
+    };
+    auto inClip = [&](const AVPacket* pkt) {
+        StreamState& state = streams[size_t(pkt->stream_index)];
+        const int64_t timeUs = packetTimeUs(pkt, input->streams[pkt->stream_index]->time_base);
+        if (pkt->stream_index == videoIndex) {
+            if (videoEndUs != AV_NOPTS_VALUE) {
+                return false;
+            }
+            if (range.endUs >= 0 && (pkt->flags & AV_PKT_FLAG_KEY) && timeUs != AV_NOPTS_VALUE &&
+                timeUs >= range.endUs - KEYFRAME_TOLERANCE_US) {
+                videoEndUs = timeUs;
+                endStream(state);
+                return false;
+            }
+            if (!(pkt->flags & AV_PKT_FLAG_KEY) && pkt->pts != AV_NOPTS_VALUE && beginUs != AV_NOPTS_VALUE &&
+                timeUs < beginUs) {
+                // ✅ Open-GOP leading frame: decoded after the start keyframe but shown before it, it references
+                // the GOP before the clip, which isn't copied - players would show it as a corrupt first frame
+                ++droppedLeading;
+                return false;
+            }
+            return true;
+        }
+        if (timeUs == AV_NOPTS_VALUE) {
+            return true;
+        }
+        if (range.endUs >= 0 && timeUs >= range.endUs) {
+            endStream(state);
+            return false;
+        }
+        return timeUs >= beginUs;
+    };
+    // Write the held packets starting at the keyframe at/before the in point
+    auto beginClip = [&](int64_t keyframeUs) {
+        beginUs = keyframeUs;
+        result.startUs = keyframeUs;
+        qDebug() << tag << "Clip starts at keyframe" << double(keyframeUs) / AV_TIME_BASE << "s (requested"
+                 << double(range.startUs) / AV_TIME_BASE << "s)";
+        int writeRet = 0;
+        for (AVPacket*& heldPacket : held) {
+            if (writeRet >= 0 && inClip(heldPacket)) {
+                writeRet = writePacket(heldPacket);
+            }
+            av_packet_free(&heldPacket);
+        }
+        held.clear();
+        return writeRet;
+    };
+    const int64_t clipEndUs = range.endUs >= 0 ? range.endUs
+                            : (input->duration > 0 ? input->duration + qMax<int64_t>(0, input->start_time) : AV_NOPTS_VALUE);
+    int64_t heldKeyframeUs = AV_NOPTS_VALUE;
+
+    while (!cancelled.load(std::memory_order_relaxed)) {
+        ret = av_read_frame(input, packet);
+        if (ret == AVERROR(EAGAIN)) {
+            continue;
+        }
+        if (ret < 0) {
+            if (ret != AVERROR_EOF) {
+                // Broken tail - keep everything up to here, that's what the repair is for
+                qWarning() << tag << "Read error, finishing with what was copied:" << errorString(ret);
+            }
+            break;
+        }
+
+        StreamState& state = streams[size_t(packet->stream_index)];
+        if (state.outputIndex < 0) {
+            av_packet_unref(packet);
+            continue;
+        }
+        const int64_t timeUs = packetTimeUs(packet, input->streams[packet->stream_index]->time_base);
+
+        if (clip) {
+            if (beginUs == AV_NOPTS_VALUE) {
+                const bool video = packet->stream_index == videoIndex;
+                const bool keyframe = video && (packet->flags & AV_PKT_FLAG_KEY);
+                if (videoIndex < 0) {
+                    ret = beginClip(range.startUs);  // No video: cut at the in point itself
+                } else if (keyframe && timeUs != AV_NOPTS_VALUE && timeUs <= range.startUs + KEYFRAME_TOLERANCE_US) {
+                    // Start candidate - a later keyframe still before the in point replaces it
+                    releaseHeld();
+                    heldKeyframeUs = timeUs;
+                    if (AVPacket* copy = av_packet_clone(packet)) {
+                        held.push_back(copy);
+                    }
+                    av_packet_unref(packet);
+                    continue;
+                } else if (video && timeUs != AV_NOPTS_VALUE &&
+                           (heldKeyframeUs != AV_NOPTS_VALUE ? timeUs > range.startUs + KEYFRAME_TOLERANCE_US : keyframe)) {
+                    // Past the in point: start at the held keyframe (or here, if the seek overshot)
+                    ret = beginClip(heldKeyframeUs != AV_NOPTS_VALUE ? heldKeyframeUs : timeUs);
+                } else {
+                    if (heldKeyframeUs != AV_NOPTS_VALUE) {
+                        if (AVPacket* copy = av_packet_clone(packet)) {
+                            held.push_back(copy);
+                        }
+                    }
+                    av_packet_unref(packet);
+                    continue;
+                }
+                if (ret < 0) {
+                    return fail(QStringLiteral("Write failed: ") + errorString(ret));
+                }
+            }
+            if (!inClip(packet)) {
+                av_packet_unref(packet);
+                if (timelineStreams > 0 && endedStreams == timelineStreams) {
+                    break;  // Every audio/video stream reached the out point
+                }
+                continue;
+            }
+        }
+
+        ret = writePacket(packet);  // Takes the packet's reference
+        if (ret < 0) {
+            return fail(QStringLiteral("Write failed: ") + errorString(ret));
+        }
+
+        if (reportProgress) {
+            qreal progress = 0.0;
+            if (clip && clipEndUs != AV_NOPTS_VALUE && timeUs != AV_NOPTS_VALUE && state.timeline) {
+                progress = qreal(timeUs - beginUs) / qreal(qMax<int64_t>(1, clipEndUs - beginUs));
+            } else if (clip) {
+                progress = lastProgress;
+            } else if (input->duration > 0 && lastTimelineUs != AV_NOPTS_VALUE) {
+                progress = qreal(lastTimelineUs - offsetUs - qMax<int64_t>(0, input->start_time)) / qreal(input->duration);
+            } else if (inputSize > 0 && input->pb) {
+                progress = qreal(avio_tell(input->pb)) / qreal(inputSize);
+            }
+            progress = qBound<qreal>(0.0, progress, 1.0);
+            if (progress - lastProgress >= PROGRESS_STEP) {
+                lastProgress = progress;
+                reportProgress(progress);
+            }
+        }
+    }
+
+    if (cancelled.load(std::memory_order_relaxed)) {
+        result.cancelled = true;
+        return fail(QStringLiteral("Cancelled"));
+    }
+    // The file ended before anything past the in point - the held GOP is the whole clip
+    if (clip && beginUs == AV_NOPTS_VALUE && heldKeyframeUs != AV_NOPTS_VALUE) {
+        ret = beginClip(heldKeyframeUs);
+        if (ret < 0) {
+            return fail(QStringLiteral("Write failed: ") + errorString(ret));
+        }
+    }
+    if (result.packets == 0) {
+        return fail(QStringLiteral("No packets copied"));
+    }
+    if (headerWritten) {
+        ret = av_write_trailer(output);
+        if (ret < 0) {
+            return fail(QStringLiteral("Failed to finalize output: ") + errorString(ret));
+        }
+    }
+    cleanup();
+
+    result.success = true;
+    if (clip) {
+        result.endUs = videoEndUs != AV_NOPTS_VALUE ? videoEndUs : range.endUs;
+        qDebug() << tag << "Copied" << result.packets << "packets (" << double(result.startUs) / AV_TIME_BASE << "s -"
+                 << (result.endUs >= 0 ? double(result.endUs) / AV_TIME_BASE : -1.0) << "s ) in" << timer.elapsed() << "ms -"
+                 << droppedLeading << "open-GOP leading frames dropped";
+    } else {
+        qDebug() << tag << "Remuxed" << result.packets << "packets in" << timer.elapsed() << "ms -"
+                 << result.repairedTimestamps << "timestamps repaired," << result.discontinuities << "discontinuities";
+    }
+    return result;
+}
@@ -0,0 +1,85 @@
+#ifndef FFMPEGREMUXER_H
+#define FFMPEGREMUXER_H
+
+#include <QObject>
+#include <QFuture>
+#include <QString>
+#include <atomic>
+#include <functional>
+#include <memory>
+
+/**
+ * In-process stream-copy remux with timestamp repair (no re-encoding)
+ *
+ * Copies the video, audio and subtitle streams of a file into a new container at disk speed
+ * and regenerates broken timestamps on the way:
+ *   - missing PTS are generated by the demuxer (AVFMT_FLAG_GENPTS), missing DTS continue the
+ *     stream at its packet duration
+ *   - jumps of more than 10 s (either direction) on the audio/video timeline are treated as a
+ *     discontinuity: every stream is shifted by the same offset, so A/V stay aligned
+ *   - DTS are forced strictly increasing per stream, PTS keep their reorder distance to DTS
+ *   - the output starts at zero (avoid_negative_ts make_zero)
+ * If the output container can't carry one of the codecs, the output becomes Matroska.
+ *
+ * A Range copies only part of the input (clip export): the copy starts at the video keyframe
+ * at or before the in point and stops before the first video keyframe at or after the out point,
+ * so every copied GOP is complete. Audio/subtitles are cut at the in point and the out point.
+ *
+ * start() runs one job on a worker thread; the static remux() is the blocking core.
+ */
+class FFmpegRemuxer : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(bool running READ running NOTIFY runningChanged)
+    Q_PROPERTY(qreal progress READ progress NOTIFY progressChanged)
+
+public:
+    // Part of the input to copy (stream time in microseconds, the player's position timeline)
+    struct Range {
+        qint64 startUs = 0;
+        qint64 endUs = -1;     // -1 = end of file
+        bool isFull() const { return startUs <= 0 && endUs < 0; }
+    };
+
+    struct Result {
+        bool success = false;
+        bool cancelled = false;
+        QString outputPath;           // May differ from the requested one (container fallback)
+        QString error;
+        qint64 packets = 0;
+        qint64 repairedTimestamps = 0;
+        int discontinuities = 0;
+        qint64 startUs = -1;          // Copied range after keyframe snapping (Range jobs only)
+        qint64 endUs = -1;            // -1 = end of file
+    };
+
+    explicit FFmpegRemuxer(QObject* parent = nullptr);
+    ~FFmpegRemuxer();
+
+    bool running() const { return m_running; }
+    qreal progress() const { return m_progress; }
+
+    // False if a job is already running
+    bool start(const QString& inputPath, const QString& outputPath, const Range& range = Range());
+    void cancel();
+
+    static Result remux(const QString& inputPath, const QString& outputPath,
+                        const std::atomic_bool& cancelled, const std::function<void(qreal)>& reportProgress,
+                        const Range& range = Range());
+
+signals:
+    void runningChanged();
+    void progressChanged();
+    void finished(const FFmpegRemuxer::Result& result);
+
+private:
+    void finishJob(quint64 generation, const Result& result);
+
+    bool m_running = false;
+    qreal m_progress = 0.0;
+    QFuture<void> m_future;
+    std::shared_ptr<std::atomic_bool> m_cancelled;
+    quint64 m_generation = 0;
+};
+
+#endif // FFMPEGREMUXER_H
@@ -56,10 +56,17 @@ bool FFmpegSubtitleExtractor::openFile(const QString &filePath)
     av_dict_set(&opts, "probesize", "32768", 0);  // Minimal probe size
     av_dict_set(&opts, "analyzeduration", "0", 0); // Don't analyze duration (we already know stream index)
     
+    // Subtitle extraction reads through the whole file - serve it from the read-ahead/mapped input
+    if (m_input.open(filePath, FFmpegInputStream::configuredMode(filePath), FFmpegInputStream::configuredReadAheadBytes())) {
+        m_formatContext = avformat_alloc_context();
+        m_input.attach(m_formatContext);
+    }
+    
     int ret = avformat_open_input(&m_formatContext, path, nullptr, &opts);
     av_dict_free(&opts);
     
     if (ret < 0) {
+        m_input.close();
         char errbuf[AV_ERROR_MAX_STRING_SIZE];
         av_strerror(ret, errbuf, AV_ERROR_MAX_STRING_SIZE);
         qWarning() << "[FFmpegSubtitleExtractor] Failed to open file:" << filePath << "Error:" << errbuf;
@@ -91,6 +98,7 @@ void FFmpegSubtitleExtractor::closeFile()
         avformat_close_input(&m_formatContext);
         m_formatContext = nullptr;
     }
+    m_input.close();
     
     m_fileOpen = false;
 }
@@ -113,7 +121,7 @@ int FFmpegSubtitleExtractor::findSubtitleStream(int streamIndex)
     return -1;
 }
 
-qint64 FFmpegSubtitleExtractor::timestampToMs(int64_t pts, const void *timeBasePtr) const
+qint64 FFmpegSubtitleExtractor::timestampToMs(int64_t pts, const void *timeBasePtr)
 {
     const AVRational *timeBase = static_cast<const AVRational*>(timeBasePtr);
     if (!timeBase || timeBase->num == 0 || timeBase->den == 0) {
@@ -128,7 +136,7 @@ qint64 FFmpegSubtitleExtractor::timestampToMs(int64_t pts, const void *timeBaseP
 
 #endif // HAS_FFMPEG_LIBS
 
-QString FFmpegSubtitleExtractor::subtitlePacketToText(const void *subPtr) const
+QString FFmpegSubtitleExtractor::subtitlePacketToText(const void *subPtr)
 {
 #ifdef HAS_FFMPEG_LIBS
     const AVSubtitle *sub = static_cast<const AVSubtitle*>(subPtr);
@@ -498,65 +506,17 @@ bool FFmpegSubtitleExtractor::extractSubtitlesIncremental(const QString &filePat
         return false;
     }
     
-    // Allocate packet and subtitle
     AVPacket *packet = av_packet_alloc();
-    AVSubtitle *subtitle = new AVSubtitle();
-    
     int subtitleCount = 0;
     
     // Read packets and emit each subtitle immediately via callback
     while (av_read_frame(m_formatContext, packet) >= 0) {
         if (packet->stream_index == subtitleStreamIndex) {
-            int got_subtitle = 0;
-            
-            // Decode subtitle packet
-            ret = avcodec_decode_subtitle2(codecContext, subtitle, &got_subtitle, packet);
-            if (ret < 0) {
-                av_packet_unref(packet);
-                continue;
-            }
-            
-            if (got_subtitle) {
+            SubtitleEntry entry;
+            if (decodePacket(codecContext, packet, stream, entry)) {
                 subtitleCount++;
-                SubtitleEntry entry;
-                
-                // For subtitles, use packet PTS as base time
-                int64_t basePts = (packet->pts != AV_NOPTS_VALUE) ? packet->pts : 
-                                  ((subtitle->pts != AV_NOPTS_VALUE) ? subtitle->pts : AV_NOPTS_VALUE);
-                
-                if (basePts != AV_NOPTS_VALUE) {
-                    entry.startTime = timestampToMs(basePts, &stream->time_base);
-                    
-                    if (subtitle->start_display_time != AV_NOPTS_VALUE && subtitle->start_display_time > 0) {
-                        entry.startTime += subtitle->start_display_time;
-                    }
-                    
-                    entry.endTime = entry.startTime;
-                    if (subtitle->end_display_time != AV_NOPTS_VALUE && subtitle->end_display_time > 0) {
-                        entry.endTime += subtitle->end_display_time;
-                    } else {
-                        entry.endTime = entry.startTime + 3000;
-                    }
-                } else {
-                    if (packet->dts != AV_NOPTS_VALUE) {
-                        entry.startTime = timestampToMs(packet->dts, &stream->time_base);
-                        entry.endTime = entry.startTime + 3000;
-                    } else {
-                        avsubtitle_free(subtitle);
-                        av_packet_unref(packet);
-                        continue;
-                    }
-                }
-                
-                // Convert subtitle to text
-                entry.text = subtitlePacketToText(subtitle);
-                
-                if (!entry.text.isEmpty()) {
-                    // Call callback immediately with this subtitle
-                    callback(entry);
-                }
-                
-                avsubtitle_free(subtitle);
+                // Call callback immediately with this subtitle
+                callback(entry);
             }
         }
         
@@ -564,7 +524,6 @@ bool FFmpegSubtitleExtractor::extractSubtitlesIncremental(const QString &filePat
     }
     
     av_packet_free(&packet);
-    delete subtitle;
     avcodec_free_context(&codecContext);
     
     closeFile();
@@ -579,6 +538,49 @@ bool FFmpegSubtitleExtractor::extractSubtitlesIncremental(const QString &filePat
 #endif
 }
 
+#ifdef HAS_FFMPEG_LIBS
+
+bool FFmpegSubtitleExtractor::decodePacket(AVCodecContext *codecContext, AVPacket *packet, const AVStream *stream, SubtitleEntry &entry)
+{
+    if (!codecContext || !packet || !stream) {
+        return false;
+    }
+    
+    AVSubtitle subtitle = {};
+    int got_subtitle = 0;
+    if (avcodec_decode_subtitle2(codecContext, &subtitle, &got_subtitle, packet) < 0 || !got_subtitle) {
+        return false;
+    }
+    
+    // For subtitles, use packet PTS as base time (more reliable than subtitle->pts)
+    int64_t basePts = (packet->pts != AV_NOPTS_VALUE) ? packet->pts : subtitle.pts;
+    
+    if (basePts != AV_NOPTS_VALUE) {
+        entry.startTime = timestampToMs(basePts, &stream->time_base);
+        
+        // start_display_time and end_display_time are in milliseconds, relative to the PTS
+        if (subtitle.start_display_time > 0) {
+            entry.startTime += subtitle.start_display_time;
+        }
+        
+        // Default duration if not specified (3 seconds)
+        entry.endTime = entry.startTime + (subtitle.end_display_time > 0 ? subtitle.end_display_time : 3000);
+    } else if (packet->dts != AV_NOPTS_VALUE) {
+        // Fallback: use packet DTS if PTS is not available
+        entry.startTime = timestampToMs(packet->dts, &stream->time_base);
+        entry.endTime = entry.startTime + 3000;
+    } else {
+        avsubtitle_free(&subtitle);
+        return false;
+    }
+    
+    entry.text = subtitlePacketToText(&subtitle);
+    avsubtitle_free(&subtitle);
+    return !entry.text.isEmpty();
+}
+
+#endif // HAS_FFMPEG_LIBS
+
 bool FFmpegSubtitleExtractor::extractSubtitleInfo(const QString &filePath, QList<QMap<QString, QVariant>> &tracks)
 {
 #ifdef HAS_FFMPEG_LIBS
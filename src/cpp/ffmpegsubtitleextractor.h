@@ -11,11 +11,14 @@
 #include <functional>
 
 #ifdef HAS_FFMPEG_LIBS
+#include "ffmpeginputstream.h"
+
 // Forward declarations to avoid including FFmpeg headers in header file
 struct AVFormatContext;
 struct AVCodecContext;
 struct AVCodec;
 struct AVPacket;
+struct AVStream;
 struct AVSubtitle;
 #endif
 
@@ -55,6 +58,13 @@ public:
     // Extract subtitle info (stream indices, codecs, etc.)
     bool extractSubtitleInfo(const QString &filePath, QList<QMap<QString, QVariant>> &tracks);
     
+#ifdef HAS_FFMPEG_LIBS
+    // Decode one packet of a subtitle stream into an entry (shared with the playback demuxer,
+    // so cues read during playback match the ones a full extraction produces).
+    // Returns false if the packet yields no text.
+    static bool decodePacket(AVCodecContext *codecContext, AVPacket *packet, const AVStream *stream, SubtitleEntry &entry);
+#endif
+    
 private:
 #ifdef HAS_FFMPEG_LIBS
     // Initialize FFmpeg context
@@ -68,12 +78,13 @@ private:
     bool readSubtitlePackets(int streamIndex, QList<SubtitleEntry> &entries);
     
     // Convert FFmpeg timestamp to milliseconds
-    qint64 timestampToMs(int64_t pts, const void *timeBase) const;  // AVRational* but forward declared
+    static qint64 timestampToMs(int64_t pts, const void *timeBase);  // AVRational* but forward declared
     
     // Convert subtitle packet to text
-    QString subtitlePacketToText(const void *sub) const;  // AVSubtitle* but forward declared
+    static QString subtitlePacketToText(const void *sub);  // AVSubtitle* but forward declared
     
     AVFormatContext *m_formatContext;
+    FFmpegInputStream m_input;  // Custom AVIO (read-ahead / mmap) behind m_formatContext
     QMap<int, AVCodecContext*> m_codecContexts;  // stream index -> codec context
     bool m_fileOpen;
 #else
@@ -0,0 +1,454 @@
+#include "ffmpegthumbnailgenerator.h"
+#include "ffmpegtonemapper.h"
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QImage>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QThread>
+#include <QThreadPool>
+#include <QtConcurrent>
+#include <cmath>
+#include <cstring>
+
+extern "C" {
+#include <libavformat/avformat.h>
+#include <libavcodec/avcodec.h>
+#include <libavutil/pixdesc.h>
+#include <libswscale/swscale.h>
+}
+
+// MSVC pragma comment for linking FFmpeg libraries (fallback if CMake doesn't link them)
+#ifdef _MSC_VER
+#pragma comment(lib, "swscale.lib")
+#endif
+
+namespace {
+    constexpr int kCacheVersion = 1;
+    constexpr int kTileWidth = 160;
+    constexpr int kColumns = 16;
+    constexpr int kMaxTiles = 240;                 // Sprite stays ~2560 px wide, a few MB decoded
+    constexpr qint64 kMinIntervalMs = 2000;
+    constexpr int kStartDelayMs = 1500;            // Let playback open and fill its queues first
+    constexpr int kMaxPacketsPerTile = 2000;       // Give up on a tile if no keyframe decodes within this many packets
+    constexpr int kJpegQuality = 80;
+
+    // One worker for every generator in the process - thumbnails never use more than one core
+    QThreadPool* thumbnailPool()
+    {
+        static QThreadPool* pool = [] {
+            auto* p = new QThreadPool();
+            p->setMaxThreadCount(1);
+            p->setExpiryTimeout(10000);
+            return p;
+        }();
+        return pool;
+    }
+
+    int swsColorspace(AVColorSpace colorspace)
+    {
+        switch (colorspace) {
+            case AVCOL_SPC_BT709: return SWS_CS_ITU709;
+            case AVCOL_SPC_BT2020_NCL:
+            case AVCOL_SPC_BT2020_CL: return SWS_CS_BT2020;
+            case AVCOL_SPC_SMPTE240M: return SWS_CS_SMPTE240M;
+            default: return SWS_CS_DEFAULT;
+        }
+    }
+}
+
+FFmpegThumbnailGenerator::FFmpegThumbnailGenerator(QObject* parent)
+    : QObject(parent)
+{
+    m_startTimer.setSingleShot(true);
+    m_startTimer.setInterval(kStartDelayMs);
+    connect(&m_startTimer, &QTimer::timeout, this, &FFmpegThumbnailGenerator::startGeneration);
+}
+
+FFmpegThumbnailGenerator::~FFmpegThumbnailGenerator()
+{
+    cancel();
+}
+
+void FFmpegThumbnailGenerator::cancel()
+{
+    m_startTimer.stop();
+    ++m_generation;
+    if (m_cancelled) {
+        m_cancelled->store(true, std::memory_order_release);
+    }
+    // The job checks the flag between packets, so this returns within one decode
+    m_future.waitForFinished();
+    m_future = QFuture<void>();
+    m_cancelled.reset();
+    setGenerating(false);
+}
+
+void FFmpegThumbnailGenerator::setSource(const QUrl& source)
+{
+    if (m_source == source) {
+        return;
+    }
+    cancel();
+    m_source = source;
+    emit sourceChanged();
+
+    const bool wasReady = m_ready;
+    m_ready = false;
+    m_layout = Layout();
+    m_progress = 0.0;
+    m_filePath.clear();
+    m_spritePath.clear();
+    m_jsonPath.clear();
+    if (wasReady) {
+        emit readyChanged();
+    }
+    emit progressChanged();
+
+    // Local files only - a second full pass over a network stream isn't free
+    const QString filePath = source.isLocalFile() ? source.toLocalFile() : QString();
+    if (filePath.isEmpty() || !QFileInfo(filePath).isFile()) {
+        return;
+    }
+    m_filePath = filePath;
+    const QString base = cacheBasePath(filePath);
+    m_spritePath = base + ".jpg";
+    m_jsonPath = base + ".json";
+
+    // Cached sprite: previews are available immediately
+    Layout layout;
+    if (QFileInfo::exists(m_spritePath) && loadLayout(m_jsonPath, &layout)) {
+        qDebug() << "[FFmpeg] Seek thumbnails loaded from cache:" << layout.count << "tiles";
+        m_layout = layout;
+        m_ready = true;
+        m_progress = 1.0;
+        emit readyChanged();
+        emit progressChanged();
+        return;
+    }
+
+    m_startTimer.start();
+}
+
+void FFmpegThumbnailGenerator::startGeneration()
+{
+    if (m_filePath.isEmpty()) {
+        return;
+    }
+
+    const quint64 generation = ++m_generation;
+    m_cancelled = std::make_shared<std::atomic_bool>(false);
+    setGenerating(true);
+
+    const QString filePath = m_filePath;
+    const QString spritePath = m_spritePath;
+    const QString jsonPath = m_jsonPath;
+    std::shared_ptr<std::atomic_bool> cancelled = m_cancelled;
+
+    m_future = QtConcurrent::run(thumbnailPool(), [this, generation, filePath, spritePath, jsonPath, cancelled]() {
+        QThread::currentThread()->setPriority(QThread::LowestPriority);
+
+        auto reportProgress = [this, generation](qreal progress) {
+            QMetaObject::invokeMethod(this, [this, generation, progress]() {
+                if (generation == m_generation) {
+                    m_progress = progress;
+                    emit progressChanged();
+                }
+            }, Qt::QueuedConnection);
+        };
+
+        Layout layout;
+        const bool success = generate(filePath, spritePath, jsonPath, *cancelled, &layout, reportProgress);
+
+        QMetaObject::invokeMethod(this, [this, generation, success, layout]() {
+            finishGeneration(generation, success, layout);
+        }, Qt::QueuedConnection);
+    });
+}
+
+void FFmpegThumbnailGenerator::finishGeneration(quint64 generation, bool success, const Layout& layout)
+{
+    if (generation != m_generation) {
+        return;  // Superseded by a newer source
+    }
+    setGenerating(false);
+    if (!success) {
+        return;
+    }
+    m_layout = layout;
+    m_ready = true;
+    m_progress = 1.0;
+    emit readyChanged();
+    emit progressChanged();
+}
+
+void FFmpegThumbnailGenerator::setGenerating(bool generating)
+{
+    if (m_generating == generating) {
+        return;
+    }
+    m_generating = generating;
+    emit generatingChanged();
+}
+
+QRect FFmpegThumbnailGenerator::tileRect(qint64 positionMs) const
+{
+    if (!m_ready || m_layout.count <= 0 || m_layout.intervalMs <= 0 || m_layout.columns <= 0) {
+        return QRect();
+    }
+    const int index = int(qBound<qint64>(0, positionMs / m_layout.intervalMs, m_layout.count - 1));
+    return QRect((index % m_layout.columns) * m_layout.tileWidth,
+                 (index / m_layout.columns) * m_layout.tileHeight,
+                 m_layout.tileWidth, m_layout.tileHeight);
+}
+
+QString FFmpegThumbnailGenerator::cacheBasePath(const QString& filePath)
+{
+    QString cacheDir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+    cacheDir += "/seek_thumbnails";
+
+    // Size + mtime in the key so a replaced file never reuses stale thumbnails
+    const QFileInfo info(filePath);
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    hash.addData(info.absoluteFilePath().toUtf8());
+    hash.addData(QByteArray::number(info.size()));
+    hash.addData(QByteArray::number(info.lastModified().toMSecsSinceEpoch()));
+    const QString hashStr = hash.result().toHex().left(16);
+
+    return cacheDir + "/" + QString("%1_%2").arg(hashStr).arg(kTileWidth);
+}
+
+bool FFmpegThumbnailGenerator::loadLayout(const QString& jsonPath, Layout* layout)
+{
+    QFile file(jsonPath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    const QJsonObject obj = QJsonDocument::fromJson(file.readAll()).object();
+    if (obj.value("version").toInt() != kCacheVersion) {
+        return false;
+    }
+    layout->intervalMs = obj.value("intervalMs").toInt();
+    layout->count = obj.value("count").toInt();
+    layout->columns = obj.value("columns").toInt();
+    layout->tileWidth = obj.value("tileWidth").toInt();
+    layout->tileHeight = obj.value("tileHeight").toInt();
+    return layout->intervalMs > 0 && layout->count > 0 && layout->columns > 0 &&
+           layout->tileWidth > 0 && layout->tileHeight > 0;
+}
+
+bool FFmpegThumbnailGenerator::generate(const QString& filePath, const QString& spritePath, const QString& jsonPath,
+                                        const std::atomic_bool& cancelled, Layout* layout,
+                                        const std::function<void(qreal)>& reportProgress)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    AVFormatContext* fmt = nullptr;
+    if (avformat_open_input(&fmt, filePath.toUtf8().constData(), nullptr, nullptr) < 0) {
+        qWarning() << "[FFmpeg] Thumbnails: failed to open" << filePath;
+        return false;
+    }
+    if (avformat_find_stream_info(fmt, nullptr) < 0) {
+        avformat_close_input(&fmt);
+        return false;
+    }
+
+    const AVCodec* codec = nullptr;
+    const int streamIndex = av_find_best_stream(fmt, AVMEDIA_TYPE_VIDEO, -1, -1, &codec, 0);
+    if (streamIndex < 0 || !codec) {
+        avformat_close_input(&fmt);
+        return false;
+    }
+    AVStream* stream = fmt->streams[streamIndex];
+    if (stream->disposition & AV_DISPOSITION_ATTACHED_PIC) {
+        avformat_close_input(&fmt);  // Cover art only - nothing to preview
+        return false;
+    }
+    for (unsigned int i = 0; i < fmt->nb_streams; ++i) {
+        fmt->streams[i]->discard = int(i) == streamIndex ? AVDISCARD_DEFAULT : AVDISCARD_ALL;
+    }
+
+    const qint64 durationMs = fmt->duration > 0 ? fmt->duration / (AV_TIME_BASE / 1000)
+        : (stream->duration > 0 ? av_rescale_q(stream->duration, stream->time_base, AVRational{1, 1000}) : 0);
+    const int srcWidth = stream->codecpar->width;
+    const int srcHeight = stream->codecpar->height;
+    if (durationMs <= 0 || srcWidth <= 0 || srcHeight <= 0) {
+        avformat_close_input(&fmt);
+        return false;
+    }
+
+    AVCodecContext* dec = avcodec_alloc_context3(codec);
+    if (!dec || avcodec_parameters_to_context(dec, stream->codecpar) < 0) {
+        avcodec_free_context(&dec);
+        avformat_close_input(&fmt);
+        return false;
+    }
+    dec->thread_count = 1;                     // One core, no frame-thread delay
+    dec->skip_loop_filter = AVDISCARD_ALL;     // Deblocking is invisible at 160 px
+    dec->skip_frame = AVDISCARD_NONKEY;
+    dec->pkt_timebase = stream->time_base;
+    // Decode at reduced resolution where the decoder supports it (MPEG-2/4, MJPEG, ...)
+    int lowres = 0;
+    while (lowres < codec->max_lowres && (srcWidth >> (lowres + 1)) >= kTileWidth) {
+        ++lowres;
+    }
+    dec->lowres = lowres;
+    if (avcodec_open2(dec, codec, nullptr) < 0) {
+        qWarning() << "[FFmpeg] Thumbnails: failed to open decoder" << codec->name;
+        avcodec_free_context(&dec);
+        avformat_close_input(&fmt);
+        return false;
+    }
+
+    // Layout: one tile every intervalMs, at most kMaxTiles
+    const double sar = stream->codecpar->sample_aspect_ratio.num > 0 && stream->codecpar->sample_aspect_ratio.den > 0
+        ? av_q2d(stream->codecpar->sample_aspect_ratio) : 1.0;
+    Layout out;
+    out.intervalMs = int(qMax<qint64>(kMinIntervalMs, (durationMs + kMaxTiles - 1) / kMaxTiles));
+    out.count = int(qMax<qint64>(1, (durationMs + out.intervalMs - 1) / out.intervalMs));
+    out.columns = qMin(kColumns, out.count);
+    out.tileWidth = kTileWidth;
+    out.tileHeight = qBound(2, int(std::lround(kTileWidth * srcHeight / (srcWidth * sar) / 2.0)) * 2, kTileWidth * 2);
+
+    const int rows = (out.count + out.columns - 1) / out.columns;
+    QImage sprite(out.columns * out.tileWidth, rows * out.tileHeight, QImage::Format_RGB32);
+    sprite.fill(Qt::black);
+
+    const qint64 startPts = stream->start_time != AV_NOPTS_VALUE ? stream->start_time : 0;
+    std::unique_ptr<FFmpegToneMapper> toneMapper;
+    AVFrame* frame = av_frame_alloc();
+    AVFrame* mapped = av_frame_alloc();
+    AVPacket* packet = av_packet_alloc();
+    SwsContext* sws = nullptr;
+    qint64 lastKeyPts = AV_NOPTS_VALUE;
+    int decodedTiles = 0;
+    int reusedTiles = 0;
+    int lastReported = -1;
+
+    for (int tile = 0; tile < out.count && !cancelled.load(std::memory_order_acquire); ++tile) {
+        const QRect dst((tile % out.columns) * out.tileWidth, (tile / out.columns) * out.tileHeight,
+                        out.tileWidth, out.tileHeight);
+        const qint64 target = startPts + av_rescale_q(qint64(tile) * out.intervalMs, AVRational{1, 1000}, stream->time_base);
+        if (av_seek_frame(fmt, streamIndex, target, AVSEEK_FLAG_BACKWARD) < 0) {
+            continue;
+        }
+        avcodec_flush_buffers(dec);
+
+        bool gotFrame = false;
+        bool reused = false;
+        for (int packets = 0; !gotFrame && packets < kMaxPacketsPerTile && !cancelled.load(std::memory_order_acquire); ++packets) {
+            if (av_read_frame(fmt, packet) < 0) {
+                avcodec_send_packet(dec, nullptr);  // Drain whatever the decoder still holds
+                gotFrame = avcodec_receive_frame(dec, frame) == 0;
+                break;
+            }
+            if (packet->stream_index != streamIndex || !(packet->flags & AV_PKT_FLAG_KEY)) {
+                av_packet_unref(packet);
+                continue;
+            }
+            // Sparse GOPs: several tiles land on the same keyframe - copy instead of decoding it again
+            const qint64 keyPts = packet->pts != AV_NOPTS_VALUE ? packet->pts : packet->dts;
+            if (tile > 0 && keyPts != AV_NOPTS_VALUE && keyPts == lastKeyPts) {
+                av_packet_unref(packet);
+                reused = true;
+                break;
+            }
+            lastKeyPts = keyPts;
+            const int sent = avcodec_send_packet(dec, packet);
+            av_packet_unref(packet);
+            if (sent < 0 && sent != AVERROR(EAGAIN)) {
+                continue;
+            }
+            gotFrame = avcodec_receive_frame(dec, frame) == 0;
+        }
+
+        if (reused) {
+            const int prev = tile - 1;
+            const int prevX = (prev % out.columns) * out.tileWidth;
+            const int prevY = (prev / out.columns) * out.tileHeight;
+            for (int y = 0; y < out.tileHeight; ++y) {
+                std::memcpy(sprite.scanLine(dst.y() + y) + dst.x() * 4,
+                            sprite.constScanLine(prevY + y) + prevX * 4, size_t(out.tileWidth) * 4);
+            }
+            ++reusedTiles;
+        } else if (gotFrame) {
+            const AVFrame* src = frame;
+            // HDR keyframes would look washed out through swscale - tone map them first (single-threaded)
+            if (FFmpegToneMapper::canProcess(frame->format) && FFmpegToneMapper::isHdrTransfer(frame)) {
+                if (!toneMapper) {
+                    toneMapper = std::make_unique<FFmpegToneMapper>(1);
+                }
+                if (toneMapper->process(frame, mapped)) {
+                    src = mapped;
+                }
+            }
+
+            sws = sws_getCachedContext(sws, src->width, src->height, AVPixelFormat(src->format),
+                                       out.tileWidth, out.tileHeight, AV_PIX_FMT_BGRA,
+                                       SWS_AREA, nullptr, nullptr, nullptr);
+            if (sws) {
+                const bool fullRange = src->color_range == AVCOL_RANGE_JPEG;
+                const int* coefficients = sws_getCoefficients(swsColorspace(src->colorspace));
+                sws_setColorspaceDetails(sws, coefficients, fullRange ? 1 : 0,
+                                         sws_getCoefficients(SWS_CS_DEFAULT), 1, 0, 1 << 16, 1 << 16);
+                uint8_t* dstData[4] = { sprite.scanLine(dst.y()) + dst.x() * 4, nullptr, nullptr, nullptr };
+                int dstLinesize[4] = { int(sprite.bytesPerLine()), 0, 0, 0 };
+                sws_scale(sws, src->data, src->linesize, 0, src->height, dstData, dstLinesize);
+                ++decodedTiles;
+            }
+            av_frame_unref(mapped);
+            av_frame_unref(frame);
+        }
+
+        const int percent = (tile + 1) * 100 / out.count;
+        if (percent != lastReported) {
+            lastReported = percent;
+            reportProgress(qreal(tile + 1) / out.count);
+        }
+    }
+
+    sws_freeContext(sws);
+    av_packet_free(&packet);
+    av_frame_free(&mapped);
+    av_frame_free(&frame);
+    avcodec_free_context(&dec);
+    avformat_close_input(&fmt);
+    toneMapper.reset();
+
+    if (cancelled.load(std::memory_order_acquire) || decodedTiles == 0) {
+        return false;
+    }
+
+    // Sprite first, layout last: a readable layout file means a complete sprite
+    QDir().mkpath(QFileInfo(spritePath).absolutePath());
+    if (!sprite.save(spritePath, "JPG", kJpegQuality)) {
+        qWarning() << "[FFmpeg] Failed to write seek thumbnail sprite:" << spritePath;
+        return false;
+    }
+    QJsonObject obj;
+    obj.insert("version", kCacheVersion);
+    obj.insert("intervalMs", out.intervalMs);
+    obj.insert("count", out.count);
+    obj.insert("columns", out.columns);
+    obj.insert("tileWidth", out.tileWidth);
+    obj.insert("tileHeight", out.tileHeight);
+    QSaveFile json(jsonPath);
+    if (!json.open(QIODevice::WriteOnly) || json.write(QJsonDocument(obj).toJson(QJsonDocument::Compact)) < 0 || !json.commit()) {
+        qWarning() << "[FFmpeg] Failed to write seek thumbnail layout:" << jsonPath;
+        return false;
+    }
+
+    qDebug() << "[FFmpeg] Seek thumbnails generated:" << out.count << "tiles every" << out.intervalMs << "ms"
+             << "(" << decodedTiles << "decoded," << reusedTiles << "reused, lowres" << lowres << ") in"
+             << timer.elapsed() << "ms";
+    *layout = out;
+    return true;
+}
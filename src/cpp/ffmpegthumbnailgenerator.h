@@ -0,0 +1,100 @@
+#ifndef FFMPEGTHUMBNAILGENERATOR_H
+#define FFMPEGTHUMBNAILGENERATOR_H
+
+#include <QObject>
+#include <QFuture>
+#include <QRect>
+#include <QString>
+#include <QTimer>
+#include <QUrl>
+#include <atomic>
+#include <functional>
+#include <memory>
+
+/**
+ * Seek-bar preview thumbnails as a single sprite sheet
+ *
+ * For a local video, a background job opens its own demuxer and decodes one keyframe
+ * every intervalMs (skip_loop_filter, non-key frames skipped, lowres where the decoder
+ * supports it), scales each to tileWidth px and packs them row-major into a JPEG sprite.
+ * The sprite and its layout are cached under CacheLocation/seek_thumbnails, keyed by
+ * path + size + mtime, so reopening a file makes previews available immediately.
+ *
+ * All generators share one single-threaded low-priority pool and decode single-threaded:
+ * thumbnailing never takes more than one core away from the playback decoder.
+ * QML shows a tile by offsetting an Image of spriteUrl by tileRect(position).
+ */
+class FFmpegThumbnailGenerator : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(QUrl source READ source WRITE setSource NOTIFY sourceChanged)
+    Q_PROPERTY(bool ready READ ready NOTIFY readyChanged)
+    Q_PROPERTY(bool generating READ generating NOTIFY generatingChanged)
+    Q_PROPERTY(qreal progress READ progress NOTIFY progressChanged)
+    Q_PROPERTY(QUrl spriteUrl READ spriteUrl NOTIFY readyChanged)
+    Q_PROPERTY(int tileWidth READ tileWidth NOTIFY readyChanged)
+    Q_PROPERTY(int tileHeight READ tileHeight NOTIFY readyChanged)
+    Q_PROPERTY(int count READ count NOTIFY readyChanged)
+    Q_PROPERTY(int intervalMs READ intervalMs NOTIFY readyChanged)
+
+public:
+    struct Layout {
+        int intervalMs = 0;
+        int count = 0;
+        int columns = 0;
+        int tileWidth = 0;
+        int tileHeight = 0;
+    };
+
+    explicit FFmpegThumbnailGenerator(QObject* parent = nullptr);
+    ~FFmpegThumbnailGenerator();
+
+    QUrl source() const { return m_source; }
+    void setSource(const QUrl& source);
+
+    bool ready() const { return m_ready; }
+    bool generating() const { return m_generating; }
+    qreal progress() const { return m_progress; }
+    QUrl spriteUrl() const { return m_ready ? QUrl::fromLocalFile(m_spritePath) : QUrl(); }
+    int tileWidth() const { return m_layout.tileWidth; }
+    int tileHeight() const { return m_layout.tileHeight; }
+    int count() const { return m_layout.count; }
+    int intervalMs() const { return m_layout.intervalMs; }
+
+    // Sprite rectangle of the tile covering positionMs (empty until ready)
+    Q_INVOKABLE QRect tileRect(qint64 positionMs) const;
+
+signals:
+    void sourceChanged();
+    void readyChanged();
+    void generatingChanged();
+    void progressChanged();
+
+private:
+    void cancel();
+    void startGeneration();
+    void setGenerating(bool generating);
+    void finishGeneration(quint64 generation, bool success, const Layout& layout);
+
+    static QString cacheBasePath(const QString& filePath);
+    static bool loadLayout(const QString& jsonPath, Layout* layout);
+    static bool generate(const QString& filePath, const QString& spritePath, const QString& jsonPath,
+                         const std::atomic_bool& cancelled, Layout* layout,
+                         const std::function<void(qreal)>& reportProgress);
+
+    QUrl m_source;
+    QString m_filePath;
+    QString m_spritePath;
+    QString m_jsonPath;
+    Layout m_layout;
+    bool m_ready = false;
+    bool m_generating = false;
+    qreal m_progress = 0.0;
+
+    QTimer m_startTimer;                 // Defers generation so it doesn't contend with opening the file for playback
+    QFuture<void> m_future;
+    std::shared_ptr<std::atomic_bool> m_cancelled;
+    quint64 m_generation = 0;            // Results of superseded jobs are ignored
+};
+
+#endif // FFMPEGTHUMBNAILGENERATOR_H
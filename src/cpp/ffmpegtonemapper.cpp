@@ -0,0 +1,452 @@
+#include "ffmpegtonemapper.h"
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QtConcurrent>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+extern "C" {
+#include <libavutil/frame.h>
+#include <libavutil/pixfmt.h>
+#include <libavutil/mastering_display_metadata.h>
+}
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define FFMPEG_TONEMAP_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace {
+    constexpr int kLutSize = 4096;
+    constexpr float kLutMax = float(kLutSize - 1);
+    constexpr double kDefaultPeakNits = 1000.0;
+    constexpr int kMinBlockRowsPerSlice = 16;
+
+    // ST 2084 (PQ) constants
+    constexpr double kPqM1 = 0.1593017578125;
+    constexpr double kPqM2 = 78.84375;
+    constexpr double kPqC1 = 0.8359375;
+    constexpr double kPqC2 = 18.8515625;
+    constexpr double kPqC3 = 18.6875;
+
+    // ARIB STD-B67 (HLG) constants, OOTF for the BT.2100 reference display
+    constexpr double kHlgA = 0.17883277;
+    constexpr double kHlgB = 0.28466892;
+    constexpr double kHlgC = 0.55991073;
+    constexpr double kHlgDisplayPeakNits = 1000.0;
+    constexpr double kHlgSystemGamma = 1.2;  // BT.2100 gamma at 1000 nits
+
+    // BT.2020 non-constant luminance Y'CbCr → R'G'B'
+    constexpr float kCrToR = 1.4746f;
+    constexpr float kCbToG = 0.16455f;
+    constexpr float kCrToG = 0.57135f;
+    constexpr float kCbToB = 1.8814f;
+
+    // Linear BT.2020 → BT.709 primaries
+    constexpr float kGamut[3][3] = {
+        {  1.6605f, -0.5876f, -0.0728f },
+        { -0.1246f,  1.1329f, -0.0083f },
+        { -0.0182f, -0.1006f,  1.1187f }
+    };
+
+    // BT.709 R'G'B' → Y'CbCr
+    constexpr float kKr = 0.2126f;
+    constexpr float kKg = 0.7152f;
+    constexpr float kKb = 0.0722f;
+    constexpr float kCbScale = 1.0f / 1.8556f;
+    constexpr float kCrScale = 1.0f / 1.5748f;
+
+    // Hable (Uncharted 2) filmic curve, same constants as vf_tonemap
+    double hable(double x)
+    {
+        const double a = 0.15, b = 0.50, c = 0.10, d = 0.20, e = 0.02, f = 0.30;
+        return (x * (a * x + c * b) + d * e) / (x * (a * x + b) + d * f) - e / f;
+    }
+
+    inline uint8_t clampToByte(float value)
+    {
+        const int v = int(value + 0.5f);
+        return uint8_t(v < 0 ? 0 : (v > 255 ? 255 : v));
+    }
+
+    inline float lookup(const float* lut, float v)
+    {
+        v = v < 0.0f ? 0.0f : (v > 1.0f ? 1.0f : v);
+        return lut[int(v * kLutMax + 0.5f)];
+    }
+}
+
+struct FFmpegToneMapper::Luts
+{
+    alignas(64) float eotf[kLutSize];       // PQ code value [0,1] → linear light (1.0 = 100 nits SDR white)
+    alignas(64) float hlgEotf[kLutSize];    // HLG code value [0,1] → display light (inverse OETF + OOTF), same units
+    alignas(64) float toneScale[kLutSize];  // sqrt(sig / peak) → tone-mapped sig / sig
+    alignas(64) float oetf[kLutSize];       // sqrt(linear) → BT.709 code value [0,1]
+    float invPeak = 0.1f;                   // 1 / peak (in units of 100 nits)
+};
+
+namespace {
+
+struct PlaneSet {
+    const uint8_t* y = nullptr;
+    const uint8_t* u = nullptr;   // P010: interleaved UV
+    const uint8_t* v = nullptr;   // YUV420P10 only
+    int yStride = 0;
+    int uStride = 0;
+    int vStride = 0;
+    bool p010 = false;
+    const float* eotf = nullptr;  // Luts::eotf (PQ) or Luts::hlgEotf, from the frame's transfer
+    // 10-bit code → Y' [0,1] / Cb,Cr [-0.5,0.5], from the frame's color_range (limited by default)
+    float yOffset = 64.0f;
+    float yScale = 1.0f / 876.0f;
+    float cScale = 1.0f / 896.0f;
+    uint8_t* outY = nullptr;
+    uint8_t* outUV = nullptr;
+    int outYStride = 0;
+    int outUVStride = 0;
+    int width = 0;
+    int height = 0;
+};
+
+#ifdef FFMPEG_TONEMAP_SSE2
+inline __m128 lookup4(const float* lut, __m128 v)
+{
+    v = _mm_min_ps(_mm_max_ps(v, _mm_setzero_ps()), _mm_set1_ps(1.0f));
+    alignas(16) int idx[4];
+    _mm_store_si128(reinterpret_cast<__m128i*>(idx), _mm_cvtps_epi32(_mm_mul_ps(v, _mm_set1_ps(kLutMax))));
+    return _mm_setr_ps(lut[idx[0]], lut[idx[1]], lut[idx[2]], lut[idx[3]]);
+}
+
+// One 2x2 block: the four luma samples are the four SSE lanes, chroma is shared
+inline void mapBlock(const FFmpegToneMapper::Luts& luts, const PlaneSet& p, const int luma[4], int cbCode, int crCode,
+                     uint8_t outLuma[4], uint8_t& outCb, uint8_t& outCr)
+{
+    const float* eotf = p.eotf;
+    const float cb = float(cbCode - 512) * p.cScale;
+    const float cr = float(crCode - 512) * p.cScale;
+
+    const __m128 y = _mm_mul_ps(_mm_sub_ps(_mm_cvtepi32_ps(_mm_setr_epi32(luma[0], luma[1], luma[2], luma[3])),
+                                           _mm_set1_ps(p.yOffset)),
+                                _mm_set1_ps(p.yScale));
+
+    // PQ/HLG R'G'B' → linear BT.2020
+    const __m128 r = lookup4(eotf, _mm_add_ps(y, _mm_set1_ps(kCrToR * cr)));
+    const __m128 g = lookup4(eotf, _mm_sub_ps(y, _mm_set1_ps(kCbToG * cb + kCrToG * cr)));
+    const __m128 b = lookup4(eotf, _mm_add_ps(y, _mm_set1_ps(kCbToB * cb)));
+
+    // Gamut BT.2020 → BT.709 (out-of-gamut negatives clipped)
+    const __m128 zero = _mm_setzero_ps();
+    __m128 r2 = _mm_max_ps(zero, _mm_add_ps(_mm_add_ps(_mm_mul_ps(r, _mm_set1_ps(kGamut[0][0])),
+                                                       _mm_mul_ps(g, _mm_set1_ps(kGamut[0][1]))),
+                                            _mm_mul_ps(b, _mm_set1_ps(kGamut[0][2]))));
+    __m128 g2 = _mm_max_ps(zero, _mm_add_ps(_mm_add_ps(_mm_mul_ps(r, _mm_set1_ps(kGamut[1][0])),
+                                                       _mm_mul_ps(g, _mm_set1_ps(kGamut[1][1]))),
+                                            _mm_mul_ps(b, _mm_set1_ps(kGamut[1][2]))));
+    __m128 b2 = _mm_max_ps(zero, _mm_add_ps(_mm_add_ps(_mm_mul_ps(r, _mm_set1_ps(kGamut[2][0])),
+                                                       _mm_mul_ps(g, _mm_set1_ps(kGamut[2][1]))),
+                                            _mm_mul_ps(b, _mm_set1_ps(kGamut[2][2]))));
+
+    // Tone curve on max(R,G,B), applied as a common scale (preserves hue)
+    const __m128 sig = _mm_max_ps(_mm_max_ps(r2, g2), b2);
+    const __m128 scale = lookup4(luts.toneScale, _mm_sqrt_ps(_mm_mul_ps(sig, _mm_set1_ps(luts.invPeak))));
+    r2 = _mm_mul_ps(r2, scale);
+    g2 = _mm_mul_ps(g2, scale);
+    b2 = _mm_mul_ps(b2, scale);
+
+    // BT.709 OETF
+    const __m128 ro = lookup4(luts.oetf, _mm_sqrt_ps(r2));
+    const __m128 go = lookup4(luts.oetf, _mm_sqrt_ps(g2));
+    const __m128 bo = lookup4(luts.oetf, _mm_sqrt_ps(b2));
+
+    // Luma per pixel (limited range)
+    const __m128 yo = _mm_add_ps(_mm_add_ps(_mm_mul_ps(ro, _mm_set1_ps(kKr)), _mm_mul_ps(go, _mm_set1_ps(kKg))),
+                                 _mm_mul_ps(bo, _mm_set1_ps(kKb)));
+    alignas(16) int yi[4];
+    _mm_store_si128(reinterpret_cast<__m128i*>(yi),
+                    _mm_cvtps_epi32(_mm_add_ps(_mm_set1_ps(16.0f), _mm_mul_ps(yo, _mm_set1_ps(219.0f)))));
+    for (int i = 0; i < 4; ++i) {
+        outLuma[i] = uint8_t(yi[i]);
+    }
+
+    // Chroma from the block average
+    alignas(16) float rs[4], gs[4], bs[4];
+    _mm_store_ps(rs, ro);
+    _mm_store_ps(gs, go);
+    _mm_store_ps(bs, bo);
+    const float ra = (rs[0] + rs[1] + rs[2] + rs[3]) * 0.25f;
+    const float ga = (gs[0] + gs[1] + gs[2] + gs[3]) * 0.25f;
+    const float ba = (bs[0] + bs[1] + bs[2] + bs[3]) * 0.25f;
+    const float ya = kKr * ra + kKg * ga + kKb * ba;
+    outCb = clampToByte(128.0f + 224.0f * (ba - ya) * kCbScale);
+    outCr = clampToByte(128.0f + 224.0f * (ra - ya) * kCrScale);
+}
+#else
+inline void mapBlock(const FFmpegToneMapper::Luts& luts, const PlaneSet& p, const int luma[4], int cbCode, int crCode,
+                     uint8_t outLuma[4], uint8_t& outCb, uint8_t& outCr)
+{
+    const float* eotf = p.eotf;
+    const float cb = float(cbCode - 512) * p.cScale;
+    const float cr = float(crCode - 512) * p.cScale;
+
+    float ra = 0.0f, ga = 0.0f, ba = 0.0f;
+    for (int i = 0; i < 4; ++i) {
+        const float y = (float(luma[i]) - p.yOffset) * p.yScale;
+        const float r = lookup(eotf, y + kCrToR * cr);
+        const float g = lookup(eotf, y - kCbToG * cb - kCrToG * cr);
+        const float b = lookup(eotf, y + kCbToB * cb);
+
+        float r2 = std::max(0.0f, kGamut[0][0] * r + kGamut[0][1] * g + kGamut[0][2] * b);
+        float g2 = std::max(0.0f, kGamut[1][0] * r + kGamut[1][1] * g + kGamut[1][2] * b);
+        float b2 = std::max(0.0f, kGamut[2][0] * r + kGamut[2][1] * g + kGamut[2][2] * b);
+
+        const float sig = std::max(std::max(r2, g2), b2);
+        const float scale = lookup(luts.toneScale, std::sqrt(sig * luts.invPeak));
+        r2 *= scale;
+        g2 *= scale;
+        b2 *= scale;
+
+        const float ro = lookup(luts.oetf, std::sqrt(r2));
+        const float go = lookup(luts.oetf, std::sqrt(g2));
+        const float bo = lookup(luts.oetf, std::sqrt(b2));
+        outLuma[i] = clampToByte(16.0f + 219.0f * (kKr * ro + kKg * go + kKb * bo));
+        ra += ro;
+        ga += go;
+        ba += bo;
+    }
+
+    ra *= 0.25f;
+    ga *= 0.25f;
+    ba *= 0.25f;
+    const float ya = kKr * ra + kKg * ga + kKb * ba;
+    outCb = clampToByte(128.0f + 224.0f * (ba - ya) * kCbScale);
+    outCr = clampToByte(128.0f + 224.0f * (ra - ya) * kCrScale);
+}
+#endif
+
+// Block rows [begin, end) - each block row is two luma rows and one chroma row
+void mapBlockRows(const FFmpegToneMapper::Luts& luts, const PlaneSet& p, int begin, int end)
+{
+    const int blocksPerRow = (p.width + 1) / 2;
+    for (int by = begin; by < end; ++by) {
+        const int y0 = by * 2;
+        const int y1 = std::min(y0 + 1, p.height - 1);
+        const uint16_t* row0 = reinterpret_cast<const uint16_t*>(p.y + ptrdiff_t(y0) * p.yStride);
+        const uint16_t* row1 = reinterpret_cast<const uint16_t*>(p.y + ptrdiff_t(y1) * p.yStride);
+        const uint16_t* uRow = reinterpret_cast<const uint16_t*>(p.u + ptrdiff_t(by) * p.uStride);
+        const uint16_t* vRow = p.p010 ? nullptr : reinterpret_cast<const uint16_t*>(p.v + ptrdiff_t(by) * p.vStride);
+        uint8_t* out0 = p.outY + ptrdiff_t(y0) * p.outYStride;
+        uint8_t* out1 = p.outY + ptrdiff_t(y1) * p.outYStride;
+        uint8_t* outUV = p.outUV + ptrdiff_t(by) * p.outUVStride;
+        const bool hasRow1 = y1 != y0;
+
+        for (int bx = 0; bx < blocksPerRow; ++bx) {
+            const int x0 = bx * 2;
+            const int x1 = std::min(x0 + 1, p.width - 1);
+
+            int luma[4];
+            int cb, cr;
+            if (p.p010) {
+                // P010: 10 significant bits in the high bits of each 16-bit word
+                luma[0] = row0[x0] >> 6;
+                luma[1] = row0[x1] >> 6;
+                luma[2] = row1[x0] >> 6;
+                luma[3] = row1[x1] >> 6;
+                cb = uRow[x0] >> 6;
+                cr = uRow[x0 + 1] >> 6;
+            } else {
+                luma[0] = row0[x0] & 0x3FF;
+                luma[1] = row0[x1] & 0x3FF;
+                luma[2] = row1[x0] & 0x3FF;
+                luma[3] = row1[x1] & 0x3FF;
+                cb = uRow[bx] & 0x3FF;
+                cr = vRow[bx] & 0x3FF;
+            }
+
+            uint8_t outLuma[4];
+            mapBlock(luts, p, luma, cb, cr, outLuma, outUV[x0], outUV[x0 + 1]);
+            out0[x0] = outLuma[0];
+            out0[x1] = x1 != x0 ? outLuma[1] : out0[x0];
+            if (hasRow1) {
+                out1[x0] = outLuma[2];
+                out1[x1] = x1 != x0 ? outLuma[3] : out1[x0];
+            }
+        }
+    }
+}
+
+} // namespace
+
+FFmpegToneMapper::FFmpegToneMapper(int maxThreads)
+    : m_luts(std::make_unique<Luts>())
+{
+    // PQ EOTF, normalized so 1.0 = 100 nits (SDR reference white)
+    for (int i = 0; i < kLutSize; ++i) {
+        const double e = double(i) / kLutMax;
+        const double ep = std::pow(e, 1.0 / kPqM2);
+        const double num = std::max(ep - kPqC1, 0.0);
+        const double den = kPqC2 - kPqC3 * ep;
+        m_luts->eotf[i] = float(std::pow(num / den, 1.0 / kPqM1) * 100.0);
+    }
+
+    // HLG inverse OETF → scene light [0,1], then the OOTF for a 1000 nit display, same normalization.
+    // The OOTF is applied per channel (E^gamma) instead of on scene luminance - the LUTs are per channel.
+    for (int i = 0; i < kLutSize; ++i) {
+        const double e = double(i) / kLutMax;
+        const double scene = e <= 0.5 ? e * e / 3.0 : (std::exp((e - kHlgC) / kHlgA) + kHlgB) / 12.0;
+        m_luts->hlgEotf[i] = float(std::pow(scene, kHlgSystemGamma) * kHlgDisplayPeakNits / 100.0);
+    }
+
+    // BT.709 OETF, indexed by sqrt(linear) for precision near black
+    for (int i = 0; i < kLutSize; ++i) {
+        const double t = double(i) / kLutMax;
+        const double v = t * t;
+        m_luts->oetf[i] = float(v < 0.018 ? 4.5 * v : 1.099 * std::pow(v, 0.45) - 0.099);
+    }
+
+    setPeakLuminance(kDefaultPeakNits);
+
+    m_threadPool.setMaxThreadCount(qMax(1, maxThreads > 0 ? maxThreads : QThread::idealThreadCount()));
+    m_outputPool.setCapacity(8);  // Display queue + GUI handoff + frame on screen
+}
+
+FFmpegToneMapper::~FFmpegToneMapper()
+{
+    m_threadPool.waitForDone();
+}
+
+bool FFmpegToneMapper::canProcess(int pixelFormat)
+{
+    return pixelFormat == AV_PIX_FMT_P010LE || pixelFormat == AV_PIX_FMT_YUV420P10LE;
+}
+
+bool FFmpegToneMapper::isHdrTransfer(const AVFrame* frame)
+{
+    if (frame->color_trc == AVCOL_TRC_SMPTE2084 || frame->color_trc == AVCOL_TRC_ARIB_STD_B67) {
+        return true;
+    }
+    // Some HDR10 streams don't signal the transfer - BT.2020 primaries are the giveaway
+    return frame->color_trc == AVCOL_TRC_UNSPECIFIED && frame->color_primaries == AVCOL_PRI_BT2020;
+}
+
+void FFmpegToneMapper::setPeakLuminance(double nits)
+{
+    nits = qBound(100.0, nits, 10000.0);
+    if (qFuzzyCompare(nits, m_peakNits)) {
+        return;
+    }
+    m_peakNits = nits;
+    buildToneLut();
+    qDebug() << "[FFmpeg] Tone mapper peak luminance:" << nits << "nits";
+}
+
+void FFmpegToneMapper::buildToneLut()
+{
+    const double peak = m_peakNits / 100.0;  // In units of SDR white
+    const double norm = hable(peak);
+    m_luts->invPeak = float(1.0 / peak);
+
+    for (int i = 0; i < kLutSize; ++i) {
+        // Entry i covers sig = (i / max)^2 * peak; entry 0 uses the curve's slope near black
+        const double t = i > 0 ? double(i) / kLutMax : 0.5 / kLutMax;
+        const double sig = t * t * peak;
+        m_luts->toneScale[i] = float(hable(sig) / norm / sig);
+    }
+}
+
+int FFmpegToneMapper::threadCount() const
+{
+    return m_threadPool.maxThreadCount();
+}
+
+bool FFmpegToneMapper::process(const AVFrame* in, AVFrame* out)
+{
+    if (!in || !out || !canProcess(in->format) || in->width <= 0 || in->height <= 0) {
+        return false;
+    }
+    const bool p010 = in->format == AV_PIX_FMT_P010LE;
+    if (!in->data[0] || !in->data[1] || (!p010 && !in->data[2])) {
+        return false;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    // Source peak: HLG is display-referred to the 1000 nit reference display; HDR10 static metadata
+    // otherwise (MaxCLL preferred, mastering display max as fallback). Encoders that don't measure
+    // the content write MaxCLL = 0 ("unknown") - that must not hide the mastering display peak.
+    const bool hlg = in->color_trc == AVCOL_TRC_ARIB_STD_B67;
+    if (hlg) {
+        setPeakLuminance(kHlgDisplayPeakNits);
+    } else {
+        const AVFrameSideData* cllData = av_frame_get_side_data(in, AV_FRAME_DATA_CONTENT_LIGHT_LEVEL);
+        const AVFrameSideData* mdmData = av_frame_get_side_data(in, AV_FRAME_DATA_MASTERING_DISPLAY_METADATA);
+        const auto* cll = cllData ? reinterpret_cast<const AVContentLightMetadata*>(cllData->data) : nullptr;
+        const auto* mdm = mdmData ? reinterpret_cast<const AVMasteringDisplayMetadata*>(mdmData->data) : nullptr;
+        if (cll && cll->MaxCLL > 0) {
+            setPeakLuminance(cll->MaxCLL);
+        } else if (mdm && mdm->has_luminance && mdm->max_luminance.num > 0 && mdm->max_luminance.den > 0) {
+            setPeakLuminance(av_q2d(mdm->max_luminance));
+        }
+    }
+
+    av_frame_unref(out);
+    out->format = AV_PIX_FMT_NV12;
+    out->width = in->width;
+    out->height = in->height;
+    if (m_outputPool.allocFrame(out) < 0 && av_frame_get_buffer(out, 0) < 0) {
+        qWarning() << "[FFmpeg] Tone mapper: failed to allocate NV12 output" << in->width << "x" << in->height;
+        return false;
+    }
+
+    av_frame_copy_props(out, in);
+    av_frame_remove_side_data(out, AV_FRAME_DATA_CONTENT_LIGHT_LEVEL);
+    av_frame_remove_side_data(out, AV_FRAME_DATA_MASTERING_DISPLAY_METADATA);
+    out->color_primaries = AVCOL_PRI_BT709;
+    out->color_trc = AVCOL_TRC_BT709;
+    out->colorspace = AVCOL_SPC_BT709;
+    out->color_range = AVCOL_RANGE_MPEG;
+
+    PlaneSet planes;
+    planes.y = in->data[0];
+    planes.u = in->data[1];
+    planes.v = p010 ? nullptr : in->data[2];
+    planes.yStride = in->linesize[0];
+    planes.uStride = in->linesize[1];
+    planes.vStride = p010 ? 0 : in->linesize[2];
+    planes.p010 = p010;
+    planes.eotf = hlg ? m_luts->hlgEotf : m_luts->eotf;
+    if (in->color_range == AVCOL_RANGE_JPEG) {
+        // Full range, expanded like the SDR shader path does (FFmpegYuvMaterial)
+        planes.yOffset = 0.0f;
+        planes.yScale = 1.0f / 1023.0f;
+        planes.cScale = 1.0f / 1023.0f;
+    }
+    planes.outY = out->data[0];
+    planes.outUV = out->data[1];
+    planes.outYStride = out->linesize[0];
+    planes.outUVStride = out->linesize[1];
+    planes.width = in->width;
+    planes.height = in->height;
+
+    // Row slices across the private pool (small frames run inline)
+    const int blockRows = (in->height + 1) / 2;
+    const int sliceCount = qBound(1, qMin(threadCount(), blockRows / kMinBlockRowsPerSlice), 64);
+    const Luts& luts = *m_luts;
+    if (sliceCount == 1) {
+        mapBlockRows(luts, planes, 0, blockRows);
+    } else {
+        std::vector<std::pair<int, int>> slices;
+        slices.reserve(sliceCount);
+        for (int i = 0; i < sliceCount; ++i) {
+            slices.emplace_back(blockRows * i / sliceCount, blockRows * (i + 1) / sliceCount);
+        }
+        QtConcurrent::blockingMap(&m_threadPool, slices, [&luts, &planes](std::pair<int, int>& slice) {
+            mapBlockRows(luts, planes, slice.first, slice.second);
+        });
+    }
+
+    const double ms = timer.nsecsElapsed() / 1000000.0;
+    m_avgMs = m_avgMs > 0.0 ? m_avgMs * 0.9 + ms * 0.1 : ms;
+    return true;
+}
@@ -0,0 +1,65 @@
+#ifndef FFMPEGTONEMAPPER_H
+#define FFMPEGTONEMAPPER_H
+
+#include <QThreadPool>
+#include <QtGlobal>
+#include <memory>
+#include "ffmpegframepool.h"
+
+// Forward declarations to avoid including FFmpeg headers in header file
+struct AVFrame;
+
+/**
+ * Native HDR (PQ or HLG / BT.2020) → SDR (BT.709) tone mapper
+ *
+ * Works directly on P010 / YUV420P10 and writes 8-bit NV12 into pooled output frames,
+ * replacing the zscale → tonemap → zscale filter graph (which goes through float RGB).
+ * Per 2x2 block: BT.2020 Y'CbCr (limited or full range, from color_range) → R'G'B',
+ * PQ EOTF or HLG inverse OETF + OOTF (1D LUT, picked from color_trc), BT.2020 → BT.709 gamut matrix,
+ * Hable curve on max(R,G,B) (1D LUT, hue preserving like vf_tonemap desat=0),
+ * BT.709 OETF (1D LUT), BT.709 Y'CbCr with chroma averaged over the block.
+ * The four pixels of a block are one SSE2 vector; row slices run on a private thread pool.
+ */
+class FFmpegToneMapper
+{
+public:
+    // maxThreads caps the slice workers (0 = one per core)
+    explicit FFmpegToneMapper(int maxThreads = 0);
+    ~FFmpegToneMapper();
+
+    FFmpegToneMapper(const FFmpegToneMapper&) = delete;
+    FFmpegToneMapper& operator=(const FFmpegToneMapper&) = delete;
+
+    // Formats process() accepts
+    static bool canProcess(int pixelFormat);
+
+    // PQ/HLG (or BT.2020 with unknown transfer) → needs tone mapping for an SDR surface
+    static bool isHdrTransfer(const AVFrame* frame);
+
+    // Source mastering peak in nits (content light level MaxCLL, or AVMasteringDisplayMetadata when
+    // MaxCLL is missing or 0; HLG uses its 1000 nit reference display).
+    // Rebuilds the tone curve LUT when it changes. Default 1000 nits.
+    void setPeakLuminance(double nits);
+    double peakLuminance() const { return m_peakNits; }
+
+    // Tone map `in` into `out` (unref'd frame; allocated from the internal pool as NV12)
+    // Frame properties (pts, duration, ...) are copied, color metadata is set to BT.709 SDR.
+    // Returns false if the input can't be processed.
+    bool process(const AVFrame* in, AVFrame* out);
+
+    int threadCount() const;
+    double averageMilliseconds() const { return m_avgMs; }  // Exponential moving average of process()
+
+    struct Luts;  // Opaque LUT storage, shared read-only by the slice workers
+
+private:
+    void buildToneLut();
+
+    std::unique_ptr<Luts> m_luts;
+    double m_peakNits = 0.0;
+    double m_avgMs = 0.0;
+    QThreadPool m_threadPool;      // Private pool: slices must not queue behind unrelated global pool work
+    FFmpegFramePool m_outputPool;  // NV12 output blocks (separate size class from the decoder's 10-bit frames)
+};
+
+#endif // FFMPEGTONEMAPPER_H
@@ -0,0 +1,145 @@
+#include "ffmpegvideobuffer.h"
+#include <QDebug>
+#include <memory>
+
+extern "C" {
+#include <libavutil/frame.h>
+#include <libavutil/pixfmt.h>
+}
+
+namespace {
+    QVideoFrameFormat::ColorSpace qtColorSpace(AVColorSpace space)
+    {
+        switch (space) {
+            case AVCOL_SPC_BT709:
+                return QVideoFrameFormat::ColorSpace_BT709;
+            case AVCOL_SPC_BT2020_NCL:
+            case AVCOL_SPC_BT2020_CL:
+                return QVideoFrameFormat::ColorSpace_BT2020;
+            case AVCOL_SPC_BT470BG:
+            case AVCOL_SPC_SMPTE170M:
+                return QVideoFrameFormat::ColorSpace_BT601;
+            default:
+                return QVideoFrameFormat::ColorSpace_Undefined;
+        }
+    }
+
+    QVideoFrameFormat::ColorRange qtColorRange(AVColorRange range)
+    {
+        switch (range) {
+            case AVCOL_RANGE_MPEG:
+                return QVideoFrameFormat::ColorRange_Video;
+            case AVCOL_RANGE_JPEG:
+                return QVideoFrameFormat::ColorRange_Full;
+            default:
+                return QVideoFrameFormat::ColorRange_Unknown;
+        }
+    }
+}
+
+FFmpegVideoBuffer::FFmpegVideoBuffer(const AVFrame* frame)
+{
+    if (!frame) {
+        return;
+    }
+    
+    const QVideoFrameFormat::PixelFormat pixelFormat = qtPixelFormat(frame->format);
+    if (pixelFormat == QVideoFrameFormat::Format_Invalid) {
+        return;
+    }
+    
+    // New reference - decoder buffer stays alive until Qt releases this QVideoFrame
+    m_frame = av_frame_alloc();
+    if (!m_frame) {
+        return;
+    }
+    if (av_frame_ref(m_frame, frame) < 0) {
+        av_frame_free(&m_frame);
+        return;
+    }
+    
+    m_format = QVideoFrameFormat(QSize(frame->width, frame->height), pixelFormat);
+    m_format.setColorSpace(qtColorSpace(frame->colorspace));
+    m_format.setColorRange(qtColorRange(frame->color_range));
+}
+
+FFmpegVideoBuffer::~FFmpegVideoBuffer()
+{
+    if (m_frame) {
+        av_frame_free(&m_frame);
+    }
+}
+
+QAbstractVideoBuffer::MapData FFmpegVideoBuffer::map(QVideoFrame::MapMode mode)
+{
+    MapData data;
+    
+    // Decoder output is shared (may still be referenced by the codec) - read-only access only
+    if (!m_frame || (mode & QVideoFrame::WriteOnly)) {
+        return data;
+    }
+    
+    const int height = m_frame->height;
+    const int chromaHeight = (height + 1) / 2;
+    
+    switch (m_frame->format) {
+        case AV_PIX_FMT_NV12:
+            data.planeCount = 2;
+            data.dataSize[1] = m_frame->linesize[1] * chromaHeight;
+            break;
+        case AV_PIX_FMT_YUV420P:
+            data.planeCount = 3;
+            data.dataSize[1] = m_frame->linesize[1] * chromaHeight;
+            data.dataSize[2] = m_frame->linesize[2] * chromaHeight;
+            break;
+        case AV_PIX_FMT_P010LE:
+            data.planeCount = 2;
+            data.dataSize[1] = m_frame->linesize[1] * chromaHeight;
+            break;
+        case AV_PIX_FMT_YUV420P10LE:
+            data.planeCount = 3;
+            data.dataSize[1] = m_frame->linesize[1] * chromaHeight;
+            data.dataSize[2] = m_frame->linesize[2] * chromaHeight;
+            break;
+        case AV_PIX_FMT_BGRA:
+            data.planeCount = 1;
+            break;
+        default:
+            return data;
+    }
+    data.dataSize[0] = m_frame->linesize[0] * height;
+    
+    for (int i = 0; i < data.planeCount; ++i) {
+        data.data[i] = m_frame->data[i];
+        data.bytesPerLine[i] = m_frame->linesize[i];
+    }
+    
+    return data;
+}
+
+QVideoFrameFormat::PixelFormat FFmpegVideoBuffer::qtPixelFormat(int avPixelFormat)
+{
+    switch (avPixelFormat) {
+        case AV_PIX_FMT_NV12:
+            return QVideoFrameFormat::Format_NV12;
+        case AV_PIX_FMT_YUV420P:
+            return QVideoFrameFormat::Format_YUV420P;
+        case AV_PIX_FMT_P010LE:
+            return QVideoFrameFormat::Format_P010;        // 10-bit SDR: sampled as 16-bit textures, no repack
+        case AV_PIX_FMT_YUV420P10LE:
+            return QVideoFrameFormat::Format_YUV420P10;
+        case AV_PIX_FMT_BGRA:
+            return QVideoFrameFormat::Format_BGRA8888;
+        default:
+            return QVideoFrameFormat::Format_Invalid;
+    }
+}
+
+QVideoFrame FFmpegVideoBuffer::wrap(const AVFrame* frame)
+{
+    auto buffer = std::make_unique<FFmpegVideoBuffer>(frame);
+    if (!buffer->isValid()) {
+        return QVideoFrame();
+    }
+    return QVideoFrame(std::move(buffer));
+}
@@ -0,0 +1,43 @@
+#ifndef FFMPEGVIDEOBUFFER_H
+#define FFMPEGVIDEOBUFFER_H
+
+#include <QAbstractVideoBuffer>
+#include <QVideoFrame>
+#include <QVideoFrameFormat>
+
+// Forward declaration to avoid including FFmpeg headers in header file
+struct AVFrame;
+
+/**
+ * Zero-copy QVideoFrame backing store for decoded FFmpeg frames
+ *
+ * Holds a reference (av_frame_ref) to the decoder's output frame and exposes its
+ * planes to Qt directly - no per-frame QVideoFrame allocation or memcpy.
+ * The AVFrame reference is released when Qt drops the last QVideoFrame copy.
+ *
+ * Supported formats: NV12, YUV420P, P010, YUV420P10, BGRA (system memory only)
+ */
+class FFmpegVideoBuffer : public QAbstractVideoBuffer
+{
+public:
+    // Takes a new reference to frame (caller keeps ownership of its own reference)
+    explicit FFmpegVideoBuffer(const AVFrame* frame);
+    ~FFmpegVideoBuffer() override;
+
+    MapData map(QVideoFrame::MapMode mode) override;
+    QVideoFrameFormat format() const override { return m_format; }
+
+    bool isValid() const { return m_frame != nullptr && m_format.isValid(); }
+
+    // Qt pixel format for an FFmpeg pixel format (Format_Invalid if not zero-copy capable)
+    static QVideoFrameFormat::PixelFormat qtPixelFormat(int avPixelFormat);
+
+    // Wrap frame in a QVideoFrame (invalid QVideoFrame if format unsupported)
+    static QVideoFrame wrap(const AVFrame* frame);
+
+private:
+    AVFrame* m_frame = nullptr;
+    QVideoFrameFormat m_format;
+};
+
+#endif // FFMPEGVIDEOBUFFER_H
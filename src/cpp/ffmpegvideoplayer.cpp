@@ -1,14 +1,24 @@
 #include "ffmpegvideoplayer.h"
 #include "ffmpegvideorenderer.h"
+#include "ffmpegvideobuffer.h"
+#include "ffmpegaudioringbuffer.h"
+#include "ffmpegremuxer.h"
+#include "ffmpegdecodesession.h"
+#include "ffmpegsubtitleextractor.h"
 #include <QDebug>
 #include <QDir>
+#include <QFileInfo>
 #include <QVideoFrame>
 #include <QVideoFrameFormat>
-#include <QImage>
 #include <QQuickWindow>
+#include <QSettings>
+#include <QtConcurrent>
+#include <QScreen>
 #include <QtGui/rhi/qrhi.h>
 #include <cstdint>  // For INT64_MIN, INT64_MAX
 #include <cmath>     // For std::isnan
+#include <cstring>   // For std::memcpy
+#include <utility>   // For std::exchange
 
 // Debug logging macro - disable in hot loops for performance
 #if 0
@@ -33,25 +43,24 @@ extern "C" {
 #include <libavcodec/avcodec.h>
 #include <libavutil/avutil.h>
 #include <libavutil/hwcontext.h>
-#include <libavutil/hwcontext_d3d11va.h>  // vcpkg FFmpeg only provides D3D11VA (not D3D11)
-#include <libavutil/hwcontext_cuda.h>     // For CUVID support
+#ifdef Q_OS_WIN
+#include <libavutil/hwcontext_d3d11va.h>  // vcpkg FFmpeg only provides D3D11VA (not D3D11) - pulls in d3d11.h
+#include <libavutil/hwcontext_cuda.h>     // For CUVID support - pulls in cuda.h
+#endif
 #include <libavutil/imgutils.h>
-#include <libavutil/time.h>               // For av_gettime_relative() and av_usleep()
+#include <libavutil/time.h>               // For av_gettime_relative()
 #include <libavutil/version.h>  // For version macros
 #include <libavutil/channel_layout.h>     // For channel layout functions
 #include <libavutil/samplefmt.h>          // For sample format definitions
 #include <libswresample/swresample.h>     // For audio resampling
-#include <libswscale/swscale.h>           // For 10-bit to 8-bit video conversion
-#include <libavfilter/avfilter.h>         // For HDR tone mapping
-#include <libavfilter/buffersink.h>       // For filter output
-#include <libavfilter/buffersrc.h>        // For filter input
+#include <libswscale/swscale.h>           // For display-size scaling
 }
 
-// MSVC pragma comment for linking FFmpeg libraries (fallback if CMake doesn't link them)
-#ifdef _MSC_VER
-#pragma comment(lib, "swscale.lib")
-#pragma comment(lib, "avfilter.lib")
-#endif
+// Helper function for wall-clock time
+static inline double nowSeconds()
+{
+    return av_gettime_relative() / 1000000.0;
+}
 
 FFmpegVideoPlayer::FFmpegVideoPlayer(QObject* parent)
     : QObject(parent)
@@ -60,10 +69,18 @@ FFmpegVideoPlayer::FFmpegVideoPlayer(QObject* parent)
     
     // Initialize FFmpeg (register all codecs, formats, etc.)
     av_log_set_level(AV_LOG_WARNING); // Reduce FFmpeg spam
+    
+    // Load decoder thread cap from settings (0 = auto)
+    QSettings settings;
+    m_maxDecoderThreads = qMax(0, settings.value("video/ffmpegMaxDecoderThreads", 0).toInt());
+    m_masterClock = qBound<int>(AudioClock, settings.value("video/ffmpegMasterClock", AudioClock).toInt(), ExternalClock);
+    m_deinterlaceMode = qBound<int>(DeinterlaceOff, settings.value("video/ffmpegDeinterlaceMode", DeinterlaceFieldRate).toInt(), DeinterlaceFieldRate);
+    m_sharedDecode = settings.value("video/ffmpegSharedDecode", true).toBool();
 }
 
 FFmpegVideoPlayer::~FFmpegVideoPlayer()
 {
+    leaveSession();  // Before stop(): a follower must not stop the shared decode, a decoder hands it over
     stop();
     
     // Stop decode thread
@@ -73,6 +90,9 @@ FFmpegVideoPlayer::~FFmpegVideoPlayer()
         m_decodeCondition.wakeAll();
     }
     
+    // Presenter first - releases a decode thread blocked on a full display queue
+    stopPresenter();
+    
     if (m_decodeThread) {
         m_decodeThread->wait(5000);
         delete m_decodeThread;
@@ -111,6 +131,7 @@ void FFmpegVideoPlayer::onSceneGraphInitialized()
 {
     qDebug() << "[FFmpeg] Scene graph initialized — RHI is now available";
     
+#ifdef Q_OS_WIN
     // Initialize Qt's D3D11 device (needed for Video Processor, not for decoding)
     if (!initD3D11FromRHI()) {
         qWarning() << "[FFmpeg] Failed to initialize D3D11 from RHI (Video Processor may not work)";
@@ -118,11 +139,15 @@ void FFmpegVideoPlayer::onSceneGraphInitialized()
     } else {
         qDebug() << "[FFmpeg] Qt D3D11 device acquired (for Video Processor)";
     }
+#endif
+    m_sceneGraphReady.store(true, std::memory_order_release);
     
     // Open media (FFmpeg will create its own video-capable device for decoding)
-    if (!m_source.isEmpty() && !m_formatContext) {
+    // Followers of a shared decode open nothing
+    if (!m_source.isEmpty() && !m_formatContext && !sharedDecoder()) {
         qDebug() << "[FFmpeg] Opening media (FFmpeg will create its own video device)";
         openMedia();
+        resumeTakeOver();
     }
 }
 
@@ -142,6 +167,8 @@ void FFmpegVideoPlayer::openMedia()
     }
     
     m_mediaOpening = true;
+    m_openTrace = OpenTrace();
+    m_openTrace.startUs = av_gettime_relative();
     
     // Note: We no longer require Qt's D3D11 device for decoding
     // FFmpeg will create its own video-capable device
@@ -164,25 +191,27 @@ void FFmpegVideoPlayer::openMedia()
         return;
     }
     
+    // Demux reads are served from memory (read-ahead thread or mapped file) instead of blocking on the disk.
+    // Non-local sources and "direct" mode keep avformat's own protocols.
+    const qint64 ioStart = av_gettime_relative();
+    if (m_input.open(filePath, FFmpegInputStream::configuredMode(filePath), FFmpegInputStream::configuredReadAheadBytes())) {
+        m_input.attach(m_formatContext);
+    }
+    
     int ret = avformat_open_input(&m_formatContext, filePath.toUtf8().constData(), nullptr, nullptr);
     if (ret < 0) {
         char errbuf[AV_ERROR_MAX_STRING_SIZE];
         av_strerror(ret, errbuf, AV_ERROR_MAX_STRING_SIZE);
         qWarning() << "[FFmpeg] Failed to open input:" << errbuf;
         emit errorOccurred(ret, QString::fromUtf8(errbuf));
-        avformat_free_context(m_formatContext);
-        m_formatContext = nullptr;
+        abortOpenInput();
         return;
     }
+    m_openTrace.ioUs = av_gettime_relative() - ioStart;
     
-    // Find stream info
-    ret = avformat_find_stream_info(m_formatContext, nullptr);
-    if (ret < 0) {
-        qWarning() << "[FFmpeg] Failed to find stream info";
-        avformat_close_input(&m_formatContext);
-        m_formatContext = nullptr;
-        m_mediaOpening = false;
-        m_mediaOpened = false;
+    // Find stream info (bounded by container, see probeStreams())
+    if (!probeStreams()) {
+        abortOpenInput();
         return;
     }
     
@@ -198,23 +227,64 @@ void FFmpegVideoPlayer::openMedia()
     
     if (m_videoStreamIndex < 0) {
         qWarning() << "[FFmpeg] No video stream found";
-        avformat_close_input(&m_formatContext);
-        m_formatContext = nullptr;
-        m_mediaOpening = false;
-        m_mediaOpened = false;
+        abortOpenInput();
         return;
     }
     
-    // Find audio stream
+    // Audio tracks (the headless benchmark measures video only)
     m_audioStreamIndex = -1;
-    for (unsigned int i = 0; i < m_formatContext->nb_streams; i++) {
-        if (m_formatContext->streams[i]->codecpar->codec_type == AVMEDIA_TYPE_AUDIO) {
-            m_audioStreamIndex = static_cast<int>(i);
-            break;
+    m_audioTracks.clear();
+    m_audioTrackStreams.clear();
+    for (unsigned int i = 0; i < m_formatContext->nb_streams && !m_benchmarkMode; i++) {
+        const AVStream* stream = m_formatContext->streams[i];
+        if (stream->codecpar->codec_type != AVMEDIA_TYPE_AUDIO) {
+            continue;
         }
-    }
+        const AVDictionaryEntry* language = av_dict_get(stream->metadata, "language", nullptr, 0);
+        const AVDictionaryEntry* title = av_dict_get(stream->metadata, "title", nullptr, 0);
+        QVariantMap track;
+        track["index"] = m_audioTrackStreams.size();
+        track["streamIndex"] = static_cast<int>(i);
+        track["language"] = language ? QString::fromUtf8(language->value) : QString();
+        track["title"] = title ? QString::fromUtf8(title->value) : QString();
+        track["codec"] = QString::fromUtf8(avcodec_get_name(stream->codecpar->codec_id));
+        track["channels"] = stream->codecpar->ch_layout.nb_channels;
+        track["sampleRate"] = stream->codecpar->sample_rate;
+        m_audioTracks.append(track);
+        m_audioTrackStreams.append(static_cast<int>(i));
+    }
+    if (!m_audioTrackStreams.isEmpty()) {
+        // First track unless a shared decode is being taken over with another one
+        const int preferred = m_preferredAudioTrack;
+        m_activeAudioTrack = (preferred >= 0 && preferred < m_audioTrackStreams.size()) ? preferred : 0;
+        m_audioStreamIndex = m_audioTrackStreams.at(m_activeAudioTrack);
+        
+        // Only the active track is demuxed - switching re-enables another one (see switchAudioStream())
+        for (int streamIndex : std::as_const(m_audioTrackStreams)) {
+            if (streamIndex != m_audioStreamIndex) {
+                m_formatContext->streams[streamIndex]->discard = AVDISCARD_ALL;
+            }
+        }
+        qDebug() << "[FFmpeg] Audio tracks:" << m_audioTrackStreams.size() << "- playing track" << m_activeAudioTrack
+                 << "(stream" << m_audioStreamIndex << ")";
+    }
+    m_preferredAudioTrack = -1;
+    emit audioTracksChanged();
+    emit activeAudioTrackChanged();
+    
+    // The video decoder open (hardware device creation, codec init - the slow part of opening) runs on
+    // a worker while this thread opens the audio decoder and starts the audio device. They share no state:
+    // the worker only touches m_codecContext / hw contexts and reads the video stream's parameters.
+    const qint64 codecPhaseStart = av_gettime_relative();
+    QFuture<bool> videoOpen = QtConcurrent::run([this]() {
+        const qint64 start = av_gettime_relative();
+        const bool opened = openVideoDecoder();
+        m_openTrace.videoCodecUs = av_gettime_relative() - start;
+        return opened;
+    });
     
     // Open audio decoder if audio stream exists
+    const qint64 audioOpenStart = av_gettime_relative();
     if (m_audioStreamIndex >= 0) {
         AVStream* audioStream = m_formatContext->streams[m_audioStreamIndex];
         const AVCodec* audioCodec = avcodec_find_decoder(audioStream->codecpar->codec_id);
@@ -291,83 +361,43 @@ void FFmpegVideoPlayer::openMedia()
                                  << m_audioFormat.channelCount() << "channels,"
                                  << "format:" << m_audioFormat.sampleFormat();
                         
+                        // Pull mode: the sink reads resampled PCM from a lock-free ring on its own thread,
+                        // the decode thread only pushes into the ring (never blocks on the device)
+                        // Sink buffer is kept short (~100ms) - it is pure output latency, the ring holds the decoded lead
+                        const qint64 bytesPerSecond = qint64(m_audioFormat.bytesPerFrame()) * m_audioFormat.sampleRate();
                         m_audioSink = new QAudioSink(defaultDevice, m_audioFormat, this);
-                        m_audioSink->setBufferSize(256 * 1024); // 256 KB buffer to prevent underruns
+                        m_audioSink->setBufferSize(int(bytesPerSecond / 10));
                         m_audioSink->setVolume(m_volume); // Apply current volume setting
-                        m_audioDevice = m_audioSink->start();
+                        m_audioRing = new FFmpegAudioRingBuffer(bytesPerSecond * 2, m_audioFormat.bytesPerFrame(), m_audioSink);
+                        m_audioRing->open(QIODevice::ReadOnly | QIODevice::Unbuffered);  // No QIODevice read-ahead: consumed bytes must be exact
+                        m_audioSink->start(m_audioRing);
                         
-                        if (!m_audioDevice || !m_audioDevice->isOpen()) {
-                            qWarning() << "[FFmpeg] Failed to start audio device - audio playback disabled";
+                        if (m_audioSink->error() != QAudio::NoError || m_audioSink->state() == QAudio::StoppedState) {
+                            qWarning() << "[FFmpeg] Failed to start audio device - audio playback disabled:" << m_audioSink->error();
                             m_audioSink->deleteLater();
                             m_audioSink = nullptr;
-                            m_audioDevice = nullptr;
+                            m_audioRing = nullptr;  // Owned by the sink
                         } else {
-                            m_audioRemainder.clear();
-                            qDebug() << "[FFmpeg] Audio sink created successfully with volume:" << m_volume;
+                            m_audioSinkBufferBytes = m_audioSink->bufferSize();
+                            qDebug() << "[FFmpeg] Audio sink created successfully (pull mode) with volume:" << m_volume
+                                     << "buffer:" << m_audioSink->bufferSize() << "bytes, ring:" << m_audioRing->capacity() << "bytes";
                         }
                         
                         // ----- Setup audio resampler -----
                         // Only setup resampler if audio device started successfully
-                        if (m_audioDevice && m_audioDevice->isOpen() && m_audioSink) {
+                        if (m_audioSink && m_audioRing) {
                             if (m_swr) {
                                 swr_free(&m_swr);
                             }
-                            
-                            AVChannelLayout outLayout = {};
-                            // Use the selected output format (may be different from input if fallback was used)
-                            av_channel_layout_default(&outLayout, m_audioFormat.channelCount());
-                            
-                            const AVChannelLayout* inLayout = &m_audioCodecContext->ch_layout;
-                            
-                            // ✅ Configure resampler to output format we selected (handles downmix if needed)
-                            int r = swr_alloc_set_opts2(
-                                &m_swr,
-                                &outLayout,
-                                AV_SAMPLE_FMT_S16,
-                                m_audioFormat.sampleRate(),  // Output sample rate (may differ from input)
-                                inLayout,
-                                m_audioCodecContext->sample_fmt,
-                                m_audioCodecContext->sample_rate,  // Input sample rate
-                                0,
-                                nullptr
-                            );
-                            
-                            av_channel_layout_uninit(&outLayout);
-                            
-                            if (r < 0 || !m_swr) {
-                                qWarning() << "[FFmpeg] Failed to allocate resampler - audio disabled";
-                                swr_free(&m_swr);
-                                m_swr = nullptr;
+                            m_swr = createAudioResampler(m_audioCodecContext);
+                            if (!m_swr) {
                                 // Cleanup audio sink if resampler failed
-                                if (m_audioSink) {
-                                    if (m_audioDevice) {
-                                        m_audioDevice->close();
-                                    }
-                                    m_audioSink->stop();
-                                    m_audioSink->deleteLater();
-                                    m_audioSink = nullptr;
-                                    m_audioDevice = nullptr;
-                                }
+                                m_audioSink->stop();
+                                m_audioSink->deleteLater();
+                                m_audioSink = nullptr;
+                                m_audioRing = nullptr;
                             } else {
-                                if (swr_init(m_swr) < 0) {
-                                    qWarning() << "[FFmpeg] Failed to init resampler - audio disabled";
-                                    swr_free(&m_swr);
-                                    m_swr = nullptr;
-                                    // Cleanup audio sink if resampler failed
-                                    if (m_audioSink) {
-                                        if (m_audioDevice) {
-                                            m_audioDevice->close();
-                                        }
-                                        m_audioSink->stop();
-                                        m_audioSink->deleteLater();
-                                        m_audioSink = nullptr;
-                                        m_audioDevice = nullptr;
-                                    }
-                                } else {
-                                    qDebug() << "[FFmpeg] Audio resampler initialized - input:" << inputSampleRate << "Hz," 
-                                             << inputChannels << "ch -> output:" << m_audioFormat.sampleRate() << "Hz," 
-                                             << m_audioFormat.channelCount() << "ch";
-                                }
+                                m_timeStretch.configure(m_audioFormat.sampleRate(), m_audioFormat.channelCount());
                             }
                         }
                         } // End of else block for valid audio device
@@ -390,81 +420,47 @@ void FFmpegVideoPlayer::openMedia()
     } else {
         qDebug() << "[FFmpeg] No audio stream found";
     }
+    m_openTrace.audioOpenUs = av_gettime_relative() - audioOpenStart;
     
-    // Get codec parameters
-    AVCodecParameters* codecpar = m_formatContext->streams[m_videoStreamIndex]->codecpar;
-    
-    // Find decoder
-    const AVCodec* codec = avcodec_find_decoder(codecpar->codec_id);
-    if (!codec) {
-        qWarning() << "[FFmpeg] Codec not found";
-        avformat_close_input(&m_formatContext);
-        m_formatContext = nullptr;
-        m_mediaOpening = false;
-        m_mediaOpened = false;
-        return;
-    }
-    
-    // Allocate codec context
-    m_codecContext = avcodec_alloc_context3(codec);
-    if (!m_codecContext) {
-        qWarning() << "[FFmpeg] Failed to allocate codec context";
-        avformat_close_input(&m_formatContext);
-        m_formatContext = nullptr;
-        m_mediaOpening = false;
-        m_mediaOpened = false;
-        return;
-    }
-    
-    // Copy codec parameters to context
-    ret = avcodec_parameters_to_context(m_codecContext, codecpar);
-    if (ret < 0) {
-        qWarning() << "[FFmpeg] Failed to copy codec parameters";
-        avcodec_free_context(&m_codecContext);
-        avformat_close_input(&m_formatContext);
-        m_formatContext = nullptr;
-        m_mediaOpening = false;
-        m_mediaOpened = false;
-        return;
-    }
-    
-    // Detect GPU vendor and setup appropriate hardware decoder
-    m_gpuVendor = detectGPUVendor();
-    if (!setupHardwareDecoder()) {
-        qWarning() << "[FFmpeg] Failed to setup hardware decoder";
-        avcodec_free_context(&m_codecContext);
-        avformat_close_input(&m_formatContext);
-        m_formatContext = nullptr;
-        m_mediaOpening = false;
-        m_mediaOpened = false;
-        return;
-    }
-    
-    // ✅ Ensure opaque is set before opening codec (callback may be called during open)
-    if (!m_codecContext->opaque) {
-        m_codecContext->opaque = this;
-    }
-    
-    // Open codec
-    // Note: codec is the original decoder found above
-    // For D3D11VA, we don't replace the codec context, so this is correct
-    // (If we were using CUVID, we'd need to pass nullptr or the CUVID codec here)
-    ret = avcodec_open2(m_codecContext, codec, nullptr);
-    if (ret < 0) {
-        char errbuf[AV_ERROR_MAX_STRING_SIZE];
-        av_strerror(ret, errbuf, AV_ERROR_MAX_STRING_SIZE);
-        qWarning() << "[FFmpeg] Failed to open codec:" << errbuf;
-        avcodec_free_context(&m_codecContext);
-        avformat_close_input(&m_formatContext);
-        m_formatContext = nullptr;
-        m_mediaOpening = false;
-        m_mediaOpened = false;
+    // Video decoder opened on the worker above
+    const bool videoDecoderOpened = videoOpen.result();
+    m_openTrace.codecPhaseUs = av_gettime_relative() - codecPhaseStart;
+    if (!videoDecoderOpened) {
+        closeMedia();  // Also releases the audio device opened meanwhile
         return;
     }
+    const AVCodec* codec = m_codecContext->codec;
     
-    // Get video dimensions (coded size)
-    m_width = m_codecContext->width;
-    m_height = m_codecContext->height;
+    // Report the threading configuration the codec actually settled on
+    {
+        const int activeType = m_codecContext->active_thread_type;
+        const char* typeName = (activeType & FF_THREAD_FRAME) ? "frame"
+                             : (activeType & FF_THREAD_SLICE) ? "slice"
+                             : "none";
+        qDebug() << "[FFmpeg] Decoder threading:" << codec->name << "threads:" << m_codecContext->thread_count
+                 << "type:" << typeName << "hwaccel:" << (m_codecContext->hw_device_ctx != nullptr);
+        setStatistic(QStringLiteral("decoder"), QString::fromUtf8(codec->name));
+        setStatistic(QStringLiteral("hardwareDecoding"), m_codecContext->hw_device_ctx != nullptr);
+        setStatistic(QStringLiteral("decoderThreads"), m_codecContext->thread_count);
+        setStatistic(QStringLiteral("decoderThreadType"), QString::fromLatin1(typeName));
+        setStatistic(QStringLiteral("decoderThreadCap"), m_maxDecoderThreads);
+        setStatistic(QStringLiteral("decoderLowres"), m_lowres);
+        setStatistic(QStringLiteral("masterClock"), QString::fromLatin1(clockSourceName(masterClock())));
+        emit statisticsChanged();
+    }
+    
+    m_activeRate = m_playbackRate.load(std::memory_order_relaxed);
+    m_rateNextPts = -1.0;
+    m_rateSkipNonRef = false;
+    m_framesThinned.store(0, std::memory_order_relaxed);
+    setStatistic(QStringLiteral("playbackRate"), m_activeRate);
+    updateFramePoolCapacity();
+    m_lastStatsPublishTime = 0.0;
+    m_lastPoolAllocations = m_framePool.stats().allocations;
+    
+    // Get video dimensions (coded size - the stream's, since lowres shrinks the codec context's)
+    m_width = m_lowres > 0 ? m_videoStream->codecpar->width : m_codecContext->width;
+    m_height = m_lowres > 0 ? m_videoStream->codecpar->height : m_codecContext->height;
     
     // Video Processor will be initialized lazily on first frame with actual texture dimensions
     emit implicitSizeChanged();
@@ -497,12 +493,22 @@ void FFmpegVideoPlayer::openMedia()
         return;
     }
     
+    // Keyframe index for accurate seeks (container index now, background scan if it's missing/sparse)
+    // Not for the benchmark: a background scan would compete with the decoder being measured
+    if (!m_benchmarkMode) {
+        m_keyframeIndex.build(filePath, m_formatContext, m_videoStream);
+    }
+    
     qDebug() << "[FFmpeg] Media opened successfully:" << m_width << "x" << m_height << "duration:" << m_duration << "ms";
     
     // Mark media as successfully opened
     m_mediaOpening = false;
     m_mediaOpened = true;
     
+    // Open phases done - the decode thread adds first packet/frame
+    m_openTrace.openUs = av_gettime_relative() - m_openTrace.startUs;
+    publishOpenTrace();
+    
     // Start decode thread
     {
         QMutexLocker locker(&m_decodeMutex);
@@ -511,14 +517,219 @@ void FFmpegVideoPlayer::openMedia()
     
     m_decodeThread = QThread::create([this]() { decodeThreadFunc(); });
     m_decodeThread->start();
+    
+    // Presenter releases decoded frames against the master clock (held until play())
+    m_presentPaused.store(true, std::memory_order_release);
+    startPresenter();
+}
+
+void FFmpegVideoPlayer::abortOpenInput()
+{
+    // avformat_open_input() frees the context itself when it fails
+    if (m_formatContext) {
+        avformat_close_input(&m_formatContext);
+    }
+    m_formatContext = nullptr;
+    m_videoStream = nullptr;
+    m_videoStreamIndex = -1;
+    m_input.close();  // Read-ahead thread and mapping of the file
+    m_mediaOpening = false;
+    m_mediaOpened = false;
+}
+
+namespace {
+
+// Probe limits by container. Indexed containers (MP4/MOV, Matroska, AVI, ASF) carry the stream
+// parameters in their header, so probing only confirms them; streams without a global header
+// (MPEG-TS/PS, FLV, raw elementary streams) are described by their packets and need more data.
+// Other containers get 0/0: the fields are left alone and FFmpeg applies its own (per-format) defaults.
+struct ProbeLimits {
+    int64_t probeSize = 0;          // Bytes, 0 = FFmpeg's default
+    int64_t analyzeDurationUs = 0;  // 0 = FFmpeg's default
+};
+
+ProbeLimits probeLimitsFor(const AVInputFormat* format)
+{
+    const QList<QByteArray> names = QByteArray(format && format->name ? format->name : "").split(',');
+    auto isAny = [&names](std::initializer_list<const char*> candidates) {
+        for (const char* candidate : candidates) {
+            if (names.contains(QByteArray(candidate))) {
+                return true;
+            }
+        }
+        return false;
+    };
+    
+    if (isAny({"mov", "mp4"})) {
+        return {1 << 20, AV_TIME_BASE / 2};
+    }
+    if (isAny({"matroska", "webm", "avi", "asf"})) {
+        return {2 << 20, AV_TIME_BASE};
+    }
+    if (isAny({"mpegts", "mpeg", "flv", "h264", "hevc", "mpegvideo", "m4v"})) {
+        return {5 << 20, 3 * AV_TIME_BASE};
+    }
+    return {};  // Unlisted format - leave probing to FFmpeg
+}
+
+// True if the streams playback uses (first video, first audio) still lack parameters that only
+// decoding finds out (pixel/sample format, dimensions, channels), or no video stream turned up yet
+bool streamsUnresolved(const AVFormatContext* context)
+{
+    bool haveVideo = false;
+    bool haveAudio = false;
+    for (unsigned int i = 0; i < context->nb_streams; i++) {
+        const AVCodecParameters* par = context->streams[i]->codecpar;
+        if (par->codec_type == AVMEDIA_TYPE_VIDEO && !haveVideo) {
+            haveVideo = true;
+            if (par->width <= 0 || par->height <= 0 || par->format < 0) {
+                return true;
+            }
+        } else if (par->codec_type == AVMEDIA_TYPE_AUDIO && !haveAudio) {
+            haveAudio = true;
+            if (par->sample_rate <= 0 || par->ch_layout.nb_channels <= 0 || par->format < 0) {
+                return true;
+            }
+        }
+    }
+    return !haveVideo;
+}
+
+} // namespace
+
+bool FFmpegVideoPlayer::probeStreams()
+{
+    const qint64 probeStart = av_gettime_relative();
+    const char* formatName = m_formatContext->iformat ? m_formatContext->iformat->name : "unknown";
+    
+    ProbeLimits limits = probeLimitsFor(m_formatContext->iformat);
+    QSettings settings;
+    const qint64 probeSizeKB = settings.value("video/ffmpegProbeSizeKB", 0).toLongLong();
+    const qint64 analyzeDurationMs = settings.value("video/ffmpegAnalyzeDurationMs", 0).toLongLong();
+    if (probeSizeKB > 0) {
+        limits.probeSize = probeSizeKB * 1024;
+    }
+    if (analyzeDurationMs > 0) {
+        limits.analyzeDurationUs = analyzeDurationMs * 1000;
+    }
+    
+    // Bounded pass first; if what we play stays unresolved (late PMT, codec parameters only in
+    // the bitstream), a second pass continues with much wider limits
+    int ret = 0;
+    for (int pass = 1; ; ++pass) {
+        if (limits.probeSize > 0) {
+            m_formatContext->probesize = limits.probeSize;
+        }
+        if (limits.analyzeDurationUs > 0) {
+            m_formatContext->max_analyze_duration = limits.analyzeDurationUs;
+        }
+        ret = avformat_find_stream_info(m_formatContext, nullptr);
+        m_openTrace.probePasses = pass;
+        m_openTrace.probeSize = m_formatContext->probesize;
+        m_openTrace.analyzeDurationUs = m_formatContext->max_analyze_duration;  // 0 = FFmpeg's per-format default
+        
+        if ((ret >= 0 && !streamsUnresolved(m_formatContext)) || pass == 2) {
+            break;
+        }
+        limits.probeSize = qMax<int64_t>(limits.probeSize * 4, 32 << 20);
+        limits.analyzeDurationUs = qMax<int64_t>(limits.analyzeDurationUs * 4, 10 * AV_TIME_BASE);
+        qDebug() << "[FFmpeg] Streams unresolved after bounded probe of" << formatName << "- probing again with"
+                 << limits.probeSize / 1024 << "KB /" << limits.analyzeDurationUs / 1000 << "ms";
+    }
+    m_openTrace.probeUs = av_gettime_relative() - probeStart;
+    
+    if (ret < 0) {
+        char errbuf[AV_ERROR_MAX_STRING_SIZE];
+        av_strerror(ret, errbuf, AV_ERROR_MAX_STRING_SIZE);
+        qWarning() << "[FFmpeg] Failed to find stream info:" << errbuf;
+        return false;
+    }
+    qDebug() << "[FFmpeg] Probed" << formatName << "in" << m_openTrace.probeUs / 1000.0 << "ms -"
+             << m_openTrace.probePasses << "pass(es), limits" << m_openTrace.probeSize / 1024 << "KB /"
+             << m_openTrace.analyzeDurationUs / 1000 << "ms";
+    return true;
+}
+
+bool FFmpegVideoPlayer::openVideoDecoder()
+{
+    // Get codec parameters
+    AVCodecParameters* codecpar = m_formatContext->streams[m_videoStreamIndex]->codecpar;
+    
+    // Find decoder
+    const AVCodec* codec = avcodec_find_decoder(codecpar->codec_id);
+    if (!codec) {
+        qWarning() << "[FFmpeg] Codec not found";
+        return false;
+    }
+    
+    // Allocate codec context
+    m_codecContext = avcodec_alloc_context3(codec);
+    if (!m_codecContext) {
+        qWarning() << "[FFmpeg] Failed to allocate codec context";
+        return false;
+    }
+    
+    // Copy codec parameters to context
+    int ret = avcodec_parameters_to_context(m_codecContext, codecpar);
+    if (ret < 0) {
+        qWarning() << "[FFmpeg] Failed to copy codec parameters";
+        avcodec_free_context(&m_codecContext);
+        return false;
+    }
+    
+    // Detect GPU vendor and setup appropriate hardware decoder
+    // If no hardware decoder is available (e.g. non-Windows), fall back to software decoding
+    m_gpuVendor = detectGPUVendor();
+    if ((m_benchmarkMode && m_benchmarkOptions.softwareDecoding) || !setupHardwareDecoder()) {
+        if (!m_codecContext) {
+            qWarning() << "[FFmpeg] Failed to setup hardware decoder (codec context lost)";
+            return false;
+        }
+        qDebug() << "[FFmpeg] Hardware decoder unavailable - using software decoding";
+    }
+    
+    // Configure frame/slice threading (matters for the software path, harmless for hwaccel)
+    configureDecoderThreading(codec);
+    
+    // Software frames are allocated from the recycled frame pool (hw frames use FFmpeg's own pool)
+    m_codecContext->get_buffer2 = getBufferCallback;
+    
+    // Small window: decoders with reduced-resolution decoding (MJPEG, some legacy codecs) skip the detail
+    // that would be scaled away anyway. Re-picked at a keyframe when the display size crosses a level
+    // (see dropSuspendedVideoPacket()).
+    m_lowres = m_codecContext->hw_device_ctx ? 0 : lowresForDisplay(codec);
+    m_codecContext->lowres = m_lowres;
+    if (m_lowres > 0) {
+        qDebug() << "[FFmpeg] Decoding at 1/" << (1 << m_lowres) << "resolution for a"
+                 << m_displayWidth.load(std::memory_order_relaxed) << "x" << m_displayHeight.load(std::memory_order_relaxed) << "display";
+    }
+    
+    // ✅ Ensure opaque is set before opening codec (callback may be called during open)
+    if (!m_codecContext->opaque) {
+        m_codecContext->opaque = this;
+    }
+    
+    // Open codec
+    // Note: codec is the original decoder found above
+    // For D3D11VA, we don't replace the codec context, so this is correct
+    // (If we were using CUVID, we'd need to pass nullptr or the CUVID codec here)
+    ret = avcodec_open2(m_codecContext, codec, nullptr);
+    if (ret < 0) {
+        char errbuf[AV_ERROR_MAX_STRING_SIZE];
+        av_strerror(ret, errbuf, AV_ERROR_MAX_STRING_SIZE);
+        qWarning() << "[FFmpeg] Failed to open codec:" << errbuf;
+        avcodec_free_context(&m_codecContext);
+        return false;
+    }
+    
+    return true;
 }
 
 void FFmpegVideoPlayer::closeMedia()
 {
     // Reset timing
     m_timingInitialized = false;
-    m_startTime = 0.0;
-    m_startPts = 0.0;
+    setWallClockAnchor(0.0, 0.0);
     m_videoStream = nullptr;
     
     // Stop decode thread
@@ -528,12 +739,28 @@ void FFmpegVideoPlayer::closeMedia()
         m_decodeCondition.wakeAll();
     }
     
+    stopPresenter();
+    
     if (m_decodeThread) {
         m_decodeThread->wait(5000);
         delete m_decodeThread;
         m_decodeThread = nullptr;
     }
     
+    // Seek state belongs to this file
+    m_requestedSeekMs.store(-1, std::memory_order_release);
+    m_seekPreviewPending = false;
+    m_lastDecodedVideoPts = -1.0;
+    m_keyframeIndex.reset();
+    
+    // Frame stepping state (cached frames pin decoder buffers)
+    m_requestedStep.store(0, std::memory_order_release);
+    m_stepResync.store(false, std::memory_order_release);
+    m_stepSalvage.clear();
+    cancelStepFill();
+    m_gopCache.clear();
+    m_stepReachedStart = false;
+    
     // Frame queue is no longer used (zero-copy path)
     // Frames are passed directly via frameReady signal
     
@@ -580,10 +807,11 @@ void FFmpegVideoPlayer::closeMedia()
     
     // Cleanup audio
     if (m_audioSink) {
+        QMutexLocker audioLock(&m_audioMutex);
         m_audioSink->stop();
-        delete m_audioSink;
+        delete m_audioSink;  // Also deletes m_audioRing (child of the sink)
         m_audioSink = nullptr;
-        m_audioDevice = nullptr;
+        m_audioRing = nullptr;
     }
     
     if (m_swr) {
@@ -591,19 +819,36 @@ void FFmpegVideoPlayer::closeMedia()
         m_swr = nullptr;
     }
     
-    // Cleanup 10-bit to 8-bit video converter (fallback, not used if filter graph active)
-    if (m_sws10to8) {
-        sws_freeContext(m_sws10to8);
-        m_sws10to8 = nullptr;
+    // Cleanup HDR tone mapper (next file starts from the default peak again)
+    // Output frames still held by Qt keep their pool blocks alive until released
+    if (m_toneMappedFrame) {
+        av_frame_free(&m_toneMappedFrame);
+        m_toneMappedFrame = nullptr;
     }
-    if (m_tmp8bitFrame) {
-        av_frame_free(&m_tmp8bitFrame);
-        m_tmp8bitFrame = nullptr;
+    m_toneMapper.reset();
+    
+    // Cleanup deinterlacer (drops held-back input references)
+    for (AVFrame*& deinterlaced : m_deinterlacedFrames) {
+        av_frame_free(&deinterlaced);
     }
+    m_deinterlacer.reset();
+    
+    // Subtitle decoders belong to this file's streams (reopened from subtitleStreams for the next one)
+    closeSubtitleDecoders();
     
-    // Cleanup HDR tone mapping filter graph (explicit cleanup - reset initialization flag)
-    // ✅ Use cleanup function to ensure flag is reset and all resources are freed properly
-    cleanupHDRToneMappingFilter();
+    // Cleanup display scaling
+    if (m_scaledFrame) {
+        av_frame_free(&m_scaledFrame);
+        m_scaledFrame = nullptr;
+    }
+    if (m_displaySws) {
+        sws_freeContext(m_displaySws);
+        m_displaySws = nullptr;
+    }
+    m_scalePool.reset();
+    m_lowres = 0;
+    m_videoSuspended = false;
+    m_awaitVideoKeyframe = false;
     
     if (m_audioFrame) {
         av_frame_free(&m_audioFrame);
@@ -611,23 +856,37 @@ void FFmpegVideoPlayer::closeMedia()
     }
     
     if (m_audioCodecContext) {
-        avcodec_free_context(&m_audioCodecContext);
-        m_audioCodecContext = nullptr;
+        AVCodecContext* audioContext = nullptr;
+        {
+            QMutexLocker clockLocker(&m_audioClockMutex);  // The presenter may be checking it
+            audioContext = std::exchange(m_audioCodecContext, nullptr);
+        }
+        avcodec_free_context(&audioContext);
     }
     
     if (m_formatContext) {
         avformat_close_input(&m_formatContext);
         m_formatContext = nullptr;
     }
+    m_input.close();  // Custom AVIO outlives the format context
     
     m_videoStreamIndex = -1;
     m_audioStreamIndex = -1;
-    m_audioRemainder.clear();
+    m_requestedAudioStream.store(-1, std::memory_order_release);
+    m_audioSwitchStartTime = 0.0;
+    resetVideoReplay();
+    if (!m_audioTracks.isEmpty()) {
+        m_audioTracks.clear();
+        m_audioTrackStreams.clear();
+        m_activeAudioTrack = -1;
+        emit audioTracksChanged();
+        emit activeAudioTrackChanged();
+    }
     m_width = 0;
     m_height = 0;
     m_duration = 0;
     m_position = 0;
-    m_audioClock = 0.0;
+    resetAudioClock();
     
     // Reset lifecycle flags
     m_mediaOpened = false;
@@ -641,41 +900,539 @@ void FFmpegVideoPlayer::closeMedia()
     m_outWidth = 0;
     m_outHeight = 0;
     
+    // Drop idle pooled frames (frames still shown by Qt are freed when released)
+    m_framePool.reset();
+    
+    clearStatistics();
+    
     emit implicitSizeChanged();
     emit durationChanged();
 }
 
-FFmpegVideoPlayer::GPUVendor FFmpegVideoPlayer::detectGPUVendor()
+int FFmpegVideoPlayer::lowresForDisplay(const AVCodec* codec) const
 {
-#ifdef Q_OS_WIN
-    if (!m_d3d11Device) {
-        qWarning() << "[FFmpeg] Cannot detect GPU vendor: D3D11 device not available";
-        return GPU_VENDOR_UNKNOWN;
+    const int displayWidth = m_displayWidth.load(std::memory_order_relaxed);
+    const int displayHeight = m_displayHeight.load(std::memory_order_relaxed);
+    if (!codec || !m_codecContext || displayWidth <= 0 || displayHeight <= 0 || m_benchmarkMode) {
+        return 0;
+    }
+    
+    // Largest reduction that still covers the display (each level halves both dimensions).
+    // Coded size from the stream - the codec context's shrinks with the current lowres level
+    const int codedWidth = m_videoStream ? m_videoStream->codecpar->width : m_codecContext->width;
+    const int codedHeight = m_videoStream ? m_videoStream->codecpar->height : m_codecContext->height;
+    int level = 0;
+    while (level < codec->max_lowres &&
+           (codedWidth >> (level + 1)) >= displayWidth &&
+           (codedHeight >> (level + 1)) >= displayHeight) {
+        ++level;
+    }
+    return level;
+}
+
+void FFmpegVideoPlayer::configureDecoderThreading(const AVCodec* codec)
+{
+    if (!m_codecContext || !codec) {
+        return;
     }
     
-    // Query DXGI adapter from D3D11 device
-    IDXGIDevice* dxgiDevice = nullptr;
-    HRESULT hr = m_d3d11Device->QueryInterface(__uuidof(IDXGIDevice), reinterpret_cast<void**>(&dxgiDevice));
-    if (FAILED(hr) || !dxgiDevice) {
-        qWarning() << "[FFmpeg] Failed to query DXGI device:" << hr;
-        return GPU_VENDOR_UNKNOWN;
+    // Hardware decoding does the heavy lifting on the GPU - extra frame threads only add latency
+    if (m_codecContext->hw_device_ctx) {
+        m_codecContext->thread_count = 1;
+        m_codecContext->thread_type = FF_THREAD_SLICE;
+        return;
     }
     
-    IDXGIAdapter* adapter = nullptr;
-    hr = dxgiDevice->GetAdapter(&adapter);
-    dxgiDevice->Release();
+    const int cores = qMax(1, QThread::idealThreadCount());
+    const qint64 pixels = qint64(m_codecContext->width) * m_codecContext->height;
     
-    if (FAILED(hr) || !adapter) {
-        qWarning() << "[FFmpeg] Failed to get DXGI adapter:" << hr;
-        return GPU_VENDOR_UNKNOWN;
+    // Scale thread count with resolution: small frames don't have enough work per slice/frame
+    // to keep many threads busy, and every frame thread adds one frame of decode latency
+    int threads;
+    if (pixels <= 1280 * 720) {
+        threads = qMin(cores, 4);
+    } else if (pixels <= 1920 * 1088) {
+        threads = qMin(cores, 8);
+    } else {
+        threads = cores;
     }
     
-    DXGI_ADAPTER_DESC desc = {};
-    hr = adapter->GetDesc(&desc);
-    adapter->Release();
+    // FFmpeg warns above 16 threads and gains nothing for frame threading
+    threads = qMin(threads, 16);
     
-    if (FAILED(hr)) {
-        qWarning() << "[FFmpeg] Failed to get adapter description:" << hr;
+    // User cap (several players side by side)
+    if (m_maxDecoderThreads > 0) {
+        threads = qMin(threads, m_maxDecoderThreads);
+    }
+    threads = qMax(1, threads);
+    
+    // Prefer frame threading (scales best for H.264/HEVC/VP9), keep slice threading as fallback.
+    // FFmpeg picks frame threading when both flags are set and the codec supports it.
+    int threadType = 0;
+    if (codec->capabilities & AV_CODEC_CAP_FRAME_THREADS) {
+        threadType |= FF_THREAD_FRAME;
+    }
+    if (codec->capabilities & AV_CODEC_CAP_SLICE_THREADS) {
+        threadType |= FF_THREAD_SLICE;
+    }
+    // Wrappers with their own thread pool (e.g. libdav1d) advertise AV_CODEC_CAP_OTHER_THREADS instead:
+    // they read thread_count directly and FFmpeg keeps it even though no frame/slice threading applies
+    const bool ownThreadPool = (codec->capabilities & AV_CODEC_CAP_OTHER_THREADS) != 0;
+    if (threadType == 0 && !ownThreadPool) {
+        // Single-threaded decoder - FFmpeg would reset thread_count to 1 anyway
+        threads = 1;
+    }
+    
+    m_codecContext->thread_count = threads;
+    m_codecContext->thread_type = threadType;
+    
+    qDebug() << "[FFmpeg] Software decode threading requested:" << threads << "threads"
+             << (threadType & FF_THREAD_FRAME ? "(frame)" : threadType & FF_THREAD_SLICE ? "(slice)"
+                 : ownThreadPool ? "(decoder's own pool)" : "(single-threaded)")
+             << "(cores:" << cores << "cap:" << m_maxDecoderThreads << "resolution:"
+             << m_codecContext->width << "x" << m_codecContext->height << ")";
+}
+
+void FFmpegVideoPlayer::setMaxDecoderThreads(int threads)
+{
+    threads = qMax(0, threads);
+    if (m_maxDecoderThreads == threads) {
+        return;
+    }
+    
+    m_maxDecoderThreads = threads;
+    
+    QSettings settings;
+    settings.setValue("video/ffmpegMaxDecoderThreads", m_maxDecoderThreads);
+    
+    // Takes effect on the next openMedia() - thread_count can't change on an open codec
+    qDebug() << "[FFmpeg] Max decoder threads set to:" << m_maxDecoderThreads << "(applies to next media)";
+    emit maxDecoderThreadsChanged();
+}
+
+void FFmpegVideoPlayer::updateFramePoolCapacity()
+{
+    if (!m_codecContext) {
+        return;
+    }
+    
+    // Frames decoded per second we have to present (stream frame rate at the playback rate; assume 30fps if unknown)
+    double presentationRate = 30.0;
+    if (m_videoStream && m_videoStream->avg_frame_rate.num > 0 && m_videoStream->avg_frame_rate.den > 0) {
+        presentationRate = av_q2d(m_videoStream->avg_frame_rate);
+    }
+    presentationRate *= m_activeRate;
+    
+    // Idle frames needed to absorb decode bursts without hitting the heap:
+    // one per frame thread, plus the display queue, GUI handoff + the frame Qt is displaying,
+    // plus one extra per 30fps of presentation rate (high rates release frames in bigger bursts),
+    // plus the previous/current frame the deinterlacer keeps for look-ahead
+    const int frameThreads = (m_codecContext->active_thread_type & FF_THREAD_FRAME) ? m_codecContext->thread_count : 1;
+    const int rateHeadroom = qBound(1, int(std::ceil(presentationRate / 30.0)), 8);
+    const int deinterlaceHeld = deinterlaceMode() != DeinterlaceOff ? 2 : 0;
+    const int capacity = qBound(3, frameThreads + DISPLAY_QUEUE_SIZE + 2 + rateHeadroom + deinterlaceHeld, 32);
+    
+    m_framePool.setCapacity(capacity);
+    m_scalePool.setCapacity(DISPLAY_QUEUE_SIZE + 2 + rateHeadroom);  // Scaled frames only live in the display queue
+    qDebug() << "[FFmpeg] Frame pool capacity:" << capacity << "frames (rate:" << presentationRate << "fps, frame threads:" << frameThreads << ")";
+}
+
+qreal FFmpegVideoPlayer::playbackRate() const
+{
+    if (FFmpegVideoPlayer* decoder = sharedDecoder()) {
+        return decoder->playbackRate();
+    }
+    return m_playbackRate.load(std::memory_order_relaxed);
+}
+
+void FFmpegVideoPlayer::setPlaybackRate(qreal rate)
+{
+    if (FFmpegVideoPlayer* decoder = sharedDecoder()) {
+        decoder->setPlaybackRate(rate);
+        return;
+    }
+    rate = qBound(FFmpegAudioTimeStretch::MIN_RATE, double(rate), FFmpegAudioTimeStretch::MAX_RATE);
+    const double previous = m_playbackRate.load(std::memory_order_relaxed);
+    if (qFuzzyCompare(previous, rate)) {
+        return;
+    }
+    
+    if (m_window && m_window->screen()) {
+        m_displayRefreshRate.store(qMax(24.0, m_window->screen()->refreshRate()), std::memory_order_relaxed);
+    }
+    {
+        // Re-anchor the wall clock on the current position and switch the rate in one step, so the
+        // decode/presenter threads never combine the new anchor with the old rate (or vice versa)
+        QMutexLocker clockLocker(&m_clockMutex);
+        if (m_timingInitialized) {
+            const double now = nowSeconds();
+            m_startPts = m_startPts + (now - m_startTime) * previous;
+            m_startTime = now;
+        }
+        m_playbackRate.store(rate, std::memory_order_relaxed);
+    }
+    
+    qDebug() << "[FFmpeg] Playback rate:" << rate;
+    {
+        QMutexLocker locker(&m_presentMutex);
+        m_presentCondition.wakeAll();  // Hold times change with the rate
+    }
+    {
+        QMutexLocker decodeLocker(&m_decodeMutex);
+        m_decodeCondition.wakeAll();
+    }
+    emit playbackRateChanged();
+}
+
+void FFmpegVideoPlayer::applyPlaybackRate()
+{
+    const double rate = m_playbackRate.load(std::memory_order_relaxed);
+    if (rate == m_activeRate) {
+        return;
+    }
+    
+    m_activeRate = rate;
+    m_rateNextPts = -1.0;
+    if (rate <= 1.0 && m_rateSkipNonRef) {
+        m_rateSkipNonRef = false;
+        m_rateSkipChangedTime = nowSeconds();
+    }
+    setStatistic(QStringLiteral("playbackRate"), rate);
+    updateFramePoolCapacity();  // More frames in flight at higher rates
+}
+
+bool FFmpegVideoPlayer::skipFrameForRate(double framePts)
+{
+    if (m_activeRate <= 1.0 || framePts <= 0.0) {
+        return false;
+    }
+    
+    // Decoding can't keep up (frames reach the decoder output already late): skip non-reference
+    // frames at the decoder until it is comfortably ahead again. Hysteresis keeps it from flapping.
+    const double now = nowSeconds();
+    const double lateness = masterClockSeconds() - framePts;
+    if (!m_rateSkipNonRef && lateness > 0.1 && now - m_rateSkipChangedTime > 1.0) {
+        m_rateSkipNonRef = true;
+        m_rateSkipChangedTime = now;
+        qDebug() << "[FFmpeg] Decoding behind at" << m_activeRate << "x (late" << lateness << "s) - skipping non-reference frames";
+        setStatistic(QStringLiteral("rateSkipNonRef"), true);
+    } else if (m_rateSkipNonRef && lateness < -0.25 && now - m_rateSkipChangedTime > 2.0) {
+        m_rateSkipNonRef = false;
+        m_rateSkipChangedTime = now;
+        qDebug() << "[FFmpeg] Decoding ahead at" << m_activeRate << "x - decoding all frames again";
+        setStatistic(QStringLiteral("rateSkipNonRef"), false);
+    }
+    
+    // More frames per second than the display can show: keep evenly spaced ones (one per refresh),
+    // the rest are never converted
+    const double step = m_activeRate / m_displayRefreshRate.load(std::memory_order_relaxed);
+    if (m_rateNextPts >= 0.0 && framePts + 0.0005 < m_rateNextPts && m_rateNextPts - framePts < step * 2.0) {
+        m_framesThinned.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+    // Keep the cadence from the slot, not from the frame (a jump in PTS restarts it)
+    m_rateNextPts = (m_rateNextPts < 0.0 || std::abs(framePts - m_rateNextPts) > step) ? framePts + step : m_rateNextPts + step;
+    return false;
+}
+
+bool FFmpegVideoPlayer::admitVideoFrame(double framePts)
+{
+    // 🚨 DROP FRAMES AFTER SEEK UNTIL WE REACH TARGET
+    // FFmpeg seeks to a keyframe (usually before target), so we must discard
+    // frames until we reach the seek target PTS
+    if (m_stepFill != NoStepFill) {
+        // Frame stepping: no scheduling or dropping - every frame is converted into the GOP cache
+        if (++m_stepFillDecoded > STEP_FILL_MAX_FRAMES) {
+            qWarning() << "[FFmpeg] Frame step fill gave up after" << STEP_FILL_MAX_FRAMES << "frames";
+            finishStepFill();
+            return false;
+        }
+        return true;
+    }
+    
+    if (m_seekPending.load(std::memory_order_acquire)) {
+        constexpr double EPS = 0.0005; // 0.5ms tolerance
+        // Drop frames with invalid/zero PTS or frames before target
+        if (framePts <= 0.0 || framePts + EPS < m_seekTargetPts) {
+            FFLOG("[FFmpeg] Dropping frame before seek target - frame PTS:" << framePts 
+                         << "target PTS:" << m_seekTargetPts);
+            ++m_seekFramesDiscarded;
+            return false;
+        }
+        
+        // First valid frame after seek - clear seek pending flag
+        FFLOG("[FFmpeg] Reached seek target - frame PTS:" << framePts 
+                 << "target PTS:" << m_seekTargetPts);
+        m_seekPending.store(false, std::memory_order_release);
+        m_timingInitialized = false; // Re-initialize timing cleanly for this frame
+        
+        const double seekMs = (nowSeconds() - m_seekRequestWallTime.load(std::memory_order_relaxed)) * 1000.0;
+        setStatistic(QStringLiteral("lastSeekMs"), seekMs);
+        setStatistic(QStringLiteral("lastSeekFramesDiscarded"), m_seekFramesDiscarded);
+        qDebug() << "[FFmpeg] Seek target reached in" << seekMs << "ms -" << m_seekFramesDiscarded << "frames discarded";
+    }
+    
+    // ✅ Hold video until audio is ready after seek (prevents A/V desync)
+    // If audio exists and we just seeked, don't present video until audio is ready.
+    // Otherwise video visibly "starts" early while audio is still catching up.
+    // (Not while paused: a paused seek shows its target frame immediately)
+    if (m_audioCodecContext && m_holdVideoUntilAudio.load(std::memory_order_acquire) &&
+        m_masterClock.load(std::memory_order_relaxed) == AudioClock &&
+        !m_presentPaused.load(std::memory_order_acquire)) {
+        // While audio seek is pending (or base not set), drop video frames.
+        // This keeps A/V start aligned after seeks.
+        if (m_audioSeekPending.load(std::memory_order_acquire) || !hasAudioClockBase()) {
+            FFLOG("[FFmpeg] Holding video frame until audio is ready - dropping frame PTS:" << framePts);
+            return false;
+        }
+        // Audio is ready - clear the hold flag (only need to check once)
+        m_holdVideoUntilAudio.store(false, std::memory_order_release);
+        FFLOG("[FFmpeg] Audio ready - video presentation can now start");
+    }
+    
+    // Initialize timing on first frame (or after seek)
+    // CRITICAL: Initialize even if audio isn't ready yet - use wall clock
+    if (!m_timingInitialized && framePts > 0.0) {
+        const double startTime = nowSeconds();  // wall time when that pts started
+        setWallClockAnchor(framePts, startTime);  // absolute pts at start
+        m_timingInitialized = true;
+        qDebug() << "[FFmpeg] Timing initialized - start time:" << startTime << "start PTS:" << framePts 
+                 << "audio ready:" << (hasAudioClockBase() && m_audioSink);
+    }
+    
+    // Very late frames are dropped here, before any expensive conversion
+    // Pacing and fine-grained drop/hold decisions belong to the presenter (presentThreadFunc):
+    // the decode loop is throttled by the display queue, not by sleeping
+    if (m_timingInitialized && framePts > 0.0 &&
+        m_masterClock.load(std::memory_order_relaxed) != VideoClock) {
+        // ✅ FIX #3: Only drop frames if they're WAY behind (300ms+)
+        // BUT: Skip dropping for first 500ms of playback to allow A/V sync to stabilize
+        // This prevents "never starts" issue when audio clock initializes ahead of video
+        double timeSincePlayStart = nowSeconds() - m_playStartWallTime;
+        bool inGraceWindow = (timeSincePlayStart < 0.5) && (m_playStartWallTime > 0.0);
+        
+        const double masterClockAbs = masterClockSeconds();
+        if (!inGraceWindow && framePts < masterClockAbs - 0.3) {
+            qDebug() << "[FFmpeg] Dropping very late frame - video:" << framePts << "master:" << masterClockAbs 
+                     << "diff:" << (framePts - masterClockAbs);
+            m_framesDropped.fetch_add(1, std::memory_order_relaxed);
+            return false;  // Before any expensive processing
+        }
+    }
+    
+    // Playback rate above 1x: thin to the display refresh rate before conversion
+    applyPlaybackRate();
+    return !(m_timingInitialized && skipFrameForRate(framePts));
+}
+
+void FFmpegVideoPlayer::publishPeriodicStatistics()
+{
+    const double now = nowSeconds();
+    if (m_lastStatsPublishTime <= 0.0) {
+        m_lastStatsPublishTime = now;
+        return;
+    }
+    
+    const double elapsed = now - m_lastStatsPublishTime;
+    if (elapsed < 1.0) {
+        return;
+    }
+    
+    const FFmpegFramePool::Stats pool = m_framePool.stats();
+    const double allocationsPerSec = double(pool.allocations - m_lastPoolAllocations) / elapsed;
+    m_lastPoolAllocations = pool.allocations;
+    m_lastStatsPublishTime = now;
+    
+    {
+        QMutexLocker locker(&m_statsMutex);
+        m_statistics.insert(QStringLiteral("frameAllocationsPerSec"), allocationsPerSec);
+        m_statistics.insert(QStringLiteral("frameAllocationsTotal"), pool.allocations);
+        m_statistics.insert(QStringLiteral("framePoolReuses"), pool.reuses);
+        m_statistics.insert(QStringLiteral("framePoolIdle"), pool.idle);
+        m_statistics.insert(QStringLiteral("framePoolOutstanding"), pool.outstanding);
+        m_statistics.insert(QStringLiteral("framePoolCapacity"), pool.capacity);
+        m_statistics.insert(QStringLiteral("framePoolBytes"), pool.blockBytes * (pool.idle + pool.outstanding));
+        
+        // Presentation scheduler
+        m_statistics.insert(QStringLiteral("masterClock"), QString::fromLatin1(clockSourceName(masterClock())));
+        m_statistics.insert(QStringLiteral("framesPresented"), m_framesPresented.load(std::memory_order_relaxed));
+        m_statistics.insert(QStringLiteral("framesDropped"), m_framesDropped.load(std::memory_order_relaxed));
+        m_statistics.insert(QStringLiteral("framesDuplicated"), m_framesDuplicated.load(std::memory_order_relaxed));
+        m_statistics.insert(QStringLiteral("framesThinned"), m_framesThinned.load(std::memory_order_relaxed));
+        QVariantList histogram;
+        for (const auto& bucket : m_avOffsetHistogram) {
+            histogram.append(bucket.load(std::memory_order_relaxed));
+        }
+        m_statistics.insert(QStringLiteral("avOffsetHistogram"), histogram);  // ms buckets: <-100,-50,-20,-5,5,20,50,100,>100
+        
+        // Seeking
+        m_statistics.insert(QStringLiteral("keyframeIndex"), QString::fromLatin1(FFmpegKeyframeIndex::sourceName(m_keyframeIndex.source())));
+        m_statistics.insert(QStringLiteral("keyframeCount"), m_keyframeIndex.count());
+        m_statistics.insert(QStringLiteral("seeksRequested"), m_seeksRequested.load(std::memory_order_relaxed));
+        m_statistics.insert(QStringLiteral("seeksCoalesced"), m_seeksCoalesced.load(std::memory_order_relaxed));
+        m_statistics.insert(QStringLiteral("audioTrackSwitches"), m_audioTrackSwitches.load(std::memory_order_relaxed));
+        
+        // Display-size output
+        m_statistics.insert(QStringLiteral("displayScaledFrames"), m_framesScaled.load(std::memory_order_relaxed));
+        m_statistics.insert(QStringLiteral("videoSuspended"), m_suspendVideo.load(std::memory_order_relaxed));
+        m_statistics.insert(QStringLiteral("videoPacketsSkipped"), m_videoPacketsSkipped.load(std::memory_order_relaxed));
+        
+        // Subtitles decoded from the playback demuxer
+        m_statistics.insert(QStringLiteral("subtitleStreamsDecoded"), int(m_subtitleDecoders.size()));
+        m_statistics.insert(QStringLiteral("subtitleCues"), m_subtitleCues.load(std::memory_order_relaxed));
+        
+        // Windows showing this decode (FFmpegDecodeSession)
+        m_statistics.insert(QStringLiteral("sessionWindows"), m_sessionWindows.load(std::memory_order_relaxed));
+        
+        // Demux input (custom AVIO)
+        if (m_input.isOpen()) {
+            const FFmpegInputStream::Stats input = m_input.stats();
+            m_statistics.insert(QStringLiteral("inputMode"), QString::fromLatin1(FFmpegInputStream::modeName(m_input.mode())));
+            m_statistics.insert(QStringLiteral("inputReads"), input.reads);
+            m_statistics.insert(QStringLiteral("inputCacheHits"), input.cacheHits);
+            m_statistics.insert(QStringLiteral("inputStalls"), input.stalls);
+            m_statistics.insert(QStringLiteral("inputStallMs"), double(input.stallUs) / 1000.0);
+            m_statistics.insert(QStringLiteral("inputRefills"), input.seeks);
+            m_statistics.insert(QStringLiteral("inputBufferedMB"), double(input.bufferedBytes) / (1024.0 * 1024.0));
+        } else {
+            m_statistics.insert(QStringLiteral("inputMode"), QString::fromLatin1(FFmpegInputStream::modeName(FFmpegInputStream::DirectMode)));
+        }
+        
+        // Native HDR tone mapper (only exists once a 10-bit frame was seen)
+        if (m_toneMapper) {
+            m_statistics.insert(QStringLiteral("toneMapMs"), m_toneMapper->averageMilliseconds());
+            m_statistics.insert(QStringLiteral("toneMapPeakNits"), m_toneMapper->peakLuminance());
+        }
+        
+        // Deinterlacer (only exists once an interlaced frame was seen)
+        if (m_deinterlacer) {
+            m_statistics.insert(QStringLiteral("deinterlaceMs"), m_deinterlacer->averageMilliseconds());
+            m_statistics.insert(QStringLiteral("deinterlacedFrames"), m_deinterlacer->outputFrames());
+        }
+        
+        // Audio ring (pull mode)
+        if (m_audioRing) {
+            const int bytesPerSecond = m_audioFormat.bytesPerFrame() * m_audioFormat.sampleRate();
+            m_statistics.insert(QStringLiteral("audioUnderruns"), m_audioRing->underruns());
+            m_statistics.insert(QStringLiteral("audioBufferedMs"),
+                                bytesPerSecond > 0 ? m_audioRing->queuedBytes() * 1000 / bytesPerSecond : 0);
+        }
+    }
+    emit statisticsChanged();
+}
+
+void FFmpegVideoPlayer::publishOpenTrace()
+{
+    auto ms = [](qint64 us) { return us < 0 ? -1.0 : double(us) / 1000.0; };
+    QVariantMap trace;
+    trace["ioMs"] = ms(m_openTrace.ioUs);
+    trace["probeMs"] = ms(m_openTrace.probeUs);
+    trace["probePasses"] = m_openTrace.probePasses;
+    trace["probeSizeKB"] = m_openTrace.probeSize / 1024;
+    trace["analyzeDurationMs"] = m_openTrace.analyzeDurationUs / 1000;
+    trace["videoCodecOpenMs"] = ms(m_openTrace.videoCodecUs);
+    trace["audioOpenMs"] = ms(m_openTrace.audioOpenUs);
+    trace["codecPhaseMs"] = ms(m_openTrace.codecPhaseUs);
+    trace["openMs"] = ms(m_openTrace.openUs);
+    trace["firstPacketMs"] = ms(m_openTrace.firstPacketUs);
+    trace["firstFrameMs"] = ms(m_openTrace.firstFrameUs);
+    // Open + first frame once decoding started: time to first frame without the wait for play()
+    trace["timeToFirstFrameMs"] = (m_openTrace.openUs >= 0 && m_openTrace.firstFrameUs >= 0)
+        ? ms(m_openTrace.openUs + m_openTrace.firstFrameUs) : -1.0;
+    setStatistic(QStringLiteral("openTrace"), trace);
+    emit statisticsChanged();
+}
+
+QVariantMap FFmpegVideoPlayer::statistics() const
+{
+    if (FFmpegVideoPlayer* decoder = sharedDecoder()) {
+        return decoder->statistics();
+    }
+    QMutexLocker locker(&m_statsMutex);
+    return m_statistics;
+}
+
+void FFmpegVideoPlayer::setBenchmarkMode(const BenchmarkOptions& options)
+{
+    if (m_mediaOpened || m_mediaOpening) {
+        qWarning() << "[FFmpeg] Benchmark mode must be set before media is opened";
+        return;
+    }
+    
+    m_benchmarkMode = true;
+    m_benchmarkOptions = options;
+    if (options.decoderThreads >= 0) {
+        m_maxDecoderThreads = options.decoderThreads;  // This run only - not persisted
+    }
+    m_benchFrames.store(0, std::memory_order_relaxed);
+    m_benchDemuxUs.store(0, std::memory_order_relaxed);
+    m_benchDecodeUs.store(0, std::memory_order_relaxed);
+    m_benchTransferUs.store(0, std::memory_order_relaxed);
+    m_benchConvertUs.store(0, std::memory_order_relaxed);
+    m_benchLastFrameUs.store(0, std::memory_order_relaxed);
+}
+
+FFmpegVideoPlayer::BenchmarkCounters FFmpegVideoPlayer::benchmarkCounters() const
+{
+    BenchmarkCounters counters;
+    counters.frames = m_benchFrames.load(std::memory_order_relaxed);
+    counters.demuxUs = m_benchDemuxUs.load(std::memory_order_relaxed);
+    counters.decodeUs = m_benchDecodeUs.load(std::memory_order_relaxed);
+    counters.transferUs = m_benchTransferUs.load(std::memory_order_relaxed);
+    counters.convertUs = m_benchConvertUs.load(std::memory_order_relaxed);
+    counters.lastFrameUs = m_benchLastFrameUs.load(std::memory_order_relaxed);
+    return counters;
+}
+
+void FFmpegVideoPlayer::setStatistic(const QString& key, const QVariant& value)
+{
+    QMutexLocker locker(&m_statsMutex);
+    m_statistics.insert(key, value);
+}
+
+void FFmpegVideoPlayer::clearStatistics()
+{
+    {
+        QMutexLocker locker(&m_statsMutex);
+        if (m_statistics.isEmpty()) {
+            return;
+        }
+        m_statistics.clear();
+    }
+    emit statisticsChanged();
+}
+
+FFmpegVideoPlayer::GPUVendor FFmpegVideoPlayer::detectGPUVendor()
+{
+#ifdef Q_OS_WIN
+    if (!m_d3d11Device) {
+        qWarning() << "[FFmpeg] Cannot detect GPU vendor: D3D11 device not available";
+        return GPU_VENDOR_UNKNOWN;
+    }
+    
+    // Query DXGI adapter from D3D11 device
+    IDXGIDevice* dxgiDevice = nullptr;
+    HRESULT hr = m_d3d11Device->QueryInterface(__uuidof(IDXGIDevice), reinterpret_cast<void**>(&dxgiDevice));
+    if (FAILED(hr) || !dxgiDevice) {
+        qWarning() << "[FFmpeg] Failed to query DXGI device:" << hr;
+        return GPU_VENDOR_UNKNOWN;
+    }
+    
+    IDXGIAdapter* adapter = nullptr;
+    hr = dxgiDevice->GetAdapter(&adapter);
+    dxgiDevice->Release();
+    
+    if (FAILED(hr) || !adapter) {
+        qWarning() << "[FFmpeg] Failed to get DXGI adapter:" << hr;
+        return GPU_VENDOR_UNKNOWN;
+    }
+    
+    DXGI_ADAPTER_DESC desc = {};
+    hr = adapter->GetDesc(&desc);
+    adapter->Release();
+    
+    if (FAILED(hr)) {
+        qWarning() << "[FFmpeg] Failed to get adapter description:" << hr;
         return GPU_VENDOR_UNKNOWN;
     }
     
@@ -875,12 +1632,6 @@ bool FFmpegVideoPlayer::setupCUDADecoder()
 #endif
 }
 
-// Helper function for wall-clock time
-static inline double nowSeconds()
-{
-    return av_gettime_relative() / 1000000.0;
-}
-
 void FFmpegVideoPlayer::decodeThreadFunc()
 {
     qDebug() << "[FFmpeg] Decode thread started";
@@ -889,26 +1640,78 @@ void FFmpegVideoPlayer::decodeThreadFunc()
         QMutexLocker locker(&m_decodeMutex);
         
         // Wait for work or stop signal (block while paused)
-        while (m_decodeThreadRunning && (!m_isPlaying || m_isPaused)) {
+        // A seek while paused still decodes up to its target so scrubbing shows the exact frame,
+        // and frame steps decode while paused until their frame is cached
+        while (m_decodeThreadRunning && (!m_isPlaying || m_isPaused) &&
+               !(m_isPaused && (m_requestedSeekMs.load(std::memory_order_acquire) >= 0 ||
+                                m_seekPending.load(std::memory_order_acquire) ||
+                                m_requestedStep.load(std::memory_order_acquire) != 0 ||
+                                m_stepFill != NoStepFill))) {
             m_decodeCondition.wait(&m_decodeMutex, 100);
+            serveAudioTrackSwitch();  // Switch right away while paused/stopped, audio continues from there
         }
         
         if (!m_decodeThreadRunning) {
             break;
         }
         
+        serveAudioTrackSwitch();
+        
+        // Serve the latest seek request (earlier ones that arrived meanwhile were coalesced away)
+        const qint64 requestedSeekMs = m_requestedSeekMs.exchange(-1, std::memory_order_acq_rel);
+        if (requestedSeekMs >= 0) {
+            performSeek(requestedSeekMs);
+        }
+        
+        // Playing again after frame stepping: drop the stepping cache, and since decoder and audio are
+        // wherever stepping left them, restart exactly at the picture on screen (unless play() started over)
+        if (m_isPlaying && !m_isPaused &&
+            (m_stepFill != NoStepFill || !m_gopCache.isEmpty() || m_stepResync.load(std::memory_order_acquire))) {
+            const bool resync = m_stepResync.exchange(false, std::memory_order_acq_rel);
+            cancelStepFill();
+            m_gopCache.clear();
+            m_stepSalvage.clear();
+            m_requestedStep.store(0, std::memory_order_release);
+            double displayedPts = -1.0;
+            {
+                QMutexLocker guiLocker(&m_guiFrameMutex);
+                displayedPts = m_guiFramePts;
+            }
+            if (resync && displayedPts >= 0.0 && m_requestedSeekMs.load(std::memory_order_acquire) < 0) {
+                performSeek(static_cast<qint64>(displayedPts * 1000.0));
+            }
+        }
+        
+        // Serve frame steps (requestStep() pauses first); a busy fill or seek defers them
+        if (m_isPaused) {
+            const int requestedSteps = m_requestedStep.exchange(0, std::memory_order_acq_rel);
+            if (requestedSteps != 0 && !performStep(requestedSteps)) {
+                m_requestedStep.fetch_add(requestedSteps, std::memory_order_acq_rel);
+            }
+        }
+        
         // Unlock for decoding
         locker.unlock();
         
+        // Audio the full ring could not take earlier (never waits here - see pushAudio())
+        flushAudioBacklog(false);
+        
         if (!m_formatContext || !m_codecContext) {
             QThread::msleep(10);
             continue;
         }
+        if (m_openTrace.decodeStartUs == 0) {
+            m_openTrace.decodeStartUs = av_gettime_relative();
+        }
         
         // CRITICAL: Decode frames continuously - don't artificially slow down
         // QVideoSink + vsync will naturally pace frame presentation
         // Only decode one frame per iteration to prevent busy loop, but don't sleep aggressively
+        const qint64 decodeStart = m_benchmarkMode ? av_gettime_relative() : 0;
         int ret = avcodec_receive_frame(m_codecContext, m_frame);
+        if (m_benchmarkMode) {
+            m_benchDecodeUs.fetch_add(av_gettime_relative() - decodeStart, std::memory_order_relaxed);
+        }
         
         if (ret == 0) {
             // ✅ CRITICAL: Validate frame after receiving from decoder to prevent assertion crashes
@@ -946,189 +1749,24 @@ void FFmpegVideoPlayer::decodeThreadFunc()
                 } else if (m_frame->pts != AV_NOPTS_VALUE) {
                     framePts = m_frame->pts * av_q2d(m_videoStream->time_base);
                 }
+                if (framePts > 0.0) {
+                    m_lastDecodedVideoPts = framePts;
+                }
                 
-                // 🚨 DROP FRAMES AFTER SEEK UNTIL WE REACH TARGET
-                // FFmpeg seeks to a keyframe (usually before target), so we must discard
-                // frames until we reach the seek target PTS
-                if (m_seekPending.load(std::memory_order_acquire)) {
-                    constexpr double EPS = 0.0005; // 0.5ms tolerance
-                    // Drop frames with invalid/zero PTS or frames before target
-                    if (framePts <= 0.0 || framePts + EPS < m_seekTargetPts) {
-                        // Drop this frame - it's before the seek target or has invalid PTS
-                        FFLOG("[FFmpeg] Dropping frame before seek target - frame PTS:" << framePts 
-                                     << "target PTS:" << m_seekTargetPts);
-                        av_frame_unref(m_frame);
-                        continue; // Continue to next iteration (don't process this frame)
-                    } else {
-                        // First valid frame after seek - clear seek pending flag
-                        FFLOG("[FFmpeg] Reached seek target - frame PTS:" << framePts 
-                                 << "target PTS:" << m_seekTargetPts);
-                        m_seekPending.store(false, std::memory_order_release);
-                        m_timingInitialized = false; // Re-initialize timing cleanly for this frame
-                        
-                        // Continue processing this frame
-                        goto process_frame;
-                    }
-                } else {
-                    // Normal playback - check for late frames
-                    process_frame:
-                        
-                        // ✅ Hold video until audio is ready after seek (prevents A/V desync)
-                        // If audio exists and we just seeked, don't present video until audio is ready.
-                        // Otherwise video visibly "starts" early while audio is still catching up.
-                        if (m_audioCodecContext && m_holdVideoUntilAudio.load(std::memory_order_acquire)) {
-                            // While audio seek is pending (or base not set), drop video frames.
-                            // This keeps A/V start aligned after seeks.
-                            if (m_audioSeekPending.load(std::memory_order_acquire) || std::isnan(m_audioBasePts)) {
-                                FFLOG("[FFmpeg] Holding video frame until audio is ready - dropping frame PTS:" << framePts);
-                                av_frame_unref(m_frame);
-                                continue; // Drop this frame, wait for audio
-                            }
-                            // Audio is ready - clear the hold flag (only need to check once)
-                            m_holdVideoUntilAudio.store(false, std::memory_order_release);
-                            FFLOG("[FFmpeg] Audio ready - video presentation can now start");
-                        }
-                        
-                        // Initialize timing on first frame (or after seek)
-                    // CRITICAL: Initialize even if audio isn't ready yet - use wall clock
-                    if (!m_timingInitialized && framePts > 0.0) {
-                        m_startPts = framePts;        // absolute pts at start
-                        m_startTime = nowSeconds();   // wall time when that pts started
-                        m_timingInitialized = true;
-                        qDebug() << "[FFmpeg] Timing initialized - start time:" << m_startTime << "start PTS:" << m_startPts 
-                                 << "audio ready:" << (!std::isnan(m_audioBasePts) && m_audioSink);
-                    }
-                    
-                    // Frame pacing: sync to audio clock if available, otherwise use wall-clock
-                    if (m_timingInitialized && framePts > 0.0) {
-                        // ✅ FIX #2: Make AUDIO the master clock - always
-                        // ✅ OPTION A: Audio is ALWAYS master whenever audio exists
-                        // If we have audio, wait for it to be ready rather than using wall clock
-                        // This ensures no switching between clocks (prevents discontinuities)
-                        double masterClockAbs;
-                        if (m_audioSink && m_audioCodecContext) {
-                            // We have audio stream - audio is master (even if not ready yet)
-                            if (!std::isnan(m_audioBasePts) && m_audioDevice && m_audioDevice->isOpen()) {
-                                // ✅ FIX #2: Use delta from snapshot to prevent clock jump after seek
-                                // ✅ LATENCY COMPENSATION: Subtract queued audio to get audible position
-                                // processedUSecs() tells us what WASAPI has accepted, not what we hear
-                                // We need to subtract the buffered/queued audio to get the actual audible position
-                                
-                                // ✅ FIX: Clamp audio latency calculations to prevent clock jumps
-                                // WASAPI can report bytesFree() > bufferSize() or negative queued values,
-                                // causing master clock to jump ahead and drop all frames
-                                qint64 proc = 0;
-                                qint64 queuedUSecs = 0;
-                                qint64 deltaUSecs = 0;
-                                
-                                {
-                                    QMutexLocker audioLock(&m_audioMutex);
-                                    if (m_audioSink && m_audioDevice && m_audioDevice->isOpen()) {
-                                        proc = m_audioSink->processedUSecs();
-                                        const int bytesPerFrame = m_audioFormat.bytesPerFrame();
-                                        const int sampleRate = m_audioFormat.sampleRate();
-                                        
-                                        if (bytesPerFrame > 0 && sampleRate > 0) {
-                                            // Total buffer size in microseconds
-                                            const qint64 bufferUSecs = (qint64(m_audioSink->bufferSize()) * 1000000) / 
-                                                                       (bytesPerFrame * sampleRate);
-                                            
-                                            // Free space in microseconds - CLAMP to [0, bufferSize]
-                                            const qint64 freeUSecsRaw = (qint64(m_audioSink->bytesFree()) * 1000000) / 
-                                                                        (bytesPerFrame * sampleRate);
-                                            const qint64 freeClamped = qBound<qint64>(0, freeUSecsRaw, bufferUSecs);
-                                            
-                                            // Queued audio = what's buffered but not yet played
-                                            queuedUSecs = bufferUSecs - freeClamped;
-                                        }
-                                        
-                                        // Clamp delta - processedUSecs can jump when device starts/restarts
-                                        deltaUSecs = qMax<qint64>(0, proc - m_audioProcessedBaseUSecs);
-                                    }
-                                }
-                                
-                                // Audible delta = processed delta - queued latency
-                                const double audibleDelta = double(deltaUSecs - queuedUSecs) / 1000000.0;
-                                
-                                m_audioClock = m_audioBasePts + audibleDelta;
-                                masterClockAbs = m_audioClock;
-                            } else {
-                                // Audio exists but not ready yet (e.g., after seek, before first frame)
-                                // Use wall clock temporarily, but audio will become master once ready
-                                // This prevents frames from being dropped unnecessarily while audio initializes
-                                masterClockAbs = m_startPts + (nowSeconds() - m_startTime);
-                            }
-                        } else {
-                            // No audio stream at all - use wall clock
-                            masterClockAbs = m_startPts + (nowSeconds() - m_startTime);
-                        }
-                        
-                        // Video clock in ABSOLUTE stream seconds
-                        double videoClockAbs = framePts;
-                        
-                        // ✅ FIX #3: Only drop frames if they're WAY behind (300ms+)
-                        // BUT: Skip dropping for first 500ms of playback to allow A/V sync to stabilize
-                        // This prevents "never starts" issue when audio clock initializes ahead of video
-                        double timeSincePlayStart = nowSeconds() - m_playStartWallTime;
-                        bool inGraceWindow = (timeSincePlayStart < 0.5) && (m_playStartWallTime > 0.0);
-                        
-                        if (!inGraceWindow && videoClockAbs < masterClockAbs - 0.3) {
-                            qDebug() << "[FFmpeg] Dropping very late frame - video:" << videoClockAbs << "master:" << masterClockAbs 
-                                     << "diff:" << (videoClockAbs - masterClockAbs);
-                            av_frame_unref(m_frame);
-                            continue; // Skip to next iteration (before any expensive processing)
-                        }
-                        
-                        double delay = videoClockAbs - masterClockAbs;
-                        
-                        // ✅ CRITICAL FIX: Pace decode loop to prevent decoding all frames instantly
-                        // If we're ahead, sleep for frame duration to slow down decode loop to realtime speed
-                        // Normal frames arriving 50-150ms early don't need sleep - QVideoSink handles that
-                        // Only sleep if significantly ahead (>200ms) to prevent decode loop from running too fast
-                        if (delay > 0.2) {
-                            // Calculate frame duration from stream (assume 30fps if unknown)
-                            double frameDuration = 0.0333; // Default 30fps
-                            if (m_videoStream && m_videoStream->avg_frame_rate.num > 0 && m_videoStream->avg_frame_rate.den > 0) {
-                                frameDuration = 1.0 / av_q2d(m_videoStream->avg_frame_rate);
-                            }
-                            // Sleep for one frame duration to pace decode loop
-                            // This prevents decode loop from decoding all frames instantly
-                            int64_t sleep_us = static_cast<int64_t>(frameDuration * 1000000);
-                            av_usleep(sleep_us);
-                        }
-                        // For normal delays (<200ms), don't sleep - frames are within normal buffer range
-                        
-                        // Only reset timing if way behind (catch-up scenario)
-                        if (delay < -0.3) {
-                            // More than 200ms behind - reset timing to catch up
-                            qDebug() << "[FFmpeg] Frame way behind, resetting timing - delay:" << delay;
-                            if (m_audioSink && m_audioClock > 0.0 && m_audioDevice && m_audioDevice->isOpen()) {
-                                // Sync to audio clock (absolute)
-                                m_startPts = framePts - m_audioClock;
-                                m_startTime = nowSeconds();
-                            } else {
-                                // Sync to wall-clock
-                                m_startTime = nowSeconds();
-                                m_startPts = framePts;
-                            }
-                        }
-                        
-                        // Update position (in milliseconds) - use absolute clock
-                        m_position = static_cast<qint64>(masterClockAbs * 1000.0);
-                        emit positionChanged();
-                        
-                        // Debug logging for timing (only log every 30 frames to avoid spam)
-                        static int frameCount = 0;
-                        if ((frameCount++ % 30) == 0) {
-                            qDebug() << "[FFmpeg] Frame timing - video:" << videoClockAbs 
-                                     << "master:" << masterClockAbs 
-                                     << "delay:" << delay 
-                                     << "audio:" << (!std::isnan(m_audioBasePts) && m_audioSink && m_audioDevice && m_audioDevice->isOpen());
-                        }
-                    }
+                // Interlaced frames come out of the deinterlacer one frame later - their seek, step and
+                // rate decisions are made in processFrame() by the PTS of the frame it actually outputs
+                m_deferVideoAdmission = m_deinterlaceMode.load(std::memory_order_relaxed) != DeinterlaceOff &&
+                                        FFmpegDeinterlacer::isInterlaced(m_frame);
+                if (!m_deferVideoAdmission && !admitVideoFrame(framePts)) {
+                    av_frame_unref(m_frame);
+                    continue;
                 }
             }
                 
+            // Benchmark: everything from here to the unref is conversion, except the hardware download
+            const qint64 convertStart = m_benchmarkMode ? av_gettime_relative() : 0;
+            const qint64 transferBefore = m_benchTransferUs.load(std::memory_order_relaxed);
+            
             // Process frame - now handles system memory formats (NV12, YUV420P, BGRA)
             // FFmpeg uses D3D11VA internally for hardware decode, but outputs CPU-visible frames
             // This is the stable QVideoSink path - no D3D11 texture handling
@@ -1144,10 +1782,26 @@ void FFmpegVideoPlayer::decodeThreadFunc()
                 if (m_transferFrame && m_codecContext->hw_device_ctx) {
                     av_frame_unref(m_transferFrame);  // Clear previous frame data before reuse
                     
+                    // Transfer into a pooled destination buffer (no per-frame heap allocation)
+                    // If the pool can't serve it, av_hwframe_transfer_data() allocates as before
+                    if (m_frame->hw_frames_ctx) {
+                        const auto* framesCtx = reinterpret_cast<const AVHWFramesContext*>(m_frame->hw_frames_ctx->data);
+                        m_transferFrame->format = framesCtx->sw_format;
+                        m_transferFrame->width = m_frame->width;
+                        m_transferFrame->height = m_frame->height;
+                        if (m_framePool.allocFrame(m_transferFrame) < 0) {
+                            av_frame_unref(m_transferFrame);
+                        }
+                    }
+                    
                     // ✅ CRITICAL: Transfer D3D11 texture to system memory
                     // Use flags=0 (default) - AV_HWFRAME_TRANSFER_DIRECTION_FROM is not a valid flag value
                     // The direction is implicit (from hardware to system memory)
+                    const qint64 transferStart = m_benchmarkMode ? av_gettime_relative() : 0;
                     int ret = av_hwframe_transfer_data(m_transferFrame, m_frame, 0);
+                    if (m_benchmarkMode) {
+                        m_benchTransferUs.fetch_add(av_gettime_relative() - transferStart, std::memory_order_relaxed);
+                    }
                     if (ret == 0) {
                         // ✅ Reset consecutive failure counter on success
                         static int consecutiveFailures = 0;
@@ -1168,20 +1822,35 @@ void FFmpegVideoPlayer::decodeThreadFunc()
                             m_transferFrame->pkt_pos = m_frame->pkt_pos;
                             // duration is now stored in duration field (not pkt_duration)
                             m_transferFrame->duration = m_frame->duration;
+                            // Interlaced/field order flags - the deinterlacer needs them
+                            m_transferFrame->flags = m_frame->flags;
+#if LIBAVUTIL_VERSION_MAJOR < 59
+                            m_transferFrame->interlaced_frame = m_frame->interlaced_frame;
+                            m_transferFrame->top_field_first = m_frame->top_field_first;
+#endif
                         }
                         
-                        // ✅ CRITICAL: Set HDR color metadata IMMEDIATELY after D3D11 transfer
-                        // D3D11 → CPU transfer loses metadata, and we MUST set it before ANY frame touches the filter graph
-                        // This prevents "unknown range/colorspace" frames from locking the graph in an invalid state
+                        // ✅ CRITICAL: Restore color metadata IMMEDIATELY after D3D11 transfer
+                        // D3D11 → CPU transfer loses it - take the decoder's values (and HDR10 side data)
+                        // so processFrame can tell HDR (tone map) from 10-bit SDR (passthrough)
                         if (transferredFormat == AV_PIX_FMT_P010LE || 
                             transferredFormat == AV_PIX_FMT_YUV420P10LE) {
-                            // Set HDR metadata on frame BEFORE it goes to processFrame
-                            m_transferFrame->color_range = AVCOL_RANGE_MPEG;
-                            m_transferFrame->color_primaries = AVCOL_PRI_BT2020;
-                            m_transferFrame->color_trc = AVCOL_TRC_SMPTE2084;
-                            m_transferFrame->colorspace = AVCOL_SPC_BT2020_NCL;
-                            // Convert 10-bit → 8-bit NV12 (Qt supports NV12)
-                            processFrame(m_transferFrame);  // processFrame will handle the conversion
+                            m_transferFrame->color_range = m_frame->color_range != AVCOL_RANGE_UNSPECIFIED
+                                ? m_frame->color_range : AVCOL_RANGE_MPEG;
+                            m_transferFrame->color_primaries = m_frame->color_primaries;
+                            m_transferFrame->color_trc = m_frame->color_trc;
+                            m_transferFrame->colorspace = m_frame->colorspace;
+                            for (int i = 0; i < m_frame->nb_side_data; ++i) {
+                                const AVFrameSideData* sd = m_frame->side_data[i];
+                                if (sd->type == AV_FRAME_DATA_MASTERING_DISPLAY_METADATA ||
+                                    sd->type == AV_FRAME_DATA_CONTENT_LIGHT_LEVEL) {
+                                    if (AVFrameSideData* copy = av_frame_new_side_data(m_transferFrame, sd->type, sd->size)) {
+                                        std::memcpy(copy->data, sd->data, sd->size);
+                                    }
+                                }
+                            }
+                            // HDR → tone mapped NV12, 10-bit SDR → P010 passthrough
+                            processFrame(m_transferFrame);
                         } else if (transferredFormat == AV_PIX_FMT_NV12 || 
                                    transferredFormat == AV_PIX_FMT_YUV420P ||
                                    transferredFormat == AV_PIX_FMT_BGRA) {
@@ -1227,7 +1896,9 @@ void FFmpegVideoPlayer::decodeThreadFunc()
                 } else {
                     qWarning() << "[FFmpeg] Cannot transfer D3D11 frame - missing transfer frame or context";
                 }
-            } else if (m_frame->format == AV_PIX_FMT_CUDA) {
+            }
+#ifdef Q_OS_WIN
+            else if (m_frame->format == AV_PIX_FMT_CUDA) {
                 // CUDA frame (shouldn't happen with D3D11VA, but handle it if it does)
                 FFLOG("[FFmpeg] Received CUDA frame (unexpected with D3D11VA)");
                 ID3D11Texture2D* d3d11Texture = nullptr;
@@ -1258,13 +1929,23 @@ void FFmpegVideoPlayer::decodeThreadFunc()
                     }
                 }
             }
+#endif
                 
+            if (m_benchmarkMode) {
+                const qint64 transferUs = m_benchTransferUs.load(std::memory_order_relaxed) - transferBefore;
+                m_benchConvertUs.fetch_add(av_gettime_relative() - convertStart - transferUs, std::memory_order_relaxed);
+            }
             av_frame_unref(m_frame);
+            publishPeriodicStatistics();
         } else if (ret == AVERROR(EAGAIN)) {
             // Decoder needs more input - read and send packets
             {
                 QMutexLocker demuxLocker(&m_demuxMutex);
+                const qint64 demuxStart = m_benchmarkMode ? av_gettime_relative() : 0;
                 ret = av_read_frame(m_formatContext, m_packet);
+                if (m_benchmarkMode) {
+                    m_benchDemuxUs.fetch_add(av_gettime_relative() - demuxStart, std::memory_order_relaxed);
+                }
             }
             
             if (ret == AVERROR_EOF) {
@@ -1293,9 +1974,42 @@ void FFmpegVideoPlayer::decodeThreadFunc()
                 qWarning() << "[FFmpeg] av_read_frame error:" << ret;
                 QThread::msleep(10);
             } else {
+                if (m_openTrace.firstPacketUs < 0) {
+                    m_openTrace.firstPacketUs = av_gettime_relative() - m_openTrace.decodeStartUs;
+                }
+                
+                // Subtitle cues ride along with playback (not while filling the stepping cache or re-reading
+                // after an audio track switch - both go over packets that were already demuxed)
+                if (m_stepFill == NoStepFill && m_videoReplayUntilPos < 0) {
+                    demuxSubtitles(m_packet);
+                }
+                
                 // Valid packet - process video or audio stream
-                if (m_packet->stream_index == m_videoStreamIndex) {
+                if (m_packet->stream_index == m_videoStreamIndex && dropReplayedVideoPacket(m_packet)) {
+                    // Re-read after an audio track switch - the video decoder already has it
+                } else if (m_packet->stream_index == m_videoStreamIndex && dropSuspendedVideoPacket(m_packet)) {
+                    // Window minimized - audio only
+                    m_videoPacketsSkipped.fetch_add(1, std::memory_order_relaxed);
+                } else if (m_packet->stream_index == m_videoStreamIndex) {
+                    // Decoding forward to a seek target: skip non-reference frames displayed before it
+                    // (nothing predicts from them and they would be dropped anyway)
+                    // Same when fast playback outruns the decoder (see skipFrameForRate())
+                    AVDiscard skipFrame = AVDISCARD_DEFAULT;
+                    if (m_seekPending.load(std::memory_order_acquire) && m_packet->pts != AV_NOPTS_VALUE &&
+                        m_packet->pts * av_q2d(m_videoStream->time_base) + 0.0005 < m_seekTargetPts) {
+                        skipFrame = AVDISCARD_NONREF;
+                    } else if (m_rateSkipNonRef && m_stepFill == NoStepFill && !m_isPaused) {
+                        skipFrame = AVDISCARD_NONREF;
+                    }
+                    if (m_codecContext->skip_frame != skipFrame) {
+                        m_codecContext->skip_frame = skipFrame;
+                    }
+                    
+                    const qint64 sendStart = m_benchmarkMode ? av_gettime_relative() : 0;
                     ret = avcodec_send_packet(m_codecContext, m_packet);
+                    if (m_benchmarkMode) {
+                        m_benchDecodeUs.fetch_add(av_gettime_relative() - sendStart, std::memory_order_relaxed);
+                    }
                     FFLOG("[FFmpeg] send_packet ret:" << ret
                              << "pkt pts:" << m_packet->pts
                              << "dts:" << m_packet->dts
@@ -1322,13 +2036,14 @@ void FFmpegVideoPlayer::decodeThreadFunc()
                         }
                         // Continue to next packet - decoder might recover
                     }
-                } else if (m_packet->stream_index == m_audioStreamIndex && m_audioCodecContext) {
-                    // Handle audio packet
+                } else if (m_packet->stream_index == m_audioStreamIndex && m_audioCodecContext &&
+                           m_stepFill == NoStepFill) {
+                    // Handle audio packet (not while filling the stepping cache - audio re-syncs on resume)
                     ret = avcodec_send_packet(m_audioCodecContext, m_packet);
                     if (ret == 0) {
                         // Decode audio frames
                         while (avcodec_receive_frame(m_audioCodecContext, m_audioFrame) == 0) {
-                            if (!m_swr || !m_audioDevice) {
+                            if (!m_swr || !m_audioRing) {
                                 av_frame_unref(m_audioFrame);
                                 continue;
                             }
@@ -1351,15 +2066,33 @@ void FFmpegVideoPlayer::decodeThreadFunc()
                                 }
                                 
                                 // ✅ First good audio frame after seek - clear seek pending and set clock
+                                // Anything still queued in the ring belongs to the old position - the sink skips it,
+                                // and the clock counts consumed bytes from this frame's first byte
+                                bool clockWasValid = false;
+                                const double clockBefore = audioClockSeconds(&clockWasValid);  // Track switch: old track audible
                                 m_audioSeekPending.store(false, std::memory_order_release);
-                                m_audioBasePts = aPts;  // Set audio base PTS immediately
-                                m_audioClock = aPts;    // Initialize clock to frame PTS
-                                
-                                // ✅ FIX #2: Rebase processedUSecs() to this moment (prevents clock jump from old playback)
-                                // Snapshot the current processedUSecs() so we can compute delta from this point
                                 {
-                                    QMutexLocker audioLock(&m_audioMutex);
-                                    m_audioProcessedBaseUSecs = m_audioSink ? m_audioSink->processedUSecs() : 0;
+                                    QMutexLocker clockLocker(&m_audioClockMutex);
+                                    m_audioBaseBytePos = m_audioRing->discardQueued();
+                                    m_audioPushBacklog.clear();
+                                    m_audioBasePts = aPts;  // Set audio base PTS immediately
+                                    m_audioClock = aPts;    // Initialize clock to frame PTS
+                                    m_audioPrevBasePts = NAN;  // Older segments were discarded with the queue
+                                    if (clockWasValid && m_audioBaseBytePos >= quint64(m_audioSinkBufferBytes)) {
+                                        // Audio track switch: what the old track left in the sink buffer keeps
+                                        // the clock running until the new track is heard
+                                        m_audioPrevBasePts = clockBefore;
+                                        m_audioPrevBaseBytePos = m_audioBaseBytePos - quint64(m_audioSinkBufferBytes);
+                                        m_audioPrevRate = m_audioRate;
+                                    }
+                                }
+                                m_timeStretch.reset();
+                                
+                                if (m_audioSwitchStartTime > 0.0) {
+                                    const double switchMs = (nowSeconds() - m_audioSwitchStartTime) * 1000.0;
+                                    m_audioSwitchStartTime = 0.0;
+                                    setStatistic("lastAudioSwitchMs", switchMs);
+                                    qDebug() << "[FFmpeg] Audio track switch in sync after" << switchMs << "ms - PTS:" << aPts;
                                 }
                                 
                                 // ✅ Clear video hold flag - audio is now ready, video can start presenting
@@ -1367,23 +2100,50 @@ void FFmpegVideoPlayer::decodeThreadFunc()
                                 
                                 qDebug() << "[FFmpeg] First good audio frame after seek - PTS:" << aPts 
                                          << "target:" << m_audioSeekTargetSec
-                                         << "processedBaseUSecs:" << m_audioProcessedBaseUSecs
+                                         << "ring base:" << m_audioBaseBytePos
                                          << "(video hold cleared)";
                             }
                             
-                            // Flush any remainder from previous write
-                            if (!m_audioRemainder.isEmpty()) {
-                                QMutexLocker audioLock(&m_audioMutex);
-                                if (m_audioSink && m_audioDevice && m_audioDevice->isOpen()) {
-                                    int freeBytes = m_audioSink->bytesFree();
-                                    if (freeBytes > 0) {
-                                        int toWrite = qMin(freeBytes, m_audioRemainder.size());
-                                        qint64 written = m_audioDevice->write(m_audioRemainder.constData(), toWrite);
-                                        if (written > 0) {
-                                            m_audioRemainder.remove(0, written);
-                                        }
-                                    }
+                            // Audio base PTS from the first frame (if not already set by seek)
+                            // Set BEFORE pushing so the base byte position is this frame's first byte
+                            if (!hasAudioClockBase() && !m_audioSeekPending.load(std::memory_order_acquire)) {
+                                double ptsSec = NAN;
+                                AVStream* audioStream = m_formatContext->streams[m_audioStreamIndex];
+                                if (m_audioFrame->best_effort_timestamp != AV_NOPTS_VALUE) {
+                                    ptsSec = m_audioFrame->best_effort_timestamp * av_q2d(audioStream->time_base);
+                                } else if (m_audioFrame->pts != AV_NOPTS_VALUE) {
+                                    ptsSec = m_audioFrame->pts * av_q2d(audioStream->time_base);
                                 }
+                                
+                                if (!std::isnan(ptsSec)) {
+                                    QMutexLocker clockLocker(&m_audioClockMutex);
+                                    m_audioBaseBytePos = m_audioRing->discardQueued();
+                                    m_audioPushBacklog.clear();
+                                    m_audioBasePts = ptsSec;
+                                    m_audioClock = ptsSec;  // Initialize clock
+                                    m_audioPrevBasePts = NAN;
+                                    m_timeStretch.reset();
+                                }
+                            }
+                            
+                            // Playback rate changed: audio from this frame on is stretched at the new rate and
+                            // starts a new clock segment (audio already in the ring keeps playing at the old one)
+                            const double rate = m_playbackRate.load(std::memory_order_relaxed);
+                            if (rate != m_timeStretch.rate()) {
+                                m_timeStretch.setRate(rate);
+                                AVStream* audioStream = m_formatContext->streams[m_audioStreamIndex];
+                                const int64_t ts = m_audioFrame->best_effort_timestamp != AV_NOPTS_VALUE
+                                    ? m_audioFrame->best_effort_timestamp : m_audioFrame->pts;
+                                QMutexLocker clockLocker(&m_audioClockMutex);
+                                if (!std::isnan(m_audioBasePts) && ts != AV_NOPTS_VALUE &&
+                                    m_audioRing->writePosition() != m_audioBaseBytePos) {
+                                    m_audioPrevBasePts = m_audioBasePts;
+                                    m_audioPrevBaseBytePos = m_audioBaseBytePos;
+                                    m_audioPrevRate = m_audioRate;
+                                    m_audioBaseBytePos = m_audioRing->writePosition();
+                                    m_audioBasePts = ts * av_q2d(audioStream->time_base);
+                                }
+                                m_audioRate = rate;
                             }
                             
                             // ✅ CRITICAL FIX: Use OUTPUT channel count, not input channel count
@@ -1392,13 +2152,13 @@ void FFmpegVideoPlayer::decodeThreadFunc()
                             const int outChannels = m_audioFormat.channelCount();  // Output channels (what we're resampling TO)
                             const int outBps = outChannels * sizeof(int16_t);      // Bytes per sample (output format)
                             
-                            // Calculate output buffer size
+                            // Calculate output buffer size (conversion buffer is reused across frames)
                             int outSamples = swr_get_out_samples(m_swr, m_audioFrame->nb_samples);
                             int outBufferSize = outSamples * outBps;  // Use output bytes per sample
-                            
-                            QByteArray buffer;
-                            buffer.resize(outBufferSize);
-                            uint8_t* outData[1] = { reinterpret_cast<uint8_t*>(buffer.data()) };
+                            if (m_audioConvertBuffer.size() < outBufferSize) {
+                                m_audioConvertBuffer.resize(outBufferSize);
+                            }
+                            uint8_t* outData[1] = { reinterpret_cast<uint8_t*>(m_audioConvertBuffer.data()) };
                             
                             // Resample audio
                             int samplesConverted = swr_convert(
@@ -1410,61 +2170,19 @@ void FFmpegVideoPlayer::decodeThreadFunc()
                             );
                             
                             if (samplesConverted > 0) {
-                                int bytes = samplesConverted * outBps;  // Use output bytes per sample
+                                const char* pcm = m_audioConvertBuffer.constData();
+                                qint64 bytes = qint64(samplesConverted) * outBps;  // Use output bytes per sample
                                 
-                                // Write to audio device (non-blocking with bytesFree check)
-                                // ✅ FIX: Protect all audio device/sink access with mutex
-                                {
-                                    QMutexLocker audioLock(&m_audioMutex);
-                                    if (m_audioSink && m_audioDevice && m_audioDevice->isOpen()) {
-                                        int freeBytes = m_audioSink->bytesFree();
-                                        if (freeBytes > 0) {
-                                            int toWrite = qMin(freeBytes, bytes);
-                                            qint64 written = m_audioDevice->write(buffer.constData(), toWrite);
-                                            
-                                            // If we couldn't write everything, keep the remainder for later
-                                            if (written < bytes) {
-                                                m_audioRemainder = buffer.mid(written, bytes - written);
-                                            } else if (!m_audioRemainder.isEmpty() && written == toWrite) {
-                                                // Try to write remainder if we wrote everything
-                                                int remainderFree = m_audioSink->bytesFree();
-                                                if (remainderFree > 0) {
-                                                    int remainderToWrite = qMin(remainderFree, m_audioRemainder.size());
-                                                    qint64 remainderWritten = m_audioDevice->write(m_audioRemainder.constData(), remainderToWrite);
-                                                    if (remainderWritten > 0) {
-                                                        m_audioRemainder.remove(0, remainderWritten);
-                                                    }
-                                                }
-                                            }
-                                        } else {
-                                            // Buffer full - store remainder
-                                            m_audioRemainder = buffer;
-                                        }
-                                    }
-                                }
-                                
-                                // Update audio base PTS from frame timestamps (first frame only, if not already set by seek)
-                                if (std::isnan(m_audioBasePts) && !m_audioSeekPending.load(std::memory_order_acquire)) {
-                                    double ptsSec = NAN;
-                                    AVStream* audioStream = m_formatContext->streams[m_audioStreamIndex];
-                                    if (m_audioFrame->best_effort_timestamp != AV_NOPTS_VALUE) {
-                                        ptsSec = m_audioFrame->best_effort_timestamp * av_q2d(audioStream->time_base);
-                                    } else if (m_audioFrame->pts != AV_NOPTS_VALUE) {
-                                        ptsSec = m_audioFrame->pts * av_q2d(audioStream->time_base);
-                                    }
-                                    
-                                    if (!std::isnan(ptsSec)) {
-                                        m_audioBasePts = ptsSec;
-                                        m_audioClock = ptsSec;  // Initialize clock
-                                        // ✅ Also snapshot processedUSecs() for initial playback (not just after seek)
-                                        {
-                                            QMutexLocker audioLock(&m_audioMutex);
-                                            m_audioProcessedBaseUSecs = m_audioSink ? m_audioSink->processedUSecs() : 0;
-                                        }
-                                    }
+                                // Off 1x: WSOLA time stretch (1/rate as long, same pitch)
+                                if (!m_timeStretch.isBypassed()) {
+                                    m_audioStretchBuffer.resize(0);
+                                    m_timeStretch.process(reinterpret_cast<const int16_t*>(pcm), samplesConverted, &m_audioStretchBuffer);
+                                    pcm = m_audioStretchBuffer.constData();
+                                    bytes = m_audioStretchBuffer.size();
                                 }
                                 
-                                // Audio clock is now updated from QAudioSink->processedUSecs() in video sync block
+                                // Push into the ring (lock-free, the sink pulls on its own thread)
+                                pushAudio(pcm, bytes);
                             }
                             
                             av_frame_unref(m_audioFrame);
@@ -1478,7 +2196,13 @@ void FFmpegVideoPlayer::decodeThreadFunc()
         } else if (ret == AVERROR_EOF) {
             // Decoder fully drained
             FFLOG("[FFmpeg] Decoder fully drained (EOF)");
+            drainDeinterlacer();  // Last interlaced frame was held back for look-ahead
             m_decoderDrained = true;
+            if (m_stepFill != NoStepFill) {
+                // Stepping ran into the end of the stream - serve what the fill decoded and stay paused
+                finishStepFill();
+                continue;
+            }
             {
                 QMutexLocker stateLocker(&m_decodeMutex);
                 m_isPlaying = false;
@@ -1667,9 +2391,9 @@ bool FFmpegVideoPlayer::initVideoProcessor(uint32_t width, uint32_t height)
 #endif
 }
 
+#ifdef Q_OS_WIN
 bool FFmpegVideoPlayer::transferCUDAToD3D11(AVFrame* cudaFrame, ID3D11Texture2D** outTexture)
 {
-#ifdef Q_OS_WIN
     if (!cudaFrame || cudaFrame->format != AV_PIX_FMT_CUDA || !outTexture || !m_swFrame) {
         return false;
     }
@@ -1721,796 +2445,923 @@ bool FFmpegVideoPlayer::transferCUDAToD3D11(AVFrame* cudaFrame, ID3D11Texture2D*
     
     qDebug() << "[FFmpeg] Transferred CUDA frame to D3D11 texture:" << width << "x" << height;
     return true;
-#else
-    return false;
-#endif
 }
+#endif
 
-bool FFmpegVideoPlayer::initHDRToneMappingFilter(int width, int height, AVPixelFormat inputFormat, int displayWidth, int displayHeight)
+void FFmpegVideoPlayer::processFrame(AVFrame* frame)
 {
-    // Cleanup any existing filter graph
-    cleanupHDRToneMappingFilter();
-    
-    // Allocate filter graph
-    m_filterGraph = avfilter_graph_alloc();
-    if (!m_filterGraph) {
-        qWarning() << "[FFmpeg] Failed to allocate filter graph for HDR tone mapping";
-        return false;
+    if (!frame) {
+        return;
     }
     
-    // ✅ CRITICAL: Buffer source args must be MINIMAL - color metadata goes on AVFrame, not buffer
-    // D3D11 → CPU transfer loses color metadata, so we set it on the frame before pushing
-    // Buffer filter only needs: video_size, pix_fmt, time_base
-    char args[512];
-    snprintf(args, sizeof(args),
-             "video_size=%dx%d:"
-             "pix_fmt=%d:"
-             "time_base=1/1000",
-             width, height, (int)inputFormat);
+    // Interlaced frames: deinterlaced at full resolution first (scaling a combed frame smears the fields)
+    // The deinterlacer holds one frame back and feeds its outputs through here again
+    if (!m_inDeinterlacedOutput && deinterlaceFrame(frame)) {
+        return;
+    }
     
-    qDebug() << "[FFmpeg] Creating HDR tone mapping filter graph with buffer args:" << args;
+    // Decisions the decode loop left to this point (interlaced input): taken once, by this frame's own PTS
+    if (m_deferVideoAdmission) {
+        m_deferVideoAdmission = false;
+        double framePts = 0.0;
+        if (frame->best_effort_timestamp != AV_NOPTS_VALUE) {
+            framePts = frame->best_effort_timestamp * av_q2d(m_videoStream->time_base);
+        } else if (frame->pts != AV_NOPTS_VALUE) {
+            framePts = frame->pts * av_q2d(m_videoStream->time_base);
+        }
+        if (!admitVideoFrame(framePts)) {
+            return;
+        }
+    }
     
-    int ret = avfilter_graph_create_filter(&m_filterSrcCtx,
-                                          avfilter_get_by_name("buffer"),
-                                          "in", args, nullptr, m_filterGraph);
-    if (ret < 0) {
-        char errbuf[AV_ERROR_MAX_STRING_SIZE];
-        av_strerror(ret, errbuf, sizeof(errbuf));
-        qWarning() << "[FFmpeg] Failed to create buffer source filter:" << errbuf;
-        avfilter_graph_free(&m_filterGraph);
-        return false;
+    // Small window: scale once, before tone mapping and upload, to what is actually shown
+    // (FFmpegVideoBuffer takes its own reference, so the scaled frame can be unref'd right away)
+    if (AVFrame* scaled = scaleForDisplay(frame)) {
+        m_inScaledOutput = true;
+        processFrame(scaled);
+        m_inScaledOutput = false;
+        av_frame_unref(scaled);
+        return;
     }
     
-    // ✅ CRITICAL: Set buffer source parameters (format, dimensions, timing)
-    // NOTE: AVBufferSrcParameters does NOT support color metadata fields in FFmpeg 7.x
-    // Color metadata MUST be set on AVFrame (which we do in processFrame before pushing)
-    // This just locks the basic format/dimensions to prevent mismatches
-    AVBufferSrcParameters* params = av_buffersrc_parameters_alloc();
-    if (params) {
-        params->format = inputFormat;
-        params->width = width;
-        params->height = height;
-        params->time_base = {1, 1000};
-        params->sample_aspect_ratio = {1, 1};
+    // ✅ Handle 10-bit HDR frames (Dolby Vision, HEVC Main10) - native HDR → SDR tone mapping
+    // PQ/HLG content would look washed out on an SDR surface, so it is tone mapped before display
+    // FFmpegToneMapper goes straight from P010/YUV420P10 to pooled NV12 (LUTs + SSE2, sliced across threads)
+    // instead of the zscale → tonemap → zscale graph that round-tripped every pixel through float RGB
+    // 10-bit SDR (BT.709 / unspecified transfer, e.g. Main10 anime encodes) skips the mapper entirely:
+    // P010 / YUV420P10 planes go to Qt untouched as Format_P010 / Format_YUV420P10 (zero passes)
+    AVPixelFormat frameFormat = (AVPixelFormat)frame->format;
+    if (FFmpegToneMapper::canProcess(frameFormat) && FFmpegToneMapper::isHdrTransfer(frame)) {
+        if (frame->width <= 0 || frame->height <= 0) {
+            return;
+        }
         
-        ret = av_buffersrc_parameters_set(m_filterSrcCtx, params);
-        av_free(params);
+        if (!m_toneMapper) {
+            m_toneMapper = std::make_unique<FFmpegToneMapper>();
+            setStatistic("toneMapper", QStringLiteral("native-lut"));
+            setStatistic("toneMapThreads", m_toneMapper->threadCount());
+            qDebug() << "[FFmpeg] Native HDR tone mapper ready:" << frame->width << "x" << frame->height
+                     << "from" << av_get_pix_fmt_name(frameFormat) << "to NV12 (PQ/HLG BT.2020 → hable → BT.709),"
+                     << m_toneMapper->threadCount() << "threads";
+        }
+        if (!m_toneMappedFrame) {
+            m_toneMappedFrame = av_frame_alloc();
+            if (!m_toneMappedFrame) {
+                qWarning() << "[FFmpeg] Failed to allocate tone mapping output frame";
+                return;
+            }
+        }
         
-        if (ret < 0) {
-            char errbuf[AV_ERROR_MAX_STRING_SIZE];
-            av_strerror(ret, errbuf, sizeof(errbuf));
-            qWarning() << "[FFmpeg] Failed to set buffer source parameters:" << errbuf;
-            // Continue anyway - frame metadata should still work
-        } else {
-            qDebug() << "[FFmpeg] Locked buffer source parameters (format/dimensions)";
+        // Output keeps the source pts/duration (copied by the mapper)
+        if (!m_toneMapper->process(frame, m_toneMappedFrame)) {
+            static int toneMapFailures = 0;
+            if (++toneMapFailures <= 5) {
+                qWarning() << "[FFmpeg] Tone mapping failed for" << frame->width << "x" << frame->height
+                           << av_get_pix_fmt_name(frameFormat) << "frame - skipping";
+            }
+            return;
         }
+        
+        // Tone-mapped NV12 output goes through the zero-copy path below
+        // (FFmpegVideoBuffer takes its own reference, so m_toneMappedFrame can be unref'd right away)
+        processFrame(m_toneMappedFrame);
+        av_frame_unref(m_toneMappedFrame);
+        return;
     }
     
-    // ✅ OPTIMIZATION 1: Scale down early if display is smaller than source (or if source is very large)
-    // Don't tonemap full 4K if display is 960x720 - scale down first to reduce expensive processing
-    int processWidth = width;
-    int processHeight = height;
-    bool needsScale = false;
+    // For QVideoSink: Handle system memory frames (NV12, YUV420P, P010, YUV420P10, BGRA)
+    // FFmpeg uses D3D11VA internally for hardware decode, but outputs CPU-visible frames
+    // Frames are handed to Qt zero-copy: FFmpegVideoBuffer holds an AVFrame reference
+    // and exposes the decoder's planes directly (no QVideoFrame allocation, no memcpy)
+    
+    int width = frame->width;
+    int height = frame->height;
     
-    if (displayWidth > 0 && displayHeight > 0 && (displayWidth < width || displayHeight < height)) {
-        // Scale to display size (with aspect ratio preserved)
-        double aspect = (double)width / height;
-        if (displayWidth / aspect <= displayHeight) {
-            processWidth = displayWidth;
-            processHeight = (int)(displayWidth / aspect);
-        } else {
-            processWidth = (int)(displayHeight * aspect);
-            processHeight = displayHeight;
-        }
-        needsScale = true;
-        qDebug() << "[FFmpeg] Scaling down from" << width << "x" << height 
-                 << "to" << processWidth << "x" << processHeight << "before HDR processing";
-    } else if (width > 1920 || height > 1080) {
-        // If source is larger than 1080p, scale to 1080p max (reasonable intermediate size)
-        double aspect = (double)width / height;
-        if (width > height) {
-            processWidth = 1920;
-            processHeight = (int)(1920 / aspect);
-        } else {
-            processHeight = 1080;
-            processWidth = (int)(1080 * aspect);
-        }
-        needsScale = true;
-        qDebug() << "[FFmpeg] Scaling down from" << width << "x" << height 
-                 << "to" << processWidth << "x" << processHeight << "before HDR processing (1080p max)";
-    }
-    
-    // Scale filter (early, before expensive HDR processing)
-    AVFilterContext* scaleCtx = nullptr;
-    if (needsScale) {
-        char scaleArgs[256];
-        snprintf(scaleArgs, sizeof(scaleArgs), "w=%d:h=%d:flags=fast_bilinear", processWidth, processHeight);
-        ret = avfilter_graph_create_filter(&scaleCtx,
-                                          avfilter_get_by_name("scale"),
-                                          "scale", scaleArgs, nullptr, m_filterGraph);
-        if (ret < 0) {
-            char errbuf[AV_ERROR_MAX_STRING_SIZE];
-            av_strerror(ret, errbuf, sizeof(errbuf));
-            qWarning() << "[FFmpeg] Failed to create scale filter:" << errbuf;
-            avfilter_graph_free(&m_filterGraph);
-            return false;
-        }
+    if (width <= 0 || height <= 0) {
+        qWarning() << "[FFmpeg] Invalid frame dimensions:" << width << "x" << height;
+        return;
     }
     
-    // zscale: Convert to linear light (PQ HDR -> linear)
-    // ✅ CRITICAL: Explicitly specify input metadata (*_in parameters)
-    // This tells zscale what we're converting FROM (bt2020 + PQ), not just what we want
-    AVFilterContext* zscale1Ctx = nullptr;
-    ret = avfilter_graph_create_filter(&zscale1Ctx,
-                                      avfilter_get_by_name("zscale"),
-                                      "zscale1", 
-                                      "primariesin=bt2020:transferin=smpte2084:matrixin=bt2020nc:rangein=tv:"
-                                      "transfer=linear:npl=100", 
-                                      nullptr, m_filterGraph);
-    if (ret < 0) {
-        char errbuf[AV_ERROR_MAX_STRING_SIZE];
-        av_strerror(ret, errbuf, sizeof(errbuf));
-        qWarning() << "[FFmpeg] Failed to create zscale filter (linearize):" << errbuf;
-        avfilter_graph_free(&m_filterGraph);
-        return false;
+    // ✅ CRITICAL: Validate frame data pointers and stride before handing planes to Qt
+    // Qt's texture upload reads bytesPerLine * height bytes per plane - stride must be sane
+    if (!frame->data[0] || frame->linesize[0] <= 0) {
+        qWarning() << "[FFmpeg] Invalid frame data pointer or linesize:" 
+                   << "data[0]=" << (void*)frame->data[0] << "linesize[0]=" << frame->linesize[0];
+        return;
     }
     
-    // ✅ OPTIMIZATION 2: tonemap - try to avoid expensive float RGB conversion
-    // tonemap by default converts to float RGB (gbrpf32le) which is very expensive.
-    // If tonemap supports format parameter, we can try to keep it in YUV, but this may not be available.
-    // ✅ CRITICAL FIX #4: Don't probe for tonemap format= option - it's not supported in this FFmpeg build
-    // The "No such option: format" error is expected - tonemap will use default (float RGB)
-    // We convert to NV12 later anyway, so the intermediate format doesn't matter
-    AVFilterContext* tonemapCtx = nullptr;
-    ret = avfilter_graph_create_filter(&tonemapCtx,
-                                      avfilter_get_by_name("tonemap"),
-                                      "tonemap", "tonemap=hable:desat=0", nullptr, m_filterGraph);
-    if (ret < 0) {
-        char errbuf[AV_ERROR_MAX_STRING_SIZE];
-        av_strerror(ret, errbuf, sizeof(errbuf));
-        qWarning() << "[FFmpeg] Failed to create tonemap filter:" << errbuf;
-        avfilter_graph_free(&m_filterGraph);
-        return false;
+    // Update size properties (source size - display-scaled and lowres frames are smaller on purpose)
+    if (!m_inScaledOutput && m_lowres == 0 && (m_width != width || m_height != height)) {
+        m_width = width;
+        m_height = height;
+        emit implicitSizeChanged();
     }
     
-    // zscale: Convert to SDR color space (bt709)
-    // Input is linear YUV (from tonemap with format=p010le), output is bt709 SDR
-    // Explicitly specify input is linear to avoid color space path errors
-    AVFilterContext* zscale2Ctx = nullptr;
-    ret = avfilter_graph_create_filter(&zscale2Ctx,
-                                      avfilter_get_by_name("zscale"),
-                                      "zscale2", 
-                                      "transferin=linear:primaries=bt709:transfer=bt709:matrix=bt709:range=tv", 
-                                      nullptr, m_filterGraph);
-    if (ret < 0) {
-        char errbuf[AV_ERROR_MAX_STRING_SIZE];
-        av_strerror(ret, errbuf, sizeof(errbuf));
-        qWarning() << "[FFmpeg] Failed to create zscale filter (to SDR):" << errbuf;
-        avfilter_graph_free(&m_filterGraph);
-        return false;
+    if (!m_videoSink && !m_benchmarkMode) {
+        return; // No sink - can't display frames
     }
     
-    // format: Convert to NV12 (8-bit, Qt compatible)
-    AVFilterContext* formatCtx = nullptr;
-    ret = avfilter_graph_create_filter(&formatCtx,
-                                      avfilter_get_by_name("format"),
-                                      "format", "pix_fmts=nv12", nullptr, m_filterGraph);
-    if (ret < 0) {
-        char errbuf[AV_ERROR_MAX_STRING_SIZE];
-        av_strerror(ret, errbuf, sizeof(errbuf));
-        qWarning() << "[FFmpeg] Failed to create format filter (to NV12):" << errbuf;
-        avfilter_graph_free(&m_filterGraph);
-        return false;
+    AVPixelFormat pixFormat = (AVPixelFormat)frame->format;
+    
+    // Validate per-plane strides against the active width (prevents out-of-bounds reads on upload)
+    if (pixFormat == AV_PIX_FMT_NV12) {
+        if (!frame->data[1] || frame->linesize[0] < width || frame->linesize[1] < width) {
+            qWarning() << "[FFmpeg] Invalid stride for NV12 frame - Y stride:" << frame->linesize[0]
+                       << "UV stride:" << frame->linesize[1] << "needs:" << width;
+            return;
+        }
+    } else if (pixFormat == AV_PIX_FMT_YUV420P) {
+        const int uvBytes = (width + 1) / 2;
+        if (!frame->data[1] || !frame->data[2] ||
+            frame->linesize[0] < width || frame->linesize[1] < uvBytes || frame->linesize[2] < uvBytes) {
+            qWarning() << "[FFmpeg] Invalid stride for YUV420P frame - Y:" << frame->linesize[0]
+                       << "U:" << frame->linesize[1] << "V:" << frame->linesize[2]
+                       << "needs Y:" << width << "UV:" << uvBytes;
+            return;
+        }
+    } else if (pixFormat == AV_PIX_FMT_P010LE) {
+        // 16-bit words: luma and interleaved UV rows are both 2 * width bytes
+        if (!frame->data[1] || frame->linesize[0] < width * 2 || frame->linesize[1] < width * 2) {
+            qWarning() << "[FFmpeg] Invalid stride for P010 frame - Y stride:" << frame->linesize[0]
+                       << "UV stride:" << frame->linesize[1] << "needs:" << width * 2;
+            return;
+        }
+    } else if (pixFormat == AV_PIX_FMT_YUV420P10LE) {
+        const int uvBytes = ((width + 1) / 2) * 2;
+        if (!frame->data[1] || !frame->data[2] ||
+            frame->linesize[0] < width * 2 || frame->linesize[1] < uvBytes || frame->linesize[2] < uvBytes) {
+            qWarning() << "[FFmpeg] Invalid stride for YUV420P10 frame - Y:" << frame->linesize[0]
+                       << "U:" << frame->linesize[1] << "V:" << frame->linesize[2]
+                       << "needs Y:" << width * 2 << "UV:" << uvBytes;
+            return;
+        }
+    } else if (pixFormat == AV_PIX_FMT_BGRA) {
+        if (frame->linesize[0] < width * 4) {
+            qWarning() << "[FFmpeg] Invalid BGRA stride:" << frame->linesize[0] << "needs:" << width * 4;
+            return;
+        }
+    } else {
+        qWarning() << "[FFmpeg] Unsupported pixel format for QVideoSink:" << av_get_pix_fmt_name(pixFormat);
+        return;
     }
     
-    // Output buffer sink
-    ret = avfilter_graph_create_filter(&m_filterSinkCtx,
-                                      avfilter_get_by_name("buffersink"),
-                                      "out", nullptr, nullptr, m_filterGraph);
-    if (ret < 0) {
-        char errbuf[AV_ERROR_MAX_STRING_SIZE];
-        av_strerror(ret, errbuf, sizeof(errbuf));
-        qWarning() << "[FFmpeg] Failed to create buffer sink filter:" << errbuf;
-        avfilter_graph_free(&m_filterGraph);
-        return false;
+    QVideoFrame videoFrame = FFmpegVideoBuffer::wrap(frame);
+    if (!videoFrame.isValid()) {
+        qWarning() << "[FFmpeg] Failed to wrap frame for QVideoSink:" << av_get_pix_fmt_name(pixFormat);
+        return;
     }
     
-    // Link filters: in -> [scale] -> zscale1 -> tonemap -> zscale2 -> format -> out
-    // (scale is optional, only if needsScale is true)
-    AVFilterContext* lastFilter = m_filterSrcCtx;
+    // Time to first frame (see OpenTrace)
+    if (m_openTrace.firstFrameUs < 0 && m_openTrace.decodeStartUs > 0) {
+        m_openTrace.firstFrameUs = av_gettime_relative() - m_openTrace.decodeStartUs;
+        qDebug() << "[FFmpeg] First frame:" << (m_openTrace.openUs + m_openTrace.firstFrameUs) / 1000.0 << "ms"
+                 << "(io" << m_openTrace.ioUs / 1000.0 << "probe" << m_openTrace.probeUs / 1000.0
+                 << "codecs" << m_openTrace.codecPhaseUs / 1000.0 << "first packet" << m_openTrace.firstPacketUs / 1000.0
+                 << "first frame" << m_openTrace.firstFrameUs / 1000.0 << "ms)";
+        publishOpenTrace();
+    }
     
-    if (needsScale && scaleCtx) {
-        ret = avfilter_link(m_filterSrcCtx, 0, scaleCtx, 0);
-        if (ret < 0) {
-            qWarning() << "[FFmpeg] Failed to link buffer source to scale";
-            avfilter_graph_free(&m_filterGraph);
-            return false;
+    // Benchmark: the frame is ready for Qt - drop it (null sink) and stop at the frame limit
+    if (m_benchmarkMode) {
+        const quint64 frames = m_benchFrames.fetch_add(1, std::memory_order_relaxed) + 1;
+        m_benchLastFrameUs.store(av_gettime_relative(), std::memory_order_relaxed);
+        if (m_benchmarkOptions.frameLimit > 0 && frames >= m_benchmarkOptions.frameLimit) {
+            QMutexLocker stateLocker(&m_decodeMutex);
+            if (m_isPlaying) {
+                m_isPlaying = false;
+                emit playbackStateChanged();
+            }
         }
-        lastFilter = scaleCtx;
+        return;
     }
     
-    ret = avfilter_link(lastFilter, 0, zscale1Ctx, 0);
-    if (ret < 0) {
-        qWarning() << "[FFmpeg] Failed to link to zscale1";
-        avfilter_graph_free(&m_filterGraph);
-        return false;
+    // Presentation time (absolute stream seconds) - the presenter schedules against the master clock
+    double pts = 0.0;
+    double duration = 0.0;
+    if (m_videoStream) {
+        const double timeBase = av_q2d(m_videoStream->time_base);
+        if (frame->best_effort_timestamp != AV_NOPTS_VALUE) {
+            pts = frame->best_effort_timestamp * timeBase;
+        } else if (frame->pts != AV_NOPTS_VALUE) {
+            pts = frame->pts * timeBase;
+        }
+        if (frame->duration > 0) {
+            duration = frame->duration * timeBase;
+        }
     }
     
-    ret = avfilter_link(zscale1Ctx, 0, tonemapCtx, 0);
-    if (ret < 0) {
-        qWarning() << "[FFmpeg] Failed to link zscale1 to tonemap";
-        avfilter_graph_free(&m_filterGraph);
-        return false;
+    // Frame stepping: converted frames go to the GOP cache, nothing is queued for the presenter
+    if (m_stepFill != NoStepFill) {
+        stageStepFrame(videoFrame, pts, duration);
+        return;
     }
     
-    ret = avfilter_link(tonemapCtx, 0, zscale2Ctx, 0);
-    if (ret < 0) {
-        qWarning() << "[FFmpeg] Failed to link tonemap to zscale2";
-        avfilter_graph_free(&m_filterGraph);
-        return false;
+    // Seek while paused: show the target right away (it also stays queued for resume)
+    if (m_seekPreviewPending) {
+        m_seekPreviewPending = false;
+        if (m_presentPaused.load(std::memory_order_acquire)) {
+            deliverFrame(videoFrame, pts);
+        }
     }
     
-    ret = avfilter_link(zscale2Ctx, 0, formatCtx, 0);
-    if (ret < 0) {
-        qWarning() << "[FFmpeg] Failed to link zscale2 to format";
-        avfilter_graph_free(&m_filterGraph);
-        return false;
+    // Blocks while the display queue is full (this is what paces the decode loop)
+    // A step request takes the queue while we wait - this frame is the next one after it, keep it for stepping
+    if (!queueFrameForPresentation(videoFrame, pts, duration) && m_requestedStep.load(std::memory_order_acquire) != 0) {
+        m_gopCache.insert(pts, duration, videoFrame, pts);
+    }
+}
+
+AVFrame* FFmpegVideoPlayer::scaleForDisplay(AVFrame* frame)
+{
+    const int displayWidth = m_displayWidth.load(std::memory_order_relaxed);
+    const int displayHeight = m_displayHeight.load(std::memory_order_relaxed);
+    if (displayWidth <= 0 || displayHeight <= 0 || m_benchmarkMode || frame->width <= 0 || frame->height <= 0) {
+        return nullptr;
     }
     
-    ret = avfilter_link(formatCtx, 0, m_filterSinkCtx, 0);
-    if (ret < 0) {
-        qWarning() << "[FFmpeg] Failed to link format to buffer sink";
-        avfilter_graph_free(&m_filterGraph);
-        return false;
+    const AVPixelFormat format = (AVPixelFormat)frame->format;
+    if (format != AV_PIX_FMT_NV12 && format != AV_PIX_FMT_YUV420P && format != AV_PIX_FMT_P010LE &&
+        format != AV_PIX_FMT_YUV420P10LE && format != AV_PIX_FMT_BGRA) {
+        return nullptr;
     }
     
-    // ✅ Configure the filter graph
-    // NOTE: Buffer source will have "unknown" colorspace/range at this point - that's expected
-    // The first frame we push will "change" it to bt2020nc/tv, causing a harmless warning:
-    // "Changing video frame properties on the fly is not supported by all filters"
-    // This is a FFmpeg limitation - buffer source can't specify color metadata at creation in FFmpeg 7.x
-    // The warning is harmless as long as ALL subsequent frames have the same metadata (which we ensure)
-    ret = avfilter_graph_config(m_filterGraph, nullptr);
-    if (ret < 0) {
-        char errbuf[AV_ERROR_MAX_STRING_SIZE];
-        av_strerror(ret, errbuf, sizeof(errbuf));
-        qWarning() << "[FFmpeg] Failed to configure filter graph:" << errbuf;
-        qWarning() << "[FFmpeg] Filter graph args:" << args;
-        qWarning() << "[FFmpeg] zscale1 args: primariesin=bt2020:transferin=smpte2084:matrixin=bt2020nc:rangein=tv:transfer=linear:npl=100";
-        avfilter_graph_free(&m_filterGraph);
-        return false;
+    // Fit the display rect (aspect kept). Only worth it when it at least halves the pixel count -
+    // a smaller reduction costs more to scale than it saves in tone mapping and upload.
+    // The factor is quantized to 1/16 so resizing the window doesn't change the output size every pixel.
+    double scale = qMin(double(displayWidth) / frame->width, double(displayHeight) / frame->height);
+    scale = std::ceil(scale * 16.0) / 16.0;
+    if (scale > 0.7) {
+        return nullptr;
     }
+    const int width = qMax(2, (int(std::ceil(frame->width * scale)) + 1) & ~1);
+    const int height = qMax(2, (int(std::ceil(frame->height * scale)) + 1) & ~1);
     
-    qDebug() << "[FFmpeg] Filter graph configured - first frame will set color metadata (warning is expected and harmless)";
+    if (!m_scaledFrame) {
+        m_scaledFrame = av_frame_alloc();
+        if (!m_scaledFrame) {
+            return nullptr;
+        }
+    }
+    m_scaledFrame->format = format;
+    m_scaledFrame->width = width;
+    m_scaledFrame->height = height;
+    if (m_scalePool.allocFrame(m_scaledFrame) < 0) {
+        av_frame_unref(m_scaledFrame);
+        return nullptr;
+    }
+    
+    m_displaySws = sws_getCachedContext(m_displaySws, frame->width, frame->height, format,
+                                        width, height, format, SWS_BILINEAR, nullptr, nullptr, nullptr);
+    if (!m_displaySws) {
+        static bool warned = false;
+        if (!warned) {
+            warned = true;
+            qWarning() << "[FFmpeg] Display scaling unavailable for" << av_get_pix_fmt_name(format);
+        }
+        av_frame_unref(m_scaledFrame);
+        return nullptr;
+    }
+    sws_scale(m_displaySws, frame->data, frame->linesize, 0, frame->height, m_scaledFrame->data, m_scaledFrame->linesize);
     
-    // Allocate output frame
-    m_filterFrame = av_frame_alloc();
-    if (!m_filterFrame) {
-        qWarning() << "[FFmpeg] Failed to allocate filter output frame";
-        avfilter_graph_free(&m_filterGraph);
+    // Timestamps and colour metadata (the tone mapper reads the transfer function)
+    av_frame_copy_props(m_scaledFrame, frame);
+    m_framesScaled.fetch_add(1, std::memory_order_relaxed);
+    return m_scaledFrame;
+}
+
+bool FFmpegVideoPlayer::deinterlaceFrame(AVFrame* frame)
+{
+    const int mode = m_deinterlaceMode.load(std::memory_order_relaxed);
+    if (mode == DeinterlaceOff || !FFmpegDeinterlacer::isInterlaced(frame) || !FFmpegDeinterlacer::canProcess(frame->format)) {
+        // Progressive frame (or deinterlacing just switched off) - the held-back frame goes first
+        drainDeinterlacer();
         return false;
     }
     
-    // Log filter graph description for debugging
-    char* graphDesc = avfilter_graph_dump(m_filterGraph, nullptr);
-    if (graphDesc) {
-        qDebug() << "[FFmpeg] HDR tone mapping filter graph initialized:" << width << "x" << height 
-                 << "from" << av_get_pix_fmt_name(inputFormat) << "to NV12 (bt2020+PQ→linear→hable→bt709)";
-        qDebug() << "[FFmpeg] Filter graph:" << graphDesc;
-        av_free(graphDesc);
-    } else {
-        qDebug() << "[FFmpeg] HDR tone mapping filter graph initialized:" << width << "x" << height 
-                 << "from" << av_get_pix_fmt_name(inputFormat) << "to NV12";
+    if (!m_deinterlacer) {
+        m_deinterlacer = std::make_unique<FFmpegDeinterlacer>();
+        setStatistic(QStringLiteral("deinterlacer"), QStringLiteral("native-yadif"));
+        setStatistic(QStringLiteral("deinterlaceThreads"), m_deinterlacer->threadCount());
+        qDebug() << "[FFmpeg] Native deinterlacer ready:" << frame->width << "x" << frame->height
+                 << av_get_pix_fmt_name((AVPixelFormat)frame->format) << "-"
+                 << m_deinterlacer->threadCount() << "threads";
+    }
+    for (AVFrame*& deinterlaced : m_deinterlacedFrames) {
+        if (!deinterlaced && !(deinterlaced = av_frame_alloc())) {
+            qWarning() << "[FFmpeg] Failed to allocate deinterlacer output frame";
+            return false;
+        }
     }
+    
+    // Outputs belong to the frame queued before this one (one frame of look-ahead)
+    m_deinterlacer->setFieldRate(mode == DeinterlaceFieldRate);
+    presentDeinterlaced(m_deinterlacer->process(frame, m_deinterlacedFrames));
     return true;
 }
 
-void FFmpegVideoPlayer::cleanupHDRToneMappingFilter()
+void FFmpegVideoPlayer::drainDeinterlacer()
 {
-    if (m_filterGraph) {
-        avfilter_graph_free(&m_filterGraph);
-        m_filterGraph = nullptr;
-        m_filterSrcCtx = nullptr;
-        m_filterSinkCtx = nullptr;
-    }
-    if (m_filterFrame) {
-        av_frame_free(&m_filterFrame);
-        m_filterFrame = nullptr;
+    if (m_deinterlacer && m_deinterlacer->hasPending()) {
+        presentDeinterlaced(m_deinterlacer->drain(m_deinterlacedFrames));
     }
-    m_filterWidth = 0;
-    m_filterHeight = 0;
-    m_filterInputFormat = AV_PIX_FMT_NONE;
-    m_filterGraphInitialized = false; // ✅ Mark as not initialized when cleaned up
-    // ✅ Reset backpressure counter when cleaning up filter graph
-    m_framesInFilter.store(0, std::memory_order_relaxed);
 }
 
-void FFmpegVideoPlayer::processFrame(AVFrame* frame)
+void FFmpegVideoPlayer::presentDeinterlaced(int count)
 {
-    if (!frame) {
-        return;
-    }
-    
-    // ✅ Handle 10-bit HDR frames (Dolby Vision, HEVC Main10) - use FFmpeg HDR tone mapping
-    // Qt QVideoSink does not support 10-bit formats (p010le, yuv420p10le), so we must convert
-    // Use FFmpeg filter graph for proper HDR → SDR tone mapping (better than simple format conversion)
-    AVPixelFormat frameFormat = (AVPixelFormat)frame->format;
-    if (frameFormat == AV_PIX_FMT_P010LE || frameFormat == AV_PIX_FMT_YUV420P10LE) {
-        int width = frame->width;
-        int height = frame->height;
-        
-        if (width <= 0 || height <= 0) {
-            return;
-        }
-        
-        // ✅ CRITICAL: Set HDR color metadata on EVERY frame BEFORE filter graph initialization
-        // This prevents "unknown range/colorspace" from locking the graph in invalid state
-        // FFmpeg requires ALL frames to have IDENTICAL metadata from the FIRST frame onward
-        // D3D11 → CPU transfer loses metadata, so we must restore it explicitly on every frame
-        frame->color_range = AVCOL_RANGE_MPEG;        // TV range (16-235)
-        frame->color_primaries = AVCOL_PRI_BT2020;    // BT.2020 primaries (HDR)
-        frame->color_trc = AVCOL_TRC_SMPTE2084;       // PQ (Perceptual Quantizer) transfer
-        frame->colorspace = AVCOL_SPC_BT2020_NCL;    // BT.2020 non-constant luminance matrix
-        
-        // ✅ CRITICAL: Initialize filter graph on first frame (even without PTS)
-        // We'll set a default PTS if needed - waiting for PTS causes infinite loop
-        // The filter graph must be initialized before we can process any 10-bit frames
-        // ✅ CRITICAL GUARD: Only recreate if graph doesn't exist OR dimensions/format actually changed
-        // This prevents repeated recreation during playback (which causes memory leaks from zscale/tonemap LUTs)
-        // Rule: Filter graph MUST NOT be recreated during playback unless dimensions/format change
-        bool needsRecreation = false;
-        if (!m_filterGraph || !m_filterGraphInitialized) {
-            // Graph doesn't exist or wasn't properly initialized - must create
-            needsRecreation = true;
-            if (m_filterGraphInitialized && m_isPlaying) {
-                qWarning() << "[FFmpeg] Filter graph lost during playback - recreating (this should not happen)";
-            }
-        } else if (m_filterWidth != width || 
-                   m_filterHeight != height || 
-                   m_filterInputFormat != frameFormat) {
-            // Dimensions or format changed - must recreate (legitimate reason)
-            needsRecreation = true;
-            qDebug() << "[FFmpeg] Filter graph dimensions/format changed:" 
-                     << m_filterWidth << "x" << m_filterHeight << "->" << width << "x" << height
-                     << "format:" << av_get_pix_fmt_name(m_filterInputFormat) 
-                     << "->" << av_get_pix_fmt_name(frameFormat);
-        } else {
-            // Graph exists, is initialized, and dimensions/format match - do NOT recreate
-            // This prevents memory leaks from repeated graph creation during playback
-        }
-        
-        if (needsRecreation) {
-            // Get display dimensions for scaling optimization (if available)
-            int displayWidth = 0;
-            int displayHeight = 0;
-            if (m_videoSink) {
-                // Try to get display size from video sink if available
-                // For now, we'll use 0 to trigger the "scale to 1080p max" logic for large sources
-                displayWidth = 0;
-                displayHeight = 0;
-            }
-            
-            if (!initHDRToneMappingFilter(width, height, frameFormat, displayWidth, displayHeight)) {
-                qWarning() << "[FFmpeg] Failed to initialize HDR tone mapping filter - video may not display";
-                m_filterGraphInitialized = false; // Mark as not initialized on failure
-                return;
-            }
-            // Store dimensions and format for next check
-            m_filterWidth = width;
-            m_filterHeight = height;
-            m_filterInputFormat = frameFormat;
-            m_filterGraphInitialized = true; // ✅ Mark as initialized for current playback session
-        }
-        
-        // ✅ CRITICAL FIX #2: Ensure ALL metadata and PTS is set BEFORE cloning
-        // Once we clone and push to filter graph, we must NEVER mutate the original frame
-        // Set PTS if missing
-        if (m_videoStream) {
-            if (frame->best_effort_timestamp == AV_NOPTS_VALUE && frame->pts == AV_NOPTS_VALUE) {
-                // No PTS available - set default to prevent filter graph errors
-                frame->pts = 0;
-                frame->best_effort_timestamp = 0;
-                qDebug() << "[FFmpeg] Frame has no valid PTS, using default PTS=0 for filter graph";
+    // FFmpegVideoBuffer takes its own reference, so the outputs can be unref'd right away
+    // Each output is admitted (seek target, step, rate thinning) by its own PTS - the one held back,
+    // not the frame that was just fed in
+    const bool deferred = m_deferVideoAdmission;
+    for (int i = 0; i < count; ++i) {
+        m_inDeinterlacedOutput = true;
+        m_deferVideoAdmission = m_videoStream && m_videoSink;
+        processFrame(m_deinterlacedFrames[i]);
+        m_inDeinterlacedOutput = false;
+        av_frame_unref(m_deinterlacedFrames[i]);
+    }
+    m_deferVideoAdmission = deferred;  // A progressive frame that drained the deinterlacer is still to be admitted
+}
+
+bool FFmpegVideoPlayer::dropSuspendedVideoPacket(const AVPacket* packet)
+{
+    // Without audio the video queue paces the decode loop - keep decoding then
+    const bool suspend = m_suspendVideo.load(std::memory_order_acquire) && m_audioRing &&
+                         m_stepFill == NoStepFill && !m_benchmarkMode;
+    if (suspend != m_videoSuspended) {
+        m_videoSuspended = suspend;
+        if (!suspend) {
+            // ✅ References from before the gap are gone - restart the decoder cleanly at the next keyframe
+            avcodec_flush_buffers(m_codecContext);
+            if (m_deinterlacer) {
+                m_deinterlacer->reset();
             }
+            m_lastDecodedVideoPts = -1.0;
+            m_awaitVideoKeyframe = true;
         }
-        
-        // ✅ CRITICAL BACKPRESSURE: Check if filter graph is full BEFORE cloning
-        // Dropping BEFORE cloning saves memory - we avoid allocating a clone that we'd just drop
-        // This prevents unbounded memory growth when decoding is faster than filter graph consumption
-        int framesInFlight = m_framesInFilter.load(std::memory_order_relaxed);
-        if (framesInFlight >= MAX_IN_FLIGHT) {
-            // Filter graph is full - drop this frame to prevent memory explosion
-            // This is expected when decode rate > filter graph processing rate
-            // The dropped frame will be compensated by later frames being processed faster
-            static int dropCount = 0;
-            dropCount++;
-            if (dropCount <= 10 || (dropCount % 60 == 0)) {
-                qDebug() << "[FFmpeg] Dropping frame (backpressure):" << framesInFlight << "frames in filter graph (max:" << MAX_IN_FLIGHT << ")";
+        qDebug() << "[FFmpeg] Video decoding" << (suspend ? "suspended (window minimized)" : "resuming at next keyframe");
+    }
+    
+    if (m_videoSuspended) {
+        return true;
+    }
+    
+    // Display grew or shrank past a lowres level: re-prime the decoder at this keyframe with the new level
+    // (like a resume - nothing before it is referenced once the decoder is flushed)
+    if ((packet->flags & AV_PKT_FLAG_KEY) && m_codecContext && m_codecContext->codec &&
+        m_codecContext->codec->max_lowres > 0 && !m_codecContext->hw_device_ctx) {
+        const int level = lowresForDisplay(m_codecContext->codec);
+        if (level != m_lowres) {
+            avcodec_flush_buffers(m_codecContext);
+            if (m_deinterlacer) {
+                m_deinterlacer->reset();
             }
-            return; // Drop frame BEFORE cloning - saves ~16MB per 4K frame
-        }
-        
-        // ✅ CRITICAL FIX #1: NEVER pass a reusable frame to filter graph with KEEP_REF
-        // The filter graph will hold a reference to the frame, and if we reuse/mutate it,
-        // the graph will see inconsistent data (width/height from one frame, linesize from another)
-        // This causes imgutils.c assertion failures when copying frame data
-        // SOLUTION: Clone the frame before pushing - filter graph owns the clone, we can reuse original
-        AVFrame* clonedFrame = av_frame_clone(frame);
-        if (!clonedFrame) {
-            qWarning() << "[FFmpeg] Failed to clone frame for filter graph - out of memory";
-            return;
+            m_codecContext->lowres = level;
+            qDebug() << "[FFmpeg] Decoder lowres" << m_lowres << "->" << level << "for a"
+                     << m_displayWidth.load(std::memory_order_relaxed) << "x" << m_displayHeight.load(std::memory_order_relaxed) << "display";
+            m_lowres = level;
+            m_lastDecodedVideoPts = -1.0;
+            m_awaitVideoKeyframe = false;  // This packet is the keyframe
+            setStatistic(QStringLiteral("decoderLowres"), m_lowres);
         }
-        
-        // Add cloned frame to filter graph input (filter graph now owns it)
-        // NOTE: First frame will cause "Changing video frame properties" warning - this is expected and harmless
-        int ret = av_buffersrc_add_frame_flags(m_filterSrcCtx, clonedFrame, AV_BUFFERSRC_FLAG_KEEP_REF);
-        
-        // ✅ CRITICAL FIX #3: If filter graph rejects frame, it's poisoned - recreate it
-        // Don't try to "recover" - once a filter graph error occurs, it's in an invalid state
-        if (ret < 0) {
-            char errbuf[AV_ERROR_MAX_STRING_SIZE];
-            av_strerror(ret, errbuf, sizeof(errbuf));
-            qWarning() << "[FFmpeg] Failed to add frame to filter graph:" << errbuf << "- recreating graph";
-            
-            // Free the cloned frame we created (filter graph didn't take it)
-            av_frame_free(&clonedFrame);
-            
-            // Cleanup and recreate filter graph - it's poisoned
-            cleanupHDRToneMappingFilter();
-            m_filterWidth = 0;  // Force recreation on next frame
-            m_filterHeight = 0;
-            m_filterInputFormat = AV_PIX_FMT_NONE;
-            m_filterGraphInitialized = false; // ✅ Mark as not initialized - will recreate on next frame
-            m_framesInFilter.store(0, std::memory_order_relaxed); // ✅ Reset counter on cleanup
-            return;
+    }
+    
+    if (m_awaitVideoKeyframe) {
+        if (!(packet->flags & AV_PKT_FLAG_KEY)) {
+            return true;
         }
-        
-        // ✅ BACKPRESSURE: Increment counter after successful push
-        m_framesInFilter.fetch_add(1, std::memory_order_relaxed);
-        
-        // Filter graph now owns clonedFrame - we can safely reuse 'frame' (m_transferFrame) for next decode
-        // Don't free clonedFrame - filter graph will free it when done
-        
-        // Get output frame from filter graph (tone-mapped, 8-bit NV12)
-        // Filter graph may need multiple input frames before producing output (especially first time)
-        ret = av_buffersink_get_frame(m_filterSinkCtx, m_filterFrame);
-        if (ret < 0) {
-            if (ret == AVERROR(EAGAIN)) {
-                // Filter graph needs more input - this is normal, especially on first frames
-                // Continue to next iteration to feed more frames
-                // Note: We already incremented the counter on push, so it stays incremented
-                return;
-            } else if (ret == AVERROR_EOF) {
-                // End of stream - this is normal
-                return;
-            } else {
-                // Real error - log it but don't crash
-                char errbuf[AV_ERROR_MAX_STRING_SIZE];
-                av_strerror(ret, errbuf, sizeof(errbuf));
-                static int consecutiveSinkErrors = 0;
-                consecutiveSinkErrors++;
-                if (consecutiveSinkErrors <= 5) {
-                    qWarning() << "[FFmpeg] Failed to get frame from filter graph:" << errbuf 
-                               << "(" << ret << ") - attempt" << consecutiveSinkErrors;
-                } else if (consecutiveSinkErrors == 6) {
-                    qWarning() << "[FFmpeg] Filter graph sink errors persisting - may need to recreate graph";
-                }
-                // Continue to next frame - filter graph might recover
-                // Note: Counter already incremented, but frame wasn't consumed - this is OK
-                // The filter graph still holds the frame, so counter is accurate
-                return;
+        m_awaitVideoKeyframe = false;
+    }
+    return false;
+}
+
+void FFmpegVideoPlayer::updateVideoSuspended()
+{
+    m_windowHidden = false;
+    if (m_window) {
+        const QWindow::Visibility visibility = m_window->visibility();
+        m_windowHidden = visibility == QWindow::Minimized || visibility == QWindow::Hidden;
+    }
+    FFmpegVideoPlayer* decoder = sharedDecoder();
+    (decoder ? decoder : this)->updateSessionOutput();
+}
+
+void FFmpegVideoPlayer::updateSessionOutput()
+{
+    // Scale for the largest window showing the video (any unknown size = full resolution),
+    // stop decoding video only when none of them is visible
+    // and decode the subtitle streams any of them shows
+    bool suspend = true;
+    int width = 0;
+    int height = 0;
+    bool fullSize = false;
+    QList<int> subtitleStreams;
+    const QList<FFmpegVideoPlayer*> consumers = frameConsumers();
+    for (FFmpegVideoPlayer* consumer : consumers) {
+        for (int stream : consumer->subtitleStreams()) {
+            if (!subtitleStreams.contains(stream)) {
+                subtitleStreams.append(stream);
             }
         }
-        
-        // ✅ BACKPRESSURE: Decrement counter after successful pull (one frame consumed from filter graph)
-        m_framesInFilter.fetch_sub(1, std::memory_order_relaxed);
-        
-        // ✅ Reset sink error counter on success
-        static int consecutiveSinkErrors = 0;
-        if (consecutiveSinkErrors > 0) {
-            consecutiveSinkErrors = 0;
-        }
-        
-        // ✅ CRITICAL: Validate filter output frame before processing to prevent assertion crashes
-        // Filter graph may output frames with invalid stride/width after decode errors or format issues
-        if (m_filterFrame->width <= 0 || m_filterFrame->height <= 0) {
-            qWarning() << "[FFmpeg] Filter output frame has invalid dimensions:" 
-                       << m_filterFrame->width << "x" << m_filterFrame->height << "- skipping";
-            av_frame_unref(m_filterFrame);
-            return;
-        }
-        if (!m_filterFrame->data[0] || m_filterFrame->linesize[0] <= 0) {
-            qWarning() << "[FFmpeg] Filter output frame has invalid data pointer or stride - skipping";
-            av_frame_unref(m_filterFrame);
-            return;
-        }
-        // Validate stride matches minimum required width (prevents assertion in imgutils.c)
-        AVPixelFormat outFormat = (AVPixelFormat)m_filterFrame->format;
-        int minStride = 0;
-        if (outFormat == AV_PIX_FMT_NV12) {
-            minStride = m_filterFrame->width; // NV12 luma: 1 byte per pixel
-        } else if (outFormat == AV_PIX_FMT_YUV420P) {
-            minStride = m_filterFrame->width; // YUV420P Y: 1 byte per pixel
-        } else if (outFormat == AV_PIX_FMT_BGRA) {
-            minStride = m_filterFrame->width * 4; // BGRA: 4 bytes per pixel
-        }
-        if (minStride > 0 && m_filterFrame->linesize[0] < minStride) {
-            qWarning() << "[FFmpeg] Filter output frame stride too small:" 
-                       << "format:" << av_get_pix_fmt_name(outFormat)
-                       << "stride[0]:" << m_filterFrame->linesize[0] 
-                       << "needs:" << minStride << "- skipping";
-            av_frame_unref(m_filterFrame);
-            return;
+        suspend = suspend && consumer->m_windowHidden;
+        if (consumer->m_requestedDisplaySize.isEmpty()) {
+            fullSize = true;
+        } else {
+            width = qMax(width, consumer->m_requestedDisplaySize.width());
+            height = qMax(height, consumer->m_requestedDisplaySize.height());
         }
-        
-        // ✅ CRITICAL: Filter graph processing is CPU-intensive and can block decode thread
-        // This can cause D3D11 resource contention when QVideoFrame.map() is called
-        // Add a small yield after filter processing to allow Qt's render thread to access D3D11 device
-        // This prevents "Failed to map buffer" COM errors from resource exhaustion
-        processFrame(m_filterFrame);
-        
-        // ✅ CRITICAL: Add throttle after filter graph processing to prevent D3D11 resource exhaustion
-        // Filter graph + QVideoFrame.map() from decode thread can create D3D11 staging textures faster
-        // than Qt's render thread can release them, causing resource exhaustion and crashes after ~2 seconds
-        // Even with m_framePending checks, filter graph processing can overwhelm D3D11 resource pool
-        // Longer delay needed for filter graph path (CPU-intensive processing + D3D11 allocation)
-        // 5ms delay = ~200fps max, which is still faster than any video (30fps typical)
-        QThread::msleep(5); // 5ms delay - prevents D3D11 resource exhaustion, minimal impact on 30fps video
-        
-        // Unref the filter output frame (will be reused next time)
-        av_frame_unref(m_filterFrame);
-        return;
     }
+    m_displayWidth.store(fullSize ? 0 : width, std::memory_order_relaxed);
+    m_displayHeight.store(fullSize ? 0 : height, std::memory_order_relaxed);
+    m_sessionWindows.store(int(consumers.size()), std::memory_order_relaxed);
     
-    // For QVideoSink: Handle system memory frames (NV12, YUV420P, BGRA)
-    // FFmpeg uses D3D11VA internally for hardware decode, but outputs CPU-visible frames
-    // This is the stable path - no D3D11 texture handling needed
-    
-    int width = frame->width;
-    int height = frame->height;
-    
-    if (width <= 0 || height <= 0) {
-        qWarning() << "[FFmpeg] Invalid frame dimensions:" << width << "x" << height;
-        return;
+    {
+        QMutexLocker locker(&m_subtitleMutex);
+        if (m_decodedSubtitleStreams != subtitleStreams) {
+            m_decodedSubtitleStreams = subtitleStreams;
+            m_subtitleStreamsDirty.store(true, std::memory_order_release);
+        }
     }
     
-    // ✅ CRITICAL: Validate frame data pointers and stride before copying
-    // Invalid stride can cause assertion failures in imgutils.c when copying
-    if (!frame->data[0] || frame->linesize[0] <= 0) {
-        qWarning() << "[FFmpeg] Invalid frame data pointer or linesize:" 
-                   << "data[0]=" << (void*)frame->data[0] << "linesize[0]=" << frame->linesize[0];
-        return;
+    if (m_suspendVideo.exchange(suspend, std::memory_order_acq_rel) != suspend) {
+        qDebug() << "[FFmpeg] Window" << (suspend ? "minimized/hidden" : "visible") << "- video decode" << (suspend ? "off" : "on");
     }
-    
-    // Update size properties
-    if (m_width != width || m_height != height) {
-        m_width = width;
-        m_height = height;
-        emit implicitSizeChanged();
+}
+
+QSize FFmpegVideoPlayer::displaySize() const
+{
+    return m_requestedDisplaySize;
+}
+
+void FFmpegVideoPlayer::setDisplaySize(const QSize& size)
+{
+    const QSize bounded(qMax(0, size.width()), qMax(0, size.height()));
+    if (bounded == m_requestedDisplaySize) {
+        return;
     }
-    
-    // ✅ CRITICAL: Check if frame is pending BEFORE creating QVideoFrame to avoid D3D11 resource allocation
-    // QVideoFrame.map() allocates D3D11 staging textures even if we skip the frame later
-    // This check prevents unnecessary D3D11 resource allocation when GUI thread is still processing previous frame
-    // NOTE: We check AFTER filter graph processing - filter graph input frames should always be processed to drain buffer
-    if (!m_videoSink) {
-        return; // No sink - can't display frames
+    m_requestedDisplaySize = bounded;
+    FFmpegVideoPlayer* decoder = sharedDecoder();
+    (decoder ? decoder : this)->updateSessionOutput();
+    emit displaySizeChanged();
+}
+
+void FFmpegVideoPlayer::setDeinterlaceMode(int mode)
+{
+    if (mode < DeinterlaceOff || mode > DeinterlaceFieldRate) {
+        qWarning() << "[FFmpeg] Ignoring invalid deinterlace mode:" << mode;
+        return;
+    }
+    if (m_deinterlaceMode.exchange(mode, std::memory_order_relaxed) == mode) {
+        return;
     }
     
-    // Feed frame to QVideoSink (Qt handles everything - GPU upload, rendering, sync)
-    QVideoFrame videoFrame;  // Declare outside format checks so it's available in all branches
-    AVPixelFormat pixFormat = (AVPixelFormat)frame->format;
+    QSettings settings;
+    settings.setValue("video/ffmpegDeinterlaceMode", mode);
     
-        if (pixFormat == AV_PIX_FMT_NV12) {
-            // ✅ CRITICAL: Check m_framePending BEFORE creating/mapping QVideoFrame to avoid D3D11 resource allocation
-            // QVideoFrame.map() allocates D3D11 staging textures immediately, even if we skip the frame later
-            // This check prevents D3D11 resource exhaustion when GUI thread is still processing previous frame
-            if (m_framePending.load(std::memory_order_acquire)) {
-                return; // Skip frame - GUI thread still processing previous one
-            }
-            
-            // NV12: Y plane + interleaved UV plane
-            QVideoFrameFormat format(QSize(width, height), QVideoFrameFormat::Format_NV12);
-            videoFrame = QVideoFrame(format);
-            
-            // ✅ CRITICAL: QVideoFrame.map() can fail with D3D11 backend when called from decode thread
-            // This is a known issue - D3D11 staging texture allocation can conflict with render thread
-            // Add error handling and skip frame if mapping fails (better than crashing)
-            if (!videoFrame.map(QVideoFrame::WriteOnly)) {
-                static int mapFailures = 0;
-                mapFailures++;
-                if (mapFailures <= 3) {
-                    qWarning() << "[FFmpeg] Failed to map QVideoFrame buffer (D3D11 resource conflict?) - skipping frame. This can happen with HDR filter graph processing.";
-                } else if (mapFailures == 4) {
-                    qWarning() << "[FFmpeg] QVideoFrame mapping failing repeatedly - may indicate D3D11 resource exhaustion or threading issue";
-                }
-                return; // Skip this frame - next one might work
-            }
-            
-            // ✅ CRITICAL PERFORMANCE FIX: Copy only active pixel width, not stride padding
-            // NV12 luma is 1 byte per pixel, chroma row is width bytes (UV interleaved)
-            // Copying stride padding wastes memory bandwidth and cache, causing lag
-            const int yBytes = width;         // NV12 luma: 1 byte per pixel
-            const int uvBytes = width;        // NV12 chroma: width bytes per row (UV interleaved)
-            
-            // ✅ CRITICAL: Validate stride before copying to prevent assertion failures
-            // Assertion failure: ((src_linesize) >= 0 ? (src_linesize) : (-(src_linesize))) >= bytewidth
-            const int srcYStride = frame->linesize[0];
-            const int srcUVStride = frame->linesize[1];
-            if (srcYStride < yBytes || srcUVStride < uvBytes) {
-                qWarning() << "[FFmpeg] Invalid stride for NV12 frame - Y stride:" << srcYStride 
-                           << "needs:" << yBytes << "UV stride:" << srcUVStride << "needs:" << uvBytes;
-                videoFrame.unmap();
-                return;
-            }
-            
-            // Copy Y plane
-            uint8_t* dstY = videoFrame.bits(0);
-            const uint8_t* srcY = frame->data[0];
-            const int dstYStride = videoFrame.bytesPerLine(0);
-            
-            if (!srcY || !dstY) {
-                qWarning() << "[FFmpeg] Invalid NV12 Y plane pointers";
-                videoFrame.unmap();
-                return;
-            }
-            
-            for (int y = 0; y < height; ++y) {
-                memcpy(dstY + y * dstYStride, srcY + y * srcYStride, yBytes);
-            }
-            
-            // Copy UV plane (interleaved)
-            uint8_t* dstUV = videoFrame.bits(1);
-            const uint8_t* srcUV = frame->data[1];
-            const int dstUVStride = videoFrame.bytesPerLine(1);
-            const int uvHeight = height / 2;
-            
-            if (!srcUV || !dstUV) {
-                qWarning() << "[FFmpeg] Invalid NV12 UV plane pointers";
-                videoFrame.unmap();
-                return;
-            }
-            
-            for (int y = 0; y < uvHeight; ++y) {
-                memcpy(dstUV + y * dstUVStride, srcUV + y * srcUVStride, uvBytes);
-            }
-            
-            videoFrame.unmap();
-            
-            // Reset failure counter on success
-            static int mapFailures = 0;
-            if (mapFailures > 0) {
-                mapFailures = 0;
-            }
-        } else if (pixFormat == AV_PIX_FMT_YUV420P) {
-            // ✅ CRITICAL: Check m_framePending BEFORE creating/mapping QVideoFrame
-            if (m_framePending.load(std::memory_order_acquire)) {
-                return; // Skip frame - GUI thread still processing previous one
-            }
-            
-            // YUV420P: Separate Y, U, V planes
-            QVideoFrameFormat format(QSize(width, height), QVideoFrameFormat::Format_YUV420P);
-            videoFrame = QVideoFrame(format);
-            
-            // ✅ CRITICAL: QVideoFrame.map() can fail with D3D11 backend when called from decode thread
-            if (!videoFrame.map(QVideoFrame::WriteOnly)) {
-                static int mapFailures = 0;
-                mapFailures++;
-                if (mapFailures <= 3) {
-                    qWarning() << "[FFmpeg] Failed to map QVideoFrame buffer (YUV420P) - skipping frame";
-                }
-                return;
-            }
-            
-            // ✅ CRITICAL PERFORMANCE FIX: Copy only active pixel width, not stride padding
-            // YUV420P: Y is full width, U/V are half width
-            const int yBytes = width;         // Y plane: 1 byte per pixel
-            const int uvBytes = width / 2;    // U/V planes: half width (subsampled)
-            
-            // ✅ CRITICAL: Validate stride before copying to prevent assertion failures
-            const int srcYStride = frame->linesize[0];
-            const int srcUStride = frame->linesize[1];
-            const int srcVStride = frame->linesize[2];
-            if (srcYStride < yBytes || srcUStride < uvBytes || srcVStride < uvBytes) {
-                qWarning() << "[FFmpeg] Invalid stride for YUV420P frame - Y:" << srcYStride 
-                           << "U:" << srcUStride << "V:" << srcVStride 
-                           << "needs Y:" << yBytes << "UV:" << uvBytes;
-                videoFrame.unmap();
-                return;
-            }
-            
-            // Validate data pointers
-            if (!frame->data[0] || !frame->data[1] || !frame->data[2]) {
-                qWarning() << "[FFmpeg] Invalid YUV420P data pointers";
-                videoFrame.unmap();
-                return;
-            }
-            
-            // Copy Y plane
-            uint8_t* dstY = videoFrame.bits(0);
-            const uint8_t* srcY = frame->data[0];
-            const int dstYStride = videoFrame.bytesPerLine(0);
-            
-            for (int y = 0; y < height; ++y) {
-                memcpy(dstY + y * dstYStride, srcY + y * srcYStride, yBytes);
-            }
-            
-            // Copy U plane
-            uint8_t* dstU = videoFrame.bits(1);
-            const uint8_t* srcU = frame->data[1];
-            const int dstUStride = videoFrame.bytesPerLine(1);
-            const int uHeight = height / 2;
-            
-            for (int y = 0; y < uHeight; ++y) {
-                memcpy(dstU + y * dstUStride, srcU + y * srcUStride, uvBytes);
-            }
-            
-            // Copy V plane
-            uint8_t* dstV = videoFrame.bits(2);
-            const uint8_t* srcV = frame->data[2];
-            const int dstVStride = videoFrame.bytesPerLine(2);
-            const int vHeight = height / 2;
-            
-            for (int y = 0; y < vHeight; ++y) {
-                memcpy(dstV + y * dstVStride, srcV + y * srcVStride, uvBytes);
-            }
-            
-            videoFrame.unmap();
-            
-            // Reset failure counter on success
-            static int mapFailures = 0;
-            if (mapFailures > 0) {
-                mapFailures = 0;
-            }
-        } else if (pixFormat == AV_PIX_FMT_BGRA) {
-            // BGRA: Already in RGB format, convert to QImage
-            // ✅ Validate stride before creating QImage to prevent assertion failures
-            const int srcStride = frame->linesize[0];
-            const int expectedStride = width * 4; // BGRA = 4 bytes per pixel
-            if (srcStride < expectedStride) {
-                qWarning() << "[FFmpeg] Invalid BGRA stride:" << srcStride << "needs:" << expectedStride;
-                return;
-            }
-            if (!frame->data[0]) {
-                qWarning() << "[FFmpeg] Invalid BGRA data pointer";
-                return;
-            }
-            QImage image(frame->data[0], width, height, srcStride, QImage::Format_ARGB32);
-            image = image.copy(); // Ensure Qt owns the pixel data
-            videoFrame = QVideoFrame(image);
-        } else {
-            // Fallback: Convert to RGB using swscale (if available) or return
-            qWarning() << "[FFmpeg] Unsupported pixel format for QVideoSink:" << av_get_pix_fmt_name((AVPixelFormat)frame->format);
+    qDebug() << "[FFmpeg] Deinterlace mode:"
+             << (mode == DeinterlaceOff ? "off" : (mode == DeinterlaceFrameRate ? "frame rate" : "field rate"));
+    emit deinterlaceModeChanged();
+}
+
+QList<int> FFmpegVideoPlayer::subtitleStreams() const
+{
+    QMutexLocker locker(&m_subtitleMutex);
+    return m_subtitleStreams;
+}
+
+void FFmpegVideoPlayer::setSubtitleStreams(const QList<int>& streams)
+{
+    {
+        QMutexLocker locker(&m_subtitleMutex);
+        if (m_subtitleStreams == streams) {
             return;
         }
+        m_subtitleStreams = streams;
+    }
+    
+    // Decoders are opened/closed by the decode thread at its next packet
+    FFmpegVideoPlayer* decoder = sharedDecoder();
+    (decoder ? decoder : this)->updateSessionOutput();
+    qDebug() << "[FFmpeg] Subtitle streams decoded from playback:" << streams;
+    emit subtitleStreamsChanged();
+}
+
+void FFmpegVideoPlayer::demuxSubtitles(const AVPacket* packet)
+{
+    if (m_subtitleStreamsDirty.exchange(false, std::memory_order_acq_rel)) {
+        syncSubtitleDecoders();
+    }
+    if (m_subtitleDecoders.isEmpty() || !m_formatContext) {
+        return;
+    }
+    
+    AVStream* stream = m_formatContext->streams[packet->stream_index];
+    
+    auto decoder = m_subtitleDecoders.constFind(packet->stream_index);
+    if (decoder != m_subtitleDecoders.constEnd()) {
+        FFmpegSubtitleExtractor::SubtitleEntry entry;
+        if (FFmpegSubtitleExtractor::decodePacket(decoder.value(), const_cast<AVPacket*>(packet), stream, entry)) {
+            m_subtitleCues.fetch_add(1, std::memory_order_relaxed);
+            emit subtitleCue(packet->stream_index, entry.startTime, entry.endTime, entry.text);
+        }
+    }
+    
+    // Coverage follows the demux position of all streams: packets are interleaved by time,
+    // so every subtitle packet before the furthest timestamp read has been seen
+    const int64_t ts = packet->pts != AV_NOPTS_VALUE ? packet->pts : packet->dts;
+    if (ts == AV_NOPTS_VALUE) {
+        return;
+    }
+    const qint64 ms = av_rescale_q(ts, stream->time_base, AVRational{1, 1000});
+    if (m_subtitleCoverageFromMs < 0) {
+        m_subtitleCoverageFromMs = ms;
+        m_subtitleCoverageToMs = ms;
+        m_subtitleCoverageReportedMs = -1;
+    } else if (ms > m_subtitleCoverageToMs) {
+        m_subtitleCoverageToMs = ms;
+    }
+    if (m_subtitleCoverageReportedMs < 0 ||
+        m_subtitleCoverageToMs - m_subtitleCoverageReportedMs >= SUBTITLE_COVERAGE_STEP_MS) {
+        m_subtitleCoverageReportedMs = m_subtitleCoverageToMs;
+        emit subtitleCoverageChanged(m_subtitleCoverageFromMs, m_subtitleCoverageToMs);
+    }
+}
+
+void FFmpegVideoPlayer::syncSubtitleDecoders()
+{
+    QList<int> wanted;
+    {
+        QMutexLocker locker(&m_subtitleMutex);
+        wanted = m_decodedSubtitleStreams;
+    }
+    
+    for (auto it = m_subtitleDecoders.begin(); it != m_subtitleDecoders.end();) {
+        if (wanted.contains(it.key())) {
+            ++it;
+            continue;
+        }
+        AVCodecContext* context = it.value();
+        avcodec_free_context(&context);
+        it = m_subtitleDecoders.erase(it);
+    }
+    
+    for (int index : wanted) {
+        if (m_subtitleDecoders.contains(index)) {
+            continue;
+        }
+        if (index < 0 || index >= int(m_formatContext->nb_streams) ||
+            m_formatContext->streams[index]->codecpar->codec_type != AVMEDIA_TYPE_SUBTITLE) {
+            qWarning() << "[FFmpeg] Stream" << index << "is not a subtitle stream - not decoding it";
+            continue;
+        }
         
-        // ✅ CRITICAL FIX: Queue frame to GUI thread (m_framePending already checked at function start)
-        // We checked m_framePending before creating QVideoFrame, so we know we can queue this frame
-        if (videoFrame.isValid()) {
-            // Mark as pending BEFORE queuing to prevent race condition
-            m_framePending.store(true, std::memory_order_release);
-            
-            QVideoFrame copy = videoFrame; // implicit shared copy
-            QMetaObject::invokeMethod(this, [this, copy]() mutable {
-                if (m_videoSink) {
-                    m_videoSink->setVideoFrame(copy);
-                }
-                m_framePending.store(false, std::memory_order_release); // Frame delivered, allow next one
-            }, Qt::QueuedConnection);
-            
-            // ✅ CRITICAL: Small throttle after queuing frame to allow Qt's render thread to process D3D11 resources
-            // QVideoFrame.map() was called from decode thread, allocating D3D11 staging texture
-            // Qt's render thread needs time to process and release these resources
-            // Without this throttle, we create frames faster than resources can be released → crash after ~2 seconds
-            // For HDR filter graph path, delay is already applied above, so this is for direct frames only
-            if (pixFormat != AV_PIX_FMT_P010LE && pixFormat != AV_PIX_FMT_YUV420P10LE) {
-                // Non-filter-graph path: smaller delay (filter graph already has 5ms delay)
-                QThread::msleep(2); // 2ms delay - minimal impact (~30fps = 33ms per frame, 2ms is ~6% overhead)
+        AVStream* stream = m_formatContext->streams[index];
+        const AVCodec* codec = avcodec_find_decoder(stream->codecpar->codec_id);
+        AVCodecContext* context = codec ? avcodec_alloc_context3(codec) : nullptr;
+        if (!context || avcodec_parameters_to_context(context, stream->codecpar) < 0) {
+            qWarning() << "[FFmpeg] No decoder for subtitle stream" << index;
+            avcodec_free_context(&context);
+            continue;
+        }
+        context->pkt_timebase = stream->time_base;
+        if (avcodec_open2(context, codec, nullptr) < 0) {
+            qWarning() << "[FFmpeg] Failed to open decoder for subtitle stream" << index << codec->name;
+            avcodec_free_context(&context);
+            continue;
+        }
+        m_subtitleDecoders.insert(index, context);
+    }
+    
+    // Newly opened streams have only seen packets from here on
+    m_subtitleCoverageFromMs = -1;
+}
+
+void FFmpegVideoPlayer::resetSubtitleDemux()
+{
+    for (AVCodecContext* context : std::as_const(m_subtitleDecoders)) {
+        avcodec_flush_buffers(context);
+    }
+    m_subtitleCoverageFromMs = -1;
+}
+
+void FFmpegVideoPlayer::closeSubtitleDecoders()
+{
+    for (AVCodecContext* context : std::as_const(m_subtitleDecoders)) {
+        avcodec_free_context(&context);
+    }
+    m_subtitleDecoders.clear();
+    m_subtitleCoverageFromMs = -1;
+    m_subtitleCues.store(0, std::memory_order_relaxed);
+    m_subtitleStreamsDirty.store(true, std::memory_order_release);
+}
+
+SwrContext* FFmpegVideoPlayer::createAudioResampler(const AVCodecContext* context) const
+{
+    AVChannelLayout outLayout = {};
+    // Use the selected output format (may be different from input if fallback was used)
+    av_channel_layout_default(&outLayout, m_audioFormat.channelCount());
+    
+    // ✅ Configure resampler to output format we selected (handles downmix if needed)
+    SwrContext* swr = nullptr;
+    int r = swr_alloc_set_opts2(
+        &swr,
+        &outLayout,
+        AV_SAMPLE_FMT_S16,
+        m_audioFormat.sampleRate(),  // Output sample rate (may differ from input)
+        &context->ch_layout,
+        context->sample_fmt,
+        context->sample_rate,        // Input sample rate
+        0,
+        nullptr
+    );
+    av_channel_layout_uninit(&outLayout);
+    
+    if (r < 0 || !swr) {
+        qWarning() << "[FFmpeg] Failed to allocate resampler - audio disabled";
+        swr_free(&swr);
+        return nullptr;
+    }
+    if (swr_init(swr) < 0) {
+        qWarning() << "[FFmpeg] Failed to init resampler - audio disabled";
+        swr_free(&swr);
+        return nullptr;
+    }
+    qDebug() << "[FFmpeg] Audio resampler initialized - input:" << context->sample_rate << "Hz,"
+             << context->ch_layout.nb_channels << "ch -> output:" << m_audioFormat.sampleRate() << "Hz,"
+             << m_audioFormat.channelCount() << "ch";
+    return swr;
+}
+
+QVariantList FFmpegVideoPlayer::audioTracks() const
+{
+    if (FFmpegVideoPlayer* decoder = sharedDecoder()) {
+        return decoder->audioTracks();
+    }
+    return m_audioTracks;
+}
+
+int FFmpegVideoPlayer::activeAudioTrack() const
+{
+    if (FFmpegVideoPlayer* decoder = sharedDecoder()) {
+        return decoder->activeAudioTrack();
+    }
+    return m_activeAudioTrack;
+}
+
+void FFmpegVideoPlayer::setActiveAudioTrack(int track)
+{
+    if (FFmpegVideoPlayer* decoder = sharedDecoder()) {
+        decoder->setActiveAudioTrack(track);
+        return;
+    }
+    if (track < 0 || track >= m_audioTrackStreams.size()) {
+        qWarning() << "[FFmpeg] Ignoring invalid audio track:" << track << "of" << m_audioTrackStreams.size();
+        return;
+    }
+    if (track == m_activeAudioTrack) {
+        return;
+    }
+    
+    // The decode thread opens the new decoder at the top of its next iteration (also while paused)
+    m_activeAudioTrack = track;
+    {
+        QMutexLocker locker(&m_decodeMutex);
+        m_requestedAudioStream.store(m_audioTrackStreams.at(track), std::memory_order_release);
+        m_decodeCondition.wakeAll();
+    }
+    qDebug() << "[FFmpeg] Audio track" << track << "requested (stream" << m_audioTrackStreams.at(track) << ")";
+    emit activeAudioTrackChanged();
+}
+
+bool FFmpegVideoPlayer::audioPushStale() const
+{
+    // Stopped or seeking: audio not yet in the ring belongs to the old position
+    return !m_decodeThreadRunning || !m_isPlaying ||
+           m_audioSeekPending.load(std::memory_order_acquire) ||
+           m_requestedSeekMs.load(std::memory_order_acquire) >= 0;
+}
+
+bool FFmpegVideoPlayer::audioPushMayWait() const
+{
+    // Paused (the sink is suspended and never drains), or the decode loop has a step or
+    // a track switch to serve - don't block it on the ring
+    return !audioPushStale() && !m_isPaused &&
+           m_requestedStep.load(std::memory_order_acquire) == 0 &&
+           m_requestedAudioStream.load(std::memory_order_acquire) < 0;
+}
+
+void FFmpegVideoPlayer::pushAudio(const char* pcm, qint64 bytes)
+{
+    if (!m_audioPushBacklog.isEmpty()) {
+        // Order is kept: new audio queues behind what did not fit before
+        m_audioPushBacklog.append(pcm, bytes);
+        flushAudioBacklog(true);
+        return;
+    }
+    
+    // The ring holds ~2s, so it only fills when audio runs far ahead of video in the file;
+    // then block until the sink drains it (readData() wakes us). The timeout only bounds how late
+    // stop/seek/pause/step/track switch requests are noticed; what didn't fit then is kept for later.
+    qint64 pushed = m_audioRing->push(pcm, bytes);
+    while (pushed < bytes && audioPushMayWait()) {
+        // Wait for a useful chunk, not every few sample frames the sink pulls
+        m_audioRing->waitForFreeBytes(qMin(bytes - pushed, m_audioRing->capacity() / 8), 100);
+        pushed += m_audioRing->push(pcm + pushed, bytes - pushed);
+    }
+    if (pushed < bytes && !audioPushStale()) {
+        m_audioPushBacklog.append(pcm + pushed, bytes - pushed);
+    }
+}
+
+void FFmpegVideoPlayer::flushAudioBacklog(bool wait)
+{
+    if (m_audioPushBacklog.isEmpty()) {
+        return;
+    }
+    if (!m_audioRing || audioPushStale()) {
+        m_audioPushBacklog.clear();
+        return;
+    }
+    
+    const qint64 bytes = m_audioPushBacklog.size();
+    const char* pcm = m_audioPushBacklog.constData();
+    qint64 pushed = m_audioRing->push(pcm, bytes);
+    while (wait && pushed < bytes && audioPushMayWait()) {
+        m_audioRing->waitForFreeBytes(qMin(bytes - pushed, m_audioRing->capacity() / 8), 100);
+        pushed += m_audioRing->push(pcm + pushed, bytes - pushed);
+    }
+    if (audioPushStale()) {
+        m_audioPushBacklog.clear();
+    } else {
+        m_audioPushBacklog.remove(0, pushed);
+    }
+}
+
+void FFmpegVideoPlayer::serveAudioTrackSwitch()
+{
+    const int streamIndex = m_requestedAudioStream.exchange(-1, std::memory_order_acq_rel);
+    if (streamIndex < 0 || streamIndex == m_audioStreamIndex || !m_formatContext) {
+        return;
+    }
+    if (switchAudioStream(streamIndex)) {
+        return;
+    }
+    
+    // Old track keeps playing - show it as active again (unless another switch came in meanwhile)
+    const int playingStream = m_audioStreamIndex;
+    QMetaObject::invokeMethod(this, [this, playingStream]() {
+        if (m_requestedAudioStream.load(std::memory_order_acquire) >= 0) {
+            return;
+        }
+        const int track = m_audioTrackStreams.indexOf(playingStream);
+        if (track != m_activeAudioTrack) {
+            m_activeAudioTrack = track;
+            emit activeAudioTrackChanged();
+        }
+    }, Qt::QueuedConnection);
+}
+
+bool FFmpegVideoPlayer::switchAudioStream(int streamIndex)
+{
+    const double switchStart = nowSeconds();
+    if (streamIndex >= static_cast<int>(m_formatContext->nb_streams)) {
+        return false;
+    }
+    AVStream* stream = m_formatContext->streams[streamIndex];
+    
+    // New decoder (and resampler to the device format the sink already runs at) before touching anything
+    const AVCodec* codec = avcodec_find_decoder(stream->codecpar->codec_id);
+    AVCodecContext* context = codec ? avcodec_alloc_context3(codec) : nullptr;
+    if (!context || avcodec_parameters_to_context(context, stream->codecpar) < 0 ||
+        avcodec_open2(context, codec, nullptr) < 0) {
+        qWarning() << "[FFmpeg] Audio track switch failed - cannot open decoder for stream" << streamIndex;
+        avcodec_free_context(&context);
+        return false;
+    }
+    SwrContext* swr = nullptr;
+    if (m_audioRing) {
+        swr = createAudioResampler(context);
+        if (!swr) {
+            qWarning() << "[FFmpeg] Audio track switch failed - no resampler for stream" << streamIndex;
+            avcodec_free_context(&context);
+            return false;
+        }
+    }
+    if (!m_audioFrame && !(m_audioFrame = av_frame_alloc())) {
+        swr_free(&swr);
+        avcodec_free_context(&context);
+        return false;
+    }
+    
+    // Where the new track takes over: what is audible once the sink buffer has played out, plus the
+    // time this switch takes. A seek still waiting for its audio keeps its own target.
+    double targetSec = NAN;
+    if (m_audioSeekPending.load(std::memory_order_acquire)) {
+        targetSec = m_audioSeekTargetSec;
+    } else {
+        bool audioValid = false;
+        const double audioClock = audioClockSeconds(&audioValid);
+        const qint64 bytesPerSecond = qint64(m_audioFormat.bytesPerFrame()) * m_audioFormat.sampleRate();
+        if (audioValid && bytesPerSecond > 0) {
+            const double sinkSeconds = double(m_audioSinkBufferBytes) / double(bytesPerSecond);
+            targetSec = audioClock + (sinkSeconds + AUDIO_SWITCH_LEAD_SECONDS) * m_playbackRate.load(std::memory_order_relaxed);
+        } else {
+            QMutexLocker guiLocker(&m_guiFrameMutex);
+            if (m_guiFramePts >= 0.0) {
+                targetSec = m_guiFramePts;
             }
+        }
+    }
+    
+    // The demuxer is ahead of the clock by the queued audio/video - packets of the new track for that span
+    // were discarded. Rewind to the keyframe before the target (never past the last video packet demuxed)
+    // and skip the video packets the decoder already has, so video decoding never notices.
+    // Not while stepping (resuming re-seeks anyway) or once the file was read to the end.
+    bool rewound = false;
+    if (m_isPlaying && m_audioRing && !std::isnan(targetSec) && m_videoStream && m_lastVideoPacketPos >= 0 &&
+        m_lastVideoPacketPts != AV_NOPTS_VALUE && !m_decoderDrained && m_stepFill == NoStepFill && m_gopCache.isEmpty()) {
+        const AVRational timeBase = m_videoStream->time_base;
+        int64_t seekPts = qMin<int64_t>(av_rescale_q(int64_t(targetSec * 1000.0), AVRational{1, 1000}, timeBase),
+                                        m_lastVideoPacketPts);
+        qint64 keyframePts = 0;
+        if (m_keyframeIndex.keyframeAtOrBefore(seekPts, &keyframePts)) {
+            seekPts = keyframePts;
+        }
+        
+        QMutexLocker demuxLocker(&m_demuxMutex);
+        avformat_flush(m_formatContext);
+        const int ret = av_seek_frame(m_formatContext, m_videoStreamIndex, seekPts, AVSEEK_FLAG_BACKWARD);
+        if (ret >= 0) {
+            m_videoReplayUntilPos = m_lastVideoPacketPos;
+            rewound = true;
         } else {
-            // Invalid frame - reset pending flag since we're not queueing
-            m_framePending.store(false, std::memory_order_release);
+            char errbuf[AV_ERROR_MAX_STRING_SIZE];
+            av_strerror(ret, errbuf, sizeof(errbuf));
+            qWarning() << "[FFmpeg] Audio track switch: rewind failed:" << errbuf << "- new track starts where the demuxer is";
+        }
+    } else if (m_stepFill != NoStepFill || !m_gopCache.isEmpty()) {
+        m_stepResync.store(true, std::memory_order_release);  // Resume re-seeks to the picture, new track included
+    }
+    
+    // Swap decoders. The presenter checks m_audioCodecContext under m_audioClockMutex - the old one is
+    // only freed once it can no longer be looking at it
+    {
+        QMutexLocker demuxLocker(&m_demuxMutex);
+        if (m_audioStreamIndex >= 0) {
+            m_formatContext->streams[m_audioStreamIndex]->discard = AVDISCARD_ALL;
+        }
+        stream->discard = AVDISCARD_DEFAULT;
+    }
+    AVCodecContext* previous = nullptr;
+    {
+        QMutexLocker clockLocker(&m_audioClockMutex);
+        previous = std::exchange(m_audioCodecContext, context);
+    }
+    avcodec_free_context(&previous);
+    m_audioStreamIndex = streamIndex;
+    swr_free(&m_swr);
+    m_swr = swr;
+    m_timeStretch.reset();
+    
+    // Rewound: the old track's queued audio keeps playing until the new one reaches the target (the cut-over
+    // is the seek-target path of the audio decode). Otherwise the new track just continues the queue.
+    if (m_audioRing && (rewound || m_audioSeekPending.load(std::memory_order_acquire))) {
+        m_audioSeekTargetSec = targetSec;
+        m_audioSeekPending.store(true, std::memory_order_release);
+        m_audioSwitchStartTime = switchStart;
+    }
+    
+    m_audioTrackSwitches.fetch_add(1, std::memory_order_relaxed);
+    setStatistic(QStringLiteral("audioStream"), streamIndex);
+    setStatistic(QStringLiteral("audioDecoder"), QString::fromUtf8(codec->name));
+    qDebug() << "[FFmpeg] Audio switched to stream" << streamIndex << codec->name
+             << (rewound ? "- re-reading from target" : "- continuing at demuxer position") << targetSec
+             << "setup:" << (nowSeconds() - switchStart) * 1000.0 << "ms";
+    return true;
+}
+
+bool FFmpegVideoPlayer::dropReplayedVideoPacket(const AVPacket* packet)
+{
+    if (m_videoReplayUntilPos >= 0) {
+        if (packet->pos < 0 || packet->pos <= m_videoReplayUntilPos) {
+            return true;
         }
+        m_videoReplayUntilPos = -1;  // Caught up with what the video decoder has
+    }
+    m_lastVideoPacketPos = packet->pos;
+    // Presentation order, like the keyframe index it is compared with (B-frames arrive out of order)
+    const int64_t pts = packet->pts != AV_NOPTS_VALUE ? packet->pts : packet->dts;
+    if (pts != AV_NOPTS_VALUE && (m_lastVideoPacketPts == AV_NOPTS_VALUE || pts > m_lastVideoPacketPts)) {
+        m_lastVideoPacketPts = pts;
+    }
+    return false;
+}
+
+void FFmpegVideoPlayer::resetVideoReplay()
+{
+    m_lastVideoPacketPos = -1;
+    m_lastVideoPacketPts = AV_NOPTS_VALUE;
+    m_videoReplayUntilPos = -1;
+    m_audioSwitchStartTime = 0.0;
 }
 
 QUrl FFmpegVideoPlayer::source() const
@@ -2532,20 +3383,26 @@ void FFmpegVideoPlayer::setSource(const QUrl& source)
     
     qDebug() << "[FFmpeg] setSource() called with:" << source;
     
+    leaveSession();
     stop();
     closeMedia();
+    m_preferredAudioTrack = -1;
     
     m_source = source;
     emit sourceChanged();
     
-    // Only open media if D3D11 is already initialized
+    // Another window already decodes this file: show its frames instead of decoding it again
+    if (joinSession()) {
+        return;
+    }
+    
+    // Only open media once the scene graph is up
     // Otherwise, onSceneGraphInitialized() will open it when RHI is ready
-    if (m_d3d11Device && m_d3d11Context) {
-        // D3D11 is ready, open immediately
+    // (the headless benchmark has no scene graph - FFmpeg creates its own decode device)
+    if (m_benchmarkMode || m_sceneGraphReady.load(std::memory_order_acquire)) {
         openMedia();
     } else {
-        // D3D11 not ready yet - wait for scene graph initialization
-        qDebug() << "[FFmpeg] Source set, waiting for D3D11 initialization...";
+        qDebug() << "[FFmpeg] Source set, waiting for scene graph initialization...";
     }
 }
 
@@ -2553,6 +3410,14 @@ void FFmpegVideoPlayer::setVideoSink(QVideoSink* sink)
 {
     if (m_videoSink == sink) return;
     m_videoSink = sink;
+    
+    // Follower: show the shared decode's current frame right away (matters while paused)
+    if (FFmpegVideoPlayer* decoder = sharedDecoder(); decoder && m_videoSink) {
+        QMutexLocker guiLocker(&decoder->m_guiFrameMutex);
+        if (decoder->m_guiFrame.isValid()) {
+            m_videoSink->setVideoFrame(decoder->m_guiFrame);
+        }
+    }
     emit videoSinkChanged();
 }
 
@@ -2570,10 +3435,12 @@ void FFmpegVideoPlayer::setWindow(QQuickWindow* window)
     }
     
     m_window = window;
+    m_sceneGraphReady.store(false, std::memory_order_release);
     emit windowChanged();
     
     if (!m_window) {
         qDebug() << "[FFmpeg] Window set to nullptr";
+        updateVideoSuspended();
         return;
     }
     
@@ -2588,6 +3455,10 @@ void FFmpegVideoPlayer::setWindow(QQuickWindow* window)
         Qt::DirectConnection
     );
     
+    // Minimized window: decode audio only (see updateVideoSuspended())
+    connect(m_window, &QWindow::visibilityChanged, this, &FFmpegVideoPlayer::updateVideoSuspended);
+    updateVideoSuspended();
+    
     // CRITICAL: If scene graph is already initialized, call immediately
     // This handles the case where window is set after scene graph is ready
     if (m_window->rhi()) {
@@ -2600,6 +3471,10 @@ void FFmpegVideoPlayer::setWindow(QQuickWindow* window)
 
 void FFmpegVideoPlayer::play()
 {
+    if (FFmpegVideoPlayer* decoder = sharedDecoder()) {
+        decoder->play();
+        return;
+    }
     QMutexLocker locker(&m_decodeMutex);
     
     // play() should NEVER open media - it should only start/resume playback if media is already opened
@@ -2628,47 +3503,41 @@ void FFmpegVideoPlayer::play()
         double pausedDuration = nowSeconds() - m_pauseTime;
         qDebug() << "[FFmpeg] Resuming from pause - paused for:" << pausedDuration << "seconds";
         
-        // Resume audio - check device state first to avoid AUDCLNT_E_NOT_STOPPED
-        if (m_audioSink) {
+        // Resume audio - check sink state first to avoid AUDCLNT_E_NOT_STOPPED
+        if (m_audioSink && m_audioRing) {
             QMutexLocker audioLock(&m_audioMutex);
-            if (m_audioDevice && m_audioDevice->isOpen()) {
-                // Device is open - safe to resume
-                // NOTE: QAudioSink::processedUSecs() automatically pauses when suspended,
-                // so resume() will continue from where it left off - no timing adjustment needed
+            if (m_audioSink->state() != QAudio::StoppedState) {
+                // Sink is suspended - safe to resume
+                // NOTE: the sink stops pulling while suspended, so the consumed-bytes clock
+                // continues from where it left off - no timing adjustment needed
                 m_audioSink->resume();
             } else {
-                // Device was stopped - need to restart it
-                qDebug() << "[FFmpeg] Audio device was stopped, restarting...";
-                // Properly close device first to avoid AUDCLNT_E_NOT_STOPPED
-                if (m_audioDevice && m_audioDevice->isOpen()) {
-                    m_audioDevice->close();
-                }
-                m_audioSink->stop();
-                m_audioSink->suspend();
-                m_audioDevice = nullptr;
-                QThread::msleep(20); // Wait for device release
+                // Sink was stopped - restart pulling from the ring
+                qDebug() << "[FFmpeg] Audio sink was stopped, restarting...";
                 m_audioSink->setVolume(m_volume); // Ensure volume is set after restart
-                m_audioDevice = m_audioSink->start();
-                if (!m_audioDevice || !m_audioDevice->isOpen()) {
-                    qWarning() << "[FFmpeg] Failed to restart audio device after pause";
+                m_audioSink->start(m_audioRing);
+                if (m_audioSink->state() == QAudio::StoppedState) {
+                    qWarning() << "[FFmpeg] Failed to restart audio sink after pause:" << m_audioSink->error();
                 }
                 audioLock.unlock(); // Release lock after audio operations
                 // Reset audio base PTS since we're restarting
-                m_audioBasePts = NAN;
-                m_audioClock = 0.0;
+                resetAudioClock();
             }
         }
         
         // ✅ CRITICAL: Only adjust wall clock timing if audio is NOT the master
-        // If audio is master, processedUSecs() handles pause/resume automatically
+        // If audio is master, the consumed-bytes clock handles pause/resume automatically
         // Adjusting m_startTime when audio is master causes desync
-        if (!m_audioSink || !m_audioDevice || !m_audioDevice->isOpen() || std::isnan(m_audioBasePts)) {
-            // No audio - adjust wall clock to account for pause
+        if (m_masterClock.load(std::memory_order_relaxed) != AudioClock ||
+            !m_audioSink || !m_audioRing || !hasAudioClockBase()) {
+            // Wall clock drives presentation - shift it past the pause
+            QMutexLocker clockLocker(&m_clockMutex);
             m_startTime += pausedDuration;
         }
         // If audio is available, don't adjust m_startTime - audio clock handles it
         
-        // Wake up decode thread
+        // Wake up decode thread and presenter
+        m_presentPaused.store(false, std::memory_order_release);
         m_decodeCondition.wakeAll();
         locker.unlock();
         
@@ -2679,12 +3548,13 @@ void FFmpegVideoPlayer::play()
     // START: Fresh playback from beginning
     // Only reset to beginning if we're not in the middle of a seek
     // (seeks set m_seekPending, so we should preserve that state)
-    if (m_seekPending.load(std::memory_order_acquire)) {
+    if (m_seekPending.load(std::memory_order_acquire) || m_requestedSeekMs.load(std::memory_order_acquire) >= 0) {
         // We're in the middle of a seek - don't reset anything
         // Just ensure playback is active
         qDebug() << "[FFmpeg] play() called during seek - preserving seek state";
         m_isPlaying = true;
         m_isPaused = false;
+        m_presentPaused.store(false, std::memory_order_release);
         m_decodeCondition.wakeAll();
         locker.unlock();
         emit playbackStateChanged();
@@ -2694,6 +3564,7 @@ void FFmpegVideoPlayer::play()
     // Reset decoder state
     m_decoderDrained = false;
     m_sentAnyPacket = false;
+    m_stepResync.store(false, std::memory_order_release);  // Starting over - nothing to re-sync to
     
     // Reset demuxer and seek to beginning (protected by demux mutex)
     {
@@ -2725,32 +3596,35 @@ void FFmpegVideoPlayer::play()
     if (m_codecContext) {
         avcodec_flush_buffers(m_codecContext);
     }
+    if (m_deinterlacer) {
+        m_deinterlacer->reset();  // Held-back frame belongs to the old position
+    }
+    resetSubtitleDemux();
+    resetVideoReplay();
     
-    // Reset timing for fresh playback
+    // Reset timing for fresh playback (frames queued for the old position are discarded)
+    flushPresentationQueue();
     m_timingInitialized = false;
-    m_startTime = 0.0;
-    m_startPts = 0.0;
+    setWallClockAnchor(0.0, 0.0);
     m_position = 0;
     
     // ✅ CRITICAL: Reset audio clock on fresh playback from beginning
     // Otherwise audio clock continues from previous playback, causing all frames to be dropped
-    m_audioBasePts = NAN;
-    m_audioClock = 0.0;
+    resetAudioClock();
     m_audioSeekPending.store(false, std::memory_order_release);
-    m_audioProcessedBaseUSecs = 0;  // Reset base - will be snapshotted at first frame
     m_holdVideoUntilAudio.store(false, std::memory_order_release);  // No hold needed for fresh playback
-    // Clear audio buffer for fresh playback
-    m_audioRemainder.clear();
     
-    // Only restart audio device if it's not already running
+    // Only restart audio sink if it's not already running
     // This prevents unnecessary stop/start cycles (and AUDCLNT_E_NOT_STOPPED)
-    if (m_audioSink) {
-        if (!m_audioDevice || !m_audioDevice->isOpen()) {
-            // Device not running - start it
+    if (m_audioSink && m_audioRing) {
+        // Drop audio queued for the old position (clock base is re-set by the first frame)
+        m_audioRing->discardQueued();
+        if (m_audioSink->state() == QAudio::StoppedState) {
+            // Sink not running - start pulling from the ring
             m_audioSink->setVolume(m_volume);
-            m_audioDevice = m_audioSink->start();
-            if (!m_audioDevice || !m_audioDevice->isOpen()) {
-                qWarning() << "[FFmpeg] Failed to start audio device on play()";
+            m_audioSink->start(m_audioRing);
+            if (m_audioSink->state() == QAudio::StoppedState) {
+                qWarning() << "[FFmpeg] Failed to start audio sink on play():" << m_audioSink->error();
             }
         } else {
             // Device already running - just ensure volume is correct and resume if paused
@@ -2763,6 +3637,7 @@ void FFmpegVideoPlayer::play()
     
     m_isPlaying = true;
     m_isPaused = false;
+    m_presentPaused.store(false, std::memory_order_release);
     
     // Wake up decode thread
     m_decodeCondition.wakeAll();
@@ -2776,6 +3651,10 @@ void FFmpegVideoPlayer::play()
 
 void FFmpegVideoPlayer::pause()
 {
+    if (FFmpegVideoPlayer* decoder = sharedDecoder()) {
+        decoder->pause();
+        return;
+    }
     QMutexLocker locker(&m_decodeMutex);
     
     if (!m_isPlaying || m_isPaused) {
@@ -2784,6 +3663,7 @@ void FFmpegVideoPlayer::pause()
     
     m_isPaused = true;
     m_pauseTime = nowSeconds();
+    m_presentPaused.store(true, std::memory_order_release);  // Queued frames stay queued for resume
     
     // Pause audio
     if (m_audioSink) {
@@ -2801,23 +3681,32 @@ void FFmpegVideoPlayer::pause()
 
 void FFmpegVideoPlayer::stop()
 {
+    if (FFmpegVideoPlayer* decoder = sharedDecoder()) {
+        decoder->stop();
+        return;
+    }
     QMutexLocker locker(&m_decodeMutex);
     
     m_isPlaying = false;
     m_isPaused = false;
+    m_presentPaused.store(true, std::memory_order_release);
+    m_requestedSeekMs.store(-1, std::memory_order_release);
+    m_requestedStep.store(0, std::memory_order_release);
+    m_stepResync.store(false, std::memory_order_release);
+    flushPresentationQueue();
     
     // Stop audio
     if (m_audioSink) {
         QMutexLocker audioLock(&m_audioMutex);
         m_audioSink->stop();
+        m_audioRing->discardQueued();
     }
     
     // Reset timing
     m_timingInitialized = false;
-    m_startTime = 0.0;
-    m_startPts = 0.0;
+    setWallClockAnchor(0.0, 0.0);
     m_position = 0;
-    m_audioClock = 0.0;
+    resetAudioClock();
     
     // Wake decode thread so it can exit cleanly
     m_decodeCondition.wakeAll();
@@ -2831,71 +3720,134 @@ void FFmpegVideoPlayer::stop()
 
 void FFmpegVideoPlayer::seek(int ms)
 {
+    if (FFmpegVideoPlayer* decoder = sharedDecoder()) {
+        decoder->seek(ms);
+        return;
+    }
     if (!m_formatContext || !m_codecContext || m_videoStreamIndex < 0 || !m_videoStream) {
         qWarning() << "[FFmpeg] Cannot seek - media not ready";
         return;
     }
     
-    qDebug() << "[FFmpeg] seek() called from C++:" << ms << "ms";
-    
     // Clamp seek position to valid range
     qint64 positionMs = qBound<qint64>(qint64(0), qint64(ms), m_duration);
     
-    QMutexLocker decodeLocker(&m_decodeMutex);
-    QMutexLocker demuxLocker(&m_demuxMutex);
+    // ✅ Coalesce rapid seeks (scrubbing): only the latest target is stored, and the decode thread
+    // serves it at the top of its loop - requests that arrive while it is busy just replace the target
+    m_seeksRequested.fetch_add(1, std::memory_order_relaxed);
+    m_seekRequestWallTime.store(nowSeconds(), std::memory_order_relaxed);
+    if (m_requestedSeekMs.exchange(positionMs, std::memory_order_acq_rel) >= 0) {
+        m_seeksCoalesced.fetch_add(1, std::memory_order_relaxed);
+    }
     
-    // Convert ms → stream timebase
-    AVRational timeBase = m_videoStream->time_base;
-    int64_t seekPts = av_rescale_q(
-        positionMs,
-        AVRational{1, 1000},
-        timeBase
-    );
-    
-    qDebug() << "[FFmpeg] seek pts:" << seekPts << "timebase:" << timeBase.num << "/" << timeBase.den;
-    
-    // Flush demuxer (clears packet queues)
-    avformat_flush(m_formatContext);
+    {
+        QMutexLocker decodeLocker(&m_decodeMutex);
+        
+        // Drop frames queued for the old position now (also releases a decode thread blocked on the queue)
+        flushPresentationQueue();
+        
+        // Update position immediately
+        m_position = positionMs;
+        
+        // Wake decode thread to serve the request (also while paused)
+        m_decodeCondition.wakeAll();
+    }
     
-    // Perform seek (AVSEEK_FLAG_BACKWARD ensures we get a keyframe)
-    int ret = av_seek_frame(
-        m_formatContext,
-        m_videoStreamIndex,
-        seekPts,
-        AVSEEK_FLAG_BACKWARD
-    );
+    emit positionChanged();
     
-    if (ret < 0) {
-        char errbuf[AV_ERROR_MAX_STRING_SIZE];
-        av_strerror(ret, errbuf, sizeof(errbuf));
-        qWarning() << "[FFmpeg] av_seek_frame failed:" << ret << errbuf;
+    FFLOG("[FFmpeg] seek() requested:" << positionMs << "ms");
+}
+
+void FFmpegVideoPlayer::performSeek(qint64 positionMs)
+{
+    if (!m_formatContext || !m_codecContext || m_videoStreamIndex < 0 || !m_videoStream) {
         return;
     }
     
-    // Flush decoders AFTER seek (critical - prevents old frames after seek)
-    avcodec_flush_buffers(m_codecContext);
+    // Convert ms → stream timebase
+    const AVRational timeBase = m_videoStream->time_base;
+    const int64_t seekPts = av_rescale_q(positionMs, AVRational{1, 1000}, timeBase);
+    const double seekPtsSeconds = seekPts * av_q2d(timeBase);
+    
+    // Nearest keyframe at or before the target (falls back to a plain backward seek without an index)
+    qint64 keyframePts = 0;
+    const bool haveKeyframe = m_keyframeIndex.keyframeAtOrBefore(seekPts, &keyframePts);
+    const double keyframeSeconds = haveKeyframe ? keyframePts * av_q2d(timeBase) : 0.0;
+    
+    // ✅ Target is ahead of the decoder in the GOP it is already decoding: no demuxer seek and no
+    // decoder flush - decoding forward from here is cheaper than restarting at the keyframe
+    const bool decodeForward = haveKeyframe && !m_decoderDrained && m_lastDecodedVideoPts >= 0.0 &&
+                               keyframeSeconds <= m_lastDecodedVideoPts && seekPtsSeconds > m_lastDecodedVideoPts &&
+                               seekPtsSeconds - m_lastDecodedVideoPts < MAX_DECODE_FORWARD_SECONDS;
+    
+    if (!decodeForward) {
+        QMutexLocker demuxLocker(&m_demuxMutex);
+        
+        // Flush demuxer (clears packet queues)
+        avformat_flush(m_formatContext);
+        
+        // Seek straight to the indexed keyframe; AVSEEK_FLAG_BACKWARD keeps us on a keyframe either way
+        int ret = av_seek_frame(
+            m_formatContext,
+            m_videoStreamIndex,
+            haveKeyframe ? keyframePts : seekPts,
+            AVSEEK_FLAG_BACKWARD
+        );
+        
+        if (ret < 0) {
+            char errbuf[AV_ERROR_MAX_STRING_SIZE];
+            av_strerror(ret, errbuf, sizeof(errbuf));
+            qWarning() << "[FFmpeg] av_seek_frame failed:" << ret << errbuf;
+            return;
+        }
+        
+        // Flush decoders AFTER seek (critical - prevents old frames after seek)
+        avcodec_flush_buffers(m_codecContext);
+        if (m_audioCodecContext) {
+            avcodec_flush_buffers(m_audioCodecContext);
+        }
+        if (m_deinterlacer) {
+            m_deinterlacer->reset();
+        }
+        resetSubtitleDemux();
+        resetVideoReplay();
+        m_lastDecodedVideoPts = -1.0;
+        
+        // Reset decoder state
+        m_decoderDrained = false;
+        m_sentAnyPacket = false;
+    }
+    
+    // Drop frames converted for the old position (decoded since seek() flushed the queue)
+    flushPresentationQueue();
+    
+    // A seek ends any stepping session (decoder and audio are re-synced by the seek itself)
+    cancelStepFill();
+    m_stepSalvage.clear();
+    m_gopCache.clear();
+    m_stepReachedStart = false;
+    m_stepResync.store(false, std::memory_order_release);
+    m_rateNextPts = -1.0;
     
     // Reset timing for new position
     m_timingInitialized = false;
-    double seekPtsSeconds = seekPts * av_q2d(timeBase);
-    m_startPts = seekPtsSeconds;
-    m_startTime = nowSeconds();  // ✅ FIX #1: Set to now (not "now - pts") for correct wall clock calculation
+    setWallClockAnchor(seekPtsSeconds, nowSeconds());  // ✅ FIX #1: Anchor at now (not "now - pts") for correct wall clock calculation
     m_playStartWallTime = nowSeconds();  // ✅ Set grace window start time for frame drop prevention
     
-    // Mark video seek as pending - decode loop will discard frames until we reach target
+    // Mark video seek as pending - decode loop discards (and skips decoding non-reference) frames until the target
     m_seekTargetPts = seekPtsSeconds;
+    m_seekFramesDiscarded = 0;
+    m_seekPreviewPending = true;
     m_seekPending.store(true, std::memory_order_release);
     
     // ✅ OPTION A: Keep audio device running - just clear buffers and mark seek pending
     if (m_audioCodecContext) {
-        avcodec_flush_buffers(m_audioCodecContext);
-        // Clear audio buffer - drop old audio data
-        m_audioRemainder.clear();
+        // Drop queued audio for the old position - the sink skips it on its next pull
+        if (m_audioRing) {
+            m_audioRing->discardQueued();
+        }
         // Reset audio clock - will be set by first good frame after seek
-        m_audioClock = 0.0;
-        m_audioBasePts = NAN;
-        // Clear processedUSecs base - will be snapshotted when first good frame arrives
-        m_audioProcessedBaseUSecs = m_audioSink ? m_audioSink->processedUSecs() : 0;  // Optional snapshot, will be updated at first frame
+        resetAudioClock();
         // Set audio seek target (in seconds) - decode loop will drop frames until we reach it
         m_audioSeekTargetSec = positionMs / 1000.0;  // Convert ms to seconds
         // Convert to audio stream timebase if available for better precision
@@ -2913,12 +3865,6 @@ void FFmpegVideoPlayer::seek(int ms)
         // ✅ NEW: prevent video presentation until audio is ready after seek
         // This ensures video and audio start together, preventing A/V desync
         m_holdVideoUntilAudio.store(true, std::memory_order_release);
-        
-        qDebug() << "[FFmpeg] Audio seek pending - target:" << m_audioSeekTargetSec << "seconds (device kept running, video held)";
-        
-        // Optional: Write a small silence chunk to avoid pops (5-10ms)
-        // This is optional - if you want smooth scrubbing you can add it
-        // For now, we'll just let the buffer drain naturally
     } else {
         // No audio stream - video can present immediately
         m_holdVideoUntilAudio.store(false, std::memory_order_release);
@@ -2928,34 +3874,426 @@ void FFmpegVideoPlayer::seek(int ms)
     // This prevents AUDCLNT_E_NOT_STOPPED errors during rapid seeking
     // The audio device stays active, we just drop old buffers and seek in the stream
     
-    // Update position immediately
-    m_position = positionMs;
+    setStatistic("lastSeekMode", decodeForward ? QStringLiteral("decode-forward")
+                                               : (haveKeyframe ? QStringLiteral("keyframe-index") : QStringLiteral("backward")));
+    qDebug() << "[FFmpeg] Seek to" << positionMs << "ms (PTS:" << seekPts << ")"
+             << (decodeForward ? "- decoding forward from" : "- from keyframe")
+             << (decodeForward ? m_lastDecodedVideoPts : keyframeSeconds) << "s";
+}
+
+void FFmpegVideoPlayer::stepForward()
+{
+    if (FFmpegVideoPlayer* decoder = sharedDecoder()) {
+        decoder->stepForward();
+        return;
+    }
+    requestStep(1);
+}
+
+void FFmpegVideoPlayer::stepBackward()
+{
+    if (FFmpegVideoPlayer* decoder = sharedDecoder()) {
+        decoder->stepBackward();
+        return;
+    }
+    requestStep(-1);
+}
+
+bool FFmpegVideoPlayer::exportClip(int inMs, int outMs, const QUrl& outputUrl)
+{
+    const QString inputPath = m_source.toLocalFile();
+    const QString outputPath = outputUrl.isLocalFile() ? outputUrl.toLocalFile() : outputUrl.toString();
+    if (inputPath.isEmpty() || outputPath.isEmpty()) {
+        qWarning() << "[FFmpeg] Clip export needs a local source and output file";
+        return false;
+    }
+    if (QFileInfo(outputPath).absoluteFilePath() == QFileInfo(inputPath).absoluteFilePath()) {
+        qWarning() << "[FFmpeg] Clip export can't overwrite its source:" << outputPath;
+        return false;
+    }
+    if (outMs >= 0 && outMs <= inMs) {
+        qWarning() << "[FFmpeg] Invalid clip range:" << inMs << "-" << outMs << "ms";
+        return false;
+    }
+    if (m_clipExporter && m_clipExporter->running()) {
+        qWarning() << "[FFmpeg] Clip export already running";
+        return false;
+    }
+    
+    FFmpegRemuxer::Range range;
+    range.startUs = qint64(qMax(0, inMs)) * 1000;
+    range.endUs = outMs >= 0 && (m_duration <= 0 || outMs < m_duration) ? qint64(outMs) * 1000 : -1;
     
-    // Reset decoder state
+    // ✅ Snap to keyframes up front so the clip is exactly what the index says
+    // (without an index the remuxer finds the in point from the packets, the out point becomes
+    // the first keyframe the copy meets)
+    if (m_videoStream && m_keyframeIndex.source() != FFmpegKeyframeIndex::NoIndex) {
+        const AVRational timeBase = m_videoStream->time_base;
+        qint64 keyframePts = 0;
+        if (m_keyframeIndex.keyframeAtOrBefore(av_rescale_q(range.startUs, AV_TIME_BASE_Q, timeBase), &keyframePts)) {
+            range.startUs = av_rescale_q(keyframePts, timeBase, AV_TIME_BASE_Q);
+        }
+        if (range.endUs >= 0) {
+            if (m_keyframeIndex.keyframeAtOrAfter(av_rescale_q(range.endUs, AV_TIME_BASE_Q, timeBase), &keyframePts)) {
+                range.endUs = av_rescale_q(keyframePts, timeBase, AV_TIME_BASE_Q);
+            } else {
+                range.endUs = -1;  // Out point is in the last GOP - copy to the end
+            }
+        }
+    }
+    
+    if (!m_clipExporter) {
+        m_clipExporter = new FFmpegRemuxer(this);
+        connect(m_clipExporter, &FFmpegRemuxer::runningChanged, this, &FFmpegVideoPlayer::clipExportRunningChanged);
+        connect(m_clipExporter, &FFmpegRemuxer::progressChanged, this, &FFmpegVideoPlayer::clipExportProgressChanged);
+        connect(m_clipExporter, &FFmpegRemuxer::finished, this, [this](const FFmpegRemuxer::Result& result) {
+            const int startMs = result.startUs >= 0 ? int(result.startUs / 1000) : 0;
+            const int endMs = result.endUs >= 0 ? int(result.endUs / 1000) : int(m_duration);
+            if (result.success) {
+                qDebug() << "[FFmpeg] Clip exported:" << result.outputPath << startMs << "-" << endMs << "ms,"
+                         << result.packets << "packets";
+            } else if (!result.cancelled) {
+                qWarning() << "[FFmpeg] Clip export failed:" << result.error;
+            }
+            emit clipExportFinished(result.success, QUrl::fromLocalFile(result.outputPath), startMs, endMs, result.error);
+        });
+    }
+    
+    qDebug() << "[FFmpeg] Exporting clip" << inMs << "-" << outMs << "ms → keyframes"
+             << range.startUs / 1000 << "-" << (range.endUs >= 0 ? range.endUs / 1000 : -1) << "ms to" << outputPath;
+    return m_clipExporter->start(inputPath, outputPath, range);
+}
+
+void FFmpegVideoPlayer::cancelClipExport()
+{
+    if (m_clipExporter) {
+        m_clipExporter->cancel();
+    }
+}
+
+bool FFmpegVideoPlayer::clipExportRunning() const
+{
+    return m_clipExporter && m_clipExporter->running();
+}
+
+qreal FFmpegVideoPlayer::clipExportProgress() const
+{
+    return m_clipExporter ? m_clipExporter->progress() : 0.0;
+}
+
+void FFmpegVideoPlayer::requestStep(int frames)
+{
+    if (!m_formatContext || !m_codecContext || m_videoStreamIndex < 0 || !m_videoStream || !m_videoSink) {
+        qWarning() << "[FFmpeg] Cannot step - media not ready";
+        return;
+    }
+    if (!m_isPlaying) {
+        qDebug() << "[FFmpeg] Frame step ignored - playback is stopped";
+        return;
+    }
+    
+    // Stepping always happens on a paused picture
+    if (!m_isPaused) {
+        pause();
+    }
+    
+    QMutexLocker decodeLocker(&m_decodeMutex);
+    
+    // Rapid key repeats just add up - the decode thread serves the sum
+    m_requestedStep.fetch_add(frames, std::memory_order_acq_rel);
+    
+    // Frames already converted ahead of the paused picture are exactly the next steps forward:
+    // hand them to the decode thread instead of dropping them (this also releases it from a full queue)
+    for (QueuedFrame& queued : takePresentationQueue()) {
+        m_stepSalvage.push_back(std::move(queued));
+    }
+    
+    m_decodeCondition.wakeAll();
+}
+
+bool FFmpegVideoPlayer::performStep(int frames)
+{
+    // Step from the seek target once it is on screen, and from a finished fill
+    // (a prefetch may keep running while steps are served from the cache)
+    if (m_seekPending.load(std::memory_order_acquire) || (m_stepFill != NoStepFill && m_stepFill != PrefetchFill)) {
+        return false;
+    }
+    
+    QVideoFrame displayed;
+    double current = -1.0;
+    {
+        QMutexLocker guiLocker(&m_guiFrameMutex);
+        displayed = m_guiFrame;
+        current = m_guiFramePts;
+    }
+    if (current < 0.0 || !displayed.isValid()) {
+        m_stepSalvage.clear();
+        return true;  // Nothing on screen to step from
+    }
+    
+    // A run that doesn't hold the picture belongs to an earlier position - start a new one there
+    if (!m_gopCache.contains(current)) {
+        cancelStepFill();
+        m_gopCache.clear();
+        m_stepReachedStart = false;
+        m_gopCache.insert(current, 0.0, displayed, current);
+    }
+    for (const QueuedFrame& queued : m_stepSalvage) {
+        m_gopCache.insert(queued.pts, queued.duration, queued.frame, current);
+    }
+    m_stepSalvage.clear();
+    m_stepResync.store(true, std::memory_order_release);
+    
+    const FFmpegGopCache::Entry* target = frames > 0 ? m_gopCache.after(current, frames)
+                                                     : m_gopCache.before(current, -frames);
+    if (target) {
+        ++m_stepsFromCache;
+        presentStepFrame(*target);
+        if (frames < 0) {
+            prefetchPreviousGop();
+        }
+        return true;
+    }
+    
+    if (m_stepFill == PrefetchFill) {
+        return false;  // Decoding the previous GOP right now - serve the step once it lands in the cache
+    }
+    if (frames < 0 && m_stepReachedStart && m_gopCache.countBefore(current) == 0) {
+        return true;  // Already on the first frame
+    }
+    
+    startStepFill(frames, current);
+    return true;
+}
+
+void FFmpegVideoPlayer::startStepFill(int frames, double fromPts)
+{
+    m_stepFillFrames = std::abs(frames);
+    m_stepFillFromPts = fromPts;
+    m_stepFillDecoded = 0;
+    m_stepStaging.clear();
+    m_stepStagingBytes = 0;
+    
+    if (frames > 0) {
+        // Decoder still sits right after the run (consecutive forward steps): just keep decoding.
+        // Otherwise restart at the keyframe of the run's last frame.
+        const double anchor = m_gopCache.lastPts();
+        const bool aligned = !m_decoderDrained && m_lastDecodedVideoPts >= 0.0 &&
+                             std::abs(m_lastDecodedVideoPts - anchor) < 0.0005;
+        if (!aligned && !seekForStep(anchor, false)) {
+            return;
+        }
+        m_stepFill = StepForwardFill;
+    } else {
+        // Decode the GOP before the run (staged until it reaches the run)
+        m_stepFillEndPts = m_gopCache.firstPts();
+        if (!seekForStep(m_stepFillEndPts, true)) {
+            return;
+        }
+        m_stepFill = StepBackwardFill;
+    }
+    
+    FFLOG("[FFmpeg] Frame step fill" << (frames > 0 ? "forward" : "backward") << "from" << fromPts);
+}
+
+bool FFmpegVideoPlayer::seekForStep(double pts, bool strictlyBefore)
+{
+    const AVRational timeBase = m_videoStream->time_base;
+    int64_t target = std::llround(pts / av_q2d(timeBase)) - (strictlyBefore ? 1 : 0);
+    
+    qint64 keyframePts = 0;
+    if (m_keyframeIndex.keyframeAtOrBefore(target, &keyframePts)) {
+        target = keyframePts;
+    } else if (strictlyBefore && m_keyframeIndex.source() != FFmpegKeyframeIndex::NoIndex) {
+        m_stepReachedStart = true;  // No keyframe before the run - it starts the stream
+        return false;
+    }
+    
+    {
+        QMutexLocker demuxLocker(&m_demuxMutex);
+        avformat_flush(m_formatContext);
+        const int ret = av_seek_frame(m_formatContext, m_videoStreamIndex, target, AVSEEK_FLAG_BACKWARD);
+        if (ret < 0) {
+            char errbuf[AV_ERROR_MAX_STRING_SIZE];
+            av_strerror(ret, errbuf, sizeof(errbuf));
+            qWarning() << "[FFmpeg] Frame step seek failed:" << ret << errbuf;
+            return false;
+        }
+    }
+    
+    avcodec_flush_buffers(m_codecContext);
+    if (m_audioCodecContext) {
+        avcodec_flush_buffers(m_audioCodecContext);
+    }
+    if (m_deinterlacer) {
+        m_deinterlacer->reset();
+    }
+    resetSubtitleDemux();  // Demux position jumped - coverage restarts once playback resumes
+    resetVideoReplay();
+    m_lastDecodedVideoPts = -1.0;
     m_decoderDrained = false;
     m_sentAnyPacket = false;
+    return true;
+}
+
+void FFmpegVideoPlayer::stageStepFrame(const QVideoFrame& frame, double pts, double duration)
+{
+    constexpr double EPS = 0.0005;
     
-    // Wake decode thread to continue from new position
-    m_decodeCondition.wakeAll();
+    if (m_stepFill == StepForwardFill) {
+        // Decoded in order starting inside the run, so inserting straight into it keeps it contiguous
+        m_gopCache.insert(pts, duration, frame, m_stepFillFromPts);
+        if (m_gopCache.after(m_stepFillFromPts, m_stepFillFrames)) {
+            finishStepFill();
+        }
+        return;
+    }
+    
+    // Backward/prefetch: the first frame at the run's start completes the GOP before it
+    if (pts + EPS >= m_stepFillEndPts) {
+        finishStepFill();
+        return;
+    }
+    
+    FFmpegGopCache::Entry entry;
+    entry.pts = pts;
+    entry.duration = duration;
+    entry.frame = frame;
+    entry.bytes = FFmpegGopCache::frameBytes(frame);
+    m_stepStagingBytes += entry.bytes;
+    m_stepStaging.push_back(std::move(entry));
     
-    // Locks automatically released by RAII when lockers go out of scope
+    // A GOP larger than the budget: only its tail (next to the run) would survive the merge anyway
+    while (m_stepStagingBytes > m_gopCache.budget() && m_stepStaging.size() > 1) {
+        m_stepStagingBytes -= m_stepStaging.front().bytes;
+        m_stepStaging.pop_front();
+    }
+}
+
+void FFmpegVideoPlayer::finishStepFill()
+{
+    const int fill = m_stepFill;
+    m_stepFill = NoStepFill;
+    if (fill == NoStepFill) {
+        return;
+    }
+    
+    if (fill != StepForwardFill) {
+        if (m_stepStaging.empty()) {
+            m_stepReachedStart = true;  // Nothing decodes before the run - it starts the stream
+        }
+        for (const FFmpegGopCache::Entry& entry : m_stepStaging) {
+            m_gopCache.insert(entry.pts, entry.duration, entry.frame, m_stepFillFromPts);
+        }
+        m_stepStaging.clear();
+        m_stepStagingBytes = 0;
+    }
+    
+    setStatistic(QStringLiteral("gopCacheFrames"), m_gopCache.size());
+    setStatistic(QStringLiteral("gopCacheMB"), double(m_gopCache.bytes()) / (1024.0 * 1024.0));
+    if (fill == PrefetchFill) {
+        FFLOG("[FFmpeg] Previous GOP prefetched - cache starts at" << m_gopCache.firstPts());
+        return;
+    }
+    
+    // Serve the step (as far as the fill got, e.g. at the end of the stream)
+    ++m_stepsDecoded;
+    const FFmpegGopCache::Entry* target = fill == StepForwardFill
+        ? m_gopCache.after(m_stepFillFromPts, m_stepFillFrames, true)
+        : m_gopCache.before(m_stepFillFromPts, m_stepFillFrames, true);
+    if (target) {
+        presentStepFrame(*target);
+        if (fill == StepBackwardFill) {
+            prefetchPreviousGop();
+        }
+    }
+}
+
+void FFmpegVideoPlayer::cancelStepFill()
+{
+    m_stepFill = NoStepFill;
+    m_stepStaging.clear();
+    m_stepStagingBytes = 0;
+}
+
+void FFmpegVideoPlayer::presentStepFrame(const FFmpegGopCache::Entry& entry)
+{
+    deliverFrame(entry.frame, entry.pts);
+    m_position = static_cast<qint64>(entry.pts * 1000.0);
     emit positionChanged();
     
-    qDebug() << "[FFmpeg] seek() completed to:" << positionMs << "ms (PTS:" << seekPts << "seconds:" << seekPtsSeconds << ")";
+    setStatistic(QStringLiteral("stepsFromCache"), m_stepsFromCache);
+    setStatistic(QStringLiteral("stepsDecoded"), m_stepsDecoded);
+    emit statisticsChanged();
+}
+
+void FFmpegVideoPlayer::prefetchPreviousGop()
+{
+    if (m_stepFill != NoStepFill || m_stepReachedStart || m_gopCache.isEmpty()) {
+        return;
+    }
+    
+    double current = -1.0;
+    {
+        QMutexLocker guiLocker(&m_guiFrameMutex);
+        current = m_guiFramePts;
+    }
+    if (m_gopCache.countBefore(current) >= STEP_PREFETCH_FRAMES) {
+        return;
+    }
+    
+    // Decode the previous GOP now, while the user is still stepping through the cached frames
+    m_stepFillFromPts = current;
+    m_stepFillFrames = 0;
+    m_stepFillDecoded = 0;
+    m_stepStaging.clear();
+    m_stepStagingBytes = 0;
+    m_stepFillEndPts = m_gopCache.firstPts();
+    if (!seekForStep(m_stepFillEndPts, true)) {
+        return;
+    }
+    m_stepFill = PrefetchFill;
+    
+    FFLOG("[FFmpeg] Prefetching GOP before" << m_stepFillEndPts);
 }
 
 qint64 FFmpegVideoPlayer::position() const
 {
+    if (FFmpegVideoPlayer* decoder = sharedDecoder()) {
+        return decoder->position();
+    }
     return m_position;
 }
 
 qint64 FFmpegVideoPlayer::duration() const
 {
+    if (FFmpegVideoPlayer* decoder = sharedDecoder()) {
+        return decoder->duration();
+    }
     return m_duration;
 }
 
+int FFmpegVideoPlayer::implicitWidth() const
+{
+    if (FFmpegVideoPlayer* decoder = sharedDecoder()) {
+        return decoder->implicitWidth();
+    }
+    return m_width;
+}
+
+int FFmpegVideoPlayer::implicitHeight() const
+{
+    if (FFmpegVideoPlayer* decoder = sharedDecoder()) {
+        return decoder->implicitHeight();
+    }
+    return m_height;
+}
+
 int FFmpegVideoPlayer::playbackState() const
 {
+    if (FFmpegVideoPlayer* decoder = sharedDecoder()) {
+        return decoder->playbackState();
+    }
     if (m_isPaused) return PausedState;
     if (m_isPlaying) return PlayingState;
     return StoppedState;
@@ -2963,11 +4301,19 @@ int FFmpegVideoPlayer::playbackState() const
 
 float FFmpegVideoPlayer::volume() const
 {
+    if (FFmpegVideoPlayer* decoder = sharedDecoder()) {
+        return decoder->volume();
+    }
     return m_volume;
 }
 
 void FFmpegVideoPlayer::setVolume(float volume)
 {
+    // Audio of a shared decode plays from the decoding player
+    if (FFmpegVideoPlayer* decoder = sharedDecoder()) {
+        decoder->setVolume(volume);
+        return;
+    }
     float newVolume = qBound(0.0f, volume, 1.0f);
     if (qFuzzyCompare(m_volume, newVolume)) {
         qDebug() << "[FFmpeg] setVolume called with same value:" << volume << "(ignored)";
@@ -2991,9 +4337,172 @@ void FFmpegVideoPlayer::setVolume(float volume)
 
 bool FFmpegVideoPlayer::seekable() const
 {
+    if (FFmpegVideoPlayer* decoder = sharedDecoder()) {
+        return decoder->seekable();
+    }
     return m_isSeekable;
 }
 
+FFmpegVideoPlayer* FFmpegVideoPlayer::sharedDecoder() const
+{
+    if (!m_session || m_session->decoder() == this) {
+        return nullptr;
+    }
+    return m_session->decoder();
+}
+
+QList<FFmpegVideoPlayer*> FFmpegVideoPlayer::frameConsumers() const
+{
+    QList<FFmpegVideoPlayer*> consumers{const_cast<FFmpegVideoPlayer*>(this)};
+    if (m_session && m_session->decoder() == this) {
+        consumers.append(m_session->followers());
+    }
+    return consumers;
+}
+
+bool FFmpegVideoPlayer::joinSession()
+{
+    // The benchmark measures its own decode; network streams may differ per open
+    if (!m_sharedDecode || m_benchmarkMode) {
+        return false;
+    }
+    const QString key = FFmpegDecodeSession::keyFor(m_source);
+    if (key.isEmpty()) {
+        return false;
+    }
+    
+    m_session = FFmpegDecodeSession::acquire(key);
+    if (m_session->join(this)) {
+        return false;  // First window: decode as usual
+    }
+    
+    FFmpegVideoPlayer* decoder = m_session->decoder();
+    followDecoder(decoder);
+    decoder->updateSessionOutput();
+    return true;
+}
+
+void FFmpegVideoPlayer::followDecoder(FFmpegVideoPlayer* decoder)
+{
+    qDebug() << "[FFmpeg] Showing the shared decode of" << m_source << "(no decoder of its own)";
+    
+    // State signals of the decoder are this player's (getters read through to it).
+    // positionChanged comes from the presenter thread - queued to this (GUI) object
+    connect(decoder, &FFmpegVideoPlayer::positionChanged, this, &FFmpegVideoPlayer::positionChanged);
+    connect(decoder, &FFmpegVideoPlayer::durationChanged, this, &FFmpegVideoPlayer::durationChanged);
+    connect(decoder, &FFmpegVideoPlayer::durationAvailable, this, &FFmpegVideoPlayer::durationAvailable);
+    connect(decoder, &FFmpegVideoPlayer::playbackStateChanged, this, &FFmpegVideoPlayer::playbackStateChanged);
+    connect(decoder, &FFmpegVideoPlayer::seekableChanged, this, &FFmpegVideoPlayer::seekableChanged);
+    connect(decoder, &FFmpegVideoPlayer::implicitSizeChanged, this, &FFmpegVideoPlayer::implicitSizeChanged);
+    connect(decoder, &FFmpegVideoPlayer::playbackRateChanged, this, &FFmpegVideoPlayer::playbackRateChanged);
+    connect(decoder, &FFmpegVideoPlayer::volumeChanged, this, &FFmpegVideoPlayer::volumeChanged);
+    connect(decoder, &FFmpegVideoPlayer::statisticsChanged, this, &FFmpegVideoPlayer::statisticsChanged);
+    connect(decoder, &FFmpegVideoPlayer::subtitleCue, this, &FFmpegVideoPlayer::subtitleCue);
+    connect(decoder, &FFmpegVideoPlayer::subtitleCoverageChanged, this, &FFmpegVideoPlayer::subtitleCoverageChanged);
+    connect(decoder, &FFmpegVideoPlayer::audioTracksChanged, this, &FFmpegVideoPlayer::audioTracksChanged);
+    connect(decoder, &FFmpegVideoPlayer::activeAudioTrackChanged, this, &FFmpegVideoPlayer::activeAudioTrackChanged);
+    
+    {
+        QMutexLocker guiLocker(&decoder->m_guiFrameMutex);
+        if (decoder->m_guiFrame.isValid()) {
+            if (m_videoSink) {
+                m_videoSink->setVideoFrame(decoder->m_guiFrame);
+            }
+            if (m_renderer) {
+                m_renderer->setFrame(decoder->m_guiFrame);
+            }
+        }
+    }
+    
+    emit implicitSizeChanged();
+    emit seekableChanged();
+    emit durationChanged();
+    emit playbackStateChanged();
+    emit positionChanged();
+    emit audioTracksChanged();
+    emit activeAudioTrackChanged();
+    emit volumeChanged();
+}
+
+void FFmpegVideoPlayer::leaveSession()
+{
+    if (!m_session) {
+        return;
+    }
+    std::shared_ptr<FFmpegDecodeSession> session = std::move(m_session);
+    
+    FFmpegVideoPlayer* decoder = session->decoder();
+    if (decoder != this) {
+        disconnect(decoder, nullptr, this, nullptr);
+        session->leave(this);
+        decoder->updateSessionOutput();
+        return;
+    }
+    
+    // This player decoded for the others: the next one opens the file and continues from here
+    const qint64 positionMs = m_position;
+    const bool playing = playbackState() == PlayingState;
+    const int audioTrack = m_activeAudioTrack;
+    FFmpegVideoPlayer* successor = session->leave(this);
+    if (!successor) {
+        return;
+    }
+    disconnect(this, nullptr, successor, nullptr);
+    for (FFmpegVideoPlayer* follower : session->followers()) {
+        disconnect(this, nullptr, follower, nullptr);
+    }
+    successor->m_volume = m_volume;  // Its volume() read through to this player - the audio keeps its level
+    successor->takeOverDecoding(positionMs, playing, audioTrack);
+}
+
+void FFmpegVideoPlayer::takeOverDecoding(qint64 positionMs, bool playing, int audioTrack)
+{
+    qDebug() << "[FFmpeg] Taking over the shared decode of" << m_source << "at" << positionMs << "ms";
+    
+    m_takeOverPositionMs = positionMs;
+    m_takeOverPlaying = playing;
+    m_preferredAudioTrack = audioTrack;  // Same language as before
+    for (FFmpegVideoPlayer* follower : m_session->followers()) {
+        follower->followDecoder(this);
+    }
+    updateSessionOutput();
+    
+    // Otherwise onSceneGraphInitialized() opens it
+    if (m_sceneGraphReady.load(std::memory_order_acquire)) {
+        openMedia();
+        resumeTakeOver();
+    }
+}
+
+void FFmpegVideoPlayer::resumeTakeOver()
+{
+    if (m_takeOverPositionMs < 0 || !m_mediaOpened) {
+        return;
+    }
+    const qint64 positionMs = m_takeOverPositionMs;
+    m_takeOverPositionMs = -1;
+    if (positionMs > 0) {
+        seek(int(positionMs));
+    }
+    if (m_takeOverPlaying) {
+        play();
+    }
+}
+
+int FFmpegVideoPlayer::getBufferCallback(AVCodecContext* ctx, AVFrame* frame, int flags)
+{
+    // May be called concurrently from frame threads - m_framePool is thread-safe
+    auto* self = static_cast<FFmpegVideoPlayer*>(ctx->opaque);
+    if (self && FFmpegFramePool::canPool(ctx, frame->format)) {
+        if (self->m_framePool.getBuffer(ctx, frame) == 0) {
+            return 0;
+        }
+    }
+    
+    // Hardware frames, non-DR1 decoders, or pool failure - FFmpeg's default allocator
+    return avcodec_default_get_buffer2(ctx, frame, flags);
+}
+
 enum AVPixelFormat FFmpegVideoPlayer::getFormatCallback(AVCodecContext* ctx, const enum AVPixelFormat* pix_fmts)
 {
     // ✅ Get instance from opaque pointer (set during codec init)
@@ -3094,21 +4603,38 @@ void FFmpegVideoPlayer::setRenderer(QObject* renderer)
 {
     // Cast to FFmpegVideoRenderer
     FFmpegVideoRenderer* videoRenderer = qobject_cast<FFmpegVideoRenderer*>(renderer);
-    if (videoRenderer) {
-        m_renderer = videoRenderer;
-        // Set player reference in renderer so it can get pending frames
-        videoRenderer->m_player = this;
-        
-        // Renderer is set - QQuickRhiItemRenderer will call getPendingFrame() in synchronize()
-        qDebug() << "[FFmpeg] Renderer set - frames will be delivered via thread-safe handoff in synchronize()";
-    } else if (renderer) {
+    if (renderer && !videoRenderer) {
         qWarning() << "[FFmpeg] setRenderer: object is not a FFmpegVideoRenderer";
-        m_renderer = nullptr;
-    } else {
-        m_renderer = nullptr;
     }
+    if (m_renderer == videoRenderer) {
+        return;
+    }
+    
+    // Detach the previous renderer (it keeps its last frame)
+    if (m_renderer && m_renderer->m_player == this) {
+        m_renderer->m_player = nullptr;
+    }
+    m_renderer = videoRenderer;
+    if (!videoRenderer) {
+        return;
+    }
+    
+    // Set player reference in renderer so it can get pending frames
+    videoRenderer->m_player = this;
+    
+    // Show the current frame right away (matters while paused; shared decode: the decoder's frame)
+    FFmpegVideoPlayer* decoder = sharedDecoder();
+    FFmpegVideoPlayer* source = decoder ? decoder : this;
+    {
+        QMutexLocker guiLocker(&source->m_guiFrameMutex);
+        if (source->m_guiFrame.isValid()) {
+            videoRenderer->setFrame(source->m_guiFrame);
+        }
+    }
+    qDebug() << "[FFmpeg] Renderer set - frames are uploaded as YUV planes by the scene graph";
 }
 
+#ifdef Q_OS_WIN
 bool FFmpegVideoPlayer::getPendingFrame(ID3D11Texture2D** texture, int* width, int* height)
 {
     QMutexLocker locker(&m_pendingFrameMutex);
@@ -3129,3 +4655,4 @@ bool FFmpegVideoPlayer::getPendingFrame(ID3D11Texture2D** texture, int* width, i
     return false;
 }
 
+#endif
@@ -13,10 +13,25 @@
 #include <QThread>
 #include <QWaitCondition>
 #include <QQuickWindow>
+#include <QVariantMap>
+#include <QVariantList>
+#include <QSize>
+#include <QList>
+#include <QMap>
+#include <QPointer>
 #include <QtGui/rhi/qrhi.h>
 #include <memory>
 #include <cstdint>
 #include <atomic>
+#include <deque>
+#include <vector>
+#include "ffmpegframepool.h"
+#include "ffmpegtonemapper.h"
+#include "ffmpegdeinterlacer.h"
+#include "ffmpegkeyframeindex.h"
+#include "ffmpeggopcache.h"
+#include "ffmpegaudiotimestretch.h"
+#include "ffmpeginputstream.h"
 
 // Forward declarations
 #ifdef Q_OS_WIN
@@ -31,9 +46,13 @@ struct ID3D11VideoProcessorEnumerator;
 
 // Forward declaration for renderer (global class, not nested)
 class FFmpegVideoRenderer;
+class FFmpegAudioRingBuffer;
+class FFmpegRemuxer;
+class FFmpegDecodeSession;
 
 // Forward declarations for FFmpeg
 struct AVFormatContext;
+struct AVCodec;
 struct AVCodecContext;
 struct AVFrame;
 struct AVPacket;
@@ -41,6 +60,7 @@ struct AVBufferRef;
 struct AVStream;  // Required for m_videoStream member
 struct AVD3D11FrameDescriptor;
 struct SwrContext;  // For audio resampling
+struct SwsContext;  // For display-size scaling
 
 // Include FFmpeg pixel format enum (needed for AV_PIX_FMT_NONE and other constants)
 extern "C" {
@@ -71,6 +91,17 @@ class FFmpegVideoPlayer : public QObject
     Q_PROPERTY(int implicitWidth READ implicitWidth NOTIFY implicitSizeChanged)
     Q_PROPERTY(int implicitHeight READ implicitHeight NOTIFY implicitSizeChanged)
     Q_PROPERTY(QQuickWindow* window READ window WRITE setWindow NOTIFY windowChanged)
+    Q_PROPERTY(int maxDecoderThreads READ maxDecoderThreads WRITE setMaxDecoderThreads NOTIFY maxDecoderThreadsChanged)
+    Q_PROPERTY(QVariantMap statistics READ statistics NOTIFY statisticsChanged)
+    Q_PROPERTY(int masterClock READ masterClock WRITE setMasterClock NOTIFY masterClockChanged)
+    Q_PROPERTY(qreal playbackRate READ playbackRate WRITE setPlaybackRate NOTIFY playbackRateChanged)
+    Q_PROPERTY(QSize displaySize READ displaySize WRITE setDisplaySize NOTIFY displaySizeChanged)
+    Q_PROPERTY(int deinterlaceMode READ deinterlaceMode WRITE setDeinterlaceMode NOTIFY deinterlaceModeChanged)
+    Q_PROPERTY(bool clipExportRunning READ clipExportRunning NOTIFY clipExportRunningChanged)
+    Q_PROPERTY(qreal clipExportProgress READ clipExportProgress NOTIFY clipExportProgressChanged)
+    Q_PROPERTY(QList<int> subtitleStreams READ subtitleStreams WRITE setSubtitleStreams NOTIFY subtitleStreamsChanged)
+    Q_PROPERTY(QVariantList audioTracks READ audioTracks NOTIFY audioTracksChanged)
+    Q_PROPERTY(int activeAudioTrack READ activeAudioTrack WRITE setActiveAudioTrack NOTIFY activeAudioTrackChanged)
 
 public:
     enum PlaybackState {
@@ -80,6 +111,22 @@ public:
     };
     Q_ENUM(PlaybackState)
 
+    // Clock the presenter schedules frames against
+    enum ClockSource {
+        AudioClock,     // Audible audio position (falls back to wall clock while audio is not ready)
+        VideoClock,     // Video cadence: frames are never dropped, clock re-anchors when late
+        ExternalClock   // Free-running wall clock: late frames are dropped, audio is not consulted
+    };
+    Q_ENUM(ClockSource)
+
+    // What happens to frames the decoder flags as interlaced
+    enum DeinterlaceMode {
+        DeinterlaceOff,        // Shown as decoded (combing on motion)
+        DeinterlaceFrameRate,  // One progressive frame per interlaced frame
+        DeinterlaceFieldRate   // One progressive frame per field (50i → 50p, 60i → 60p)
+    };
+    Q_ENUM(DeinterlaceMode)
+
     explicit FFmpegVideoPlayer(QObject* parent = nullptr);
     ~FFmpegVideoPlayer();
 
@@ -96,23 +143,104 @@ public:
     QVideoSink* videoSink() const { return m_videoSink; }
     void setVideoSink(QVideoSink* sink);
 
-    int implicitWidth() const { return m_width; }
-    int implicitHeight() const { return m_height; }
+    int implicitWidth() const;
+    int implicitHeight() const;
 
     QQuickWindow* window() const { return m_window; }
     void setWindow(QQuickWindow* window);
 
+    // Upper bound for software decoder threads (0 = auto, based on core count)
+    // Useful when several players run side by side and would oversubscribe the CPU
+    int maxDecoderThreads() const { return m_maxDecoderThreads; }
+    void setMaxDecoderThreads(int threads);
+
+    // Snapshot of playback/decoder statistics (thread-safe, updated by decode thread)
+    // "openTrace" breaks down the time to first frame (io/probe/codec open/first packet/first frame, ms)
+    QVariantMap statistics() const;
+
+    // Master clock used for frame presentation (ClockSource), persisted in QSettings "video/ffmpegMasterClock"
+    int masterClock() const { return m_masterClock.load(std::memory_order_relaxed); }
+    void setMasterClock(int clock);
+
+    // Playback speed 0.25x - 4x. Audio is time-stretched (pitch kept); above 1x video is thinned
+    // to the display refresh rate and non-reference frames are skipped while decoding falls behind.
+    qreal playbackRate() const;
+    void setPlaybackRate(qreal rate);
+
+    // On-screen size of the video in device pixels (empty = unknown, full resolution).
+    // Frames much larger than this are scaled down once in the conversion stage; software decoders
+    // that support it decode at reduced resolution (lowres, re-picked at the next keyframe after a resize).
+    // While the window is minimized only audio is decoded; video resumes at the next keyframe.
+    QSize displaySize() const;
+    void setDisplaySize(const QSize& size);
+
+    // Deinterlacing of interlaced frames (DeinterlaceMode), persisted in QSettings "video/ffmpegDeinterlaceMode".
+    // Progressive frames are never touched; the mode applies from the next frame on.
+    int deinterlaceMode() const { return m_deinterlaceMode.load(std::memory_order_relaxed); }
+    void setDeinterlaceMode(int mode);
+
+    // Subtitle streams (container stream indices) decoded from the playback demuxer: their packets are
+    // already being read for playback, so cues come out as subtitleCue() with no second pass over the file.
+    // subtitleCoverageChanged() reports the span read since the last open/seek - every cue starting
+    // inside it has been delivered. Applies from the next packet; selection is kept across files.
+    QList<int> subtitleStreams() const;
+    void setSubtitleStreams(const QList<int>& streams);
+    
+    // Audio tracks of the open file (index, streamIndex, language, title, codec, channels, sampleRate),
+    // same shape as MediaPlayerWrapper's. Only the active track is demuxed, the others are discarded.
+    // Switching opens the new decoder on the decode thread without touching video decoding: the demuxer
+    // re-reads from the audible position (video packets the decoder already has are skipped) and the new
+    // track replaces the queued audio of the old one where it reaches the clock.
+    QVariantList audioTracks() const;
+    int activeAudioTrack() const;
+    void setActiveAudioTrack(int track);
+
     Q_INVOKABLE void play();
     Q_INVOKABLE void pause();
     Q_INVOKABLE void stop();
     Q_INVOKABLE void seek(int ms);
     
+    // Frame-accurate stepping (pauses playback). Backward steps inside the cached GOP are served from memory.
+    Q_INVOKABLE void stepForward();
+    Q_INVOKABLE void stepBackward();
+    
+    // Lossless clip export of the current file: packets are stream-copied (no decoding) from the keyframe
+    // at or before inMs up to the keyframe at or after outMs (-1 = end of file), on a worker thread.
+    // Cut points come from the keyframe index when it is available. False if the request is invalid
+    // or an export is already running; clipExportFinished() reports the snapped range.
+    Q_INVOKABLE bool exportClip(int inMs, int outMs, const QUrl& outputUrl);
+    Q_INVOKABLE void cancelClipExport();
+    bool clipExportRunning() const;
+    qreal clipExportProgress() const;
+    
+    // Headless decode benchmark (FFmpegDecodeBenchmark): no window, sink or audio. Frames are decoded and
+    // converted as fast as the pipeline allows, then dropped (null sink). Call before setSource().
+    struct BenchmarkOptions {
+        bool softwareDecoding = false;  // Skip hardware decoder setup
+        int decoderThreads = -1;        // Decoder thread cap for this run (-1 = the persisted setting)
+        quint64 frameLimit = 0;         // Stop after this many converted frames (0 = whole file)
+    };
+    struct BenchmarkCounters {
+        quint64 frames = 0;       // Converted frames
+        qint64 demuxUs = 0;       // av_read_frame
+        qint64 decodeUs = 0;      // avcodec_send_packet / avcodec_receive_frame
+        qint64 transferUs = 0;    // Hardware frame download
+        qint64 convertUs = 0;     // Tone mapping, validation, QVideoFrame wrap
+        qint64 lastFrameUs = 0;   // av_gettime_relative() when the last frame was converted
+    };
+    void setBenchmarkMode(const BenchmarkOptions& options);
+    BenchmarkCounters benchmarkCounters() const;
+    FFmpegFramePool::Stats framePoolStats() const { return m_framePool.stats(); }
+    
     // Set the renderer to receive frames (C++ connection, not QML - QML can't receive native pointers)
+    // Presented frames go to the renderer as well as the video sink (nullptr = detach)
     Q_INVOKABLE void setRenderer(QObject* renderer);
     
+#ifdef Q_OS_WIN
     // Get pending frame from decode thread (called from render thread only)
     // Returns true if a new frame was available and consumed
     bool getPendingFrame(ID3D11Texture2D** texture, int* width, int* height);
+#endif
 
 signals:
     void sourceChanged();
@@ -124,6 +252,20 @@ signals:
     void videoSinkChanged();
     void implicitSizeChanged();
     void windowChanged();
+    void maxDecoderThreadsChanged();
+    void statisticsChanged();
+    void masterClockChanged();
+    void playbackRateChanged();
+    void displaySizeChanged();
+    void deinterlaceModeChanged();
+    void clipExportRunningChanged();
+    void clipExportProgressChanged();
+    void clipExportFinished(bool success, const QUrl& outputUrl, int startMs, int endMs, const QString& error);
+    void subtitleStreamsChanged();
+    void subtitleCue(int streamIndex, qint64 startMs, qint64 endMs, const QString& text);  // Decode thread
+    void subtitleCoverageChanged(qint64 fromMs, qint64 toMs);                                // Decode thread
+    void audioTracksChanged();
+    void activeAudioTrackChanged();
     void errorOccurred(int error, const QString &errorString);
     void durationAvailable();
 
@@ -134,22 +276,105 @@ private:
     void initFFmpeg();
     void cleanupFFmpeg();
     void openMedia();
+    void abortOpenInput();  // openMedia() failed before any decoder was opened: close the input again
     void closeMedia();
     void decodeFrame();
     
+    // Stream probing bounded by container (avformat_find_stream_info), with a wider second pass
+    // if the streams we play stay unresolved. Limits overridable in QSettings
+    // "video/ffmpegProbeSizeKB" / "video/ffmpegAnalyzeDurationMs" (0 = automatic)
+    bool probeStreams();
+    // Video decoder + hardware device setup and avcodec_open2 (worker thread, overlaps the audio open)
+    // Frees m_codecContext on failure
+    bool openVideoDecoder();
+    
+    // Software decoder threading (frame/slice threads from codec caps, resolution and core count)
+    void configureDecoderThreading(const AVCodec* codec);
+    
+    // Statistics helpers (safe to call from decode thread)
+    void setStatistic(const QString& key, const QVariant& value);
+    void clearStatistics();
+    void publishPeriodicStatistics();  // Decode thread: refresh rate-based stats about once per second
+    void publishOpenTrace();           // "openTrace" statistic from m_openTrace
+    
+    // Frame pool sizing (idle frames retained, scaled with the effective presentation rate)
+    void updateFramePoolCapacity();
+    
+    // Playback rate (decode thread): rate changes, frame thinning and AVDISCARD_NONREF above 1x
+    void applyPlaybackRate();
+    bool skipFrameForRate(double framePts);  // True = don't convert this frame
+    bool admitVideoFrame(double framePts);   // Seek target, step fill, A/V hold, late drop, thinning - false = drop
+    
     // D3D11 setup - import from Qt RHI
     bool initD3D11FromRHI();
     void cleanupD3D11();
     bool initVideoProcessor(uint32_t width, uint32_t height);  // Initialize Video Processor with actual dimensions
     
-    // HDR tone mapping filter graph setup
-    bool initHDRToneMappingFilter(int width, int height, AVPixelFormat inputFormat, int displayWidth = 0, int displayHeight = 0);
-    void cleanupHDRToneMappingFilter();
-    
     void processFrame(AVFrame* frame);
+    AVFrame* scaleForDisplay(AVFrame* frame);  // Decode thread: display-size copy of frame, or nullptr if it fits
+    bool deinterlaceFrame(AVFrame* frame);     // Decode thread: true if the deinterlacer took the frame
+    void drainDeinterlacer();                  // Decode thread: present the frame the deinterlacer holds back
+    void presentDeinterlaced(int count);       // Decode thread: processFrame() the deinterlacer outputs
+    int lowresForDisplay(const AVCodec* codec) const;
+    bool dropSuspendedVideoPacket(const AVPacket* packet);  // Decode thread: minimized window / waiting for a keyframe
+    void updateVideoSuspended();               // GUI thread: window minimized/hidden → audio-only decode
+    void demuxSubtitles(const AVPacket* packet);  // Decode thread: subtitle cues + coverage for every demuxed packet
+    void syncSubtitleDecoders();               // Decode thread: open/close decoders to match subtitleStreams
+    void resetSubtitleDemux();                 // Decode thread: demuxer seeked - coverage restarts
+    void closeSubtitleDecoders();
+    SwrContext* createAudioResampler(const AVCodecContext* context) const;  // Decoded audio → m_audioFormat (nullptr on failure)
+    void serveAudioTrackSwitch();              // Decode thread, m_decodeMutex held: latest setActiveAudioTrack()
+    void pushAudio(const char* pcm, qint64 bytes);  // Decode thread: into the ring, behind any backlog
+    void flushAudioBacklog(bool wait);         // Decode thread: push m_audioPushBacklog (wait = block while it fits later)
+    bool audioPushStale() const;               // Unpushed audio belongs to an old position (seek/stop)
+    bool audioPushMayWait() const;             // Nothing else for the decode loop to serve (not paused, no step/switch)
+    bool switchAudioStream(int streamIndex);   // Decode thread: false = new decoder failed, old track kept
+    bool dropReplayedVideoPacket(const AVPacket* packet);  // Decode thread: re-read after an audio switch rewind
+    void resetVideoReplay();                   // Decode thread: demuxer seeked - an audio switch re-read is void
+    
+    // Shared decode (GUI thread) - see FFmpegDecodeSession. Followers forward transport and volume
+    // calls to the decoding player; disabled with QSettings "video/ffmpegSharedDecode" = false.
+    bool joinSession();                                      // True = another player decodes this source
+    void leaveSession();                                     // A follower takes over if this player decoded
+    void followDecoder(FFmpegVideoPlayer* decoder);          // Mirror the decoder's state signals
+    void takeOverDecoding(qint64 positionMs, bool playing, int audioTrack);  // Former follower opens the source itself
+    void resumeTakeOver();                                   // Restore position/state once the media is open
+    FFmpegVideoPlayer* sharedDecoder() const;                // Player this one mirrors (nullptr = decodes itself)
+    QList<FFmpegVideoPlayer*> frameConsumers() const;        // This player and its followers
+    void updateSessionOutput();                              // Display size / suspension / subtitles over all windows fed
     
     // Decode thread
     void decodeThreadFunc();
+    void performSeek(qint64 positionMs);  // Decode thread, m_decodeMutex held: serve the latest seek() request
+    
+    // Frame stepping (decode thread unless noted) - see stepForward()/stepBackward()
+    void requestStep(int frames);  // GUI thread
+    bool performStep(int frames);  // m_decodeMutex held. False = busy (request is retried)
+    void startStepFill(int frames, double fromPts);
+    bool seekForStep(double pts, bool strictlyBefore);  // Demuxer seek to the keyframe at/before pts (decoders flushed)
+    void stageStepFrame(const QVideoFrame& frame, double pts, double duration);  // processFrame() while filling
+    void finishStepFill();
+    void cancelStepFill();
+    void presentStepFrame(const FFmpegGopCache::Entry& entry);
+    void prefetchPreviousGop();  // Start decoding the GOP before the cached run when the view nears its start
+    
+    // Presentation scheduler (ffmpegvideoplayer_presenter.cpp)
+    // Decode thread queues converted frames, the presenter thread releases them against the master clock
+    void startPresenter();
+    void stopPresenter();
+    void presentThreadFunc();
+    bool queueFrameForPresentation(const QVideoFrame& frame, double pts, double duration);  // Blocks while the display queue is full
+    void flushPresentationQueue();  // Drop queued frames (seek/stop/pause changes)
+    void deliverFrame(const QVideoFrame& frame, double pts);  // Hand a frame to the GUI thread (coalesces if the GUI is behind)
+    void recordPresentation(double offset, double frameDuration, double now);
+    double audioClockSeconds(bool* valid);  // Audible audio position (locks m_audioClockMutex)
+    bool hasAudioClockBase() const;         // First audio frame since the last reset was seen (locks m_audioClockMutex)
+    void resetAudioClock();                 // Base cleared - the next audio frame re-sets it (locks m_audioClockMutex)
+    double masterClockSeconds();
+    double wallClockSeconds() const;  // m_startPts advanced at the playback rate (locks m_clockMutex)
+    void setWallClockAnchor(double pts, double wallTime);  // Locks m_clockMutex
+    double nominalFrameDuration() const;
+    static const char* clockSourceName(int source);
     
     // GPU vendor detection
     enum GPUVendor {
@@ -165,18 +390,26 @@ private:
     bool setupD3D11VADecoder();
     bool setupCUDADecoder();
     
+#ifdef Q_OS_WIN
     // CUDA → D3D11 interop
     bool transferCUDAToD3D11(AVFrame* cudaFrame, ID3D11Texture2D** outTexture);
+#endif
     
     // Static callback for codec format selection
     static enum AVPixelFormat getFormatCallback(AVCodecContext* ctx, const enum AVPixelFormat* pix_fmts);
     
+    // Static callback for decoder buffer allocation (software frames come from m_framePool)
+    static int getBufferCallback(AVCodecContext* ctx, AVFrame* frame, int flags);
+    
     QUrl m_source;
     QVideoSink* m_videoSink = nullptr;
+    QPointer<FFmpegVideoRenderer> m_renderer;  // Optional RHI output (gets the same frames as the sink)
     QQuickWindow* m_window = nullptr;
+    std::atomic_bool m_sceneGraphReady{false};  // Set on the render thread - media may be opened
     
     // FFmpeg
     AVFormatContext* m_formatContext = nullptr;
+    FFmpegInputStream m_input;    // Custom AVIO (read-ahead / mmap) behind m_formatContext, closed after it
     AVCodecContext* m_codecContext = nullptr;
     AVFrame* m_frame = nullptr;
     AVFrame* m_hwFrame = nullptr; // Hardware frame
@@ -196,39 +429,115 @@ private:
     AVFrame* m_audioFrame = nullptr;
     SwrContext* m_swr = nullptr;
     
-    // FFmpeg video conversion (10-bit to 8-bit)
-    struct SwsContext* m_sws10to8 = nullptr;  // For converting YUV420P10LE to YUV420P (fallback, not used if filter graph active)
-    AVFrame* m_tmp8bitFrame = nullptr;        // Temporary 8-bit frame for conversion
-    
-    // FFmpeg filter graph for HDR → SDR tone mapping
-    struct AVFilterGraph* m_filterGraph = nullptr;
-    struct AVFilterContext* m_filterSrcCtx = nullptr;   // Input buffer source
-    struct AVFilterContext* m_filterSinkCtx = nullptr;  // Output buffer sink
-    AVFrame* m_filterFrame = nullptr;                   // Frame for filter output
-    int m_filterWidth = 0;                              // Width for filter graph (to detect dimension changes)
-    int m_filterHeight = 0;                             // Height for filter graph (to detect dimension changes)
-    AVPixelFormat m_filterInputFormat = AV_PIX_FMT_NONE; // Input format for filter graph
-    std::atomic<int> m_framesInFilter{0};               // ✅ Backpressure: Track frames in filter graph pipeline
-    static constexpr int MAX_IN_FLIGHT = 2;             // ✅ Max frames in filter graph (prevents unbounded memory growth)
-    bool m_filterGraphInitialized = false;              // ✅ Guard: Track if filter graph is initialized for current playback session
+    // Native HDR → SDR tone mapping (10-bit → NV12), created on the first 10-bit frame
+    std::unique_ptr<FFmpegToneMapper> m_toneMapper;
+    AVFrame* m_toneMappedFrame = nullptr;               // Tone mapper output (pooled NV12, unref'd after hand-off)
+    
+    // Native deinterlacing, created on the first interlaced frame (decode thread)
+    std::unique_ptr<FFmpegDeinterlacer> m_deinterlacer;
+    AVFrame* m_deinterlacedFrames[2] = { nullptr, nullptr };  // Deinterlacer outputs (pooled, unref'd after hand-off)
+    bool m_inDeinterlacedOutput = false;                      // processFrame() is handling a deinterlaced frame
+    bool m_deferVideoAdmission = false;                       // processFrame() makes the admitVideoFrame() decision
+    std::atomic<int> m_deinterlaceMode{DeinterlaceFieldRate};
+    
+    // Clip export (GUI thread), created on the first exportClip()
+    FFmpegRemuxer* m_clipExporter = nullptr;
+    
+    // Subtitles from the playback demuxer (see subtitleStreams())
+    mutable QMutex m_subtitleMutex;
+    QList<int> m_subtitleStreams;                     // Guarded by m_subtitleMutex
+    QList<int> m_decodedSubtitleStreams;              // Guarded by m_subtitleMutex: union over the windows fed
+    std::atomic_bool m_subtitleStreamsDirty{false};   // Decoders don't match m_decodedSubtitleStreams yet
+    QMap<int, AVCodecContext*> m_subtitleDecoders;    // Decode thread: stream index → decoder
+    qint64 m_subtitleCoverageFromMs = -1;             // Decode thread (-1 = nothing read since open/seek)
+    qint64 m_subtitleCoverageToMs = -1;
+    qint64 m_subtitleCoverageReportedMs = -1;         // Decode thread: last toMs sent (throttles the signal)
+    std::atomic<quint64> m_subtitleCues{0};
+    static constexpr qint64 SUBTITLE_COVERAGE_STEP_MS = 500;  // subtitleCoverageChanged() granularity
+    
+    // Audio tracks (see audioTracks())
+    QVariantList m_audioTracks;                       // GUI thread, built in openMedia()
+    QList<int> m_audioTrackStreams;                   // GUI thread: track → stream index
+    int m_activeAudioTrack = -1;                      // GUI thread
+    int m_preferredAudioTrack = -1;                   // Track the next openMedia() starts with (-1 = first)
+    std::atomic<int> m_requestedAudioStream{-1};      // Switch not yet served by the decode thread (-1 = none)
+    int64_t m_lastVideoPacketPos = -1;                // Decode thread: file position of the last video packet demuxed
+    int64_t m_lastVideoPacketPts = INT64_MIN;         // Decode thread: largest PTS demuxed (DTS if none), AV_NOPTS_VALUE = none
+    int64_t m_videoReplayUntilPos = -1;               // Decode thread: skip re-read video packets up to here (-1 = none)
+    double m_audioSwitchStartTime = 0.0;              // Decode thread: switch waiting for its first frame (0 = none)
+    std::atomic<quint64> m_audioTrackSwitches{0};
+    static constexpr double AUDIO_SWITCH_LEAD_SECONDS = 0.05;  // Time the switch itself may take before the cut
     
     // Qt audio
     QAudioSink* m_audioSink = nullptr;
-    QIODevice* m_audioDevice = nullptr;
+    FFmpegAudioRingBuffer* m_audioRing = nullptr;  // Pull-mode source of m_audioSink (child of the sink)
     QAudioFormat m_audioFormat;  // Audio format (needed for latency compensation)
-    QByteArray m_audioRemainder;  // Buffer for audio data that couldn't be written immediately
-    
-    // Audio clock (seconds)
+    QByteArray m_audioConvertBuffer;  // swr_convert output, reused across frames (decode thread only)
+    FFmpegAudioTimeStretch m_timeStretch;  // Tempo change with pitch kept (decode thread only)
+    QByteArray m_audioStretchBuffer;       // m_timeStretch output, reused across frames
+    QByteArray m_audioPushBacklog;         // Audio the full ring could not take yet (pause, step, track switch)
+    qint64 m_audioSinkBufferBytes = 0;  // Sink buffer = output latency between pull and playback
+    
+    // Audio clock (seconds). The decode thread moves the segment fields (seek, first frame, rate change,
+    // track switch) while the presenter reads them - every access is under m_audioClockMutex so a reader
+    // never pairs a new base PTS with an old byte position
+    mutable QMutex m_audioClockMutex;
     double m_audioClock = 0.0;
     double m_audioBasePts = NAN;  // First audio PTS seen (absolute stream seconds)
-    qint64 m_audioProcessedBaseUSecs = 0;  // Snapshot of processedUSecs() when audio base PTS was set (for rebasing after seek)
+    quint64 m_audioBaseBytePos = 0;  // Ring write position of the audio base PTS (clock = consumed bytes since then)
+    double m_audioRate = 1.0;        // Media seconds per second of ring audio since the base (playback rate it was stretched at)
+    double m_audioPrevBasePts = NAN; // Segment before the last rate change (still audible until the sink reaches the base)
+    quint64 m_audioPrevBaseBytePos = 0;
+    double m_audioPrevRate = 1.0;
     
     // Frame queue control - prevent GUI thread flooding
     std::atomic_bool m_framePending{false};  // Only ONE frame in flight to GUI thread
+    QMutex m_guiFrameMutex;
+    QVideoFrame m_guiFrame;                  // Latest presented frame, picked up by the queued GUI call
+    double m_guiFramePts = -1.0;             // Its PTS (absolute stream seconds, -1 = none) - where stepping starts
+    
+    // Presentation scheduler (guarded by m_presentMutex)
+    struct QueuedFrame {
+        QVideoFrame frame;
+        double pts = 0.0;       // Absolute stream seconds
+        double duration = 0.0;  // Seconds (0 = use nominal frame duration)
+    };
+    static constexpr int DISPLAY_QUEUE_SIZE = 3;  // Frames converted ahead of presentation
+    QThread* m_presentThread = nullptr;
+    QMutex m_presentMutex;
+    QWaitCondition m_presentCondition;       // Wakes presenter: new frame, flush, pause, stop
+    QWaitCondition m_queueSpaceCondition;    // Wakes decode thread: frame consumed, flush, stop
+    std::deque<QueuedFrame> m_displayQueue;
+    std::deque<QueuedFrame> takePresentationQueue();  // Flush, handing the queued frames to the caller
+    quint64 m_presentGeneration = 0;         // Bumped by flushPresentationQueue() (stale frames are discarded)
+    bool m_presentThreadRunning = false;
+    std::atomic_bool m_presentPaused{true};
+    std::atomic<int> m_masterClock{AudioClock};
+    double m_lastPresentWallTime = 0.0;      // Presenter only (0 = nothing on screen since flush)
+    double m_lastPresentDuration = 0.0;
+    
+    // Playback rate
+    std::atomic<double> m_playbackRate{1.0};           // Requested rate (wall clock, presenter hold times)
+    std::atomic<double> m_displayRefreshRate{60.0};    // Frames per second the window can show (thinning above 1x)
+    double m_activeRate = 1.0;                         // Decode thread: rate the frame thinning / pool are set up for
+    double m_rateNextPts = -1.0;                       // Decode thread: next frame to keep when thinning (-1 = keep next)
+    bool m_rateSkipNonRef = false;                     // Decode thread: AVDISCARD_NONREF because decoding fell behind
+    double m_rateSkipChangedTime = 0.0;                // Decode thread: when m_rateSkipNonRef last changed (hysteresis)
+    std::atomic<quint64> m_framesThinned{0};           // Skipped to match the display refresh rate
+    
+    // Presentation counters (presenter thread, published via publishPeriodicStatistics)
+    static constexpr int AV_OFFSET_BUCKETS = 9;
+    std::atomic<quint64> m_framesPresented{0};
+    std::atomic<quint64> m_framesDropped{0};
+    std::atomic<quint64> m_framesDuplicated{0};
+    std::atomic<quint64> m_avOffsetHistogram[AV_OFFSET_BUCKETS] = {};
     
     // Playback timing
-    double m_startTime = 0.0;  // Wall-clock time when playback started (seconds)
-    double m_startPts = 0.0;    // PTS of first frame (seconds)
+    // The wall clock anchor (m_startPts/m_startTime) and the rate it runs at are written from the GUI,
+    // decode and presenter threads - always read/write the pair through wallClockSeconds()/setWallClockAnchor()
+    mutable QMutex m_clockMutex;
+    double m_startTime = 0.0;  // Wall-clock time when playback started (seconds, guarded by m_clockMutex)
+    double m_startPts = 0.0;    // PTS of first frame (seconds, guarded by m_clockMutex)
     double m_pauseTime = 0.0;   // Wall-clock time when paused (seconds)
     bool m_timingInitialized = false;  // True after first frame sets timing
     
@@ -238,6 +547,40 @@ private:
     std::atomic<bool> m_audioSeekPending{false};  // Whether an audio seek is in progress
     double m_audioSeekTargetSec = 0.0;       // Target PTS for audio seek (in seconds)
     std::atomic_bool m_holdVideoUntilAudio{false};  // Hold video presentation until audio is ready after seek
+    std::atomic<qint64> m_requestedSeekMs{-1};      // Latest seek() target not yet served by the decode thread (-1 = none)
+    std::atomic<double> m_seekRequestWallTime{0.0}; // When the latest seek() came in (seek latency statistic)
+    std::atomic<quint64> m_seeksRequested{0};
+    std::atomic<quint64> m_seeksCoalesced{0};       // Requests superseded before the decode thread got to them
+    bool m_seekPreviewPending = false;              // Decode thread: show the seek target frame even while paused
+    double m_lastDecodedVideoPts = -1.0;            // Decode thread: decoder position, for same-GOP forward seeks
+    quint64 m_seekFramesDiscarded = 0;              // Decode thread: frames decoded and dropped on the way to the target
+    static constexpr double MAX_DECODE_FORWARD_SECONDS = 5.0;  // Forward seeks within the GOP closer than this skip the demuxer seek
+    FFmpegKeyframeIndex m_keyframeIndex;            // Keyframe PTS of the video stream (container index / scan / disk cache)
+    
+    // Frame stepping
+    enum StepFill {
+        NoStepFill,
+        StepForwardFill,   // Decoding past the cached run until the requested frame exists
+        StepBackwardFill,  // Decoding the GOP before the cached run (staged, merged when it reaches the run)
+        PrefetchFill       // Same as backward, nothing presented - started ahead of the user
+    };
+    static constexpr qint64 GOP_CACHE_BUDGET_BYTES = 512ll * 1024 * 1024;  // Decoded frames kept for stepping
+    static constexpr int STEP_PREFETCH_FRAMES = 8;  // Prefetch the previous GOP this close to the run's start
+    static constexpr int STEP_FILL_MAX_FRAMES = 1200;  // Give up on a fill that never reaches its target (broken PTS)
+    std::atomic<int> m_requestedStep{0};            // Frames to step not yet served (+forward / -backward)
+    std::vector<QueuedFrame> m_stepSalvage;         // Display queue taken by requestStep() (guarded by m_decodeMutex)
+    FFmpegGopCache m_gopCache{GOP_CACHE_BUDGET_BYTES};  // Decode thread
+    int m_stepFill = NoStepFill;                    // Decode thread: fill in progress
+    int m_stepFillFrames = 0;                       // Decode thread: steps the fill serves (forward/backward)
+    int m_stepFillDecoded = 0;                      // Decode thread: frames converted by the current fill
+    double m_stepFillFromPts = 0.0;                 // Decode thread: frame on screen when the fill started
+    double m_stepFillEndPts = 0.0;                  // Decode thread: backward/prefetch fills stop at this PTS
+    std::deque<FFmpegGopCache::Entry> m_stepStaging;  // Decode thread: backward/prefetch frames before the merge
+    qint64 m_stepStagingBytes = 0;
+    bool m_stepReachedStart = false;                // Decode thread: the run starts at the first frame of the stream
+    std::atomic_bool m_stepResync{false};           // Decoder/audio moved away from the picture: re-seek on resume
+    quint64 m_stepsFromCache = 0;
+    quint64 m_stepsDecoded = 0;
     
     // Decode thread
     QThread* m_decodeThread = nullptr;
@@ -269,9 +612,6 @@ private:
     ID3D11VideoProcessorEnumerator* m_videoProcessorEnumerator = nullptr;
     ID3D11Texture2D* m_outputTexture = nullptr;
     
-    // Renderer reference (for thread-safe texture handoff)
-    FFmpegVideoRenderer* m_renderer = nullptr;
-    
     // Thread-safe pending texture storage (decode thread → render thread)
     // Decode thread stores texture here, render thread consumes it
     struct PendingFrame {
@@ -283,6 +623,71 @@ private:
     PendingFrame m_pendingFrame;
 #endif
     
+    // Display-size output (see setDisplaySize())
+    std::atomic<int> m_displayWidth{0};
+    std::atomic<int> m_displayHeight{0};
+    FFmpegFramePool m_scalePool;                // Scaled frames (separate size class from decoder frames)
+    AVFrame* m_scaledFrame = nullptr;           // Decode thread
+    SwsContext* m_displaySws = nullptr;         // Decode thread
+    bool m_inScaledOutput = false;              // Decode thread: processFrame() is handling a display-scaled frame
+    int m_lowres = 0;                           // Decode thread: decoder lowres level (openMedia(), then at keyframes)
+    std::atomic_bool m_suspendVideo{false};     // Window minimized: don't decode video
+    bool m_videoSuspended = false;              // Decode thread: video packets are being dropped
+    bool m_awaitVideoKeyframe = false;          // Decode thread: resumed, drop video packets until a keyframe
+    std::atomic<quint64> m_framesScaled{0};
+    std::atomic<quint64> m_videoPacketsSkipped{0};
+    
+    // Shared decode (GUI thread unless noted)
+    std::shared_ptr<FFmpegDecodeSession> m_session;  // nullptr = not shared (benchmark, streams, disabled)
+    bool m_sharedDecode = true;                      // QSettings "video/ffmpegSharedDecode"
+    QSize m_requestedDisplaySize;                    // setDisplaySize() of this window alone
+    bool m_windowHidden = false;                     // This window is minimized/hidden
+    std::atomic<int> m_sessionWindows{1};            // Windows fed by this decoder (statistics)
+    qint64 m_takeOverPositionMs = -1;                // Took over before the scene graph was ready (-1 = no)
+    bool m_takeOverPlaying = false;
+    
+    // Headless benchmark (counters written by the decode thread only)
+    bool m_benchmarkMode = false;
+    BenchmarkOptions m_benchmarkOptions;
+    std::atomic<quint64> m_benchFrames{0};
+    std::atomic<qint64> m_benchDemuxUs{0};
+    std::atomic<qint64> m_benchDecodeUs{0};
+    std::atomic<qint64> m_benchTransferUs{0};
+    std::atomic<qint64> m_benchConvertUs{0};
+    std::atomic<qint64> m_benchLastFrameUs{0};
+    
+    // Decoder threading (configured in openMedia before avcodec_open2)
+    int m_maxDecoderThreads = 0;      // User cap (0 = auto), persisted in QSettings "video/ffmpegMaxDecoderThreads"
+    
+    // Statistics exposed to QML (guarded by m_statsMutex)
+    mutable QMutex m_statsMutex;
+    QVariantMap m_statistics;
+    double m_lastStatsPublishTime = 0.0;   // Decode thread only
+    quint64 m_lastPoolAllocations = 0;     // Decode thread only (for allocations/second)
+    
+    // Time-to-first-frame breakdown (µs, -1 = not reached). openMedia() fills the open phases,
+    // the decode thread the first packet/frame (measured from when it starts pulling packets,
+    // so the wait for play() isn't counted). Published as the "openTrace" statistic.
+    struct OpenTrace {
+        qint64 startUs = 0;          // av_gettime_relative() when openMedia() started
+        qint64 ioUs = -1;            // Input open + container header (avformat_open_input)
+        qint64 probeUs = -1;         // avformat_find_stream_info, all passes
+        int probePasses = 0;
+        qint64 probeSize = 0;        // Limits of the last pass
+        qint64 analyzeDurationUs = 0;
+        qint64 videoCodecUs = -1;    // Video decoder + hw device (worker thread)
+        qint64 audioOpenUs = -1;     // Audio decoder + sink start (GUI thread, overlaps videoCodecUs)
+        qint64 codecPhaseUs = -1;    // Wall time of the overlapped codec phase
+        qint64 openUs = -1;          // Whole openMedia()
+        qint64 decodeStartUs = 0;    // Decode thread only: absolute time it started pulling packets
+        qint64 firstPacketUs = -1;   // Decode thread only: from decodeStartUs
+        qint64 firstFrameUs = -1;    // Decode thread only: from decodeStartUs
+    };
+    OpenTrace m_openTrace;
+    
+    // Recycled frame buffers for software decode output and hwframe transfers
+    FFmpegFramePool m_framePool;
+    
     // State
     qint64 m_duration = 0;
     qint64 m_position = 0;
@@ -0,0 +1,416 @@
+#include "ffmpegvideoplayer.h"
+#include "ffmpegaudioringbuffer.h"
+#include "ffmpegvideorenderer.h"
+#include <QDebug>
+#include <QMetaObject>
+#include <QSettings>
+#include <cmath>
+
+extern "C" {
+#include <libavformat/avformat.h>
+#include <libavutil/time.h>
+}
+
+// Presentation scheduler for FFmpegVideoPlayer
+//
+// The decode thread converts frames (zero-copy QVideoFrame) and queues them here; it blocks
+// while the display queue is full, which is what paces decoding (no sleeps in the decode loop).
+// The presenter thread compares the head frame's PTS against the selected master clock:
+// early frames are held (condition wait, woken by flush/pause/stop), late frames are dropped
+// when a newer frame is already queued, everything else is handed to the GUI thread.
+
+namespace {
+
+// Frames due within this window are presented now (QVideoSink shows them at the next vsync)
+constexpr double PRESENT_EARLY_TOLERANCE = 0.002;
+// Longest single hold, so clock changes (audio start, resume) are picked up promptly
+constexpr double PRESENT_MAX_HOLD = 0.050;
+// Audio clock frozen this long = sink starved (decode thread is waiting on us) - follow the wall clock
+constexpr double AUDIO_STALL_TIMEOUT = 0.250;
+
+// A/V offset histogram bucket edges (ms): <-100, -100..-50, -50..-20, -20..-5, -5..5, 5..20, 20..50, 50..100, >100
+constexpr double AV_OFFSET_EDGES_MS[] = { -100.0, -50.0, -20.0, -5.0, 5.0, 20.0, 50.0, 100.0 };
+
+inline double nowSeconds()
+{
+    return av_gettime_relative() / 1000000.0;
+}
+
+} // namespace
+
+const char* FFmpegVideoPlayer::clockSourceName(int source)
+{
+    switch (source) {
+    case VideoClock: return "video";
+    case ExternalClock: return "external";
+    default: return "audio";
+    }
+}
+
+void FFmpegVideoPlayer::startPresenter()
+{
+    {
+        QMutexLocker locker(&m_presentMutex);
+        m_displayQueue.clear();
+        ++m_presentGeneration;
+        m_presentThreadRunning = true;
+        m_lastPresentWallTime = 0.0;
+        m_lastPresentDuration = 0.0;
+    }
+
+    m_framesPresented.store(0, std::memory_order_relaxed);
+    m_framesDropped.store(0, std::memory_order_relaxed);
+    m_framesDuplicated.store(0, std::memory_order_relaxed);
+    for (auto& bucket : m_avOffsetHistogram) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+
+    m_presentThread = QThread::create([this]() { presentThreadFunc(); });
+    m_presentThread->start();
+}
+
+void FFmpegVideoPlayer::stopPresenter()
+{
+    {
+        QMutexLocker locker(&m_presentMutex);
+        m_presentThreadRunning = false;
+        m_displayQueue.clear();
+        ++m_presentGeneration;
+        m_presentCondition.wakeAll();
+        m_queueSpaceCondition.wakeAll();  // Release a decode thread blocked on a full queue
+    }
+
+    if (m_presentThread) {
+        m_presentThread->wait(5000);
+        delete m_presentThread;
+        m_presentThread = nullptr;
+    }
+
+    QMutexLocker guiLocker(&m_guiFrameMutex);
+    m_guiFrame = QVideoFrame();
+    m_guiFramePts = -1.0;
+}
+
+void FFmpegVideoPlayer::flushPresentationQueue()
+{
+    QMutexLocker locker(&m_presentMutex);
+    m_displayQueue.clear();
+    ++m_presentGeneration;
+    m_lastPresentWallTime = 0.0;  // Don't count the gap across a seek/stop as duplicated frames
+    m_presentCondition.wakeAll();
+    m_queueSpaceCondition.wakeAll();
+}
+
+std::deque<FFmpegVideoPlayer::QueuedFrame> FFmpegVideoPlayer::takePresentationQueue()
+{
+    QMutexLocker locker(&m_presentMutex);
+    std::deque<QueuedFrame> frames;
+    frames.swap(m_displayQueue);
+    ++m_presentGeneration;
+    m_lastPresentWallTime = 0.0;
+    m_presentCondition.wakeAll();
+    m_queueSpaceCondition.wakeAll();
+    return frames;
+}
+
+bool FFmpegVideoPlayer::queueFrameForPresentation(const QVideoFrame& frame, double pts, double duration)
+{
+    QMutexLocker locker(&m_presentMutex);
+    const quint64 generation = m_presentGeneration;
+
+    // Backpressure: the decode thread waits here until the presenter consumes a frame
+    while (m_presentThreadRunning && m_decodeThreadRunning &&
+           generation == m_presentGeneration &&
+           static_cast<int>(m_displayQueue.size()) >= DISPLAY_QUEUE_SIZE) {
+        m_queueSpaceCondition.wait(&m_presentMutex, 100);
+    }
+
+    // Stopped or flushed (seek) while waiting - this frame belongs to the old position
+    if (!m_presentThreadRunning || !m_decodeThreadRunning || generation != m_presentGeneration) {
+        return false;
+    }
+
+    m_displayQueue.push_back(QueuedFrame{ frame, pts, duration });
+    m_presentCondition.wakeAll();
+    return true;
+}
+
+void FFmpegVideoPlayer::presentThreadFunc()
+{
+    qDebug() << "[FFmpeg] Presenter thread started";
+
+    double lastAudioClock = -1.0;
+    double lastAudioClockChange = 0.0;
+
+    QMutexLocker locker(&m_presentMutex);
+    while (m_presentThreadRunning) {
+        if (m_presentPaused.load(std::memory_order_acquire)) {
+            m_lastPresentWallTime = 0.0;  // Paused time is not a duplicated frame
+            lastAudioClock = -1.0;        // ...nor an audio stall
+            m_presentCondition.wait(&m_presentMutex, 100);
+            continue;
+        }
+        if (m_displayQueue.empty()) {
+            m_presentCondition.wait(&m_presentMutex, 100);
+            continue;
+        }
+
+        const quint64 generation = m_presentGeneration;
+        const double pts = m_displayQueue.front().pts;
+        const double frameDuration = m_displayQueue.front().duration > 0.0
+            ? m_displayQueue.front().duration : nominalFrameDuration();
+        const int source = m_masterClock.load(std::memory_order_relaxed);
+
+        // Read the clocks without the queue lock held (decode thread may be waiting on it)
+        locker.unlock();
+        bool audioValid = false;
+        const double audioClock = audioClockSeconds(&audioValid);
+        const double rate = m_playbackRate.load(std::memory_order_relaxed);
+        const double wallClock = wallClockSeconds();
+        locker.relock();
+
+        // Holding video while the audio sink underruns would never let the decode thread refill it
+        bool audioStalled = false;
+        if (audioValid) {
+            const double now = nowSeconds();
+            if (audioClock != lastAudioClock) {
+                lastAudioClock = audioClock;
+                lastAudioClockChange = now;
+            } else if (now - lastAudioClockChange > AUDIO_STALL_TIMEOUT) {
+                audioStalled = true;
+            }
+        }
+
+        if (!m_presentThreadRunning) {
+            break;
+        }
+        if (generation != m_presentGeneration || m_displayQueue.empty()) {
+            continue;  // Flushed while unlocked
+        }
+
+        const double clock = (source == AudioClock && audioValid && !audioStalled) ? audioClock : wallClock;
+        // Frames without a timestamp (or before timing is set up) are shown as soon as they arrive
+        const bool scheduled = pts > 0.0 && m_timingInitialized;
+        const double delay = scheduled ? pts - clock : 0.0;
+
+        // Early: hold until due (woken early by new frames, flush, pause or stop)
+        // delay is media time - it passes 1/rate as fast on the wall clock
+        if (delay > PRESENT_EARLY_TOLERANCE * rate) {
+            const double hold = qMin(delay / rate, PRESENT_MAX_HOLD);
+            m_presentCondition.wait(&m_presentMutex, qMax<unsigned long>(1, static_cast<unsigned long>(hold * 1000.0)));
+            continue;
+        }
+
+        // Late by more than a frame and a newer frame is ready: skip this one
+        // (video master never drops - it slips its clock instead, below)
+        if (source != VideoClock && delay < -frameDuration && m_displayQueue.size() > 1) {
+            m_displayQueue.pop_front();
+            m_framesDropped.fetch_add(1, std::memory_order_relaxed);
+            m_queueSpaceCondition.wakeAll();
+            continue;
+        }
+
+        QueuedFrame queued = std::move(m_displayQueue.front());
+        m_displayQueue.pop_front();
+        m_queueSpaceCondition.wakeAll();
+
+        const double now = nowSeconds();
+        if (source == VideoClock && delay < -frameDuration) {
+            // Video is master: re-anchor the clock on this frame so following frames keep their cadence
+            setWallClockAnchor(pts, now);
+        }
+
+        // A/V offset is measured against the audible position whenever audio is running,
+        // regardless of which clock drives presentation
+        if (scheduled) {
+            recordPresentation(audioValid ? pts - audioClock : delay, frameDuration, now);
+        } else {
+            m_lastPresentWallTime = now;
+            m_lastPresentDuration = frameDuration;
+            m_framesPresented.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        locker.unlock();
+        deliverFrame(queued.frame, queued.pts);
+        if (scheduled) {
+            m_position = static_cast<qint64>(pts * 1000.0);
+            emit positionChanged();
+        }
+        locker.relock();
+    }
+
+    qDebug() << "[FFmpeg] Presenter thread stopped";
+}
+
+void FFmpegVideoPlayer::deliverFrame(const QVideoFrame& frame, double pts)
+{
+    {
+        QMutexLocker guiLocker(&m_guiFrameMutex);
+        m_guiFrame = frame;
+        m_guiFramePts = pts;
+    }
+
+    // Only ONE queued call in flight to the GUI thread - if it hasn't run yet it will
+    // pick up this (newer) frame instead of the one it was queued for
+    if (m_framePending.exchange(true, std::memory_order_acq_rel)) {
+        return;
+    }
+
+    QMetaObject::invokeMethod(this, [this]() {
+        // Clear pending BEFORE reading so a frame stored meanwhile always gets its own call
+        m_framePending.store(false, std::memory_order_release);
+        QVideoFrame videoFrame;
+        {
+            QMutexLocker guiLocker(&m_guiFrameMutex);
+            videoFrame = m_guiFrame;
+        }
+        if (!videoFrame.isValid()) {
+            return;
+        }
+        // Shared decode: every window showing this source gets the same (reference-counted) frame now
+        const QList<FFmpegVideoPlayer*> consumers = frameConsumers();
+        for (FFmpegVideoPlayer* consumer : consumers) {
+            if (consumer->m_videoSink) {
+                consumer->m_videoSink->setVideoFrame(videoFrame);
+            }
+            if (consumer->m_renderer) {
+                consumer->m_renderer->setFrame(videoFrame);
+            }
+        }
+    }, Qt::QueuedConnection);
+}
+
+void FFmpegVideoPlayer::recordPresentation(double offset, double frameDuration, double now)
+{
+    const double offsetMs = offset * 1000.0;
+    int bucket = 0;
+    while (bucket < AV_OFFSET_BUCKETS - 1 && offsetMs >= AV_OFFSET_EDGES_MS[bucket]) {
+        ++bucket;
+    }
+    m_avOffsetHistogram[bucket].fetch_add(1, std::memory_order_relaxed);
+
+    // Previous frame stayed on screen for extra frame periods (decode/convert couldn't keep up)
+    if (m_lastPresentWallTime > 0.0 && m_lastPresentDuration > 0.0) {
+        const double shown = now - m_lastPresentWallTime;
+        if (shown > m_lastPresentDuration * 1.5) {
+            const quint64 repeats = static_cast<quint64>(std::lround(shown / m_lastPresentDuration)) - 1;
+            m_framesDuplicated.fetch_add(qMax<quint64>(1, repeats), std::memory_order_relaxed);
+        }
+    }
+
+    m_lastPresentWallTime = now;
+    m_lastPresentDuration = frameDuration;
+    m_framesPresented.fetch_add(1, std::memory_order_relaxed);
+}
+
+double FFmpegVideoPlayer::audioClockSeconds(bool* valid)
+{
+    *valid = false;
+    FFmpegAudioRingBuffer* ring = m_audioRing;
+    QMutexLocker locker(&m_audioClockMutex);
+    if (!m_audioCodecContext || !ring || std::isnan(m_audioBasePts)) {
+        return 0.0;
+    }
+
+    const qint64 bytesPerSecond = qint64(m_audioFormat.bytesPerFrame()) * m_audioFormat.sampleRate();
+    if (bytesPerSecond <= 0) {
+        return 0.0;
+    }
+
+    // Bytes of this segment the sink has actually pulled (silence padding on underrun is never counted,
+    // old-position audio still draining after a seek gives a negative value)
+    const quint64 readPosition = ring->readPosition();
+    const qint64 consumed = qint64(readPosition - m_audioBaseBytePos);
+    // Pulled audio becomes audible one sink buffer later
+    const qint64 audible = consumed - m_audioSinkBufferBytes;
+
+    // Each second of ring audio covers `rate` seconds of media (time-stretched).
+    // Audio queued before the last rate change is still playing: count it at its own rate.
+    if (audible < 0 && !std::isnan(m_audioPrevBasePts)) {
+        const qint64 previous = qMax<qint64>(0, qint64(readPosition - m_audioPrevBaseBytePos) - m_audioSinkBufferBytes);
+        m_audioClock = m_audioPrevBasePts + double(previous) / double(bytesPerSecond) * m_audioPrevRate;
+    } else {
+        m_audioClock = m_audioBasePts + double(qMax<qint64>(0, audible)) / double(bytesPerSecond) * m_audioRate;
+    }
+    *valid = true;
+    return m_audioClock;
+}
+
+bool FFmpegVideoPlayer::hasAudioClockBase() const
+{
+    QMutexLocker locker(&m_audioClockMutex);
+    return !std::isnan(m_audioBasePts);
+}
+
+void FFmpegVideoPlayer::resetAudioClock()
+{
+    QMutexLocker locker(&m_audioClockMutex);
+    m_audioBasePts = NAN;
+    m_audioPrevBasePts = NAN;
+    m_audioClock = 0.0;
+}
+
+double FFmpegVideoPlayer::masterClockSeconds()
+{
+    if (m_masterClock.load(std::memory_order_relaxed) == AudioClock) {
+        bool valid = false;
+        const double audioClock = audioClockSeconds(&valid);
+        if (valid) {
+            return audioClock;
+        }
+        // Audio not ready yet (e.g. after seek) - wall clock until the first audio frame is out
+    }
+    return wallClockSeconds();
+}
+
+double FFmpegVideoPlayer::wallClockSeconds() const
+{
+    // Anchor and rate are only changed together under m_clockMutex (setPlaybackRate re-anchors first)
+    QMutexLocker locker(&m_clockMutex);
+    return m_startPts + (nowSeconds() - m_startTime) * m_playbackRate.load(std::memory_order_relaxed);
+}
+
+void FFmpegVideoPlayer::setWallClockAnchor(double pts, double wallTime)
+{
+    QMutexLocker locker(&m_clockMutex);
+    m_startPts = pts;
+    m_startTime = wallTime;
+}
+
+double FFmpegVideoPlayer::nominalFrameDuration() const
+{
+    const AVStream* stream = m_videoStream;  // closeMedia() clears it while the presenter may still run
+    if (stream && stream->avg_frame_rate.num > 0 && stream->avg_frame_rate.den > 0) {
+        return 1.0 / av_q2d(stream->avg_frame_rate);
+    }
+    return 1.0 / 30.0;  // Assume 30fps if unknown
+}
+
+void FFmpegVideoPlayer::setMasterClock(int clock)
+{
+    if (clock < AudioClock || clock > ExternalClock) {
+        qWarning() << "[FFmpeg] Ignoring invalid master clock:" << clock;
+        return;
+    }
+    if (m_masterClock.exchange(clock, std::memory_order_relaxed) == clock) {
+        return;
+    }
+
+    // Re-anchor the wall clock on the current position so switching doesn't jump
+    if (m_timingInitialized) {
+        setWallClockAnchor(m_position / 1000.0, nowSeconds());
+    }
+
+    QSettings settings;
+    settings.setValue("video/ffmpegMasterClock", clock);
+
+    setStatistic(QStringLiteral("masterClock"), QString::fromLatin1(clockSourceName(clock)));
+    qDebug() << "[FFmpeg] Master clock:" << clockSourceName(clock);
+
+    {
+        QMutexLocker locker(&m_presentMutex);
+        m_presentCondition.wakeAll();
+    }
+    emit masterClockChanged();
+    emit statisticsChanged();
+}
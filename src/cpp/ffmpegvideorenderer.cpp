@@ -1,6 +1,8 @@
 #include "ffmpegvideorenderer.h"
 #include "ffmpegvideoplayer.h"
+#include "ffmpegyuvmaterial.h"
 #include <QDebug>
+#include <QtQuick/QSGGeometryNode>
 #include <QtQuick/QSGSimpleTextureNode>
 #include <QtQuick/QSGTexture>
 #include <QQuickWindow>
@@ -13,15 +15,70 @@
 
 FFmpegVideoRenderer::FFmpegVideoRenderer(QQuickItem* parent)
     : QQuickItem(parent)
-    , m_player(nullptr)
 {
     setFlag(ItemHasContents, true);
 }
 
 FFmpegVideoRenderer::~FFmpegVideoRenderer()
 {
+    if (m_player) {
+        m_player->setRenderer(nullptr);
+    }
+}
+
+QObject* FFmpegVideoRenderer::player() const
+{
+    return m_player.data();
+}
+
+void FFmpegVideoRenderer::setPlayer(QObject* player)
+{
+    FFmpegVideoPlayer* videoPlayer = qobject_cast<FFmpegVideoPlayer*>(player);
+    if (player && !videoPlayer) {
+        qWarning() << "[FFmpegRenderer] player is not a FFmpegVideoPlayer";
+    }
+    if (m_player == videoPlayer) {
+        return;
+    }
+
+    if (m_player) {
+        m_player->setRenderer(nullptr);
+    }
+    if (videoPlayer) {
+        videoPlayer->setRenderer(this);  // Sets m_player, pushes the current frame
+    } else {
+        // Detached: release the last frame (its buffer belongs to the player's frame pool)
+        m_frame = QVideoFrame();
+        m_frameDirty = true;
+        update();
+    }
+    emit playerChanged();
+}
+
+QRectF FFmpegVideoRenderer::contentRect() const
+{
+    const QRectF bounds = boundingRect();
+    if (m_videoWidth <= 0 || m_videoHeight <= 0 || bounds.isEmpty()) {
+        return bounds;
+    }
+
+    // Aspect fit, centered
+    const qreal scale = qMin(bounds.width() / m_videoWidth, bounds.height() / m_videoHeight);
+    const QSizeF size(m_videoWidth * scale, m_videoHeight * scale);
+    return QRectF(bounds.x() + (bounds.width() - size.width()) / 2.0,
+                  bounds.y() + (bounds.height() - size.height()) / 2.0,
+                  size.width(), size.height());
 }
 
+void FFmpegVideoRenderer::setFrame(const QVideoFrame& frame)
+{
+    m_frame = frame;
+    m_frameDirty = true;
+    setVideoSize(frame.width(), frame.height());
+    update();
+}
+
+#ifdef Q_OS_WIN
 bool FFmpegVideoRenderer::getPendingFrame(ID3D11Texture2D** texture, int* width, int* height)
 {
     // This is called from render thread - get pending frame from player
@@ -31,6 +88,7 @@ bool FFmpegVideoRenderer::getPendingFrame(ID3D11Texture2D** texture, int* width,
     
     return m_player->getPendingFrame(texture, width, height);
 }
+#endif
 
 void FFmpegVideoRenderer::setVideoSize(int w, int h)
 {
@@ -41,25 +99,113 @@ void FFmpegVideoRenderer::setVideoSize(int w, int h)
     m_videoWidth = w;
     m_videoHeight = h;
     emit videoSizeChanged();
+    emit contentRectChanged();
+}
+
+void FFmpegVideoRenderer::geometryChange(const QRectF& newGeometry, const QRectF& oldGeometry)
+{
+    QQuickItem::geometryChange(newGeometry, oldGeometry);
+    if (newGeometry.size() != oldGeometry.size()) {
+        emit contentRectChanged();
+        update();  // Refit the picture
+    }
 }
 
 QSGNode* FFmpegVideoRenderer::updatePaintNode(QSGNode* oldNode, UpdatePaintNodeData* data)
 {
     Q_UNUSED(data);
     
-    // This is called on the render thread
-    QSGSimpleTextureNode* node = static_cast<QSGSimpleTextureNode*>(oldNode);
-    
-    // Get pending frame from player
+    // This is called on the render thread (GUI thread blocked)
+#ifdef Q_OS_WIN
+    // CUDA frames arrive as D3D11 textures
     ID3D11Texture2D* frameTexture = nullptr;
     int frameWidth = 0;
     int frameHeight = 0;
-    
-    if (!getPendingFrame(&frameTexture, &frameWidth, &frameHeight) || !frameTexture) {
-        // No frame available - return existing node or nullptr
+    if (getPendingFrame(&frameTexture, &frameWidth, &frameHeight) && frameTexture) {
+        if (m_nodeKind != NodeKind::D3D11) {
+            delete oldNode;
+            oldNode = nullptr;
+        }
+        QSGNode* node = updateD3D11Node(static_cast<QSGSimpleTextureNode*>(oldNode), frameTexture, frameWidth, frameHeight);
+        m_nodeKind = node ? NodeKind::D3D11 : NodeKind::None;
         return node;
     }
-    
+    if (m_nodeKind == NodeKind::D3D11 && !m_frameDirty) {
+        return oldNode;
+    }
+#endif
+    return updateYuvNode(oldNode);
+}
+
+QSGNode* FFmpegVideoRenderer::updateYuvNode(QSGNode* oldNode)
+{
+    QSGGeometryNode* node = m_nodeKind == NodeKind::Yuv ? static_cast<QSGGeometryNode*>(oldNode) : nullptr;
+    if (!m_frameDirty) {
+        // Resize only
+        if (node) {
+            updateYuvGeometry(node);
+        }
+        return oldNode;
+    }
+    m_frameDirty = false;
+
+    // The material keeps the frame mapped until the next one
+    const QVideoFrame frame = m_frame;
+    m_frame = QVideoFrame();
+    if (!frame.isValid()) {
+        delete oldNode;
+        m_nodeKind = NodeKind::None;
+        return nullptr;
+    }
+
+    const bool created = !node;
+    if (created) {
+        delete oldNode;
+        node = new QSGGeometryNode;
+        node->setGeometry(new QSGGeometry(QSGGeometry::defaultAttributes_TexturedPoint2D(), 4));
+        node->setFlag(QSGNode::OwnsGeometry);
+        node->setMaterial(new FFmpegYuvMaterial);
+        node->setFlag(QSGNode::OwnsMaterial);
+        m_nodeKind = NodeKind::Yuv;
+        m_nodeRect = QRectF();
+    }
+
+    QRhi* rhi = window() ? window()->rhi() : nullptr;
+    auto* material = static_cast<FFmpegYuvMaterial*>(node->material());
+    if (!material->setFrame(frame, rhi)) {
+        if (!m_loggedUnsupported) {
+            qWarning() << "[FFmpegRenderer] Can't draw" << frame.pixelFormat() << "frames on this backend";
+            m_loggedUnsupported = true;
+        }
+        if (created) {
+            // Nothing to show yet - no node rather than one without textures
+            delete node;
+            m_nodeKind = NodeKind::None;
+            return nullptr;
+        }
+        return node;  // Keep the previous picture
+    }
+
+    node->markDirty(QSGNode::DirtyMaterial);
+    updateYuvGeometry(node);
+    return node;
+}
+
+void FFmpegVideoRenderer::updateYuvGeometry(QSGGeometryNode* node)
+{
+    const QRectF rect = contentRect();
+    if (rect == m_nodeRect) {
+        return;
+    }
+    m_nodeRect = rect;
+    QSGGeometry::updateTexturedRectGeometry(node->geometry(), rect, QRectF(0, 0, 1, 1));
+    node->markDirty(QSGNode::DirtyGeometry);
+}
+
+#ifdef Q_OS_WIN
+QSGNode* FFmpegVideoRenderer::updateD3D11Node(QSGSimpleTextureNode* node, ID3D11Texture2D* frameTexture,
+                                              int frameWidth, int frameHeight)
+{
     // Update size properties (emit signal on GUI thread)
     if (m_videoWidth != frameWidth || m_videoHeight != frameHeight) {
         QMetaObject::invokeMethod(this,
@@ -174,3 +320,4 @@ QSGNode* FFmpegVideoRenderer::updatePaintNode(QSGNode* oldNode, UpdatePaintNodeD
     
     return node;
 }
+#endif
@@ -2,6 +2,9 @@
 #define FFMPEGVIDEORENDERER_H
 
 #include <QtQuick/QQuickItem>
+#include <QPointer>
+#include <QRectF>
+#include <QVideoFrame>
 
 // Forward declarations
 #ifdef Q_OS_WIN
@@ -9,40 +12,82 @@ struct ID3D11Texture2D;
 #endif
 
 class FFmpegVideoPlayer;
+class QSGGeometryNode;
+class QSGSimpleTextureNode;
 
+/**
+ * Scene graph output for FFmpegVideoPlayer (alternative to VideoOutput + videoSink)
+ *
+ * Frames are drawn by an FFmpegYuvMaterial node: the Y and CbCr (or Cb/Cr) planes are uploaded
+ * as separate textures and converted to RGB in the fragment shader, so the only CPU work per
+ * frame is the plane upload. Runs on any RHI backend (D3D11, Vulkan, OpenGL incl. llvmpipe).
+ * The picture is aspect-fitted into the item (contentRect).
+ *
+ * Windows CUDA frames still arrive as D3D11 textures (getPendingFrame) and use the D3D11-only path.
+ */
 class FFmpegVideoRenderer : public QQuickItem
 {
     Q_OBJECT
+    Q_PROPERTY(QObject* player READ player WRITE setPlayer NOTIFY playerChanged)
     Q_PROPERTY(int videoWidth READ videoWidth NOTIFY videoSizeChanged)
     Q_PROPERTY(int videoHeight READ videoHeight NOTIFY videoSizeChanged)
+    Q_PROPERTY(QRectF contentRect READ contentRect NOTIFY contentRectChanged)
 
 public:
     explicit FFmpegVideoRenderer(QQuickItem* parent = nullptr);
     ~FFmpegVideoRenderer();
 
+    QObject* player() const;
+    void setPlayer(QObject* player);
+
     int videoWidth() const { return m_videoWidth; }
     int videoHeight() const { return m_videoHeight; }
+    QRectF contentRect() const;
+
+    // GUI thread: next frame to show (the player calls this for every presented frame)
+    void setFrame(const QVideoFrame& frame);
 
+#ifdef Q_OS_WIN
     // Called from render thread to get pending frame from player
     // Returns true if a new frame was available
     bool getPendingFrame(ID3D11Texture2D** texture, int* width, int* height);
+#endif
 
 signals:
+    void playerChanged();
     void videoSizeChanged();
+    void contentRectChanged();
 
 protected:
     QSGNode* updatePaintNode(QSGNode* oldNode, UpdatePaintNodeData* data) override;
+    void geometryChange(const QRectF& newGeometry, const QRectF& oldGeometry) override;
 
 private slots:
     // Set video size (called from render thread via invokeMethod)
     void setVideoSize(int w, int h);
 
 private:
+    QSGNode* updateYuvNode(QSGNode* oldNode);
+    void updateYuvGeometry(QSGGeometryNode* node);
+#ifdef Q_OS_WIN
+    QSGNode* updateD3D11Node(QSGSimpleTextureNode* node, ID3D11Texture2D* frameTexture, int frameWidth, int frameHeight);
+#endif
+
     friend class FFmpegVideoPlayer;
-    FFmpegVideoPlayer* m_player = nullptr;
-    
+    QPointer<FFmpegVideoPlayer> m_player;
+
     int m_videoWidth = 0;
     int m_videoHeight = 0;
+
+    // Written on the GUI thread, read in updatePaintNode() (GUI thread blocked during sync)
+    QVideoFrame m_frame;
+    bool m_frameDirty = false;
+    bool m_loggedUnsupported = false;
+
+    // Render thread
+    enum class NodeKind { None, Yuv, D3D11 };
+    NodeKind m_nodeKind = NodeKind::None;
+    QRectF m_nodeRect;
 };
 
 #endif // FFMPEGVIDEORENDERER_H
@@ -0,0 +1,262 @@
+#include "ffmpegyuvmaterial.h"
+#include <QDebug>
+#include <QtQuick/QSGMaterialShader>
+#include <cstring>
+
+qint64 FFmpegPlaneTexture::comparisonKey() const
+{
+    return qint64(qintptr(m_texture ? static_cast<const void*>(m_texture.get()) : static_cast<const void*>(this)));
+}
+
+void FFmpegPlaneTexture::setPlane(const uchar* data, int bytesPerLine, const QSize& size, QRhiTexture::Format format)
+{
+    m_data = data;
+    m_bytesPerLine = bytesPerLine;
+    m_size = size;
+    m_format = format;
+    m_dirty = true;
+}
+
+void FFmpegPlaneTexture::commitTextureOperations(QRhi* rhi, QRhiResourceUpdateBatch* resourceUpdates)
+{
+    if (!m_dirty || !m_data || !rhi || !resourceUpdates) {
+        return;
+    }
+    m_dirty = false;
+
+    if (!m_texture || m_texture->pixelSize() != m_size || m_texture->format() != m_format) {
+        m_texture.reset(rhi->newTexture(m_format, m_size, 1, {}));
+        if (!m_texture->create()) {
+            qWarning() << "[FFmpegRenderer] Failed to create plane texture" << m_size << "format" << m_format;
+            m_texture.reset();
+            return;
+        }
+    }
+
+    // ✅ Upload straight from the mapped frame (stride passed through, no repacking)
+    QRhiTextureSubresourceUploadDescription subresource(
+        QByteArray::fromRawData(reinterpret_cast<const char*>(m_data), m_bytesPerLine * m_size.height()));
+    subresource.setDataStride(quint32(m_bytesPerLine));
+    resourceUpdates->uploadTexture(m_texture.get(), QRhiTextureUploadDescription({ 0, 0, subresource }));
+}
+
+namespace {
+
+class FFmpegYuvShader : public QSGMaterialShader
+{
+public:
+    FFmpegYuvShader()
+    {
+        setShaderFileName(VertexStage, QStringLiteral(":/resources/shaders/ffmpeg_yuv.vert.qsb"));
+        setShaderFileName(FragmentStage, QStringLiteral(":/resources/shaders/ffmpeg_yuv.frag.qsb"));
+    }
+
+    bool updateUniformData(RenderState& state, QSGMaterial* newMaterial, QSGMaterial* oldMaterial) override
+    {
+        Q_UNUSED(oldMaterial);
+        auto* material = static_cast<FFmpegYuvMaterial*>(newMaterial);
+        QByteArray* buf = state.uniformData();
+        Q_ASSERT(buf->size() >= 136);
+
+        // std140 layout: qt_Matrix @0, colorMatrix @64, qt_Opacity @128, planeLayout @132
+        if (state.isMatrixDirty()) {
+            const QMatrix4x4 matrix = state.combinedMatrix();
+            std::memcpy(buf->data(), matrix.constData(), 64);
+        }
+        std::memcpy(buf->data() + 64, material->colorMatrix().constData(), 64);
+        if (state.isOpacityDirty()) {
+            const float opacity = state.opacity();
+            std::memcpy(buf->data() + 128, &opacity, 4);
+        }
+        const qint32 layout = material->planeLayout();
+        std::memcpy(buf->data() + 132, &layout, 4);
+        return true;
+    }
+
+    void updateSampledImage(RenderState& state, int binding, QSGTexture** texture,
+                            QSGMaterial* newMaterial, QSGMaterial* oldMaterial) override
+    {
+        Q_UNUSED(oldMaterial);
+        if (binding < 1 || binding > 3) {
+            return;
+        }
+        auto* material = static_cast<FFmpegYuvMaterial*>(newMaterial);
+        FFmpegPlaneTexture* plane = material->plane(binding - 1);
+        plane->commitTextureOperations(state.rhi(), state.resourceUpdateBatch());
+        *texture = plane;
+    }
+};
+
+} // namespace
+
+FFmpegYuvMaterial::FFmpegYuvMaterial()
+{
+    for (auto& plane : m_planes) {
+        plane = std::make_unique<FFmpegPlaneTexture>();
+        plane->setFiltering(QSGTexture::Linear);
+        plane->setHorizontalWrapMode(QSGTexture::ClampToEdge);
+        plane->setVerticalWrapMode(QSGTexture::ClampToEdge);
+    }
+    setFlag(Blending);  // Item opacity (the shader outputs premultiplied color)
+}
+
+FFmpegYuvMaterial::~FFmpegYuvMaterial()
+{
+    if (m_frame.isMapped()) {
+        m_frame.unmap();
+    }
+}
+
+QSGMaterialType* FFmpegYuvMaterial::type() const
+{
+    static QSGMaterialType type;
+    return &type;
+}
+
+QSGMaterialShader* FFmpegYuvMaterial::createShader(QSGRendererInterface::RenderMode renderMode) const
+{
+    Q_UNUSED(renderMode);
+    return new FFmpegYuvShader;
+}
+
+int FFmpegYuvMaterial::compare(const QSGMaterial* other) const
+{
+    // Every node owns its planes - never batch two videos
+    return this == other ? 0 : (this < other ? -1 : 1);
+}
+
+bool FFmpegYuvMaterial::setFrame(const QVideoFrame& frame, QRhi* rhi)
+{
+    QRhiTexture::Format lumaFormat = QRhiTexture::R8;
+    QRhiTexture::Format chromaFormat = QRhiTexture::RG8;
+    int layout = SemiPlanar;
+    int planeCount = 2;
+
+    switch (frame.pixelFormat()) {
+    case QVideoFrameFormat::Format_NV12:
+        break;
+    case QVideoFrameFormat::Format_P010:
+        lumaFormat = QRhiTexture::R16;
+        chromaFormat = QRhiTexture::RG16;
+        break;
+    case QVideoFrameFormat::Format_YUV420P:
+        chromaFormat = QRhiTexture::R8;
+        layout = Planar;
+        planeCount = 3;
+        break;
+    case QVideoFrameFormat::Format_YUV420P10:
+        lumaFormat = QRhiTexture::R16;
+        chromaFormat = QRhiTexture::R16;
+        layout = Planar;
+        planeCount = 3;
+        break;
+    case QVideoFrameFormat::Format_BGRA8888:
+        lumaFormat = QRhiTexture::BGRA8;
+        layout = PackedRgb;
+        planeCount = 1;
+        break;
+    default:
+        return false;
+    }
+
+    if (rhi && (!rhi->isTextureFormatSupported(lumaFormat)
+                || (planeCount > 1 && !rhi->isTextureFormatSupported(chromaFormat)))) {
+        return false;
+    }
+
+    // The previous frame's planes were uploaded by the last render pass
+    if (m_frame.isMapped()) {
+        m_frame.unmap();
+    }
+    m_frame = frame;
+    if (!m_frame.map(QVideoFrame::ReadOnly)) {
+        m_frame = QVideoFrame();
+        return false;
+    }
+
+    const QSize lumaSize(m_frame.width(), m_frame.height());
+    const QSize chromaSize((lumaSize.width() + 1) / 2, (lumaSize.height() + 1) / 2);
+    m_planes[0]->setPlane(m_frame.bits(0), m_frame.bytesPerLine(0), lumaSize, lumaFormat);
+    for (int i = 1; i < planeCount; ++i) {
+        m_planes[i]->setPlane(m_frame.bits(i), m_frame.bytesPerLine(i), chromaSize, chromaFormat);
+    }
+
+    m_planeLayout = layout;
+    m_planeCount = planeCount;
+    m_colorMatrix = colorMatrix(m_frame.surfaceFormat());
+    return true;
+}
+
+QMatrix4x4 FFmpegYuvMaterial::colorMatrix(const QVideoFrameFormat& format)
+{
+    // Sample value → code value: 8-bit formats sample code/255, P010 stores the code in the top
+    // 10 bits of a 16-bit word (sample = code*64/65535), YUV420P10 in the low bits (code/65535)
+    int bits = 8;
+    float codeScale = 255.0f;
+    switch (format.pixelFormat()) {
+    case QVideoFrameFormat::Format_P010:
+        bits = 10;
+        codeScale = 65535.0f / 64.0f;
+        break;
+    case QVideoFrameFormat::Format_YUV420P10:
+        bits = 10;
+        codeScale = 65535.0f;
+        break;
+    case QVideoFrameFormat::Format_BGRA8888:
+        return QMatrix4x4();  // Not used by the shader
+    default:
+        break;
+    }
+
+    // Luma coefficients
+    float kr = 0.2126f;
+    float kb = 0.0722f;
+    switch (format.colorSpace()) {
+    case QVideoFrameFormat::ColorSpace_BT601:
+        kr = 0.299f;
+        kb = 0.114f;
+        break;
+    case QVideoFrameFormat::ColorSpace_BT2020:
+        kr = 0.2627f;
+        kb = 0.0593f;
+        break;
+    case QVideoFrameFormat::ColorSpace_Undefined:
+        // Untagged: SD is BT.601, everything larger BT.709
+        if (format.frameHeight() <= 576) {
+            kr = 0.299f;
+            kb = 0.114f;
+        }
+        break;
+    default:
+        break;
+    }
+    const float kg = 1.0f - kr - kb;
+
+    // Range expansion to Y' in [0, 1] and Cb/Cr in [-0.5, 0.5]
+    const float step = float(1 << (bits - 8));
+    float yScale, yOffset, cScale, cOffset;
+    if (format.colorRange() == QVideoFrameFormat::ColorRange_Full) {
+        const float maxCode = float((1 << bits) - 1);
+        yScale = codeScale / maxCode;
+        yOffset = 0.0f;
+        cScale = codeScale / maxCode;
+        cOffset = -float(1 << (bits - 1)) / maxCode;
+    } else {
+        // Limited (studio) range, also the default for untagged video
+        yScale = codeScale / (219.0f * step);
+        yOffset = -16.0f / 219.0f;
+        cScale = codeScale / (224.0f * step);
+        cOffset = -128.0f / 224.0f;
+    }
+
+    const float rCr = 2.0f * (1.0f - kr);
+    const float gCb = 2.0f * kb * (1.0f - kb) / kg;
+    const float gCr = 2.0f * kr * (1.0f - kr) / kg;
+    const float bCb = 2.0f * (1.0f - kb);
+
+    return QMatrix4x4(
+        yScale, 0.0f, rCr * cScale, yOffset + rCr * cOffset,
+        yScale, -gCb * cScale, -gCr * cScale, yOffset - (gCb + gCr) * cOffset,
+        yScale, bCb * cScale, 0.0f, yOffset + bCb * cOffset,
+        0.0f, 0.0f, 0.0f, 1.0f);
+}
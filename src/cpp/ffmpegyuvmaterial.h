@@ -0,0 +1,92 @@
+#ifndef FFMPEGYUVMATERIAL_H
+#define FFMPEGYUVMATERIAL_H
+
+#include <QtQuick/QSGMaterial>
+#include <QtQuick/QSGTexture>
+#include <QtGui/rhi/qrhi.h>
+#include <QMatrix4x4>
+#include <QVideoFrame>
+#include <memory>
+
+/**
+ * One plane of a video frame as an RHI texture (R8/RG8, R16/RG16 for 10-bit, BGRA8 for packed RGB)
+ *
+ * The plane is uploaded straight from the mapped frame memory - no CPU-side conversion or copy.
+ * The texture is recreated only when the plane size or format changes.
+ */
+class FFmpegPlaneTexture : public QSGTexture
+{
+public:
+    FFmpegPlaneTexture() = default;
+
+    qint64 comparisonKey() const override;
+    QRhiTexture* rhiTexture() const override { return m_texture.get(); }
+    QSize textureSize() const override { return m_size; }
+    bool hasAlphaChannel() const override { return false; }
+    bool hasMipmaps() const override { return false; }
+    void commitTextureOperations(QRhi* rhi, QRhiResourceUpdateBatch* resourceUpdates) override;
+
+    // Next upload (data must stay valid until commitTextureOperations(), i.e. the frame stays mapped)
+    void setPlane(const uchar* data, int bytesPerLine, const QSize& size, QRhiTexture::Format format);
+
+private:
+    // The texture may still be used by a frame in flight - release it at the end of that frame
+    struct RhiResourceDeleter {
+        void operator()(QRhiResource* resource) const { resource->deleteLater(); }
+    };
+
+    std::unique_ptr<QRhiTexture, RhiResourceDeleter> m_texture;
+    QSize m_size;
+    QRhiTexture::Format m_format = QRhiTexture::R8;
+    const uchar* m_data = nullptr;
+    int m_bytesPerLine = 0;
+    bool m_dirty = false;
+};
+
+/**
+ * Scene graph material drawing an FFmpegVideoPlayer frame from its Y/CbCr (or Y/Cb/Cr) planes
+ *
+ * The fragment shader (resources/shaders/ffmpeg_yuv.frag) converts to RGB with a matrix built from the
+ * frame's color space (BT.601/709/2020) and range (limited/full), so the CPU never produces RGB.
+ * Works on every RHI backend (D3D11, Vulkan, OpenGL including software rasterizers such as llvmpipe).
+ *
+ * Supported: NV12, P010, YUV420P, YUV420P10 and BGRA8888 (passed through).
+ */
+class FFmpegYuvMaterial : public QSGMaterial
+{
+public:
+    enum PlaneLayout {
+        SemiPlanar = 0,  // Y + interleaved CbCr
+        Planar = 1,      // Y, Cb, Cr
+        PackedRgb = 2    // Single BGRA plane
+    };
+
+    FFmpegYuvMaterial();
+    ~FFmpegYuvMaterial() override;
+
+    QSGMaterialType* type() const override;
+    QSGMaterialShader* createShader(QSGRendererInterface::RenderMode renderMode) const override;
+    int compare(const QSGMaterial* other) const override;
+
+    // Render thread (scene graph sync): map the frame and queue its planes for upload.
+    // False if the pixel format isn't supported or the frame can't be mapped.
+    // 16-bit plane formats are checked against rhi (may be nullptr = assume supported).
+    bool setFrame(const QVideoFrame& frame, QRhi* rhi);
+
+    // YUV → RGB for normalized samples (y, cb, cr, 1) of the given format
+    static QMatrix4x4 colorMatrix(const QVideoFrameFormat& format);
+
+    // Unused planes alias the last used one (the shader always binds three samplers)
+    FFmpegPlaneTexture* plane(int index) const { return m_planes[qMin(index, m_planeCount - 1)].get(); }
+    int planeLayout() const { return m_planeLayout; }
+    const QMatrix4x4& colorMatrix() const { return m_colorMatrix; }
+
+private:
+    QVideoFrame m_frame;  // Kept mapped until the next frame - the plane uploads read from it
+    std::unique_ptr<FFmpegPlaneTexture> m_planes[3];
+    int m_planeLayout = SemiPlanar;
+    int m_planeCount = 1;
+    QMatrix4x4 m_colorMatrix;
+};
+
+#endif // FFMPEGYUVMATERIAL_H
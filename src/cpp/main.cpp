@@ -37,6 +37,10 @@
 #endif
 #include "ffmpegvideoplayer.h"
 #include "ffmpegvideorenderer.h"
+#include "ffmpegthumbnailgenerator.h"
+#ifdef HAS_FFMPEG_LIBS
+#include "ffmpegdecodebenchmark.h"
+#endif
 #include "lrclibclient.h"
 #include "lyricstranslationclient.h"
 #include "audiovisualizer.h"
@@ -108,6 +112,7 @@ namespace {
 #endif
         qmlRegisterType<FFmpegVideoPlayer>("s3rpent_media", 1, 0, "FFmpegVideoPlayer");
         qmlRegisterType<FFmpegVideoRenderer>("s3rpent_media", 1, 0, "FFmpegVideoRenderer");
+        qmlRegisterType<FFmpegThumbnailGenerator>("s3rpent_media", 1, 0, "FFmpegThumbnailGenerator");
         qmlRegisterType<LRCLibClient>("s3rpent_media", 1, 0, "LRCLibClient");
         qmlRegisterType<LyricsTranslationClient>("s3rpent_media", 1, 0, "LyricsTranslationClient");
         qmlRegisterType<AudioVisualizer>("s3rpent_media", 1, 0, "AudioVisualizer");
@@ -505,6 +510,14 @@ int main(int argc, char *argv[])
     QCoreApplication::setOrganizationDomain("s3rpent.media");
     QCoreApplication::setApplicationName("s3rpent_media");
     
+#ifdef HAS_FFMPEG_LIBS
+    // Headless decode benchmark: no window, no QML, no graphics API selection
+    if (FFmpegDecodeBenchmark::isRequested(argc, argv)) {
+        QCoreApplication benchmarkApp(argc, argv);
+        return FFmpegDecodeBenchmark::run(benchmarkApp.arguments());
+    }
+#endif
+    
     // Check settings to determine which Qt scenegraph backend to use.
     // Default behavior:
     // - Direct3D11 for normal app startup on Windows
@@ -534,10 +547,15 @@ int main(int argc, char *argv[])
         QQuickWindow::setGraphicsApi(QSGRendererInterface::OpenGL);
         qDebug() << "[Main] libmpv backend selected - forcing OpenGL backend";
     } else {
+#ifdef Q_OS_WIN
         // Explicitly select D3D11 so startup defaults to DirectX for non-mpv backends.
         qputenv("QSG_RHI_BACKEND", "d3d11");
         QQuickWindow::setGraphicsApi(QSGRendererInterface::Direct3D11);
         qDebug() << "[Main] Non-mpv backend selected - using Direct3D11 backend";
+#else
+        // Elsewhere Qt picks the platform's default RHI backend (OpenGL/Vulkan/Metal)
+        qDebug() << "[Main] Non-mpv backend selected - using the platform default RHI backend";
+#endif
     }
     
     // Set style before creating QApplication (Qt recommendation)
@@ -23,6 +23,13 @@ MPVGlWidget::MPVGlWidget(MPVVideoPlayer *player, QWidget *parent)
     setAttribute(Qt::WA_OpaquePaintEvent);
     setAttribute(Qt::WA_NoSystemBackground);
 
+    // Keep the framebuffer between paints (the default NoPartialUpdate clears it before each paintGL),
+    // so paintGL can skip rendering when mpv has no new frame
+    setUpdateBehavior(QOpenGLWidget::PartialUpdate);
+
+    // Report presented frames back to mpv (display-sync / frame timing)
+    connect(this, &QOpenGLWidget::frameSwapped, this, &MPVGlWidget::onFrameSwapped);
+
     qDebug() << "[MPVGlWidget] Constructor called";
 }
 
@@ -105,16 +112,30 @@ void MPVGlWidget::render_update(void *ctx)
     // CRITICAL: This callback is ONLY a signal - do NOT call mpv_render_context_update() here!
     // mpv_render_context_update() must ONLY be called from paintGL() before rendering
     auto *self = static_cast<MPVGlWidget*>(ctx);
-    QMetaObject::invokeMethod(self, "maybeUpdate", Qt::QueuedConnection);
+    // ✅ Coalesce bursts of updates into one queued repaint request
+    if (!self->m_updatePending.exchange(true, std::memory_order_acq_rel)) {
+        QMetaObject::invokeMethod(self, "maybeUpdate", Qt::QueuedConnection);
+    }
 }
 
 void MPVGlWidget::maybeUpdate()
 {
+    m_updatePending.store(false, std::memory_order_release);
     if (window() && !window()->isMinimized()) {
         update();
     }
 }
 
+void MPVGlWidget::onFrameSwapped()
+{
+    if (m_swapPending) {
+        m_swapPending = false;
+        makeCurrent();
+        MPVVideoPlayer::reportSwap(m_renderContext);
+        doneCurrent();
+    }
+}
+
 void MPVGlWidget::initializeGL()
 {
 #ifdef HAS_LIBMPV
@@ -191,6 +212,7 @@ void MPVGlWidget::initializeGL()
 
     // Store render context in player for cleanup
     m_player->setMpvRenderContext(m_renderContext);
+    m_forceRender = true;
 
     qDebug() << "[MPVGlWidget] mpv render context created successfully";
     
@@ -227,6 +249,18 @@ void MPVGlWidget::paintGL()
         return;
     }
 
+    // CRITICAL: Ask mpv if a frame is actually ready before rendering
+    // This must be called to acknowledge updates and check frame readiness
+    uint64_t flags = mpv_render_context_update(m_renderContext);
+
+    // ✅ Render on demand: with PartialUpdate (see constructor) the framebuffer survives between paints, so without a new mpv frame
+    // (paused, or a repaint for other reasons) the last picture is still there - don't clear or re-render it.
+    // The first paint and paints after a resize always render (mpv may need one unconditional render)
+    if (!(flags & MPV_RENDER_UPDATE_FRAME) && !m_forceRender) {
+        return;
+    }
+    m_forceRender = false;
+
     // REQUIRED: Reset GL state (Qt dirties it before paintGL)
     // mpv does not set viewport or disable scissor, so we must do it
     f->glDisable(GL_SCISSOR_TEST);
@@ -237,22 +271,6 @@ void MPVGlWidget::paintGL()
     f->glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
     f->glClear(GL_COLOR_BUFFER_BIT);
 
-    // CRITICAL: Ask mpv if a frame is actually ready before rendering
-    // This must be called to acknowledge updates and check frame readiness
-    uint64_t flags = mpv_render_context_update(m_renderContext);
-    
-    // IMPORTANT: Don't gate the first render on MPV_RENDER_UPDATE_FRAME
-    // mpv may require one unconditional render to transition into configured state
-    // After that, we can gate on the flag for efficiency
-    static bool firstRender = true;
-    if (firstRender) {
-        firstRender = false;
-        // First render: always render (mpv will no-op if nothing ready)
-    } else if (!(flags & MPV_RENDER_UPDATE_FRAME)) {
-        // Subsequent renders: only render if frame is ready
-        return;
-    }
-
     // Render mpv frame into the default framebuffer (matches mpc-qt pattern)
     mpv_opengl_fbo fbo{
         static_cast<int>(defaultFramebufferObject()),
@@ -273,6 +291,7 @@ void MPVGlWidget::paintGL()
     };
 
     mpv_render_context_render(m_renderContext, params);
+    m_swapPending = true;  // Reported to mpv on frameSwapped
 #else
     Q_UNUSED(this);
 #endif
@@ -284,7 +303,8 @@ void MPVGlWidget::resizeGL(int w, int h)
     int glW = static_cast<int>(w * ratio);
     int glH = static_cast<int>(h * ratio);
     qDebug() << "[MPVGlWidget] Resized to" << w << "x" << h << "(GL:" << glW << "x" << glH << ")";
-    // Trigger repaint with new size
+    // New framebuffer size - repaint even if mpv has no new frame
+    m_forceRender = true;
     update();
 }
 
@@ -4,6 +4,7 @@
 #include <QOpenGLWidget>
 #include <QOpenGLContext>
 #include <QOpenGLFunctions>
+#include <atomic>
 
 // Forward declarations
 struct mpv_handle;
@@ -34,10 +35,14 @@ private:
 
 private slots:
     void maybeUpdate();
+    void onFrameSwapped();
 
 private:
     MPVVideoPlayer *m_player;
     mpv_render_context *m_renderContext;
+    std::atomic<bool> m_updatePending{false};  // A maybeUpdate() call is queued
+    bool m_forceRender = true;   // Framebuffer (re)created - render even without MPV_RENDER_UPDATE_FRAME
+    bool m_swapPending = false;  // A frame was rendered since the last reported swap
     // Note: m_glWidth/m_glHeight removed - size calculated dynamically in paintGL()
 };
 
@@ -35,30 +35,19 @@ MPVVideoPlayer::MPVVideoPlayer(QObject *parent)
     , m_hasAudio(true)
     , m_mpv(nullptr)
     , m_mpvRenderContext(nullptr)
-    , m_positionTimer(nullptr)
-    , m_eventTimer(nullptr)
 {
     // Load saved volume from settings
     QSettings settings;
     m_volume = settings.value("video/volume", 1.0).toReal();
     qDebug() << "[MPVVideoPlayer] Loaded saved volume:" << m_volume;
     
-    // CRITICAL: Create timers BEFORE initializeMPV() (which uses m_eventTimer)
-    m_positionTimer = new QTimer(this);
-    m_positionTimer->setInterval(100); // Update every 100ms
-    connect(m_positionTimer, &QTimer::timeout, this, &MPVVideoPlayer::updatePosition);
-    
-    m_eventTimer = new QTimer(this);
-    m_eventTimer->setInterval(10); // Process events every 10ms
-    connect(m_eventTimer, &QTimer::timeout, this, &MPVVideoPlayer::processEvents);
-    
     // Check if libmpv is available
     if (!s_mpvChecked) {
         s_mpvAvailable = isAvailable();
         s_mpvChecked = true;
     }
     
-    // Now initialize MPV (timers are ready)
+    // Now initialize MPV
     if (s_mpvAvailable) {
         initializeMPV();
     } else {
@@ -110,20 +99,24 @@ void MPVVideoPlayer::initializeMPV()
     
     qDebug() << "[MPVVideoPlayer] mpv_initialize() succeeded";
     
-    // Set up event handling
-    mpv_set_wakeup_callback((mpv_handle*)m_mpv, [](void *ctx) {
+    // Event-driven: mpv pushes property changes (no polling with mpv_get_property)
+    mpv_handle *mpv = (mpv_handle*)m_mpv;
+    mpv_observe_property(mpv, ObservedTimePos, "time-pos", MPV_FORMAT_DOUBLE);
+    mpv_observe_property(mpv, ObservedPause, "pause", MPV_FORMAT_FLAG);
+    mpv_observe_property(mpv, ObservedDuration, "duration", MPV_FORMAT_DOUBLE);
+    mpv_observe_property(mpv, ObservedSeekable, "seekable", MPV_FORMAT_FLAG);
+    mpv_observe_property(mpv, ObservedAudioId, "aid", MPV_FORMAT_INT64);
+    
+    // Set up event handling: the wakeup callback (any mpv thread) queues ONE drain on the GUI thread
+    // at a time - nothing runs while mpv has nothing to report
+    mpv_set_wakeup_callback(mpv, [](void *ctx) {
         MPVVideoPlayer *player = static_cast<MPVVideoPlayer*>(ctx);
-        QMetaObject::invokeMethod(player, "processEvents", Qt::QueuedConnection);
+        if (!player->m_eventsPending.exchange(true, std::memory_order_acq_rel)) {
+            QMetaObject::invokeMethod(player, "processEvents", Qt::QueuedConnection);
+        }
     }, this);
     
-    qDebug() << "[MPVVideoPlayer] Wakeup callback set";
-    
-    if (!m_eventTimer) {
-        qWarning() << "[MPVVideoPlayer] Event timer is null!";
-    } else {
-        m_eventTimer->start();
-        qDebug() << "[MPVVideoPlayer] Event timer started";
-    }
+    qDebug() << "[MPVVideoPlayer] Wakeup callback set, properties observed";
     
     qDebug() << "[MPVVideoPlayer] ✓ Initialized successfully with HDR support";
 #endif
@@ -165,6 +158,9 @@ void MPVVideoPlayer::shutdownMPV()
     }
     
     if (m_mpv) {
+        // No more wakeups into a player being destroyed
+        mpv_set_wakeup_callback((mpv_handle*)m_mpv, nullptr, nullptr);
+        
         // Use mpv_destroy instead of mpv_terminate_destroy for compatibility
         // mpv_terminate_destroy may not be available in all libmpv builds
         mpv_destroy((mpv_handle*)m_mpv);
@@ -226,13 +222,7 @@ void MPVVideoPlayer::loadSourceAfterRenderContext()
         } else {
             qDebug() << "[MPVVideoPlayer] Loading file (render context ready):" << localPath;
         }
-        
-        // Wait a bit for file to load, then update properties
-        QTimer::singleShot(500, this, [this]() {
-            updateDuration();
-            updateSeekable();
-            updateHasAudio();
-        });
+        // Duration/seekable/audio arrive as property changes once the file is loaded
     } else {
         qWarning() << "[MPVVideoPlayer] File does not exist:" << localPath;
     }
@@ -251,10 +241,6 @@ void MPVVideoPlayer::play()
     mpv_command(mpv, cmd);
     m_playbackState = 1; // Playing
     emit playbackStateChanged();
-    
-    if (!m_positionTimer->isActive()) {
-        m_positionTimer->start();
-    }
 #endif
 }
 
@@ -282,8 +268,6 @@ void MPVVideoPlayer::stop()
     m_playbackState = 0; // Stopped
     emit playbackStateChanged();
     
-    m_positionTimer->stop();
-    m_eventTimer->stop();
     m_position = 0;
     emit positionChanged();
 #endif
@@ -336,25 +320,10 @@ void MPVVideoPlayer::setVolume(qreal volume)
     emit volumeChanged();
 }
 
-void MPVVideoPlayer::updatePosition()
-{
-    if (!m_mpv) return;
-    
-#ifdef HAS_LIBMPV
-    mpv_handle *mpv = (mpv_handle*)m_mpv;
-    double timePos = 0.0;
-    if (mpv_get_property(mpv, "time-pos", MPV_FORMAT_DOUBLE, &timePos) >= 0) {
-        int newPosition = static_cast<int>(timePos * 1000.0); // Convert seconds to ms
-        if (newPosition != m_position) {
-            m_position = newPosition;
-            emit positionChanged();
-        }
-    }
-#endif
-}
-
 void MPVVideoPlayer::processEvents()
 {
+    // Clear pending BEFORE draining so a wakeup arriving meanwhile always queues another drain
+    m_eventsPending.store(false, std::memory_order_release);
     if (!m_mpv) return;
     
 #ifdef HAS_LIBMPV
@@ -393,19 +362,7 @@ void MPVVideoPlayer::setupRenderContextCallback()
     if (mpvModule) {
         set_update_callback_fn setCallback = (set_update_callback_fn)GetProcAddress(mpvModule, "mpv_render_context_set_update_callback");
         if (setCallback) {
-            setCallback(
-                ctx,
-                [](void *userdata) {
-                    MPVVideoPlayer *player = static_cast<MPVVideoPlayer *>(userdata);
-                    if (player) {
-                        // Emit frameReady signal on GUI thread
-                        QMetaObject::invokeMethod(player, [player]() {
-                            emit player->frameReady();
-                        }, Qt::QueuedConnection);
-                    }
-                },
-                this
-            );
+            setCallback(ctx, &MPVVideoPlayer::onRenderUpdate, this);
             qDebug() << "[MPVVideoPlayer] Render context callback registered via dynamic loading - will emit frameReady()";
         } else {
             qWarning() << "[MPVVideoPlayer] Failed to get mpv_render_context_set_update_callback function address";
@@ -415,24 +372,57 @@ void MPVVideoPlayer::setupRenderContextCallback()
     }
 #else
     // On non-Windows platforms, the function is exported normally
-    mpv_render_context_set_update_callback(
-        ctx,
-        [](void *userdata) {
-            MPVVideoPlayer *player = static_cast<MPVVideoPlayer *>(userdata);
-            if (player) {
-                // Emit frameReady signal on GUI thread
-                QMetaObject::invokeMethod(player, [player]() {
-                    emit player->frameReady();
-                }, Qt::QueuedConnection);
-            }
-        },
-        this
-    );
+    mpv_render_context_set_update_callback(ctx, &MPVVideoPlayer::onRenderUpdate, this);
     qDebug() << "[MPVVideoPlayer] Render context callback registered - will emit frameReady()";
 #endif
 #endif
 }
 
+void MPVVideoPlayer::onRenderUpdate(void *ctx)
+{
+    MPVVideoPlayer *player = static_cast<MPVVideoPlayer *>(ctx);
+    if (!player) {
+        return;
+    }
+    // ✅ Coalesce: mpv may fire several updates before the GUI thread runs - one frameReady() is enough
+    // (the renderer asks mpv_render_context_update() whether there really is a new frame)
+    if (player->m_framePending.exchange(true, std::memory_order_acq_rel)) {
+        return;
+    }
+    QMetaObject::invokeMethod(player, [player]() {
+        player->m_framePending.store(false, std::memory_order_release);
+        emit player->frameReady();
+    }, Qt::QueuedConnection);
+}
+
+void MPVVideoPlayer::reportSwap(void *renderContext)
+{
+#ifdef HAS_LIBMPV
+    if (!renderContext) {
+        return;
+    }
+#ifdef Q_OS_WIN
+    // Resolved like mpv_render_context_set_update_callback (not every libmpv-2.dll build exports it)
+    typedef void (*report_swap_fn)(mpv_render_context *ctx);
+    static report_swap_fn reportSwapFn = []() -> report_swap_fn {
+        HMODULE mpvModule = GetModuleHandleA("libmpv-2.dll");
+        report_swap_fn fn = mpvModule ? (report_swap_fn)GetProcAddress(mpvModule, "mpv_render_context_report_swap") : nullptr;
+        if (!fn) {
+            qWarning() << "[MPVVideoPlayer] mpv_render_context_report_swap not available - display-sync timing disabled";
+        }
+        return fn;
+    }();
+    if (reportSwapFn) {
+        reportSwapFn((mpv_render_context*)renderContext);
+    }
+#else
+    mpv_render_context_report_swap((mpv_render_context*)renderContext);
+#endif
+#else
+    Q_UNUSED(renderContext);
+#endif
+}
+
 void MPVVideoPlayer::handleMPVEvent(void *event)
 {
 #ifdef HAS_LIBMPV
@@ -462,9 +452,7 @@ void MPVVideoPlayer::handleMPVEvent(void *event)
                 }
             }
             
-            updateDuration();
-            updateSeekable();
-            updateHasAudio();
+            m_fileLoaded = true;
             // Ensure playback starts automatically
             {
                 mpv_handle *mpv = (mpv_handle*)m_mpv;
@@ -475,101 +463,89 @@ void MPVVideoPlayer::handleMPVEvent(void *event)
                 qDebug() << "[MPVVideoPlayer] Auto-started playback after file load";
             }
             break;
+        case MPV_EVENT_START_FILE:
+            m_fileLoaded = false;
+            break;
         case MPV_EVENT_END_FILE:
             qDebug() << "[MPVVideoPlayer] Playback ended";
+            m_fileLoaded = false;
             m_playbackState = 0; // Stopped
             emit playbackStateChanged();
             break;
         case MPV_EVENT_PLAYBACK_RESTART:
             qDebug() << "[MPVVideoPlayer] Playback restarted";
             break;
-        case MPV_EVENT_PROPERTY_CHANGE: {
-            mpv_event_property *prop = (mpv_event_property *)ev->data;
-            if (strcmp(prop->name, "pause") == 0) {
-                updatePlaybackState();
-            }
+        case MPV_EVENT_PROPERTY_CHANGE:
+            handlePropertyChange(ev->data, ev->reply_userdata);
             break;
-        }
         default:
             break;
     }
 #endif
 }
 
-void MPVVideoPlayer::updatePlaybackState()
+void MPVVideoPlayer::handlePropertyChange(void *property, quint64 id)
 {
-    if (!m_mpv) return;
-    
 #ifdef HAS_LIBMPV
-    mpv_handle *mpv = (mpv_handle*)m_mpv;
-    int flag = 0;
-    if (mpv_get_property(mpv, "pause", MPV_FORMAT_FLAG, &flag) >= 0) {
-        int newState = flag ? 2 : 1; // 2=Paused, 1=Playing
-        if (newState != m_playbackState) {
-            m_playbackState = newState;
-            emit playbackStateChanged();
-            
-            if (m_playbackState == 1) {
-                if (!m_positionTimer->isActive()) {
-                    m_positionTimer->start();
-                }
-            } else {
-                m_positionTimer->stop();
+    const mpv_event_property *prop = (const mpv_event_property *)property;
+    // MPV_FORMAT_NONE: property unavailable (no file, or "no"/"auto" for aid)
+    const bool available = prop->format != MPV_FORMAT_NONE && prop->data;
+    
+    switch (id) {
+        case ObservedTimePos: {
+            const int newPosition = available ? static_cast<int>(*(double *)prop->data * 1000.0) : 0; // Seconds to ms
+            if (newPosition != m_position) {
+                m_position = newPosition;
+                emit positionChanged();
+            }
+            break;
+        }
+        case ObservedPause: {
+            // Only while a file is loaded - stop() owns the stopped state
+            if (!available || !m_fileLoaded) {
+                break;
+            }
+            const int newState = *(int *)prop->data ? 2 : 1; // 2=Paused, 1=Playing
+            if (newState != m_playbackState) {
+                m_playbackState = newState;
+                emit playbackStateChanged();
             }
+            break;
         }
-    }
-#endif
-}
-
-void MPVVideoPlayer::updateDuration()
-{
-    if (!m_mpv) return;
-    
-#ifdef HAS_LIBMPV
-    mpv_handle *mpv = (mpv_handle*)m_mpv;
-    double duration = 0.0;
-    if (mpv_get_property(mpv, "duration", MPV_FORMAT_DOUBLE, &duration) >= 0) {
-        int newDuration = static_cast<int>(duration * 1000.0); // Convert seconds to ms
-        if (newDuration != m_duration) {
-            m_duration = newDuration;
-            emit durationChanged();
+        case ObservedDuration: {
+            const int newDuration = available ? static_cast<int>(*(double *)prop->data * 1000.0) : 0; // Seconds to ms
+            if (newDuration != m_duration) {
+                m_duration = newDuration;
+                emit durationChanged();
+            }
+            break;
         }
-    }
-#endif
-}
-
-void MPVVideoPlayer::updateSeekable()
-{
-    if (!m_mpv) return;
-    
-#ifdef HAS_LIBMPV
-    mpv_handle *mpv = (mpv_handle*)m_mpv;
-    int flag = 0;
-    if (mpv_get_property(mpv, "seekable", MPV_FORMAT_FLAG, &flag) >= 0) {
-        bool newSeekable = (flag != 0);
-        if (newSeekable != m_seekable) {
-            m_seekable = newSeekable;
-            emit seekableChanged();
+        case ObservedSeekable: {
+            const bool newSeekable = available && *(int *)prop->data != 0;
+            if (newSeekable != m_seekable) {
+                m_seekable = newSeekable;
+                emit seekableChanged();
+            }
+            break;
         }
-    }
-#endif
-}
-
-void MPVVideoPlayer::updateHasAudio()
-{
-    if (!m_mpv) return;
-    
-#ifdef HAS_LIBMPV
-    mpv_handle *mpv = (mpv_handle*)m_mpv;
-    int64_t audioId = 0;
-    // Check if audio track exists
-    if (mpv_get_property(mpv, "audio-id", MPV_FORMAT_INT64, &audioId) >= 0) {
-        bool hasAudioTrack = (audioId != 0);
-        if (hasAudioTrack != m_hasAudio) {
-            m_hasAudio = hasAudioTrack;
-            emit hasAudioChanged();
+        case ObservedAudioId: {
+            // Before a file is loaded aid reads "auto" - keep the last value until tracks are known
+            if (!available && !m_fileLoaded) {
+                break;
+            }
+            const bool hasAudioTrack = available && *(int64_t *)prop->data != 0;
+            if (hasAudioTrack != m_hasAudio) {
+                m_hasAudio = hasAudioTrack;
+                emit hasAudioChanged();
+            }
+            break;
         }
+        default:
+            break;
     }
+#else
+    Q_UNUSED(property);
+    Q_UNUSED(id);
 #endif
 }
 
@@ -616,7 +592,8 @@ void MPVVideoItem::setPlayer(MPVVideoPlayer *player)
 
 void MPVVideoItem::onFrameReady()
 {
-    // Request render update when mpv signals a new frame
+    // Request render update when mpv signals a new frame (the only source of redraws besides resizes,
+    // so a paused video costs no scene graph frames)
     // Note: update() is lightweight - it just marks the item as dirty for next frame
     // Qt Quick will call render() on the render thread when ready (throttled by vsync)
     update();
@@ -637,6 +614,7 @@ public:
     
     ~MPVVideoItemRenderer()
     {
+        QObject::disconnect(m_swapConnection);
         if (m_mpvCtx) {
             mpv_render_context_free(m_mpvCtx);
             m_mpvCtx = nullptr;
@@ -724,6 +702,9 @@ public:
         gl->glClear(GL_COLOR_BUFFER_BIT);
         fbo->release();
         
+        // The new FBO holds no picture yet - the next render() must draw even without a new mpv frame
+        m_forceRender = true;
+        
         return fbo;
     }
     
@@ -739,7 +720,22 @@ public:
         m_player = videoItem->player();
         
         // Store window reference for DPR access (Qt 6 requires QScreen for DPR)
-        m_window = videoItem->window();
+        QQuickWindow *window = videoItem->window();
+        if (window != m_window) {
+            m_window = window;
+            
+            // Tell mpv when the frame it rendered actually reached the screen (display-sync / frame timing).
+            // frameSwapped is emitted on the render thread - DirectConnection keeps it there.
+            QObject::disconnect(m_swapConnection);
+            if (m_window) {
+                m_swapConnection = QObject::connect(m_window, &QQuickWindow::frameSwapped, m_window, [this]() {
+                    if (m_swapPending) {
+                        m_swapPending = false;
+                        MPVVideoPlayer::reportSwap(m_mpvCtx);
+                    }
+                }, Qt::DirectConnection);
+            }
+        }
     }
     
     void render() override
@@ -759,27 +755,21 @@ public:
         // This MUST be called in render() method, NOT in the callback
         uint64_t flags = mpv_render_context_update(m_mpvCtx);
         
-        // CRITICAL FIX: ALWAYS clear FBO to black FIRST (before any early returns)
-        // This prevents white artifacts during resize/maximize when FBO is recreated
+        // ✅ Render on demand: without a new mpv frame the FBO still holds the last one (e.g. paused) -
+        // leave it untouched instead of clearing and re-rendering the same picture.
+        // A freshly created FBO is always drawn once (mpv may also need one unconditional render).
+        if (!(flags & MPV_RENDER_UPDATE_FRAME) && !m_forceRender) {
+            return;
+        }
+        m_forceRender = false;
+        
+        // Clear FBO to black before mpv renders (prevents white artifacts during resize/maximize)
         // mpv does NOT clear uncovered regions, so uninitialized FBO memory shows as white
         // Qt Quick already has the FBO bound in render(), so we don't need to bind/release
-        // NOTE: Do NOT set glViewport or glDisable(GL_SCISSOR_TEST) - Qt Quick manages these
-        // for correct DPR handling. Overriding them causes corner cut-off when maximized.
         QOpenGLFunctions *gl = QOpenGLContext::currentContext()->functions();
         gl->glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
         gl->glClear(GL_COLOR_BUFFER_BIT);
         
-        // Don't gate first render on MPV_RENDER_UPDATE_FRAME (mpv may need one unconditional render)
-        static bool firstRender = true;
-        if (firstRender) {
-            firstRender = false;
-            // First render: always render (mpv will no-op if nothing ready)
-        } else if (!(flags & MPV_RENDER_UPDATE_FRAME)) {
-            // Subsequent renders: only render if frame is ready
-            // FBO was cleared above, so black screen is shown (correct behavior)
-            return;
-        }
-        
         // CRITICAL: Set viewport and disable scissor BEFORE mpv renders
         // Qt Quick's scene graph may leave viewport/scissor set to the item's logical/old rect.
         // mpv does not set viewport/scissor - it renders into whatever GL state exists.
@@ -804,6 +794,7 @@ public:
         
         // RULE 3: Render mpv frame into FBO (ONLY place mpv_render_context_render is called)
         mpv_render_context_render(m_mpvCtx, params);
+        m_swapPending = true;  // Reported to mpv on the window's next frameSwapped
         
         // CRITICAL: Reset Qt Quick's OpenGL state after rendering
         // Qt Quick does not provide a clean OpenGL state and expects you to restore it.
@@ -818,6 +809,9 @@ private:
     mpv_render_context *m_mpvCtx;
     MPVVideoPlayer *m_player;
     QQuickWindow *m_window;  // Store window reference for DPR access (Qt 6 requires QScreen)
+    QMetaObject::Connection m_swapConnection;  // m_window's frameSwapped → mpv_render_context_report_swap
+    bool m_forceRender = true;   // FBO (re)created - render even without MPV_RENDER_UPDATE_FRAME
+    bool m_swapPending = false;  // A frame was rendered since the last reported swap
 };
 
 QQuickFramebufferObject::Renderer *MPVVideoItem::createRenderer() const
@@ -4,12 +4,12 @@
 #include <QObject>
 #include <QUrl>
 #include <QString>
-#include <QTimer>
 #include <QQuickFramebufferObject>
 #include <QQuickWindow>
 #include <QMutex>
 #include <QWaitCondition>
 #include <QThread>
+#include <atomic>
 
 // Forward declaration for mpv handle
 struct mpv_handle;
@@ -55,6 +55,9 @@ public:
     // Public setters for renderer (avoids accessing private members)
     void setMpvRenderContext(void *ctx) { m_mpvRenderContext = ctx; }
     void ensureRenderCallbackRegistered() { setupRenderContextCallback(); }
+    
+    // Render thread, after the frame rendered with renderContext was presented (feeds mpv's display-sync timing)
+    static void reportSwap(void *renderContext);
 
     // Check if libmpv is available
     static bool isAvailable();
@@ -71,21 +74,27 @@ signals:
     void frameReady(); // Signal when a new frame is ready for rendering
 
 private slots:
-    void updatePosition();
-    void processEvents();
+    void processEvents();  // Drains mpv's event queue (queued by the wakeup callback)
 
 private:
     void initializeMPV();
     void shutdownMPV();
     void setupMPVOptions();
     void handleMPVEvent(void *event);
-    void updatePlaybackState();
-    void updateDuration();
-    void updateSeekable();
-    void updateHasAudio();
+    void handlePropertyChange(void *property, quint64 id);  // mpv_event_property*, ObservedProperty
+    
+    // reply_userdata of the observed properties (mpv_observe_property)
+    enum ObservedProperty : quint64 {
+        ObservedTimePos = 1,
+        ObservedPause,
+        ObservedDuration,
+        ObservedSeekable,
+        ObservedAudioId
+    };
     
     // Setup render context callback (called by MPVVideoItem after context creation)
     void setupRenderContextCallback();
+    static void onRenderUpdate(void *ctx);  // mpv render update callback (any mpv thread)
 
     QUrl m_source;
     int m_position;
@@ -97,9 +106,10 @@ private:
     
     void* m_mpv; // mpv_handle* (void* to avoid including mpv headers in header)
     void* m_mpvRenderContext; // mpv_render_context* (void* to avoid including mpv headers in header)
-    QTimer *m_positionTimer;
-    QTimer *m_eventTimer;
     QMutex m_mpvMutex;
+    std::atomic<bool> m_eventsPending{false};  // A processEvents() call is queued
+    std::atomic<bool> m_framePending{false};   // A frameReady() emission is queued
+    bool m_fileLoaded = false;                 // Between MPV_EVENT_FILE_LOADED and the end of the file
     
     // Allow renderer to set render context
     friend class MPVVideoRenderer;
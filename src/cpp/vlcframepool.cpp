@@ -0,0 +1,224 @@
+#include "vlcframepool.h"
+#include <QAbstractVideoBuffer>
+#include <QDebug>
+#include <QMutexLocker>
+#include <new>
+#include <utility>
+
+namespace {
+    constexpr size_t BufferAlignment = 64;
+
+    int alignUp(int value, int alignment)
+    {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+}
+
+struct VLCFramePool::Buffer {
+    explicit Buffer(size_t bytes)
+        : data(static_cast<uchar*>(::operator new[](bytes, std::align_val_t(BufferAlignment))))
+    {
+    }
+    ~Buffer()
+    {
+        ::operator delete[](data, std::align_val_t(BufferAlignment));
+    }
+
+    uchar* data = nullptr;
+    std::atomic<int> refs{0};
+};
+
+namespace {
+
+// QVideoFrame backing store over a pooled buffer (returned to the pool when Qt drops the frame)
+class VLCVideoBuffer : public QAbstractVideoBuffer
+{
+public:
+    VLCVideoBuffer(std::shared_ptr<VLCFramePool> pool, VLCFramePool::Buffer* buffer, uchar* const planes[3],
+                   const QVideoFrameFormat& format)
+        : m_pool(std::move(pool))
+        , m_buffer(buffer)
+        , m_format(format)
+    {
+        for (int i = 0; i < 3; ++i) {
+            m_planes[i] = planes[i];
+        }
+    }
+
+    ~VLCVideoBuffer() override
+    {
+        m_pool->release(m_buffer);
+    }
+
+    MapData map(QVideoFrame::MapMode mode) override
+    {
+        MapData data;
+        // VLC may still read the picture (reference frame) - read-only access only
+        if (mode & QVideoFrame::WriteOnly) {
+            return data;
+        }
+        const VLCFramePool::Layout& layout = m_pool->layout();
+        data.planeCount = layout.planeCount;
+        for (int i = 0; i < layout.planeCount; ++i) {
+            data.data[i] = m_planes[i];
+            data.bytesPerLine[i] = layout.pitches[i];
+            data.dataSize[i] = layout.pitches[i] * layout.lines[i];
+        }
+        return data;
+    }
+
+    QVideoFrameFormat format() const override { return m_format; }
+
+private:
+    std::shared_ptr<VLCFramePool> m_pool;
+    VLCFramePool::Buffer* m_buffer = nullptr;
+    uchar* m_planes[3] = {};
+    QVideoFrameFormat m_format;
+};
+
+} // namespace
+
+VLCFramePool::Layout VLCFramePool::layoutFor(QVideoFrameFormat::PixelFormat pixelFormat, const QSize& size)
+{
+    Layout layout;
+    layout.pixelFormat = pixelFormat;
+    layout.size = size;
+
+    // Decoders write whole macroblock rows and SIMD-wide lines
+    const int lumaLines = alignUp(size.height(), 16);
+    layout.pitches[0] = alignUp(size.width(), 64);
+    layout.lines[0] = lumaLines;
+
+    if (pixelFormat == QVideoFrameFormat::Format_NV12) {
+        layout.planeCount = 2;
+        layout.pitches[1] = layout.pitches[0];  // Interleaved CbCr: full width in bytes
+        layout.lines[1] = lumaLines / 2;
+    } else {
+        layout.pixelFormat = QVideoFrameFormat::Format_YUV420P;
+        layout.planeCount = 3;
+        layout.pitches[1] = layout.pitches[2] = alignUp((size.width() + 1) / 2, 32);
+        layout.lines[1] = layout.lines[2] = lumaLines / 2;
+    }
+    return layout;
+}
+
+VLCFramePool::VLCFramePool(const Layout& layout, int maxBuffers)
+    : m_layout(layout)
+    , m_maxBuffers(qMax(1, maxBuffers))
+{
+    size_t offset = 0;
+    for (int i = 0; i < m_layout.planeCount; ++i) {
+        m_planeOffsets[i] = offset;
+        offset += size_t(m_layout.pitches[i]) * size_t(m_layout.lines[i]);
+        offset = (offset + BufferAlignment - 1) / BufferAlignment * BufferAlignment;
+    }
+    m_bufferBytes = offset;
+    m_scratch.reset(allocateBuffer());
+}
+
+VLCFramePool::~VLCFramePool()
+{
+    const Stats current = stats();
+    if (current.droppedPictures > 0) {
+        qDebug() << "[VLC] Frame pool:" << current.buffers << "buffers," << current.droppedPictures
+                 << "pictures dropped (all buffers held by Qt)";
+    }
+}
+
+VLCFramePool::Buffer* VLCFramePool::allocateBuffer() const
+{
+    return new Buffer(m_bufferBytes);
+}
+
+VLCFramePool::Buffer* VLCFramePool::acquire(void** planes)
+{
+    Buffer* buffer = nullptr;
+    {
+        QMutexLocker locker(&m_mutex);
+        if (!m_free.empty()) {
+            buffer = m_free.back();
+            m_free.pop_back();
+        } else if (int(m_buffers.size()) < m_maxBuffers) {
+            m_buffers.emplace_back(allocateBuffer());
+            buffer = m_buffers.back().get();
+        }
+    }
+
+    if (buffer) {
+        buffer->refs.store(1, std::memory_order_release);
+    } else {
+        // Every buffer is on screen or queued - decode into the scratch buffer and drop the picture
+        buffer = m_scratch.get();
+        m_droppedPictures.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    for (int i = 0; i < m_layout.planeCount; ++i) {
+        planes[i] = buffer->data + m_planeOffsets[i];
+    }
+    return buffer;
+}
+
+void VLCFramePool::release(Buffer* buffer)
+{
+    if (!buffer || buffer == m_scratch.get()) {
+        return;
+    }
+    if (buffer->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        QMutexLocker locker(&m_mutex);
+        m_free.push_back(buffer);
+    }
+}
+
+void VLCFramePool::unlock(Buffer* buffer)
+{
+    if (!buffer || buffer == m_scratch.get()) {
+        return;
+    }
+    // Pictures are displayed in unlock order - one still waiting here was dropped by VLC
+    Buffer* undisplayed = nullptr;
+    {
+        QMutexLocker locker(&m_mutex);
+        undisplayed = std::exchange(m_awaitingDisplay, buffer);
+    }
+    if (undisplayed && undisplayed != buffer) {
+        release(undisplayed);
+    }
+}
+
+QVideoFrame VLCFramePool::wrap(Buffer* buffer, const QVideoFrameFormat& format)
+{
+    if (!buffer || buffer == m_scratch.get()) {
+        return QVideoFrame();
+    }
+
+    uchar* planes[3] = {};
+    for (int i = 0; i < m_layout.planeCount; ++i) {
+        planes[i] = buffer->data + m_planeOffsets[i];
+    }
+    // Qt's reference is taken while VLC's is still held, then VLC's is dropped
+    buffer->refs.fetch_add(1, std::memory_order_acq_rel);
+    QVideoFrame frame(std::make_unique<VLCVideoBuffer>(shared_from_this(), buffer, planes, format));
+
+    bool vlcReference = false;
+    {
+        QMutexLocker locker(&m_mutex);
+        if (m_awaitingDisplay == buffer) {
+            m_awaitingDisplay = nullptr;
+            vlcReference = true;
+        }
+    }
+    if (vlcReference) {
+        release(buffer);
+    }
+    return frame;
+}
+
+VLCFramePool::Stats VLCFramePool::stats() const
+{
+    QMutexLocker locker(&m_mutex);
+    Stats current;
+    current.buffers = int(m_buffers.size());
+    current.free = int(m_free.size());
+    current.droppedPictures = m_droppedPictures.load(std::memory_order_relaxed);
+    return current;
+}
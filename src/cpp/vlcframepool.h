@@ -0,0 +1,86 @@
+#ifndef VLCFRAMEPOOL_H
+#define VLCFRAMEPOOL_H
+
+#include <QMutex>
+#include <QSize>
+#include <QVideoFrame>
+#include <QVideoFrameFormat>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+/**
+ * Picture buffers for VLCVideoPlayer's vmem output
+ *
+ * VLC decodes straight into pooled, 64-byte aligned I420 (YUV420P) or NV12 buffers which are
+ * handed to Qt as QVideoFrames without a copy; the YUV→RGB conversion happens on the GPU.
+ * A buffer is reused once both VLC and Qt (last QVideoFrame copy) have released it. VLC unlocks
+ * a picture before displaying it, so VLC's reference is kept until display() wrapped the buffer
+ * (or the next picture is unlocked without it being displayed) - it never reaches zero in between.
+ * When every buffer is in use and the pool can't grow, acquire() hands out a scratch buffer
+ * whose picture is dropped, so VLC's decoder never waits for the GUI/render thread.
+ *
+ * Thread-safe; the pool outlives the player while Qt still holds frames.
+ */
+class VLCFramePool : public std::enable_shared_from_this<VLCFramePool>
+{
+public:
+    static constexpr int DefaultMaxBuffers = 12;
+
+    // Plane geometry requested from VLC (pitches/lines are padded for its decoders)
+    struct Layout {
+        QVideoFrameFormat::PixelFormat pixelFormat = QVideoFrameFormat::Format_Invalid;
+        QSize size;
+        int planeCount = 0;
+        int pitches[3] = {};
+        int lines[3] = {};
+    };
+
+    struct Stats {
+        int buffers = 0;             // Allocated (excluding the scratch buffer)
+        int free = 0;
+        quint64 droppedPictures = 0; // Pictures decoded into the scratch buffer
+    };
+
+    struct Buffer;
+
+    // Format_YUV420P or Format_NV12
+    static Layout layoutFor(QVideoFrameFormat::PixelFormat pixelFormat, const QSize& size);
+
+    VLCFramePool(const Layout& layout, int maxBuffers = DefaultMaxBuffers);
+    ~VLCFramePool();
+
+    VLCFramePool(const VLCFramePool&) = delete;
+    VLCFramePool& operator=(const VLCFramePool&) = delete;
+
+    const Layout& layout() const { return m_layout; }
+
+    // VLC lock callback: a buffer referenced once for VLC, planes filled in (never nullptr)
+    Buffer* acquire(void** planes);
+    // VLC unlock callback: decoding done, VLC's reference is handed to the coming display()
+    void unlock(Buffer* buffer);
+    // Drop one reference (Qt releasing a frame, undisplayed pictures)
+    void release(Buffer* buffer);
+    // VLC display callback: the buffer as a zero-copy QVideoFrame (invalid for the scratch buffer),
+    // then VLC's reference is dropped
+    QVideoFrame wrap(Buffer* buffer, const QVideoFrameFormat& format);
+
+    Stats stats() const;
+
+private:
+    Buffer* allocateBuffer() const;
+
+    Layout m_layout;
+    size_t m_planeOffsets[3] = {};
+    size_t m_bufferBytes = 0;
+    int m_maxBuffers = DefaultMaxBuffers;
+
+    mutable QMutex m_mutex;  // Free list and m_awaitingDisplay only (held for a push/pop)
+    std::vector<std::unique_ptr<Buffer>> m_buffers;
+    std::vector<Buffer*> m_free;
+    Buffer* m_awaitingDisplay = nullptr;  // Unlocked, still holds VLC's reference until display()
+    std::unique_ptr<Buffer> m_scratch;
+    std::atomic<quint64> m_droppedPictures{0};
+};
+
+#endif // VLCFRAMEPOOL_H
@@ -19,11 +19,8 @@ VLCVideoPlayer::VLCVideoPlayer(QObject* parent)
 VLCVideoPlayer::~VLCVideoPlayer()
 {
     cleanupVideoCallbacks();
-    if (m_buffer) {
-        delete[] m_buffer;
-        m_buffer = nullptr;
-    }
-    cleanupVLC();
+    cleanupVLC();  // Stops VLC - frames still held by Qt keep their pool alive
+    m_pool.reset();
 }
 
 void VLCVideoPlayer::initVLC()
@@ -114,30 +111,35 @@ unsigned VLCVideoPlayer::videoFormatCallback(void** opaque, char* chroma, unsign
 {
     auto* self = static_cast<VLCVideoPlayer*>(*opaque);
     
-    // Set chroma format to RV32 (BGRA)
-    strcpy(chroma, "RV32");
+    // Keep the decoder's YUV: NV12 stays NV12, everything else becomes I420 (J420 = full-range I420).
+    // Qt converts to RGB on the GPU - no CPU conversion inside VLC.
+    const bool nv12 = std::memcmp(chroma, "NV12", 4) == 0;
+    const bool fullRange = std::memcmp(chroma, "J420", 4) == 0;
+    std::memcpy(chroma, nv12 ? "NV12" : (fullRange ? "J420" : "I420"), 4);
     
     // Store dimensions
     unsigned w = *width;
     unsigned h = *height;
     
     // CRITICAL: Set pitches and lines synchronously (VLC needs these immediately)
-    pitches[0] = w * 4;  // 4 bytes per pixel (RGBA32)
-    lines[0] = h;
-    
-    // Allocate buffer immediately (this callback is called from VLC thread)
-    // We need the buffer ready before lock() is called
-    {
-        QMutexLocker locker(&self->m_mutex);
-        self->m_width = static_cast<int>(w);
-        self->m_height = static_cast<int>(h);
-        
-        if (self->m_buffer) {
-            delete[] self->m_buffer;
-        }
-        self->m_buffer = new uchar[self->m_width * self->m_height * 4];
+    const VLCFramePool::Layout layout = VLCFramePool::layoutFor(
+        nv12 ? QVideoFrameFormat::Format_NV12 : QVideoFrameFormat::Format_YUV420P, QSize(int(w), int(h)));
+    for (int i = 0; i < layout.planeCount; ++i) {
+        pitches[i] = unsigned(layout.pitches[i]);
+        lines[i] = unsigned(layout.lines[i]);
     }
     
+    // libvlc 3 doesn't report the color space - SD is BT.601, everything larger BT.709
+    QVideoFrameFormat format(layout.size, layout.pixelFormat);
+    format.setColorSpace(h > 576 ? QVideoFrameFormat::ColorSpace_BT709 : QVideoFrameFormat::ColorSpace_BT601);
+    format.setColorRange(fullRange ? QVideoFrameFormat::ColorRange_Full : QVideoFrameFormat::ColorRange_Video);
+    
+    // New pool for the new format (frames of the old one release into it until Qt drops them)
+    self->m_width = static_cast<int>(w);
+    self->m_height = static_cast<int>(h);
+    self->m_frameFormat = format;
+    self->m_pool = std::make_shared<VLCFramePool>(layout);
+    
     // Setup lock/unlock/display callbacks on main thread
     QMetaObject::invokeMethod(
         self,
@@ -147,71 +149,79 @@ unsigned VLCVideoPlayer::videoFormatCallback(void** opaque, char* chroma, unsign
         Qt::QueuedConnection
     );
     
-    qDebug() << "[VLC] videoFormatCallback:" << w << "x" << h << "- buffer allocated";
+    qDebug() << "[VLC] videoFormatCallback:" << w << "x" << h << (nv12 ? "NV12" : (fullRange ? "J420" : "I420"))
+             << "- frame pool of up to" << VLCFramePool::DefaultMaxBuffers << "buffers";
     
-    return 1;  // Return 1 to indicate success
+    // Pictures VLC may hold at once (decode ahead + display) - more than one so decoding never waits for display
+    return VLC_PICTURES;
 }
 
 void VLCVideoPlayer::videoCleanupCallback(void* opaque)
 {
-    // Called when video format changes or playback stops
-    // Cleanup is handled by the player's destructor and cleanupVideoCallbacks()
-    Q_UNUSED(opaque);
+    // Called when video format changes or playback stops (VLC released every picture)
+    // Buffers still shown by Qt stay valid - they hold the pool
+    auto* self = static_cast<VLCVideoPlayer*>(opaque);
+    self->m_pool.reset();
 }
 
 void* VLCVideoPlayer::lock(void* opaque, void** planes)
 {
     auto* self = static_cast<VLCVideoPlayer*>(opaque);
-    self->m_mutex.lock();
-    
-    if (!self->m_buffer) {
-        self->m_mutex.unlock();
+    if (!self->m_pool) {
         return nullptr;
     }
     
-    // CRITICAL: planes is an array of pointers, not a single pointer
-    // For RV32 format, we set planes[0] to our buffer
-    planes[0] = self->m_buffer;
-    return nullptr;
+    // CRITICAL: planes is an array of pointers, one per plane
+    // The returned buffer is the picture id passed to unlock()/display()
+    return self->m_pool->acquire(planes);
 }
 
-void VLCVideoPlayer::unlock(void* opaque, void*, void* const*)
+void VLCVideoPlayer::unlock(void* opaque, void* picture, void* const* planes)
 {
+    Q_UNUSED(planes);
     auto* self = static_cast<VLCVideoPlayer*>(opaque);
-    self->m_mutex.unlock();
+    if (self->m_pool) {
+        // Decoded - VLC's reference stays until display() has wrapped the picture for Qt
+        self->m_pool->unlock(static_cast<VLCFramePool::Buffer*>(picture));
+    }
 }
 
-void VLCVideoPlayer::display(void* opaque, void*)
+void VLCVideoPlayer::display(void* opaque, void* picture)
 {
     auto* self = static_cast<VLCVideoPlayer*>(opaque);
-    if (!self->m_videoSink || !self->m_buffer || self->m_width <= 0 || self->m_height <= 0) {
+    if (!self->m_pool || !picture) {
         return;
     }
     
-    // Note: We don't lock here because unlock() was already called
-    // The buffer is safe to read now
-    
-    // Create QImage from buffer (shallow copy for performance)
-    // RV32 format is BGRA (little-endian), which matches Format_RGB32 on Windows
-    QImage img(
-        self->m_buffer,
-        self->m_width,
-        self->m_height,
-        self->m_width * 4,
-        QImage::Format_RGB32  // BGRA on little-endian systems (Windows)
-    );
-    
-    // Deep copy the image data (required because buffer is owned by VLC and may be overwritten)
-    QImage imgCopy = img.copy();
+    // Zero-copy: the frame references the pooled buffer VLC decoded into
+    QVideoFrame frame = self->m_pool->wrap(static_cast<VLCFramePool::Buffer*>(picture), self->m_frameFormat);
+    if (!frame.isValid()) {
+        return;  // Scratch picture (every buffer held by Qt) - dropped
+    }
+    {
+        QMutexLocker locker(&self->m_frameMutex);
+        self->m_latestFrame = frame;
+    }
     
-    // Create video frame and send to sink (must be on main thread)
-    QVideoFrame frame(imgCopy);
+    // Only ONE queued call in flight to the GUI thread - if it hasn't run yet it will
+    // pick up this (newer) frame instead of the one it was queued for
+    if (self->m_framePending.exchange(true, std::memory_order_acq_rel)) {
+        return;
+    }
     
     QMetaObject::invokeMethod(
-        self->m_videoSink,
-        [sink = self->m_videoSink, frame]() mutable {
-            if (sink) {
-                sink->setVideoFrame(frame);
+        self,
+        [self]() {
+            // Clear pending BEFORE reading so a frame stored meanwhile always gets its own call
+            self->m_framePending.store(false, std::memory_order_release);
+            QVideoFrame latest;
+            {
+                QMutexLocker locker(&self->m_frameMutex);
+                latest = self->m_latestFrame;
+                self->m_latestFrame = QVideoFrame();
+            }
+            if (latest.isValid() && self->m_videoSink) {
+                self->m_videoSink->setVideoFrame(latest);
             }
         },
         Qt::QueuedConnection
@@ -239,11 +249,12 @@ void VLCVideoPlayer::setSource(const QUrl& source)
         // Stop previous playback
         libvlc_media_player_stop(m_mediaPlayer);
         
-        // Clean up old buffer and callbacks
+        // Clean up old frame pool and callbacks (VLC is stopped - its threads are gone)
         cleanupVideoCallbacks();
-        if (m_buffer) {
-            delete[] m_buffer;
-            m_buffer = nullptr;
+        m_pool.reset();
+        {
+            QMutexLocker locker(&m_frameMutex);
+            m_latestFrame = QVideoFrame();
         }
         m_width = 0;
         m_height = 0;
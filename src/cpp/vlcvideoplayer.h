@@ -7,8 +7,11 @@
 #include <QTimer>
 #include <QVideoSink>
 #include <QMutex>
-#include <QImage>
 #include <QVideoFrame>
+#include <QVideoFrameFormat>
+#include <atomic>
+#include <memory>
+#include "vlcframepool.h"
 
 class VLCVideoPlayer : public QObject
 {
@@ -72,8 +75,8 @@ private:
     static unsigned videoFormatCallback(void** opaque, char* chroma, unsigned* width, unsigned* height, unsigned* pitches, unsigned* lines);
     static void videoCleanupCallback(void* opaque);
     static void* lock(void* opaque, void** planes);
-    static void unlock(void* opaque, void*, void* const*);
-    static void display(void* opaque, void*);
+    static void unlock(void* opaque, void* picture, void* const* planes);
+    static void display(void* opaque, void* picture);
 
     libvlc_instance_t* m_vlcInstance = nullptr;
     libvlc_media_player_t* m_mediaPlayer = nullptr;
@@ -86,12 +89,22 @@ private:
     bool m_isSeekable = false;
     int m_lastPlaybackState = StoppedState;
     
-    // vmem rendering
+    static constexpr unsigned VLC_PICTURES = 4;  // Pictures VLC may hold at once (format callback result)
+    
+    // vmem rendering: VLC decodes into pooled I420/NV12 buffers that Qt samples without a copy
+    // m_pool/m_frameFormat belong to VLC's threads (format/lock/unlock/display/cleanup callbacks),
+    // the GUI thread only touches them while VLC is stopped
     QVideoSink* m_videoSink = nullptr;
     int m_width = 0;
     int m_height = 0;
-    uchar* m_buffer = nullptr;
-    QMutex m_mutex;
+    std::shared_ptr<VLCFramePool> m_pool;
+    QVideoFrameFormat m_frameFormat;
+    
+    // Newest displayed frame not yet handed to the sink (only one queued GUI call at a time,
+    // a frame replaced before the GUI took it goes straight back to the pool)
+    QMutex m_frameMutex;
+    QVideoFrame m_latestFrame;
+    std::atomic<bool> m_framePending{false};
     bool m_pendingPlay = false;  // True when source is set but playback is waiting for videoSink
 };
 
@@ -22,6 +22,7 @@ Item {
     property var eqBands: [0, 0, 0, 0, 0, 0, 0, 0, 0, 0]  // 10-band EQ, values from -12 to +12 dB
     property bool eqEnabled: false  // EQ enabled state
     property bool loop: false  // Loop playback state
+    property var thumbnailProvider: null  // Optional FFmpegThumbnailGenerator for seek-bar previews
     
     // Calculate if background is light or dark to determine icon color
     readonly property color backgroundColor: Qt.rgba(
@@ -496,6 +497,63 @@ Item {
                                     seekReleased()
                                 }
                             }
+
+                            // Seek preview thumbnail - positioned outside to avoid clipping
+                            Rectangle {
+                                id: seekPreview
+                                parent: audioControls
+                                readonly property real hoverPosition: progressArea.width > 0
+                                    ? Math.max(0, Math.min(progressArea.mouseX / progressArea.width, 1)) * duration : 0
+                                readonly property rect tile: thumbnailProvider && thumbnailProvider.ready
+                                    ? thumbnailProvider.tileRect(hoverPosition) : Qt.rect(0, 0, 0, 0)
+                                width: tile.width + 8
+                                height: tile.height + 28
+                                radius: 8
+                                color: Qt.rgba(
+                                    Qt.lighter(accentColor, 1.1).r,
+                                    Qt.lighter(accentColor, 1.1).g,
+                                    Qt.lighter(accentColor, 1.1).b,
+                                    0.95
+                                )
+                                border.color: Qt.rgba(255, 255, 255, 0.2)
+                                border.width: 1
+                                visible: progressArea.containsMouse && duration > 0 && tile.width > 0
+                                z: 1000
+
+                                // Follow the cursor, kept inside the controls bar
+                                x: {
+                                    const p = progressArea.mapToItem(audioControls, progressArea.mouseX, 0)
+                                    return Math.max(0, Math.min(p.x - width / 2, audioControls.width - width))
+                                }
+                                y: progressArea.mapToItem(audioControls, 0, 0).y - height - 16
+
+                                // Whole sprite stays loaded; only the offset changes while hovering
+                                Item {
+                                    x: 4; y: 4
+                                    width: seekPreview.tile.width
+                                    height: seekPreview.tile.height
+                                    clip: true
+
+                                    Image {
+                                        x: -seekPreview.tile.x
+                                        y: -seekPreview.tile.y
+                                        source: thumbnailProvider && thumbnailProvider.ready ? thumbnailProvider.spriteUrl : ""
+                                        asynchronous: true
+                                        cache: true
+                                        smooth: false
+                                    }
+                                }
+
+                                Text {
+                                    anchors.horizontalCenter: parent.horizontalCenter
+                                    anchors.bottom: parent.bottom
+                                    anchors.bottomMargin: 5
+                                    color: iconColor
+                                    font.pixelSize: 12
+                                    font.weight: Font.Medium
+                                    text: formatTime(seekPreview.hoverPosition)
+                                }
+                            }
                         }
 
                         // total time
@@ -158,6 +158,8 @@ Item {
     S3rpentMedia.EmbeddedSubtitleExtractor {
         id: embeddedSubtitleExtractor
         enabled: subtitleEngine === "external"  // Custom engine works with both external files and embedded subtitles
+        // FFmpeg backend: cues are decoded from the packets playback already reads (full scan only on far seeks)
+        playbackSource: useFFmpeg ? ffmpegPlayer : null
         
         onExtractingChanged: {
             if (extracting) {
@@ -210,6 +212,12 @@ Item {
         }
     }
     
+    // Seek-bar preview thumbnails - keyframe sprite sheet generated in the background (cached per file)
+    S3rpentMedia.FFmpegThumbnailGenerator {
+        id: seekThumbnails
+        source: videoPlayer.source
+    }
+    
     // Timer to update embedded subtitles based on video position (for custom engine)
     // Uses cached subtitle data - no FFmpeg calls during playback
     Timer {
@@ -388,6 +396,7 @@ Item {
         property bool useWMF: false  // Legacy: kept for backward compatibility
         property string videoBackend: "mediaplayer"  // "mediaplayer", "wmf", "libmpv", "libvlc", or "ffmpeg"
         property string mpvRendererMode: "opengl"  // "opengl" or "d3d11" (only applies when videoBackend is "libmpv")
+        property string ffmpegRendererMode: "videooutput"  // "videooutput" or "rhi" (only applies when videoBackend is "ffmpeg")
         
         onVideoBackendChanged: {
             console.log("[VideoPlayer] Settings videoBackend changed to:", videoBackend)
@@ -850,8 +859,25 @@ Item {
         visible: active && videoPlayer.source !== ""
         
         sourceComponent: Item {
+            id: ffmpegOutputItem
             anchors.fill: parent
             
+            // "rhi": FFmpegVideoRenderer uploads the YUV planes and converts in its shader (any RHI backend),
+            // otherwise the frames go through VideoOutput's videoSink
+            readonly property bool useRhiRenderer: videoSettings.ffmpegRendererMode === "rhi"
+            readonly property rect outputRect: useRhiRenderer ? ffmpegRhiRenderer.contentRect : ffmpegVideoOutput.contentRect
+            
+            function connectOutput() {
+                if (!videoPlayer.ffmpegPlayer) {
+                    return
+                }
+                // The renderer gets frames through its player binding - don't feed an invisible sink too
+                videoPlayer.ffmpegPlayer.videoSink = useRhiRenderer ? null : ffmpegVideoOutput.videoSink
+                console.log("[FFmpeg] Connected FFmpeg player to", useRhiRenderer ? "FFmpegVideoRenderer" : "VideoOutput videoSink")
+            }
+            
+            onUseRhiRendererChanged: connectOutput()
+            
             // Black background to prevent white rectangles from showing through
             Rectangle {
                 id: videoBackgroundFFmpeg
@@ -865,24 +891,28 @@ Item {
                 id: ffmpegVideoOutput
                 anchors.fill: parent
                 z: 0
+                visible: !ffmpegOutputItem.useRhiRenderer
                 fillMode: VideoOutput.PreserveAspectFit
                 
                 Component.onCompleted: {
                     console.log("[FFmpeg] VideoOutput created")
-                    // Connect FFmpeg player to VideoOutput's videoSink
-                    if (videoPlayer.ffmpegPlayer && ffmpegVideoOutput.videoSink) {
-                        videoPlayer.ffmpegPlayer.videoSink = ffmpegVideoOutput.videoSink
-                        console.log("[FFmpeg] Connected FFmpeg player to VideoOutput videoSink")
-                    }
+                    // Connect FFmpeg player to VideoOutput's videoSink (or the RHI renderer)
+                    ffmpegOutputItem.connectOutput()
+                }
+                
+                // On-screen size in device pixels: the player scales (or lowres-decodes) large videos down to it
+                Binding {
+                    target: videoPlayer.ffmpegPlayer
+                    property: "displaySize"
+                    when: videoPlayer.ffmpegPlayer !== null
+                    value: Qt.size(Math.round(ffmpegOutputItem.outputRect.width * Screen.devicePixelRatio),
+                                   Math.round(ffmpegOutputItem.outputRect.height * Screen.devicePixelRatio))
                 }
                 
                 Connections {
                     target: videoPlayer
                     function onFfmpegPlayerChanged() {
-                        if (videoPlayer.ffmpegPlayer && ffmpegVideoOutput.videoSink) {
-                            videoPlayer.ffmpegPlayer.videoSink = ffmpegVideoOutput.videoSink
-                            console.log("[FFmpeg] Reconnected FFmpeg player to VideoOutput videoSink")
-                        }
+                        ffmpegOutputItem.connectOutput()
                     }
                 }
                 
@@ -893,6 +923,21 @@ Item {
                     angle: videoPlayer.videoRotation
                 }
             }
+            
+            S3rpentMedia.FFmpegVideoRenderer {
+                id: ffmpegRhiRenderer
+                anchors.fill: parent
+                z: 0
+                visible: ffmpegOutputItem.useRhiRenderer
+                player: ffmpegOutputItem.useRhiRenderer ? videoPlayer.ffmpegPlayer : null
+                
+                // Apply rotation transform
+                transform: Rotation {
+                    origin.x: ffmpegRhiRenderer.width / 2
+                    origin.y: ffmpegRhiRenderer.height / 2
+                    angle: videoPlayer.videoRotation
+                }
+            }
         }
     }
 
@@ -1764,24 +1809,27 @@ Item {
         modal: false
         closePolicy: Popup.CloseOnPressOutside | Popup.CloseOnEscape
         
+        // FFmpeg backend switches tracks in place (no reopen); otherwise the QML MediaPlayer's tracks
+        property var trackPlayer: (videoPlayer.useFFmpeg && videoPlayer.ffmpegPlayer) ? videoPlayer.ffmpegPlayer : mediaPlayer
+        
         onOpened: {
             console.log("[VideoPlayer] ===== Audio track popup opened =====")
-            console.log("[VideoPlayer] MediaPlayer reports", mediaPlayer.audioTracks.length, "audio tracks")
+            console.log("[VideoPlayer] MediaPlayer reports", audioTrackPopup.trackPlayer.audioTracks.length, "audio tracks")
             console.log("[VideoPlayer] Repeater count:", audioTrackRepeater.count)
             console.log("[VideoPlayer] Track list height:", audioTrackList.height)
             console.log("[VideoPlayer] Popup height:", height)
-            console.log("[VideoPlayer] Current activeAudioTrack:", mediaPlayer.activeAudioTrack)
+            console.log("[VideoPlayer] Current activeAudioTrack:", audioTrackPopup.trackPlayer.activeAudioTrack)
             // Force update all track items
             for (var i = 0; i < audioTrackRepeater.count; i++) {
                 var item = audioTrackRepeater.itemAt(i)
                 if (item) {
-                    item.currentActiveTrack = mediaPlayer.activeAudioTrack
+                    item.currentActiveTrack = audioTrackPopup.trackPlayer.activeAudioTrack
                     console.log("[VideoPlayer] Updated track item", i, "currentActiveTrack to:", item.currentActiveTrack, "isActive:", item.isActive)
                 }
             }
             // Log each track individually
-            for (var j = 0; j < mediaPlayer.audioTracks.length; j++) {
-                var track = mediaPlayer.audioTracks[j]
+            for (var j = 0; j < audioTrackPopup.trackPlayer.audioTracks.length; j++) {
+                var track = audioTrackPopup.trackPlayer.audioTracks[j]
                 var trackInfo = "Track " + (j + 1)
                 if (track) {
                     if (track.title) trackInfo += " - " + track.title
@@ -1826,7 +1874,7 @@ Item {
                 // Get available audio tracks
                 Repeater {
                     id: audioTrackRepeater
-                    model: (videoPlayer.useWMF && videoPlayer.wmfPlayer) ? [] : mediaPlayer.audioTracks
+                    model: (videoPlayer.useWMF && videoPlayer.wmfPlayer) ? [] : audioTrackPopup.trackPlayer.audioTracks
                     
                     onItemAdded: function(index, item) {
                         console.log("[VideoPlayer] Repeater item added at index:", index)
@@ -1834,7 +1882,7 @@ Item {
                     
                     onCountChanged: {
                         console.log("[VideoPlayer] Audio track Repeater count changed to:", audioTrackRepeater.count)
-                        console.log("[VideoPlayer] MediaPlayer reports", mediaPlayer.audioTracks.length, "audio tracks")
+                        console.log("[VideoPlayer] MediaPlayer reports", audioTrackPopup.trackPlayer.audioTracks.length, "audio tracks")
                     }
                     
                     Rectangle {
@@ -1844,22 +1892,22 @@ Item {
                         radius: 8
                         color: audioTrackItemMouseArea.containsMouse ? Qt.rgba(255, 255, 255, 0.1) : "transparent"
                         // Force binding update by using a function that gets re-evaluated
-                        property int currentActiveTrack: mediaPlayer.activeAudioTrack
+                        property int currentActiveTrack: audioTrackPopup.trackPlayer.activeAudioTrack
                         property bool isActive: !(videoPlayer.useWMF && videoPlayer.wmfPlayer) && currentActiveTrack === index
                         
                         // Monitor activeAudioTrack changes and force update
                         Connections {
-                            target: mediaPlayer
+                            target: audioTrackPopup.trackPlayer
                             function onActiveAudioTrackChanged() {
-                                console.log("[VideoPlayer] activeAudioTrack changed to:", mediaPlayer.activeAudioTrack, "Track", index, "isActive:", audioTrackItem.isActive)
+                                console.log("[VideoPlayer] activeAudioTrack changed to:", audioTrackPopup.trackPlayer.activeAudioTrack, "Track", index, "isActive:", audioTrackItem.isActive)
                                 // Force property update
-                                audioTrackItem.currentActiveTrack = mediaPlayer.activeAudioTrack
+                                audioTrackItem.currentActiveTrack = audioTrackPopup.trackPlayer.activeAudioTrack
                             }
                         }
                         
                         // Also update when popup opens
                         Component.onCompleted: {
-                            currentActiveTrack = mediaPlayer.activeAudioTrack
+                            currentActiveTrack = audioTrackPopup.trackPlayer.activeAudioTrack
                             console.log("[VideoPlayer] Audio track item created - index:", index, "displayed as Track", (index + 1))
                         }
                         
@@ -1875,12 +1923,12 @@ Item {
                                     console.log("[VideoPlayer] ===== Track Selection Debug =====")
                                     console.log("[VideoPlayer] Clicked Repeater index:", index)
                                     console.log("[VideoPlayer] Track object type:", typeof track)
-                                    console.log("[VideoPlayer] Current activeAudioTrack:", mediaPlayer.activeAudioTrack)
-                                    console.log("[VideoPlayer] Total audio tracks:", mediaPlayer.audioTracks.length)
+                                    console.log("[VideoPlayer] Current activeAudioTrack:", audioTrackPopup.trackPlayer.activeAudioTrack)
+                                    console.log("[VideoPlayer] Total audio tracks:", audioTrackPopup.trackPlayer.audioTracks.length)
                                     
                                     // Log all available tracks and their properties
-                                    for (var i = 0; i < mediaPlayer.audioTracks.length; i++) {
-                                        var t = mediaPlayer.audioTracks[i]
+                                    for (var i = 0; i < audioTrackPopup.trackPlayer.audioTracks.length; i++) {
+                                        var t = audioTrackPopup.trackPlayer.audioTracks[i]
                                         console.log("[VideoPlayer] Track", i, ":", t)
                                         if (t) {
                                             // Try to access common properties
@@ -1896,17 +1944,18 @@ Item {
                                     }
                                     
                                     // Ensure media is loaded before setting track
-                                    if (mediaPlayer.source === "" || mediaPlayer.playbackState === MediaPlayer.StoppedState) {
+                                    if (String(audioTrackPopup.trackPlayer.source) === "" ||
+                                        (audioTrackPopup.trackPlayer === mediaPlayer && mediaPlayer.playbackState === MediaPlayer.StoppedState)) {
                                         console.log("[VideoPlayer] WARNING: Media not loaded, cannot set track")
                                     } else {
                                         // Use the Repeater index directly (0-based indexing)
                                         console.log("[VideoPlayer] Setting activeAudioTrack to:", trackIndex, "(0-based index)")
                                         
-                                        mediaPlayer.activeAudioTrack = trackIndex
+                                        audioTrackPopup.trackPlayer.activeAudioTrack = trackIndex
                                         
                                         // Verify
                                         Qt.callLater(function() {
-                                            var verified = mediaPlayer.activeAudioTrack
+                                            var verified = audioTrackPopup.trackPlayer.activeAudioTrack
                                             console.log("[VideoPlayer] Verified activeAudioTrack:", verified, "Expected:", trackIndex)
                                         }, 150)
                                     }
@@ -1952,7 +2001,7 @@ Item {
                 // Show message if no tracks or using WMF
                 Text {
                     width: audioTrackList.width
-                    visible: (videoPlayer.useWMF && videoPlayer.wmfPlayer) || (!(videoPlayer.useWMF && videoPlayer.wmfPlayer) && mediaPlayer.audioTracks.length === 0)
+                    visible: (videoPlayer.useWMF && videoPlayer.wmfPlayer) || (!(videoPlayer.useWMF && videoPlayer.wmfPlayer) && audioTrackPopup.trackPlayer.audioTracks.length === 0)
                     text: (videoPlayer.useWMF && videoPlayer.wmfPlayer) ? "Audio track selection\nnot available with WMF" : "No audio tracks available"
                     color: foregroundColor
                     font.pixelSize: 12
@@ -2351,6 +2400,7 @@ Item {
     property bool isFixingVideo: false
     property url originalVideoSource: ""
     property url fixedVideoUrl: ""
+    property real videoFixProgress: 0  // 0..1 while the timestamp-repair remux runs
     property int lastPosition: 0
     property int positionStallCount: 0
     property bool hardwareDecoderUnavailable: false  // Track if hardware decoder is not available
@@ -2466,8 +2516,8 @@ Item {
             return
         }
         
-        if (!ColorUtils.fixVideoFile) {
-            console.log("[Video] ERROR: ColorUtils.fixVideoFile function not found")
+        if (!ColorUtils.startVideoFix) {
+            console.log("[Video] ERROR: ColorUtils.startVideoFix function not found")
             videoPlayer.isFixingVideo = false
             videoPlayer.originalVideoSource = ""
             return
@@ -2475,8 +2525,23 @@ Item {
         
         console.log("[Video] FFmpeg is available, starting fix process...")
         console.log("[Video] Source video:", videoPlayer.originalVideoSource)
-        Qt.callLater(function() {
-            const fixedUrl = ColorUtils.fixVideoFile(videoPlayer.originalVideoSource)
+        // Stream-copy remux on a worker thread - playback of the original continues meanwhile
+        if (!ColorUtils.startVideoFix(videoPlayer.originalVideoSource)) {
+            console.log("[Video] Failed to start video fix - keeping original source")
+            videoPlayer.isFixingVideo = false
+        }
+    }
+    
+    Connections {
+        target: typeof ColorUtils !== "undefined" ? ColorUtils : null
+        ignoreUnknownSignals: true
+        function onVideoFixProgress(progress) {
+            videoPlayer.videoFixProgress = progress
+        }
+        function onVideoFixFinished(fixedUrl) {
+            if (!videoPlayer.isFixingVideo) {
+                return
+            }
             const fixedUrlStr = String(fixedUrl || "")
             console.log("[Video] Fix result:", fixedUrlStr)
             if (fixedUrl && fixedUrlStr !== "" && fixedUrlStr !== "null" && fixedUrlStr !== "undefined") {
@@ -2490,7 +2555,7 @@ Item {
                 // Keep originalVideoSource set so we don't try to fix again
                 // Don't clear it - this prevents infinite retry loops
             }
-        })
+        }
     }
     
     // Monitor for stuttering by tracking position updates
@@ -2656,6 +2721,7 @@ Item {
             playbackState: videoPlayer.playbackState
             seekable: videoPlayer.seekable
             accentColor: videoPlayer.accentColor
+            thumbnailProvider: seekThumbnails
             muted: (videoPlayer.useWMF && wmfPlayer) ? (wmfPlayer.volume === 0 && videoPlayer.volume > 0) : (audioOutput.volume === 0 && videoPlayer.volume > 0)
             
             onPlayClicked: {
@@ -2888,7 +2954,8 @@ Item {
             console.log("[VideoPlayer] 🎨 Video dimensions changed:", implicitWidth, "x", implicitHeight)
         }
     }
-    property real playbackRate: (useWMF && wmfPlayer) ? 1.0 : ((useLibvlc && vlcPlayer) ? 1.0 : mediaPlayer.playbackRate)
+    property real playbackRate: (useWMF && wmfPlayer) ? 1.0 : ((useLibvlc && vlcPlayer) ? 1.0 :
+                                ((useFFmpeg && ffmpegPlayer) ? ffmpegPlayer.playbackRate : mediaPlayer.playbackRate))
     
     function play() { 
         if (useLibmpv && mpvPlayer) {
@@ -2929,7 +2996,45 @@ Item {
             mediaPlayer.stop()
         }
     }
-    
+
+    // Frame stepping (FFmpeg backend): pauses and moves one frame, backwards served from the GOP cache
+    Shortcut {
+        sequence: "."
+        enabled: videoPlayer.visible && videoPlayer.useFFmpeg && videoPlayer.ffmpegPlayer
+        onActivated: videoPlayer.ffmpegPlayer.stepForward()
+    }
+    Shortcut {
+        sequence: ","
+        enabled: videoPlayer.visible && videoPlayer.useFFmpeg && videoPlayer.ffmpegPlayer
+        onActivated: videoPlayer.ffmpegPlayer.stepBackward()
+    }
+
+    // Playback speed (FFmpeg backend): ] faster, [ slower, \ back to 1x - audio keeps its pitch
+    readonly property var ffmpegRateSteps: [0.25, 0.5, 0.75, 1.0, 1.25, 1.5, 2.0, 3.0, 4.0]
+    function stepFFmpegRate(direction) {
+        const current = ffmpegPlayer.playbackRate
+        let index = ffmpegRateSteps.findIndex(rate => rate >= current - 0.001)
+        if (index < 0) index = ffmpegRateSteps.length - 1
+        if (direction > 0 && ffmpegRateSteps[index] <= current + 0.001) index++
+        if (direction < 0) index--
+        ffmpegPlayer.playbackRate = ffmpegRateSteps[Math.max(0, Math.min(ffmpegRateSteps.length - 1, index))]
+    }
+    Shortcut {
+        sequence: "]"
+        enabled: videoPlayer.visible && videoPlayer.useFFmpeg && videoPlayer.ffmpegPlayer
+        onActivated: videoPlayer.stepFFmpegRate(1)
+    }
+    Shortcut {
+        sequence: "["
+        enabled: videoPlayer.visible && videoPlayer.useFFmpeg && videoPlayer.ffmpegPlayer
+        onActivated: videoPlayer.stepFFmpegRate(-1)
+    }
+    Shortcut {
+        sequence: "\\"
+        enabled: videoPlayer.visible && videoPlayer.useFFmpeg && videoPlayer.ffmpegPlayer
+        onActivated: videoPlayer.ffmpegPlayer.playbackRate = 1.0
+    }
+
     onSourceChanged: {
         if (source !== "") {
             // HDR/Color Space Diagnostic Logging
@@ -2947,7 +3052,11 @@ Item {
             
             // Reset fixing state when source changes (unless it's the fixed version)
             if (source !== fixedVideoUrl) {
+                if (isFixingVideo && typeof ColorUtils !== "undefined" && ColorUtils.cancelVideoFix) {
+                    ColorUtils.cancelVideoFix()  // A different video now - its fix is no longer wanted
+                }
                 isFixingVideo = false
+                videoFixProgress = 0
                 // Only clear originalVideoSource if we're loading a completely new video
                 // Don't clear it if we're just retrying the same video (prevents auto-fix retry loops)
                 const sourceStr2 = String(source)
@@ -0,0 +1,218 @@
+#include "ffmpegaudioringbuffer.h"
+#include <QElapsedTimer>
+#include <QThread>
+#include <QtTest>
+#include <atomic>
+#include <thread>
+
+namespace {
+    constexpr int kBytesPerFrame = 4;  // S16 stereo
+
+    // Byte i of the stream is i % 251 - a prime period, so a misplaced or repeated chunk never lines up
+    QByteArray pattern(quint64 start, qint64 size)
+    {
+        QByteArray bytes(size, Qt::Uninitialized);
+        for (qint64 i = 0; i < size; ++i) {
+            bytes[i] = char((start + quint64(i)) % 251);
+        }
+        return bytes;
+    }
+}
+
+class TestFFmpegAudioRingBuffer : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void capacityRoundsUpToPowerOfTwo();
+    void emptyAndFull();
+    void wrapAround();
+    void readsStayFrameAligned();
+    void underrunPadsWithSilence();
+    void discardQueuedFreesSpace();
+    void waitForFreeBytes();
+    void concurrentPushPop();
+};
+
+void TestFFmpegAudioRingBuffer::capacityRoundsUpToPowerOfTwo()
+{
+    QCOMPARE(FFmpegAudioRingBuffer(5000, kBytesPerFrame).capacity(), qint64(8192));
+    QCOMPARE(FFmpegAudioRingBuffer(8192, kBytesPerFrame).capacity(), qint64(8192));
+    QCOMPARE(FFmpegAudioRingBuffer(100, kBytesPerFrame).capacity(), qint64(4096));  // Minimum size
+}
+
+void TestFFmpegAudioRingBuffer::emptyAndFull()
+{
+    FFmpegAudioRingBuffer ring(4096, kBytesPerFrame);
+    QVERIFY(ring.open(QIODevice::ReadOnly | QIODevice::Unbuffered));
+    QCOMPARE(ring.queuedBytes(), qint64(0));
+    QCOMPARE(ring.freeBytes(), qint64(4096));
+
+    // Only what fits is accepted
+    const QByteArray data = pattern(0, 5000);
+    QCOMPARE(ring.push(data.constData(), data.size()), qint64(4096));
+    QCOMPARE(ring.queuedBytes(), qint64(4096));
+    QCOMPARE(ring.freeBytes(), qint64(0));
+    QCOMPARE(ring.push(data.constData(), 4), qint64(0));
+
+    QCOMPARE(ring.read(1000), pattern(0, 1000));
+    QCOMPARE(ring.freeBytes(), qint64(1000));
+    QCOMPARE(ring.readPosition(), quint64(1000));
+
+    QCOMPARE(ring.read(3096), pattern(1000, 3096));
+    QCOMPARE(ring.queuedBytes(), qint64(0));
+    QCOMPARE(ring.freeBytes(), qint64(4096));
+}
+
+void TestFFmpegAudioRingBuffer::wrapAround()
+{
+    FFmpegAudioRingBuffer ring(4096, kBytesPerFrame);
+    QVERIFY(ring.open(QIODevice::ReadOnly | QIODevice::Unbuffered));
+
+    quint64 position = 0;
+    for (int round = 0; round < 8; ++round) {
+        // 3000 bytes per round: every round after the first straddles the end of the buffer
+        const QByteArray data = pattern(position, 3000);
+        QCOMPARE(ring.push(data.constData(), data.size()), qint64(data.size()));
+        QCOMPARE(ring.read(data.size()), data);
+        position += quint64(data.size());
+        QCOMPARE(ring.writePosition(), position);
+        QCOMPARE(ring.readPosition(), position);
+    }
+}
+
+void TestFFmpegAudioRingBuffer::readsStayFrameAligned()
+{
+    FFmpegAudioRingBuffer ring(4096, kBytesPerFrame);
+    QVERIFY(ring.open(QIODevice::ReadOnly | QIODevice::Unbuffered));
+
+    const QByteArray data = pattern(0, 10);
+    ring.push(data.constData(), data.size());
+
+    // Two and a half frames queued: only the two whole ones are handed out
+    QCOMPARE(ring.read(10), pattern(0, 8));
+    QCOMPARE(ring.readPosition(), quint64(8));
+    QCOMPARE(ring.queuedBytes(), qint64(2));
+}
+
+void TestFFmpegAudioRingBuffer::underrunPadsWithSilence()
+{
+    FFmpegAudioRingBuffer ring(4096, kBytesPerFrame);
+    QVERIFY(ring.open(QIODevice::ReadOnly | QIODevice::Unbuffered));
+
+    // Empty: silence, counted as an underrun, nothing consumed
+    QCOMPARE(ring.read(64), QByteArray(64, '\0'));
+    QCOMPARE(ring.underruns(), quint64(1));
+    QCOMPARE(ring.readPosition(), quint64(0));
+
+    // Short: the queued audio, then silence - only the real bytes count as consumed
+    const QByteArray data = pattern(0, 16);
+    ring.push(data.constData(), data.size());
+    QCOMPARE(ring.read(64), data + QByteArray(48, '\0'));
+    QCOMPARE(ring.readPosition(), quint64(16));
+    QCOMPARE(ring.underruns(), quint64(1));
+}
+
+void TestFFmpegAudioRingBuffer::discardQueuedFreesSpace()
+{
+    FFmpegAudioRingBuffer ring(4096, kBytesPerFrame);
+    QVERIFY(ring.open(QIODevice::ReadOnly | QIODevice::Unbuffered));
+
+    const QByteArray stale = pattern(0, 4096);
+    ring.push(stale.constData(), stale.size());
+    QCOMPARE(ring.freeBytes(), qint64(0));
+
+    // Space is reusable before the consumer reads again
+    QCOMPARE(ring.discardQueued(), quint64(4096));
+    QCOMPARE(ring.queuedBytes(), qint64(0));
+    QCOMPARE(ring.freeBytes(), qint64(4096));
+
+    // The consumer skips the discarded bytes and sees only audio pushed afterwards
+    const QByteArray fresh = pattern(4096, 400);
+    QCOMPARE(ring.push(fresh.constData(), fresh.size()), qint64(fresh.size()));
+    QCOMPARE(ring.read(fresh.size()), fresh);
+    QCOMPARE(ring.readPosition(), quint64(4096 + 400));
+}
+
+void TestFFmpegAudioRingBuffer::waitForFreeBytes()
+{
+    FFmpegAudioRingBuffer ring(4096, kBytesPerFrame);
+    QVERIFY(ring.open(QIODevice::ReadOnly | QIODevice::Unbuffered));
+
+    const QByteArray data = pattern(0, 4096);
+    ring.push(data.constData(), data.size());
+    QVERIFY(!ring.waitForFreeBytes(1024, 10));  // Times out on a full ring
+
+    // A read on another thread wakes the producer
+    std::thread consumer([&ring] {
+        QThread::msleep(50);
+        ring.read(2048);
+    });
+    QVERIFY(ring.waitForFreeBytes(1024, 5000));
+    consumer.join();
+    QCOMPARE(ring.freeBytes(), qint64(2048));
+
+    // So does a discard
+    ring.push(data.constData(), 2048);
+    std::thread discarder([&ring] {
+        QThread::msleep(50);
+        ring.discardQueued();
+    });
+    QVERIFY(ring.waitForFreeBytes(4096, 5000));
+    discarder.join();
+}
+
+void TestFFmpegAudioRingBuffer::concurrentPushPop()
+{
+    FFmpegAudioRingBuffer ring(4096, kBytesPerFrame);
+    QVERIFY(ring.open(QIODevice::ReadOnly | QIODevice::Unbuffered));
+
+    constexpr qint64 kTotal = 4 * 1024 * 1024;
+    std::atomic_bool stop{false};
+
+    // Producer: odd-sized chunks so pushes and wraps land everywhere in the buffer
+    std::thread producer([&] {
+        quint64 written = 0;
+        while (written < quint64(kTotal) && !stop.load()) {
+            const QByteArray chunk = pattern(written, qMin<qint64>(1000, kTotal - qint64(written)));
+            qint64 offset = 0;
+            while (offset < chunk.size() && !stop.load()) {
+                const qint64 pushed = ring.push(chunk.constData() + offset, chunk.size() - offset);
+                offset += pushed;
+                if (pushed == 0) {
+                    ring.waitForFreeBytes(kBytesPerFrame, 100);
+                }
+            }
+            written += quint64(offset);
+        }
+    });
+
+    // Consumer: only read what is queued (a longer read would be padded with silence)
+    QElapsedTimer timer;
+    timer.start();
+    quint64 consumed = 0;
+    bool intact = true;
+    while (consumed < quint64(kTotal) && timer.elapsed() < 20000) {
+        qint64 available = qMin<qint64>(ring.queuedBytes(), 700);
+        available -= available % kBytesPerFrame;
+        if (available <= 0) {
+            QThread::yieldCurrentThread();
+            continue;
+        }
+        const QByteArray chunk = ring.read(available);
+        if (chunk != pattern(consumed, available)) {
+            intact = false;
+            break;
+        }
+        consumed += quint64(chunk.size());
+    }
+
+    stop.store(true);
+    producer.join();
+    QVERIFY(intact);
+    QCOMPARE(consumed, quint64(kTotal));
+    QCOMPARE(ring.readPosition(), quint64(kTotal));
+}
+
+QTEST_GUILESS_MAIN(TestFFmpegAudioRingBuffer)
+#include "tst_ffmpegaudioringbuffer.moc"
@@ -0,0 +1,158 @@
+#include "ffmpegaudiotimestretch.h"
+#include <QtTest>
+#include <cmath>
+
+namespace {
+    constexpr int kSampleRate = 48000;
+    constexpr int kChannels = 2;
+    constexpr int kChunkFrames = 1024;  // Typical decoded AAC/Opus frame sizes are in this range
+
+    // Stretcher geometry at 48 kHz: 15 ms hop, 30 ms window, +-8 ms search
+    constexpr int kOverlap = 720;
+    constexpr int kWindow = 2 * kOverlap;
+    constexpr int kSearch = 384;
+
+    std::vector<int16_t> sine(double frequency, int frames)
+    {
+        std::vector<int16_t> samples(size_t(frames) * kChannels);
+        for (int i = 0; i < frames; ++i) {
+            const auto value = int16_t(std::lrint(12000.0 * std::sin(2.0 * 3.14159265358979323846 * frequency * i / kSampleRate)));
+            for (int c = 0; c < kChannels; ++c) {
+                samples[size_t(i) * kChannels + size_t(c)] = value;
+            }
+        }
+        return samples;
+    }
+
+    // Feed in decoder-sized chunks, like the decode thread does
+    QByteArray stretch(FFmpegAudioTimeStretch& stretcher, const std::vector<int16_t>& samples)
+    {
+        QByteArray out;
+        const int frames = int(samples.size() / kChannels);
+        for (int offset = 0; offset < frames; offset += kChunkFrames) {
+            stretcher.process(samples.data() + size_t(offset) * kChannels, qMin(kChunkFrames, frames - offset), &out);
+        }
+        return out;
+    }
+
+    qint64 outputFrames(const QByteArray& out)
+    {
+        return out.size() / qint64(kChannels * sizeof(int16_t));
+    }
+}
+
+class TestFFmpegAudioTimeStretch : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void rateIsClamped();
+    void bypassAtNormalRate();
+    void outputLengthFollowsRate_data();
+    void outputLengthFollowsRate();
+    void preservesPitch();
+    void resetDropsBufferedInput();
+};
+
+void TestFFmpegAudioTimeStretch::rateIsClamped()
+{
+    FFmpegAudioTimeStretch stretcher;
+    stretcher.configure(kSampleRate, kChannels);
+    QVERIFY(stretcher.isBypassed());
+
+    stretcher.setRate(10.0);
+    QCOMPARE(stretcher.rate(), FFmpegAudioTimeStretch::MAX_RATE);
+    stretcher.setRate(0.1);
+    QCOMPARE(stretcher.rate(), FFmpegAudioTimeStretch::MIN_RATE);
+    QVERIFY(!stretcher.isBypassed());
+}
+
+void TestFFmpegAudioTimeStretch::bypassAtNormalRate()
+{
+    FFmpegAudioTimeStretch stretcher;
+    stretcher.configure(kSampleRate, kChannels);
+
+    const std::vector<int16_t> input = sine(440.0, 5000);
+    const QByteArray out = stretch(stretcher, input);
+    QCOMPARE(out, QByteArray(reinterpret_cast<const char*>(input.data()), qsizetype(input.size() * sizeof(int16_t))));
+}
+
+void TestFFmpegAudioTimeStretch::outputLengthFollowsRate_data()
+{
+    QTest::addColumn<double>("rate");
+    QTest::newRow("0.25x") << 0.25;
+    QTest::newRow("0.5x") << 0.5;
+    QTest::newRow("0.75x") << 0.75;
+    QTest::newRow("1.25x") << 1.25;
+    QTest::newRow("1.5x") << 1.5;
+    QTest::newRow("2x") << 2.0;
+    QTest::newRow("4x") << 4.0;
+}
+
+void TestFFmpegAudioTimeStretch::outputLengthFollowsRate()
+{
+    QFETCH(double, rate);
+
+    FFmpegAudioTimeStretch stretcher;
+    stretcher.configure(kSampleRate, kChannels);
+    stretcher.setRate(rate);
+
+    const int inputFrames = 10 * kSampleRate;
+    const QByteArray out = stretch(stretcher, sine(440.0, inputFrames));
+    QCOMPARE(out.size() % qsizetype(kChannels * sizeof(int16_t)), qsizetype(0));
+
+    // Input duration / rate, less what is still buffered: up to one window plus the search range of
+    // input (scaled by the rate), give or take an output hop
+    const double expected = inputFrames / rate;
+    const double tolerance = (kWindow + kSearch) / rate + 2 * kOverlap;
+    const qint64 actual = outputFrames(out);
+    QVERIFY2(std::abs(actual - expected) <= tolerance,
+             qPrintable(QString("rate %1: %2 frames out, expected %3 +- %4").arg(rate).arg(actual).arg(expected).arg(tolerance)));
+}
+
+void TestFFmpegAudioTimeStretch::preservesPitch()
+{
+    FFmpegAudioTimeStretch stretcher;
+    stretcher.configure(kSampleRate, kChannels);
+    stretcher.setRate(2.0);
+
+    constexpr double frequency = 1000.0;
+    const QByteArray out = stretch(stretcher, sine(frequency, 4 * kSampleRate));
+    const auto* samples = reinterpret_cast<const int16_t*>(out.constData());
+    const qint64 frames = outputFrames(out);
+    QVERIFY(frames > kSampleRate);
+
+    // Count rising zero crossings on the left channel: the tone must stay at 1 kHz, not double
+    int crossings = 0;
+    for (qint64 i = 1; i < frames; ++i) {
+        if (samples[(i - 1) * kChannels] < 0 && samples[i * kChannels] >= 0) {
+            ++crossings;
+        }
+    }
+    const double measured = crossings * double(kSampleRate) / double(frames);
+    QVERIFY2(std::abs(measured - frequency) < frequency * 0.03,
+             qPrintable(QString("measured %1 Hz").arg(measured)));
+}
+
+void TestFFmpegAudioTimeStretch::resetDropsBufferedInput()
+{
+    FFmpegAudioTimeStretch stretcher;
+    stretcher.configure(kSampleRate, kChannels);
+    stretcher.setRate(1.5);
+
+    // Less than a window: buffered, nothing out yet
+    QByteArray out;
+    const std::vector<int16_t> input = sine(440.0, kWindow - 1);
+    stretcher.process(input.data(), kWindow - 1, &out);
+    QVERIFY(out.isEmpty());
+
+    // Without the reset one more frame would complete the first window
+    stretcher.reset();
+    stretcher.process(input.data(), 1, &out);
+    QVERIFY(out.isEmpty());
+    stretcher.process(input.data(), kWindow - 1, &out);
+    QCOMPARE(outputFrames(out), qint64(kOverlap));
+}
+
+QTEST_GUILESS_MAIN(TestFFmpegAudioTimeStretch)
+#include "tst_ffmpegaudiotimestretch.moc"
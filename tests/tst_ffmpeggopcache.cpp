@@ -0,0 +1,166 @@
+#include "ffmpeggopcache.h"
+#include <QtTest>
+
+namespace {
+    constexpr double kFrameDuration = 0.04;  // 25 fps
+    const QSize kFrameSize(16, 16);
+    constexpr qint64 kFrameBytes = 16 * 16 * 3 / 2;  // NV12
+
+    QVideoFrame makeFrame()
+    {
+        return QVideoFrame(QVideoFrameFormat(kFrameSize, QVideoFrameFormat::Format_NV12));
+    }
+
+    double framePts(int index)
+    {
+        return index * kFrameDuration;
+    }
+
+    void fill(FFmpegGopCache& cache, int frames)
+    {
+        for (int i = 0; i < frames; ++i) {
+            cache.insert(framePts(i), kFrameDuration, makeFrame(), framePts(i));
+        }
+    }
+}
+
+class TestFFmpegGopCache : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void insertKeepsOrderAndSkipsDuplicates();
+    void budgetEvictsBehindForwardDecode();
+    void budgetKeepsViewedNeighbourhood();
+    void budgetKeepsAtLeastOneFrame();
+    void stepForward();
+    void stepBackward();
+    void clear();
+};
+
+void TestFFmpegGopCache::insertKeepsOrderAndSkipsDuplicates()
+{
+    FFmpegGopCache cache(100 * kFrameBytes);
+    cache.insert(framePts(2), kFrameDuration, makeFrame(), 0.0);
+    cache.insert(framePts(0), kFrameDuration, makeFrame(), 0.0);
+    cache.insert(framePts(1), kFrameDuration, makeFrame(), 0.0);
+    QCOMPARE(cache.size(), 3);
+    QCOMPARE(cache.firstPts(), framePts(0));
+    QCOMPARE(cache.lastPts(), framePts(2));
+    QCOMPARE(cache.bytes(), 3 * kFrameBytes);
+
+    // Same frame again (PTS off by a rounding error): not stored twice
+    cache.insert(framePts(1) + 0.0001, kFrameDuration, makeFrame(), 0.0);
+    QCOMPARE(cache.size(), 3);
+    QCOMPARE(cache.bytes(), 3 * kFrameBytes);
+    QVERIFY(cache.contains(framePts(1)));
+    QVERIFY(!cache.contains(framePts(3)));
+}
+
+void TestFFmpegGopCache::budgetEvictsBehindForwardDecode()
+{
+    // Viewing the newest frame (decoding forward): the oldest frames go first
+    FFmpegGopCache cache(4 * kFrameBytes);
+    fill(cache, 10);
+    QCOMPARE(cache.size(), 4);
+    QCOMPARE(cache.bytes(), 4 * kFrameBytes);
+    QCOMPARE(cache.firstPts(), framePts(6));
+    QCOMPARE(cache.lastPts(), framePts(9));
+}
+
+void TestFFmpegGopCache::budgetKeepsViewedNeighbourhood()
+{
+    // Viewing the start of the GOP (decoding ahead of it for a backward step): the far end goes first
+    FFmpegGopCache cache(4 * kFrameBytes);
+    for (int i = 0; i < 10; ++i) {
+        cache.insert(framePts(i), kFrameDuration, makeFrame(), framePts(0));
+    }
+    QCOMPARE(cache.size(), 4);
+    QCOMPARE(cache.firstPts(), framePts(0));
+    QCOMPARE(cache.lastPts(), framePts(3));
+
+    // Viewing the middle: trimmed from both sides around it
+    cache.setBudget(100 * kFrameBytes);
+    cache.clear();
+    fill(cache, 10);
+    cache.setBudget(3 * kFrameBytes);
+    cache.insert(framePts(10), kFrameDuration, makeFrame(), framePts(5));
+    QCOMPARE(cache.size(), 3);
+    QVERIFY(cache.contains(framePts(4)));
+    QVERIFY(cache.contains(framePts(5)));
+    QVERIFY(cache.contains(framePts(6)));
+}
+
+void TestFFmpegGopCache::budgetKeepsAtLeastOneFrame()
+{
+    FFmpegGopCache cache(kFrameBytes / 2);
+    fill(cache, 3);
+    QCOMPARE(cache.size(), 1);
+    QCOMPARE(cache.firstPts(), framePts(2));
+}
+
+void TestFFmpegGopCache::stepForward()
+{
+    FFmpegGopCache cache(100 * kFrameBytes);
+    fill(cache, 6);
+
+    const FFmpegGopCache::Entry* entry = cache.after(framePts(2), 1, false);
+    QVERIFY(entry);
+    QCOMPARE(entry->pts, framePts(3));
+    QCOMPARE(entry->duration, kFrameDuration);
+
+    entry = cache.after(framePts(2), 2, false);
+    QVERIFY(entry);
+    QCOMPARE(entry->pts, framePts(4));
+
+    // Between frames: the next one
+    entry = cache.after(framePts(2) + 0.01, 1, false);
+    QVERIFY(entry);
+    QCOMPARE(entry->pts, framePts(3));
+
+    // Past the cached run: nothing, or its last frame when clamping
+    QVERIFY(!cache.after(framePts(5), 1, false));
+    QVERIFY(!cache.after(framePts(4), 3, false));
+    entry = cache.after(framePts(4), 3, true);
+    QVERIFY(entry);
+    QCOMPARE(entry->pts, framePts(5));
+    QVERIFY(!cache.after(framePts(2), 0, true));
+}
+
+void TestFFmpegGopCache::stepBackward()
+{
+    FFmpegGopCache cache(100 * kFrameBytes);
+    fill(cache, 6);
+    QCOMPARE(cache.countBefore(framePts(3)), 3);
+    QCOMPARE(cache.countBefore(framePts(0)), 0);
+
+    const FFmpegGopCache::Entry* entry = cache.before(framePts(3), 1, false);
+    QVERIFY(entry);
+    QCOMPARE(entry->pts, framePts(2));
+
+    entry = cache.before(framePts(3), 3, false);
+    QVERIFY(entry);
+    QCOMPARE(entry->pts, framePts(0));
+
+    // Before the cached run: nothing, or its first frame when clamping
+    QVERIFY(!cache.before(framePts(0), 1, false));
+    QVERIFY(!cache.before(framePts(2), 3, false));
+    entry = cache.before(framePts(2), 3, true);
+    QVERIFY(entry);
+    QCOMPARE(entry->pts, framePts(0));
+    QVERIFY(!cache.before(framePts(0), 1, true));
+}
+
+void TestFFmpegGopCache::clear()
+{
+    FFmpegGopCache cache(100 * kFrameBytes);
+    fill(cache, 4);
+    cache.clear();
+    QVERIFY(cache.isEmpty());
+    QCOMPARE(cache.bytes(), qint64(0));
+    QCOMPARE(cache.firstPts(), -1.0);
+    QVERIFY(!cache.after(-1.0, 1, true));
+}
+
+QTEST_GUILESS_MAIN(TestFFmpegGopCache)
+#include "tst_ffmpeggopcache.moc"
@@ -0,0 +1,184 @@
+#include "ffmpegkeyframeindex.h"
+#include <QFile>
+#include <QTemporaryDir>
+#include <QtTest>
+
+namespace {
+    constexpr int kTimeBaseNum = 1;
+    constexpr int kTimeBaseDen = 90000;
+
+    std::vector<qint64> sampleKeyframes()
+    {
+        // Unevenly spaced, as after scene-cut keyframes
+        return {0, 3000, 6000, 7501, 9000, 180000};
+    }
+}
+
+class TestFFmpegKeyframeIndex : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void emptyIndexAnswersNothing();
+    void keyframeAtOrBefore();
+    void keyframeAtOrAfter();
+    void resetForgetsIndex();
+    void cacheRoundTrip();
+    void cacheRejectsMismatchedTimeBase();
+    void cacheRejectsOtherVersion();
+    void cacheRejectsTruncatedFile();
+};
+
+void TestFFmpegKeyframeIndex::emptyIndexAnswersNothing()
+{
+    FFmpegKeyframeIndex index;
+    qint64 pts = -1;
+    QVERIFY(!index.keyframeAtOrBefore(1000, &pts));
+    QVERIFY(!index.keyframeAtOrAfter(0, &pts));
+    QCOMPARE(pts, qint64(-1));
+    QCOMPARE(index.count(), 0);
+    QCOMPARE(index.source(), FFmpegKeyframeIndex::NoIndex);
+}
+
+void TestFFmpegKeyframeIndex::keyframeAtOrBefore()
+{
+    FFmpegKeyframeIndex index;
+    index.publish(sampleKeyframes(), FFmpegKeyframeIndex::ScannedIndex);
+    QCOMPARE(index.count(), 6);
+    QCOMPARE(index.source(), FFmpegKeyframeIndex::ScannedIndex);
+
+    qint64 pts = -1;
+    QVERIFY(!index.keyframeAtOrBefore(-1, &pts));  // Before the first keyframe
+    QVERIFY(index.keyframeAtOrBefore(0, &pts));
+    QCOMPARE(pts, qint64(0));
+    QVERIFY(index.keyframeAtOrBefore(2999, &pts));
+    QCOMPARE(pts, qint64(0));
+    QVERIFY(index.keyframeAtOrBefore(3000, &pts));  // Exact hit
+    QCOMPARE(pts, qint64(3000));
+    QVERIFY(index.keyframeAtOrBefore(7500, &pts));
+    QCOMPARE(pts, qint64(6000));
+    QVERIFY(index.keyframeAtOrBefore(1000000, &pts));  // Past the end: last keyframe
+    QCOMPARE(pts, qint64(180000));
+    QVERIFY(index.keyframeAtOrBefore(4000, nullptr));
+}
+
+void TestFFmpegKeyframeIndex::keyframeAtOrAfter()
+{
+    FFmpegKeyframeIndex index;
+    index.publish(sampleKeyframes(), FFmpegKeyframeIndex::ContainerIndex);
+
+    qint64 pts = -1;
+    QVERIFY(index.keyframeAtOrAfter(-100, &pts));
+    QCOMPARE(pts, qint64(0));
+    QVERIFY(index.keyframeAtOrAfter(1, &pts));
+    QCOMPARE(pts, qint64(3000));
+    QVERIFY(index.keyframeAtOrAfter(7501, &pts));  // Exact hit
+    QCOMPARE(pts, qint64(7501));
+    QVERIFY(index.keyframeAtOrAfter(180000, &pts));
+    QCOMPARE(pts, qint64(180000));
+    QVERIFY(!index.keyframeAtOrAfter(180001, &pts));  // Past the last keyframe
+    QVERIFY(index.keyframeAtOrAfter(5000, nullptr));
+}
+
+void TestFFmpegKeyframeIndex::resetForgetsIndex()
+{
+    FFmpegKeyframeIndex index;
+    index.publish(sampleKeyframes(), FFmpegKeyframeIndex::CachedIndex);
+    index.reset();
+    QCOMPARE(index.count(), 0);
+    QCOMPARE(index.source(), FFmpegKeyframeIndex::NoIndex);
+    QVERIFY(!index.keyframeAtOrBefore(5000, nullptr));
+}
+
+void TestFFmpegKeyframeIndex::cacheRoundTrip()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = dir.filePath("keyframe_index/sample_stream0.kfi");  // saveCache() creates the directory
+
+    FFmpegKeyframeIndex written;
+    written.publish(sampleKeyframes(), FFmpegKeyframeIndex::ScannedIndex);
+    written.saveCache(path, kTimeBaseNum, kTimeBaseDen);
+    QVERIFY(QFile::exists(path));
+
+    FFmpegKeyframeIndex loaded;
+    QVERIFY(loaded.loadCache(path, kTimeBaseNum, kTimeBaseDen));
+    QCOMPARE(loaded.source(), FFmpegKeyframeIndex::CachedIndex);
+    QCOMPARE(loaded.count(), written.count());
+
+    // Every keyframe survives the round trip
+    for (qint64 keyframe : sampleKeyframes()) {
+        qint64 pts = -1;
+        QVERIFY(loaded.keyframeAtOrAfter(keyframe, &pts));
+        QCOMPARE(pts, keyframe);
+    }
+}
+
+void TestFFmpegKeyframeIndex::cacheRejectsMismatchedTimeBase()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = dir.filePath("index.kfi");
+
+    FFmpegKeyframeIndex written;
+    written.publish(sampleKeyframes(), FFmpegKeyframeIndex::ScannedIndex);
+    written.saveCache(path, kTimeBaseNum, kTimeBaseDen);
+
+    FFmpegKeyframeIndex loaded;
+    QVERIFY(!loaded.loadCache(path, 1, 1000));
+    QVERIFY(!loaded.loadCache(dir.filePath("missing.kfi"), kTimeBaseNum, kTimeBaseDen));
+    QCOMPARE(loaded.count(), 0);
+    QCOMPARE(loaded.source(), FFmpegKeyframeIndex::NoIndex);
+}
+
+void TestFFmpegKeyframeIndex::cacheRejectsOtherVersion()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = dir.filePath("index.kfi");
+
+    FFmpegKeyframeIndex written;
+    written.publish(sampleKeyframes(), FFmpegKeyframeIndex::ScannedIndex);
+    written.saveCache(path, kTimeBaseNum, kTimeBaseDen);
+
+    // Rewrite the version (big-endian quint32 after the magic) to 1: the DTS-keyed format
+    QFile file(path);
+    QVERIFY(file.open(QIODevice::ReadWrite));
+    QByteArray data = file.readAll();
+    QVERIFY(data.size() > 8);
+    data[4] = 0;
+    data[5] = 0;
+    data[6] = 0;
+    data[7] = 1;
+    QVERIFY(file.seek(0));
+    QCOMPARE(file.write(data), qint64(data.size()));
+    file.close();
+
+    FFmpegKeyframeIndex loaded;
+    QVERIFY(!loaded.loadCache(path, kTimeBaseNum, kTimeBaseDen));
+    QCOMPARE(loaded.count(), 0);
+}
+
+void TestFFmpegKeyframeIndex::cacheRejectsTruncatedFile()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = dir.filePath("index.kfi");
+
+    FFmpegKeyframeIndex written;
+    written.publish(sampleKeyframes(), FFmpegKeyframeIndex::ScannedIndex);
+    written.saveCache(path, kTimeBaseNum, kTimeBaseDen);
+
+    // Drop the last keyframe and a half
+    QFile file(path);
+    QVERIFY(file.open(QIODevice::ReadWrite));
+    QVERIFY(file.resize(file.size() - 12));
+    file.close();
+
+    FFmpegKeyframeIndex loaded;
+    QVERIFY(!loaded.loadCache(path, kTimeBaseNum, kTimeBaseDen));
+    QCOMPARE(loaded.count(), 0);
+}
+
+QTEST_GUILESS_MAIN(TestFFmpegKeyframeIndex)
+#include "tst_ffmpegkeyframeindex.moc"